@@ -0,0 +1,354 @@
+; Compiled from programs/bench/crc16.c
+
+__start:
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0x8800
+    MOVI R0, 16
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x8802
+    MOVI R0, 48
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x8804
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8806
+    MOVI R0, 54
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x8808
+    MOVI R0, 4
+    SHLI R0, R0, 8
+    STORE R0, 0x880A
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x880C
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x880E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x8810
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 6
+    STORE R0, 0x8812
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x8814
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x8816
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x8818
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x881A
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x881C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x881E
+    CALL main
+    HALT
+
+; crc16
+crc16:
+    MOVI R5, -1
+    MOVI R6, 0
+    SHLI R7, R6, 1
+    LOAD R4, 0x8800
+    ADD R7, R7, R4
+    JMP __crc16_4
+__crc16_2:
+    LOAD R4, [R7]
+    SHLI R4, R4, 8
+    XOR R5, R5, R4
+    MOVI R4, 0
+    JMP __crc16_8
+__crc16_3:
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__crc16_4:
+    XOR R3, R6, R1
+    CMPI R3, 0
+    JN __crc16_15
+    CMP R6, R1
+    JC __crc16_2
+__crc16_5:
+    MOV R0, R5
+    JMP __crc16_1
+__crc16_6:
+    LOAD R3, 0x8800
+    AND R3, R5, R3
+    CMPI R3, 0
+    JNZ __crc16_10
+    SHLI R3, R5, 1
+    MOVI R2, -1
+    AND R5, R3, R2
+__crc16_7:
+    ADDI R4, R4, 1
+__crc16_8:
+    MOVI R3, 8
+    CMP R4, R3
+    JC __crc16_6
+    CMPI R4, 0
+    JN __crc16_6
+    JMP __crc16_3
+__crc16_10:
+    SHLI R3, R5, 1
+    LOAD R2, 0x8802
+    XOR R3, R3, R2
+    MOVI R2, -1
+    AND R5, R3, R2
+    JMP __crc16_7
+__crc16_15:
+    CMPI R6, 0
+    JN __crc16_2
+    JMP __crc16_5
+__crc16_1:
+    RET
+
+; main
+main:
+    LOAD R5, 0x8804
+    MOVI R6, 0
+    SHLI R7, R6, 1
+    LOAD R4, 0x8800
+    ADD R7, R7, R4
+    JMP __main_4
+__main_2:
+    LOAD R4, 0x8806
+    MUL R4, R5, R4
+    LOAD R3, 0x8808
+    ADD R4, R4, R3
+    MOVI R3, -1
+    AND R5, R4, R3
+    SHRI R4, R5, 8
+    STORE R4, [R7]
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__main_4:
+    LOAD R4, 0x880A
+    CMP R6, R4
+    JC __main_2
+    CMPI R6, 0
+    JN __main_2
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    LOAD R5, 0x880E
+    STORE R5, 0xF000
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8810
+    STORE R5, 0xF000
+    LOAD R5, 0x8812
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 49
+    STORE R5, 0xF000
+    MOVI R5, 54
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8814
+    STORE R5, 0xF000
+    LOAD R5, 0x8816
+    STORE R5, 0xF000
+    LOAD R5, 0x8818
+    STORE R5, 0xF000
+    LOAD R5, 0x881A
+    STORE R5, 0xF000
+    LOAD R5, 0x881C
+    STORE R5, 0xF000
+    MOVI R5, 58
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 48
+    STORE R5, 0xF000
+    LOAD R5, 0x881E
+    STORE R5, 0xF000
+    MOVI R1, 16
+    PUSH R6
+    CALL crc16
+    POP R6
+    PUSH R6
+    MOV R1, R0
+    CALL __print_hex
+    POP R6
+    MOVI R5, 10
+    STORE R5, 0xF000
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    LOAD R5, 0x880E
+    STORE R5, 0xF000
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8810
+    STORE R5, 0xF000
+    LOAD R5, 0x8812
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 49
+    STORE R5, 0xF000
+    MOVI R5, 48
+    STORE R5, 0xF000
+    MOVI R5, 50
+    STORE R5, 0xF000
+    MOVI R5, 52
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8814
+    STORE R5, 0xF000
+    LOAD R5, 0x8816
+    STORE R5, 0xF000
+    LOAD R5, 0x8818
+    STORE R5, 0xF000
+    LOAD R5, 0x881A
+    STORE R5, 0xF000
+    LOAD R5, 0x881C
+    STORE R5, 0xF000
+    MOVI R5, 58
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 48
+    STORE R5, 0xF000
+    LOAD R5, 0x881E
+    STORE R5, 0xF000
+    LOAD R1, 0x880A
+    PUSH R6
+    CALL crc16
+    POP R6
+    PUSH R6
+    MOV R1, R0
+    CALL __print_hex
+    POP R6
+    MOVI R5, 10
+    STORE R5, 0xF000
+    MOVI R6, 0
+    SHLI R5, R6, 1
+    LOAD R7, 0x8800
+    ADD R5, R5, R7
+    JMP __main_9
+__main_7:
+    MOVI R7, 49
+    ADD R7, R6, R7
+    STORE R7, [R5]
+    ADDI R6, R6, 1
+    ADDI R5, R5, 2
+__main_9:
+    MOVI R7, 9
+    CMP R6, R7
+    JC __main_7
+    CMPI R6, 0
+    JN __main_7
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    LOAD R5, 0x880E
+    STORE R5, 0xF000
+    LOAD R5, 0x880C
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8810
+    STORE R5, 0xF000
+    LOAD R5, 0x8812
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 34
+    STORE R5, 0xF000
+    MOVI R5, 49
+    STORE R5, 0xF000
+    MOVI R5, 50
+    STORE R5, 0xF000
+    MOVI R5, 51
+    STORE R5, 0xF000
+    MOVI R5, 52
+    STORE R5, 0xF000
+    MOVI R5, 53
+    STORE R5, 0xF000
+    MOVI R5, 54
+    STORE R5, 0xF000
+    MOVI R5, 55
+    STORE R5, 0xF000
+    MOVI R5, 56
+    STORE R5, 0xF000
+    MOVI R5, 57
+    STORE R5, 0xF000
+    MOVI R5, 34
+    STORE R5, 0xF000
+    MOVI R5, 58
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 48
+    STORE R5, 0xF000
+    LOAD R5, 0x881E
+    STORE R5, 0xF000
+    MOVI R1, 9
+    CALL crc16
+    MOV R1, R0
+    CALL __print_hex
+    MOVI R5, 10
+    STORE R5, 0xF000
+    MOVI R0, 0
+    RET
+
+; Print R1 in hexadecimal
+__print_hex:
+    MOVI R3, 0
+__print_hex_digit:
+    ANDI R4, R1, 15
+    PUSH R4
+    INC R3
+    SHRI R1, R1, 4
+    CMPI R1, 0
+    JNZ __print_hex_digit
+    MOVI R2, 10
+    MOVI R5, 48
+    MOVI R6, 39
+__print_hex_out:
+    POP R4
+    CMP R4, R2
+    JC __print_hex_decimal
+    ADD R4, R4, R6
+__print_hex_decimal:
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_hex_out
+    RET
@@ -0,0 +1,1166 @@
+; Compiled from programs/bench/dhrystone.c
+
+__start:
+    MOVI R0, 1
+    STORE R0, 0x8392
+    MOVI R0, 2
+    STORE R0, 0x8394
+    MOVI R0, 3
+    STORE R0, 0x8396
+    MOVI R0, 4
+    STORE R0, 0x8398
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x839A
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0x839C
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    STORE R0, 0x839E
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x83A0
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x83A2
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    ORI R0, R0, 8
+    STORE R0, 0x83A4
+    MOVI R0, -8
+    SHLI R0, R0, 8
+    ORI R0, R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0x83A6
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x83A8
+    MOVI R0, 31
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x83AA
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x83AC
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    STORE R0, 0x83AE
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x83B0
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    STORE R0, 0x83B2
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x83B4
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x83B6
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0x83B8
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0x83BA
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x83BC
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x83BE
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x83C0
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x83C2
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x83C4
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x83C6
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x83C8
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x83CA
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x83CC
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    STORE R0, 0x83CE
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x83D0
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x83D2
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0x83D4
+    MOVI R0, -17
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    STORE R0, 0xEFFE
+    CALL main
+    HALT
+
+; Func_1
+Func_1:
+    MOV R5, R1
+    MOV R6, R5
+    CMP R6, R2
+    JNZ __Func_1_2
+    STORE R5, 0x8004
+    LOAD R0, 0x8392
+    JMP __Func_1_1
+__Func_1_2:
+    LOAD R0, 0x8390
+__Func_1_1:
+    RET
+
+; Func_3
+Func_3:
+    LOAD R5, 0x8394
+    CMP R1, R5
+    JZ __Func_3_2
+    MOVI R5, 0
+    JMP __Func_3_4
+__Func_3_2:
+    MOVI R5, 1
+__Func_3_4:
+    MOV R0, R5
+    RET
+
+; Func_2
+Func_2:
+    MOVI R5, 2
+    LOAD R6, 0x839A
+    JMP __Func_2_3
+__Func_2_2:
+    CMPI R5, 2
+    JZ __Func_2_7
+    MOV R7, R1
+    JMP __Func_2_9
+__Func_2_3:
+    CMPI R5, 3
+    JC __Func_2_2
+    CMPI R5, 0
+    JN __Func_2_2
+    LOAD R0, 0x839C
+    CMP R6, R0
+    JC __Func_2_15
+    CMPI R6, 0
+    JN __Func_2_15
+    LOAD R0, 0x839E
+    CMP R6, R0
+    JC __Func_2_14
+    CMPI R6, 0
+    JN __Func_2_14
+    JMP __Func_2_15
+__Func_2_5:
+    LOAD R6, 0x839A
+    ADDI R5, R5, 1
+    JMP __Func_2_3
+__Func_2_7:
+    MOV R7, R2
+__Func_2_9:
+    CMPI R5, 2
+    JZ __Func_2_10
+    ADDI R0, R3, 1
+    JMP __Func_2_12
+__Func_2_10:
+    MOV R0, R4
+__Func_2_12:
+    PUSH R1
+    PUSH R2
+    PUSH R3
+    PUSH R4
+    PUSH R5
+    PUSH R6
+    MOV R1, R7
+    MOV R2, R0
+    CALL Func_1
+    POP R6
+    POP R5
+    POP R4
+    POP R3
+    POP R2
+    POP R1
+    LOAD R7, 0x8390
+    CMP R0, R7
+    JZ __Func_2_5
+    JMP __Func_2_3
+__Func_2_14:
+    MOVI R5, 7
+__Func_2_15:
+    LOAD R7, 0x83A0
+    CMP R6, R7
+    JZ __Func_2_19
+    XOR R6, R4, R2
+    CMPI R6, 0
+    JN __Func_2_25
+    CMP R4, R2
+    JC __Func_2_22
+    JMP __Func_2_23
+__Func_2_19:
+    MOVI R0, 1
+    JMP __Func_2_1
+__Func_2_22:
+    ADDI R5, R5, 7
+    STORE R5, 0x8000
+    MOVI R0, 1
+    JMP __Func_2_1
+__Func_2_23:
+    MOVI R0, 0
+    JMP __Func_2_1
+__Func_2_25:
+    CMPI R4, 0
+    JN __Func_2_22
+    JMP __Func_2_23
+__Func_2_1:
+    RET
+
+; Proc_6
+Proc_6:
+    MOV R5, R1
+    PUSH R1
+    PUSH R5
+    CALL Func_3
+    POP R5
+    POP R1
+    CMPI R0, 0
+    JNZ __Proc_6_3
+    LOAD R5, 0x8396
+__Proc_6_3:
+    LOAD R6, 0x8390
+    CMP R1, R6
+    JZ __Proc_6_4
+    LOAD R6, 0x8392
+    CMP R1, R6
+    JZ __Proc_6_7
+    LOAD R6, 0x8394
+    CMP R1, R6
+    JZ __Proc_6_14
+    LOAD R6, 0x8398
+    CMP R1, R6
+    JZ __Proc_6_17
+    JMP __Proc_6_6
+__Proc_6_4:
+    LOAD R5, 0x8390
+__Proc_6_6:
+    MOV R0, R5
+    JMP __Proc_6_1
+__Proc_6_7:
+    LOAD R6, 0x8000
+    LOAD R7, 0x83A2
+    CMP R6, R7
+    JC __Proc_6_11
+    CMPI R6, 0
+    JN __Proc_6_11
+    LOAD R5, 0x8390
+    JMP __Proc_6_6
+__Proc_6_11:
+    LOAD R5, 0x8396
+    JMP __Proc_6_6
+__Proc_6_14:
+    LOAD R5, 0x8392
+    JMP __Proc_6_6
+__Proc_6_17:
+    LOAD R5, 0x8394
+    JMP __Proc_6_6
+__Proc_6_1:
+    RET
+
+; Proc_7
+Proc_7:
+    ADDI R5, R1, 2
+    ADD R0, R2, R5
+    RET
+
+; Proc_8
+Proc_8:
+    ADDI R5, R1, 5
+    SHLI R6, R5, 1
+    LOAD R7, 0x83A4
+    ADD R6, R6, R7
+    STORE R2, [R6]
+    ADDI R6, R5, 1
+    SHLI R6, R6, 1
+    LOAD R7, 0x83A4
+    ADD R6, R6, R7
+    SHLI R7, R5, 1
+    LOAD R4, 0x83A4
+    ADD R7, R7, R4
+    LOAD R7, [R7]
+    STORE R7, [R6]
+    MOVI R6, 30
+    ADD R6, R5, R6
+    SHLI R6, R6, 1
+    LOAD R7, 0x83A4
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    MOV R6, R5
+    JMP __Proc_8_4
+__Proc_8_2:
+    MOVI R7, 20
+    MUL R7, R5, R7
+    ADD R7, R7, R6
+    SHLI R7, R7, 1
+    LOAD R4, 0x83A6
+    ADD R7, R7, R4
+    STORE R5, [R7]
+    ADDI R6, R6, 1
+__Proc_8_4:
+    ADDI R7, R5, 1
+    XOR R4, R7, R6
+    CMPI R4, 0
+    JN __Proc_8_7
+    CMP R7, R6
+    JNC __Proc_8_2
+__Proc_8_5:
+    MOVI R4, 20
+    MUL R4, R5, R4
+    ADD R4, R4, R5
+    SUBI R4, R4, 1
+    SHLI R4, R4, 1
+    LOAD R3, 0x83A6
+    ADD R4, R4, R3
+    LOAD R3, [R4]
+    ADDI R3, R3, 1
+    STORE R3, [R4]
+    MOVI R4, 10
+    ADD R4, R5, R4
+    MOVI R3, 20
+    MUL R4, R4, R3
+    ADD R4, R4, R5
+    SHLI R4, R4, 1
+    LOAD R3, 0x83A6
+    ADD R4, R4, R3
+    SHLI R3, R5, 1
+    LOAD R2, 0x83A4
+    ADD R3, R3, R2
+    LOAD R3, [R3]
+    STORE R3, [R4]
+    MOVI R4, 5
+    STORE R4, 0x8000
+    JMP __Proc_8_1
+__Proc_8_7:
+    CMPI R7, 0
+    JN __Proc_8_5
+    JMP __Proc_8_2
+__Proc_8_1:
+    RET
+
+; Proc_2
+Proc_2:
+    MOVI R5, 10
+    ADD R5, R1, R5
+    LOAD R6, 0x8392
+__Proc_2_2:
+    LOAD R7, 0x8004
+    LOAD R4, 0x839A
+    CMP R7, R4
+    JZ __Proc_2_5
+    JMP __Proc_2_6
+__Proc_2_4:
+    MOV R0, R1
+    JMP __Proc_2_1
+__Proc_2_5:
+    SUBI R5, R5, 1
+    LOAD R7, 0x8000
+    SUB R1, R5, R7
+    LOAD R6, 0x8390
+__Proc_2_6:
+    LOAD R7, 0x8390
+    CMP R6, R7
+    JZ __Proc_2_4
+    JMP __Proc_2_2
+__Proc_2_1:
+    RET
+
+; Proc_3
+Proc_3:
+    MOVI R1, 10
+    LOAD R2, 0x8000
+    CALL Proc_7
+    STORE R0, 0x838C
+    RET
+
+; Proc_1
+Proc_1:
+    MOVI R1, 5
+    MOVI R5, 5
+    STORE R5, 0x838C
+    PUSH R1
+    CALL Proc_3
+    POP R1
+    LOAD R0, 0x838E
+    LOAD R5, 0x8390
+    CMP R0, R5
+    JNZ __Proc_1_3
+    MOVI R1, 6
+    LOAD R5, 0x8394
+    PUSH R1
+    MOV R1, R5
+    CALL Proc_6
+    POP R1
+    MOVI R2, 10
+    CALL Proc_7
+    MOV R1, R0
+__Proc_1_3:
+    STORE R1, 0x838C
+    RET
+
+; Proc_4
+Proc_4:
+    LOAD R5, 0x8004
+    LOAD R6, 0x839A
+    CMP R5, R6
+    JZ __Proc_4_2
+    MOVI R5, 0
+    JMP __Proc_4_4
+__Proc_4_2:
+    MOVI R5, 1
+__Proc_4_4:
+    LOAD R6, 0x8002
+    OR R5, R5, R6
+    STORE R5, 0x8002
+    LOAD R5, 0x83A8
+    STORE R5, 0x8006
+    RET
+
+; Proc_5
+Proc_5:
+    LOAD R5, 0x839A
+    STORE R5, 0x8004
+    MOVI R5, 0
+    STORE R5, 0x8002
+    RET
+
+; main (frame: 12 bytes)
+main:
+    LOAD R7, 0xEFFE
+    MOVI R6, 12
+    SUB R7, R7, R6
+    STORE R7, 0xEFFE
+    MOVI R5, 0
+    STORE R5, [R7]
+    MOVI R5, 0
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    MOVI R5, 0
+    ADDI R6, R7, 4
+    STORE R5, [R6]
+    MOVI R5, 0
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    LOAD R5, 0x83AA
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    LOAD R1, 0x8394
+    STORE R1, 0x838E
+    MOVI R1, 10
+    STORE R1, 0x81BA
+    MOVI R1, 1
+    JMP __main_4
+__main_2:
+    PUSH R1
+    PUSH R7
+    CALL Proc_5
+    POP R7
+    POP R1
+    PUSH R1
+    PUSH R7
+    CALL Proc_4
+    POP R7
+    POP R1
+    MOVI R5, 2
+    STORE R5, [R7]
+    MOVI R5, 3
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    LOAD R5, 0x8392
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    MOVI R4, 49
+    LOAD R3, 0x83AC
+    MOVI R2, 50
+    LOAD R0, 0x83AE
+    PUSH R1
+    PUSH R7
+    MOV R1, R4
+    MOV R4, R0
+    MOV R0, R2
+    MOV R2, R3
+    MOV R3, R0
+    CALL Func_2
+    POP R7
+    POP R1
+    CMPI R0, 0
+    JNZ __main_7
+    MOVI R4, 1
+    JMP __main_8
+__main_3:
+    ADDI R1, R1, 1
+__main_4:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    XOR R3, R5, R1
+    CMPI R3, 0
+    JN __main_23
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R1
+    JNC __main_2
+__main_5:
+    LOAD R3, 0x83B0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x8000
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R3
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 10
+    STORE R3, 0xF000
+    LOAD R3, 0x83A8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x8002
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R3
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 10
+    STORE R3, 0xF000
+    LOAD R3, 0x83C0
+    STORE R3, 0xF000
+    LOAD R3, 0x83C2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 49
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x8004
+    STORE R3, 0xF000
+    MOVI R3, 44
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x83C0
+    STORE R3, 0xF000
+    LOAD R3, 0x83C2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 50
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x8006
+    STORE R3, 0xF000
+    MOVI R3, 10
+    STORE R3, 0xF000
+    LOAD R3, 0x839A
+    STORE R3, 0xF000
+    LOAD R3, 0x83C4
+    STORE R3, 0xF000
+    LOAD R3, 0x83C4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 49
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    LOAD R3, 0x83C6
+    STORE R3, 0xF000
+    MOVI R3, 56
+    STORE R3, 0xF000
+    LOAD R3, 0x83C8
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x8018
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R3
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 44
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x839A
+    STORE R3, 0xF000
+    LOAD R3, 0x83C4
+    STORE R3, 0xF000
+    LOAD R3, 0x83C4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 50
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B8
+    STORE R3, 0xF000
+    LOAD R3, 0x83BA
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83BE
+    STORE R3, 0xF000
+    LOAD R3, 0x83C6
+    STORE R3, 0xF000
+    MOVI R3, 56
+    STORE R3, 0xF000
+    LOAD R3, 0x83C8
+    STORE R3, 0xF000
+    LOAD R3, 0x83C6
+    STORE R3, 0xF000
+    MOVI R3, 55
+    STORE R3, 0xF000
+    LOAD R3, 0x83C8
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x81BA
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R3
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 10
+    STORE R3, 0xF000
+    LOAD R3, 0x83A0
+    STORE R3, 0xF000
+    LOAD R3, 0x83A2
+    STORE R3, 0xF000
+    LOAD R3, 0x83CA
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83B0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83C0
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CE
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x838C
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R3
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 44
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x83D0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83D2
+    STORE R3, 0xF000
+    LOAD R3, 0x83CC
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83D4
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CA
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    ADDI R1, R7, 6
+    LOAD R1, [R1]
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 10
+    STORE R3, 0xF000
+    LOAD R3, 0x83B0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 49
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83D4
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CA
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    LOAD R1, [R7]
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 44
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x83B0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 50
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83D4
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CA
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    ADDI R1, R7, 2
+    LOAD R1, [R1]
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 44
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    LOAD R3, 0x83B0
+    STORE R3, 0xF000
+    LOAD R3, 0x83B2
+    STORE R3, 0xF000
+    LOAD R3, 0x83B4
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    MOVI R3, 51
+    STORE R3, 0xF000
+    LOAD R3, 0x83B6
+    STORE R3, 0xF000
+    LOAD R3, 0x83D4
+    STORE R3, 0xF000
+    LOAD R3, 0x83BC
+    STORE R3, 0xF000
+    LOAD R3, 0x83CA
+    STORE R3, 0xF000
+    MOVI R3, 58
+    STORE R3, 0xF000
+    MOVI R3, 32
+    STORE R3, 0xF000
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    ADDI R1, R7, 4
+    LOAD R1, [R1]
+    CALL __print_int
+    POP R7
+    POP R4
+    POP R1
+    MOVI R3, 10
+    STORE R3, 0xF000
+    MOVI R5, 0
+    MOVI R6, 10
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    JMP __main_1
+__main_7:
+    MOVI R4, 0
+__main_8:
+    STORE R4, 0x8002
+    JMP __main_10
+__main_9:
+    MOVI R4, 5
+    LOAD R5, [R7]
+    MUL R4, R5, R4
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    SUB R5, R4, R6
+    ADDI R6, R7, 4
+    STORE R5, [R6]
+    PUSH R1
+    PUSH R7
+    LOAD R1, [R7]
+    ADDI R2, R7, 2
+    LOAD R2, [R2]
+    CALL Proc_7
+    POP R7
+    ADDI R6, R7, 4
+    STORE R0, [R6]
+    POP R1
+    LOAD R5, [R7]
+    ADDI R5, R5, 1
+    STORE R5, [R7]
+__main_10:
+    LOAD R5, [R7]
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    XOR R4, R5, R6
+    CMPI R4, 0
+    JN __main_13
+    LOAD R5, [R7]
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    CMP R5, R6
+    JC __main_9
+__main_11:
+    PUSH R1
+    PUSH R7
+    LOAD R1, [R7]
+    ADDI R2, R7, 4
+    LOAD R2, [R2]
+    CALL Proc_8
+    POP R7
+    POP R1
+    PUSH R1
+    PUSH R7
+    CALL Proc_1
+    POP R7
+    POP R1
+    LOAD R4, 0x839A
+    JMP __main_16
+__main_13:
+    LOAD R5, [R7]
+    CMPI R5, 0
+    JN __main_9
+    JMP __main_11
+__main_14:
+    LOAD R2, 0x83C0
+    PUSH R1
+    PUSH R4
+    PUSH R7
+    MOV R1, R4
+    CALL Func_1
+    MOV R3, R0
+    POP R7
+    POP R4
+    POP R1
+    ADDI R5, R7, 6
+    LOAD R5, [R5]
+    CMP R5, R3
+    JZ __main_18
+__main_15:
+    ADDI R4, R4, 1
+__main_16:
+    LOAD R3, 0x8006
+    XOR R2, R3, R4
+    CMPI R2, 0
+    JN __main_21
+    CMP R3, R4
+    JNC __main_14
+__main_17:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    LOAD R6, [R7]
+    MUL R5, R5, R6
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    PUSH R1
+    PUSH R3
+    PUSH R4
+    PUSH R7
+    ADDI R1, R7, 2
+    LOAD R1, [R1]
+    ADDI R2, R7, 4
+    LOAD R2, [R2]
+    CALL __divs
+    POP R7
+    STORE R0, [R7]
+    POP R4
+    POP R3
+    POP R1
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    ADDI R6, R7, 4
+    LOAD R6, [R6]
+    SUB R2, R5, R6
+    MOVI R0, 7
+    MUL R2, R2, R0
+    LOAD R6, [R7]
+    SUB R5, R2, R6
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    PUSH R1
+    PUSH R3
+    PUSH R4
+    PUSH R7
+    LOAD R1, [R7]
+    CALL Proc_2
+    POP R7
+    STORE R0, [R7]
+    POP R4
+    POP R3
+    POP R1
+    JMP __main_3
+__main_18:
+    LOAD R2, 0x8390
+    PUSH R1
+    PUSH R3
+    PUSH R4
+    PUSH R7
+    MOV R1, R2
+    CALL Proc_6
+    POP R7
+    ADDI R6, R7, 6
+    STORE R0, [R6]
+    POP R4
+    POP R3
+    POP R1
+    ADDI R6, R7, 2
+    STORE R1, [R6]
+    STORE R1, 0x8000
+    JMP __main_15
+__main_21:
+    CMPI R3, 0
+    JN __main_17
+    JMP __main_14
+__main_23:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_5
+    JMP __main_2
+__main_1:
+    MOVI R0, 10
+    ADD R0, R0, R7
+    LOAD R0, [R0]
+    MOVI R6, 12
+    ADD R7, R7, R6
+    STORE R7, 0xEFFE
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
+
+; Signed R1 / R2 and R1 % R2 via unsigned DIV
+__divs:
+    XOR R6, R1, R2
+    CALL __abs_operands
+    DIV R0, R1, R2
+    JMP __apply_sign
+__apply_sign:
+    CMPI R6, 0
+    JN __apply_sign_negate
+    RET
+__apply_sign_negate:
+    NOT R0, R0
+    INC R0
+    RET
+__abs_operands:
+    CMPI R1, 0
+    JN __abs_operands_negate1
+__abs_operands_check2:
+    CMPI R2, 0
+    JN __abs_operands_negate2
+    RET
+__abs_operands_negate1:
+    NOT R1, R1
+    INC R1
+    JMP __abs_operands_check2
+__abs_operands_negate2:
+    NOT R2, R2
+    INC R2
+    RET
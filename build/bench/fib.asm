@@ -0,0 +1,117 @@
+; Compiled from programs/bench/fib.c
+
+__start:
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 6
+    STORE R0, 0x8000
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x8002
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x8004
+    CALL main
+    HALT
+
+; fib
+fib:
+    CMPI R1, 2
+    JC __fib_2
+    CMPI R1, 0
+    JN __fib_2
+    SUBI R5, R1, 1
+    PUSH R1
+    MOV R1, R5
+    CALL fib
+    POP R1
+    SUBI R5, R1, 2
+    PUSH R0
+    PUSH R1
+    MOV R1, R5
+    CALL fib
+    MOV R5, R0
+    POP R1
+    POP R0
+    ADD R0, R0, R5
+    JMP __fib_1
+__fib_2:
+    MOV R0, R1
+__fib_1:
+    RET
+
+; main
+main:
+    MOVI R1, 0
+    JMP __main_4
+__main_2:
+    LOAD R5, 0x8000
+    STORE R5, 0xF000
+    LOAD R5, 0x8002
+    STORE R5, 0xF000
+    LOAD R5, 0x8004
+    STORE R5, 0xF000
+    MOVI R5, 40
+    STORE R5, 0xF000
+    PUSH R1
+    CALL __print_int
+    POP R1
+    MOVI R5, 41
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    MOVI R5, 61
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    PUSH R1
+    CALL fib
+    POP R1
+    PUSH R1
+    MOV R1, R0
+    CALL __print_int
+    POP R1
+    MOVI R5, 10
+    STORE R5, 0xF000
+    ADDI R1, R1, 5
+__main_4:
+    MOVI R5, 21
+    CMP R1, R5
+    JC __main_2
+    CMPI R1, 0
+    JN __main_2
+    MOVI R0, 0
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
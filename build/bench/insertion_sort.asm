@@ -0,0 +1,431 @@
+; Compiled from programs/bench/insertion_sort.c
+
+__start:
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x8320
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0x8322
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8324
+    MOVI R0, 54
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x8326
+    MOVI R0, 63
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x8328
+    MOVI R0, 32
+    SHLI R0, R0, 8
+    STORE R0, 0x832A
+    MOVI R0, 25
+    SHLI R0, R0, 4
+    STORE R0, 0x832C
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x832E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x8330
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x8332
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x8334
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8336
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x8338
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x833A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x833C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    STORE R0, 0x833E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x8340
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x8342
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x8344
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x8346
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x8348
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x834A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x834C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x834E
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8350
+    CALL main
+    HALT
+
+; insertion_sort
+insertion_sort:
+    MOVI R5, 1
+    SHLI R6, R5, 1
+    ADD R6, R1, R6
+    JMP __insertion_sort_4
+__insertion_sort_2:
+    LOAD R7, [R6]
+    SUBI R4, R5, 1
+    JMP __insertion_sort_7
+__insertion_sort_3:
+    ADDI R5, R5, 1
+    ADDI R6, R6, 2
+__insertion_sort_4:
+    XOR R3, R5, R2
+    CMPI R3, 0
+    JN __insertion_sort_13
+    CMP R5, R2
+    JC __insertion_sort_2
+    JMP __insertion_sort_1
+__insertion_sort_6:
+    ADDI R3, R4, 1
+    SHLI R3, R3, 1
+    ADD R3, R1, R3
+    SHLI R0, R4, 1
+    ADD R0, R1, R0
+    LOAD R0, [R0]
+    STORE R0, [R3]
+    ADDI R4, R4, -1
+__insertion_sort_7:
+    CMPI R4, 0
+    JN __insertion_sort_8
+    SHLI R3, R4, 1
+    ADD R3, R1, R3
+    LOAD R3, [R3]
+    XOR R0, R7, R3
+    CMPI R0, 0
+    JN __insertion_sort_11
+    CMP R7, R3
+    JC __insertion_sort_6
+__insertion_sort_8:
+    ADDI R3, R4, 1
+    SHLI R3, R3, 1
+    ADD R3, R1, R3
+    STORE R7, [R3]
+    JMP __insertion_sort_3
+__insertion_sort_11:
+    CMPI R7, 0
+    JN __insertion_sort_6
+    JMP __insertion_sort_8
+__insertion_sort_13:
+    CMPI R5, 0
+    JN __insertion_sort_2
+__insertion_sort_1:
+    RET
+
+; main
+main:
+    LOAD R5, 0x8320
+    MOVI R1, 0
+    MOVI R6, 1
+    MOVI R7, 0
+    SHLI R4, R7, 1
+    LOAD R3, 0x8322
+    ADD R4, R4, R3
+    JMP __main_4
+__main_2:
+    LOAD R3, 0x8324
+    MUL R3, R5, R3
+    LOAD R2, 0x8326
+    ADD R3, R3, R2
+    MOVI R2, -1
+    AND R5, R3, R2
+    LOAD R3, 0x8328
+    AND R3, R5, R3
+    LOAD R2, 0x832A
+    SUB R3, R3, R2
+    STORE R3, [R4]
+    ADDI R7, R7, 1
+    ADDI R4, R4, 2
+__main_4:
+    LOAD R3, 0x832C
+    CMP R7, R3
+    JC __main_2
+    CMPI R7, 0
+    JN __main_2
+    LOAD R5, 0x8322
+    LOAD R2, 0x832C
+    PUSH R1
+    PUSH R6
+    PUSH R7
+    MOV R1, R5
+    CALL insertion_sort
+    POP R7
+    POP R6
+    POP R1
+    MOVI R7, 0
+    SHLI R5, R7, 1
+    LOAD R4, 0x8322
+    ADD R5, R5, R4
+    JMP __main_9
+__main_7:
+    CMPI R7, 1
+    JC __main_12
+    CMPI R7, 0
+    JN __main_12
+    SUBI R4, R7, 1
+    SHLI R4, R4, 1
+    LOAD R3, 0x8322
+    ADD R4, R4, R3
+    LOAD R4, [R4]
+    LOAD R3, [R5]
+    XOR R2, R3, R4
+    CMPI R2, 0
+    JN __main_16
+    CMP R3, R4
+    JC __main_11
+    JMP __main_12
+__main_8:
+    ADDI R7, R7, 1
+    ADDI R5, R5, 2
+__main_9:
+    LOAD R4, 0x832C
+    CMP R7, R4
+    JC __main_7
+    CMPI R7, 0
+    JN __main_7
+    LOAD R4, 0x832E
+    STORE R4, 0xF000
+    LOAD R4, 0x8330
+    STORE R4, 0xF000
+    LOAD R4, 0x8332
+    STORE R4, 0xF000
+    LOAD R4, 0x8334
+    STORE R4, 0xF000
+    LOAD R4, 0x8336
+    STORE R4, 0xF000
+    LOAD R4, 0x8338
+    STORE R4, 0xF000
+    MOVI R4, 58
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R6
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    LOAD R4, 0x833A
+    STORE R4, 0xF000
+    LOAD R4, 0x833C
+    STORE R4, 0xF000
+    LOAD R4, 0x833E
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 44
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8340
+    STORE R4, 0xF000
+    LOAD R4, 0x8336
+    STORE R4, 0xF000
+    LOAD R4, 0x8338
+    STORE R4, 0xF000
+    LOAD R4, 0x833C
+    STORE R4, 0xF000
+    LOAD R4, 0x8342
+    STORE R4, 0xF000
+    LOAD R4, 0x833E
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8190
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 44
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8340
+    STORE R4, 0xF000
+    LOAD R4, 0x8342
+    STORE R4, 0xF000
+    LOAD R4, 0x8344
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x831E
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    LOAD R4, 0x8346
+    STORE R4, 0xF000
+    LOAD R4, 0x8348
+    STORE R4, 0xF000
+    LOAD R4, 0x8336
+    STORE R4, 0xF000
+    LOAD R4, 0x834A
+    STORE R4, 0xF000
+    LOAD R4, 0x834C
+    STORE R4, 0xF000
+    LOAD R4, 0x834E
+    STORE R4, 0xF000
+    LOAD R4, 0x8350
+    STORE R4, 0xF000
+    LOAD R4, 0x8340
+    STORE R4, 0xF000
+    MOVI R4, 58
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    CALL __print_uint
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    MOVI R0, 0
+    JMP __main_1
+__main_11:
+    MOVI R6, 0
+__main_12:
+    MOVI R4, 31
+    MUL R4, R1, R4
+    LOAD R2, [R5]
+    ADD R4, R4, R2
+    MOVI R2, -1
+    AND R1, R4, R2
+    JMP __main_8
+__main_16:
+    CMPI R3, 0
+    JN __main_11
+    JMP __main_12
+__main_1:
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
@@ -0,0 +1,433 @@
+; Compiled from programs/bench/matmul.c
+
+__start:
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0x8600
+    MOVI R0, -8
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 8
+    STORE R0, 0x8602
+    MOVI R0, -8
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    SHLI R0, R0, 8
+    STORE R0, 0x8604
+    MOVI R0, 16
+    SHLI R0, R0, 4
+    STORE R0, 0x8606
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x8608
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x860A
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x860C
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x860E
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x8610
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x8612
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8614
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x8616
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x8618
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x861A
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x861C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x861E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x8620
+    CALL main
+    HALT
+
+; matmul
+matmul:
+    MOVI R5, 0
+    JMP __matmul_4
+__matmul_2:
+    MOVI R6, 0
+    JMP __matmul_8
+__matmul_3:
+    ADDI R5, R5, 1
+__matmul_4:
+    XOR R7, R5, R1
+    CMPI R7, 0
+    JN __matmul_19
+    CMP R5, R1
+    JC __matmul_2
+    JMP __matmul_1
+__matmul_6:
+    MOVI R7, 0
+    MOVI R4, 0
+    JMP __matmul_12
+__matmul_7:
+    ADDI R6, R6, 1
+__matmul_8:
+    XOR R3, R6, R1
+    CMPI R3, 0
+    JN __matmul_17
+    CMP R6, R1
+    JC __matmul_6
+    JMP __matmul_3
+__matmul_10:
+    MUL R3, R5, R1
+    ADD R3, R3, R4
+    SHLI R3, R3, 1
+    LOAD R2, 0x8600
+    ADD R3, R3, R2
+    LOAD R3, [R3]
+    MUL R2, R4, R1
+    ADD R2, R2, R6
+    SHLI R2, R2, 1
+    LOAD R0, 0x8602
+    ADD R2, R2, R0
+    LOAD R2, [R2]
+    MUL R3, R3, R2
+    ADD R7, R7, R3
+    ADDI R4, R4, 1
+__matmul_12:
+    XOR R3, R4, R1
+    CMPI R3, 0
+    JN __matmul_15
+    CMP R4, R1
+    JC __matmul_10
+__matmul_13:
+    MUL R3, R5, R1
+    ADD R3, R3, R6
+    SHLI R3, R3, 1
+    LOAD R2, 0x8604
+    ADD R3, R3, R2
+    STORE R7, [R3]
+    JMP __matmul_7
+__matmul_15:
+    CMPI R4, 0
+    JN __matmul_10
+    JMP __matmul_13
+__matmul_17:
+    CMPI R6, 0
+    JN __matmul_6
+    JMP __matmul_3
+__matmul_19:
+    CMPI R5, 0
+    JN __matmul_2
+__matmul_1:
+    RET
+
+; main
+main:
+    MOVI R1, 0
+    MOVI R5, 0
+    MOVI R6, 0
+    SHLI R7, R6, 1
+    LOAD R4, 0x8600
+    ADD R7, R7, R4
+    SHLI R4, R6, 1
+    LOAD R3, 0x8602
+    ADD R4, R4, R3
+    JMP __main_4
+__main_2:
+    MOVI R3, 7
+    MUL R3, R6, R3
+    ADDI R3, R3, 3
+    MOVI R2, 11
+    PUSH R1
+    PUSH R4
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R3
+    CALL __mods
+    POP R7
+    POP R6
+    POP R5
+    POP R4
+    POP R1
+    SUBI R3, R0, 5
+    STORE R3, [R7]
+    MOVI R3, 5
+    MUL R3, R6, R3
+    ADDI R3, R3, 1
+    MOVI R2, 13
+    PUSH R1
+    PUSH R4
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R3
+    CALL __mods
+    POP R7
+    POP R6
+    POP R5
+    POP R4
+    POP R1
+    SUBI R3, R0, 6
+    STORE R3, [R4]
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+    ADDI R4, R4, 2
+__main_4:
+    LOAD R3, 0x8606
+    CMP R6, R3
+    JC __main_2
+    CMPI R6, 0
+    JN __main_2
+    MOVI R7, 0
+    JMP __main_9
+__main_7:
+    MOVI R4, 16
+    PUSH R1
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL matmul
+    POP R7
+    POP R6
+    POP R5
+    POP R1
+    ADDI R7, R7, 1
+__main_9:
+    CMPI R7, 4
+    JC __main_7
+    CMPI R7, 0
+    JN __main_7
+    MOVI R6, 0
+    SHLI R7, R6, 1
+    LOAD R4, 0x8604
+    ADD R7, R7, R4
+    JMP __main_14
+__main_12:
+    MOVI R4, 31
+    MUL R4, R1, R4
+    LOAD R3, [R7]
+    ADD R4, R4, R3
+    MOVI R3, -1
+    AND R1, R4, R3
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__main_14:
+    LOAD R4, 0x8606
+    CMP R6, R4
+    JC __main_12
+    CMPI R6, 0
+    JN __main_12
+    MOVI R6, 0
+    JMP __main_19
+__main_17:
+    SHLI R7, R6, 4
+    ADD R7, R7, R6
+    SHLI R7, R7, 1
+    LOAD R4, 0x8604
+    ADD R7, R7, R4
+    LOAD R7, [R7]
+    ADD R5, R5, R7
+    ADDI R6, R6, 1
+__main_19:
+    MOVI R7, 16
+    CMP R6, R7
+    JC __main_17
+    CMPI R6, 0
+    JN __main_17
+    LOAD R6, 0x8608
+    STORE R6, 0xF000
+    LOAD R6, 0x860A
+    STORE R6, 0xF000
+    MOVI R6, 48
+    STORE R6, 0xF000
+    LOAD R6, 0x860C
+    STORE R6, 0xF000
+    LOAD R6, 0x860A
+    STORE R6, 0xF000
+    MOVI R6, 48
+    STORE R6, 0xF000
+    LOAD R6, 0x860C
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    MOVI R6, 61
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0x8400
+    PUSH R1
+    PUSH R5
+    MOV R1, R6
+    CALL __print_int
+    POP R5
+    POP R1
+    MOVI R6, 44
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0x8608
+    STORE R6, 0xF000
+    LOAD R6, 0x860A
+    STORE R6, 0xF000
+    MOVI R6, 49
+    STORE R6, 0xF000
+    MOVI R6, 53
+    STORE R6, 0xF000
+    LOAD R6, 0x860C
+    STORE R6, 0xF000
+    LOAD R6, 0x860A
+    STORE R6, 0xF000
+    MOVI R6, 49
+    STORE R6, 0xF000
+    MOVI R6, 53
+    STORE R6, 0xF000
+    LOAD R6, 0x860C
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    MOVI R6, 61
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0x85FE
+    PUSH R1
+    PUSH R5
+    MOV R1, R6
+    CALL __print_int
+    POP R5
+    POP R1
+    MOVI R6, 10
+    STORE R6, 0xF000
+    LOAD R6, 0x860E
+    STORE R6, 0xF000
+    LOAD R6, 0x8610
+    STORE R6, 0xF000
+    LOAD R6, 0x8612
+    STORE R6, 0xF000
+    LOAD R6, 0x8608
+    STORE R6, 0xF000
+    LOAD R6, 0x8614
+    STORE R6, 0xF000
+    MOVI R6, 58
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    PUSH R1
+    MOV R1, R5
+    CALL __print_int
+    POP R1
+    MOVI R5, 10
+    STORE R5, 0xF000
+    LOAD R5, 0x8616
+    STORE R5, 0xF000
+    LOAD R5, 0x8618
+    STORE R5, 0xF000
+    LOAD R5, 0x8614
+    STORE R5, 0xF000
+    LOAD R5, 0x8608
+    STORE R5, 0xF000
+    LOAD R5, 0x861A
+    STORE R5, 0xF000
+    LOAD R5, 0x861C
+    STORE R5, 0xF000
+    LOAD R5, 0x861E
+    STORE R5, 0xF000
+    LOAD R5, 0x8620
+    STORE R5, 0xF000
+    MOVI R5, 58
+    STORE R5, 0xF000
+    MOVI R5, 32
+    STORE R5, 0xF000
+    CALL __print_uint
+    MOVI R5, 10
+    STORE R5, 0xF000
+    MOVI R0, 0
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
+
+; Signed R1 / R2 and R1 % R2 via unsigned DIV
+__mods:
+    MOV R6, R1
+    CALL __abs_operands
+    DIV R0, R1, R2
+    MUL R0, R0, R2
+    SUB R0, R1, R0
+__apply_sign:
+    CMPI R6, 0
+    JN __apply_sign_negate
+    RET
+__apply_sign_negate:
+    NOT R0, R0
+    INC R0
+    RET
+__abs_operands:
+    CMPI R1, 0
+    JN __abs_operands_negate1
+__abs_operands_check2:
+    CMPI R2, 0
+    JN __abs_operands_negate2
+    RET
+__abs_operands_negate1:
+    NOT R1, R1
+    INC R1
+    JMP __abs_operands_check2
+__abs_operands_negate2:
+    NOT R2, R2
+    INC R2
+    RET
@@ -0,0 +1,792 @@
+; Compiled from programs/bench/quicksort.c
+
+__start:
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0x9770
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x9772
+    MOVI R0, 54
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x9774
+    MOVI R0, 31
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    SHLI R0, R0, 4
+    STORE R0, 0x9776
+    MOVI R0, 11
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x9778
+    MOVI R0, 11
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0x977A
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x977C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0x977E
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x9780
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x9782
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x9784
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x9786
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x9788
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0x978A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    STORE R0, 0x978C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0x978E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x9790
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x9792
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x9794
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x9796
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x9798
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x979A
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x979C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x979E
+    MOVI R0, -17
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    STORE R0, 0xEFFE
+    CALL main
+    HALT
+
+; quicksort (frame: 14 bytes)
+quicksort:
+    LOAD R7, 0xEFFE
+    MOVI R6, 14
+    SUB R7, R7, R6
+    STORE R7, 0xEFFE
+    STORE R1, [R7]
+    ADDI R6, R7, 2
+    STORE R2, [R6]
+    ADDI R6, R7, 4
+    STORE R3, [R6]
+    JMP __quicksort_3
+__quicksort_2:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    SUB R4, R5, R6
+    MOVI R0, 2
+    PUSH R7
+    MOV R1, R4
+    MOV R2, R0
+    CALL __divs
+    POP R7
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    ADD R4, R5, R0
+    SHLI R0, R4, 1
+    LOAD R5, [R7]
+    ADD R0, R5, R0
+    LOAD R0, [R0]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R1, R5, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    XOR R2, R0, R1
+    CMPI R2, 0
+    JN __quicksort_8
+    CMP R0, R1
+    JC __quicksort_5
+    JMP __quicksort_6
+__quicksort_3:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    ADDI R6, R7, 4
+    LOAD R6, [R6]
+    XOR R2, R5, R6
+    CMPI R2, 0
+    JN __quicksort_33
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    ADDI R6, R7, 4
+    LOAD R6, [R6]
+    CMP R5, R6
+    JC __quicksort_2
+    JMP __quicksort_1
+__quicksort_5:
+    SHLI R2, R4, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    LOAD R5, [R2]
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    SHLI R1, R4, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R3, [R3]
+    STORE R3, [R1]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    ADDI R6, R7, 6
+    LOAD R6, [R6]
+    STORE R6, [R3]
+__quicksort_6:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R3, [R3]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R1, R5, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    XOR R2, R3, R1
+    CMPI R2, 0
+    JN __quicksort_12
+    CMP R3, R1
+    JC __quicksort_9
+    JMP __quicksort_10
+__quicksort_8:
+    CMPI R0, 0
+    JN __quicksort_5
+    JMP __quicksort_6
+__quicksort_9:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R2, R5, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    LOAD R5, [R2]
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R2, R5, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R1, R5, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    STORE R1, [R2]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R2, R5, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    ADDI R6, R7, 6
+    LOAD R6, [R6]
+    STORE R6, [R2]
+__quicksort_10:
+    SHLI R2, R4, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    LOAD R2, [R2]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R1, R5, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    XOR R0, R2, R1
+    CMPI R0, 0
+    JN __quicksort_16
+    CMP R2, R1
+    JC __quicksort_13
+    JMP __quicksort_14
+__quicksort_12:
+    CMPI R3, 0
+    JN __quicksort_9
+    JMP __quicksort_10
+__quicksort_13:
+    SHLI R3, R4, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R5, [R3]
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    SHLI R3, R4, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R1, R5, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    STORE R1, [R3]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    ADDI R6, R7, 6
+    LOAD R6, [R6]
+    STORE R6, [R3]
+__quicksort_14:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R5, [R3]
+    MOVI R6, 10
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    MOV R0, R5
+    SHLI R1, R0, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    JMP __quicksort_19
+__quicksort_16:
+    CMPI R2, 0
+    JN __quicksort_13
+    JMP __quicksort_14
+__quicksort_17:
+    LOAD R4, [R1]
+    MOVI R6, 10
+    ADD R6, R6, R7
+    LOAD R6, [R6]
+    XOR R2, R4, R6
+    CMPI R2, 0
+    JN __quicksort_24
+    MOVI R6, 10
+    ADD R6, R6, R7
+    LOAD R6, [R6]
+    CMP R4, R6
+    JC __quicksort_21
+__quicksort_18:
+    ADDI R0, R0, 1
+    ADDI R1, R1, 2
+__quicksort_19:
+    ADDI R6, R7, 4
+    LOAD R6, [R6]
+    XOR R2, R0, R6
+    CMPI R2, 0
+    JN __quicksort_26
+    ADDI R6, R7, 4
+    LOAD R6, [R6]
+    CMP R0, R6
+    JC __quicksort_17
+__quicksort_20:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SHLI R2, R5, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    LOAD R5, [R2]
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SHLI R2, R5, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R3, [R3]
+    STORE R3, [R2]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    ADDI R6, R7, 6
+    LOAD R6, [R6]
+    STORE R6, [R3]
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    SUB R5, R5, R6
+    MOVI R6, 12
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    MOVI R6, 8
+    ADD R6, R6, R7
+    LOAD R6, [R6]
+    SUB R2, R5, R6
+    MOVI R5, 12
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    XOR R3, R5, R2
+    CMPI R3, 0
+    JN __quicksort_31
+    MOVI R5, 12
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R2
+    JC __quicksort_27
+    JMP __quicksort_28
+__quicksort_21:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R5, [R3]
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SHLI R3, R5, 1
+    LOAD R5, [R7]
+    ADD R3, R5, R3
+    LOAD R2, [R1]
+    STORE R2, [R3]
+    ADDI R6, R7, 6
+    LOAD R6, [R6]
+    STORE R6, [R1]
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    ADDI R5, R5, 1
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    JMP __quicksort_18
+__quicksort_24:
+    CMPI R4, 0
+    JN __quicksort_21
+    JMP __quicksort_18
+__quicksort_26:
+    CMPI R0, 0
+    JN __quicksort_17
+    JMP __quicksort_20
+__quicksort_27:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SUBI R3, R5, 1
+    PUSH R7
+    LOAD R1, [R7]
+    ADDI R2, R7, 2
+    LOAD R2, [R2]
+    CALL quicksort
+    POP R7
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    ADDI R5, R5, 1
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    JMP __quicksort_3
+__quicksort_28:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    ADDI R2, R5, 1
+    PUSH R7
+    LOAD R1, [R7]
+    ADDI R3, R7, 4
+    LOAD R3, [R3]
+    CALL quicksort
+    POP R7
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    SUBI R5, R5, 1
+    ADDI R6, R7, 4
+    STORE R5, [R6]
+    JMP __quicksort_3
+__quicksort_31:
+    MOVI R5, 12
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __quicksort_27
+    JMP __quicksort_28
+__quicksort_33:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __quicksort_2
+__quicksort_1:
+    MOVI R6, 14
+    ADD R7, R7, R6
+    STORE R7, 0xEFFE
+    RET
+
+; main
+main:
+    MOVI R5, 7
+    MOVI R1, 0
+    MOVI R6, 1
+    MOVI R7, 0
+    SHLI R4, R7, 1
+    LOAD R3, 0x9770
+    ADD R4, R4, R3
+    JMP __main_4
+__main_2:
+    LOAD R3, 0x9772
+    MUL R3, R5, R3
+    LOAD R2, 0x9774
+    ADD R3, R3, R2
+    MOVI R2, -1
+    AND R5, R3, R2
+    SHRI R3, R5, 2
+    LOAD R2, 0x9776
+    SUB R3, R3, R2
+    STORE R3, [R4]
+    ADDI R7, R7, 1
+    ADDI R4, R4, 2
+__main_4:
+    LOAD R3, 0x9778
+    CMP R7, R3
+    JC __main_2
+    CMPI R7, 0
+    JN __main_2
+    LOAD R5, 0x9770
+    MOVI R2, 0
+    LOAD R3, 0x977A
+    PUSH R1
+    PUSH R6
+    PUSH R7
+    MOV R1, R5
+    CALL quicksort
+    POP R7
+    POP R6
+    POP R1
+    MOVI R7, 0
+    SHLI R5, R7, 1
+    LOAD R4, 0x9770
+    ADD R5, R5, R4
+    JMP __main_9
+__main_7:
+    CMPI R7, 1
+    JC __main_12
+    CMPI R7, 0
+    JN __main_12
+    SUBI R4, R7, 1
+    SHLI R4, R4, 1
+    LOAD R3, 0x9770
+    ADD R4, R4, R3
+    LOAD R4, [R4]
+    LOAD R3, [R5]
+    XOR R2, R3, R4
+    CMPI R2, 0
+    JN __main_16
+    CMP R3, R4
+    JC __main_11
+    JMP __main_12
+__main_8:
+    ADDI R7, R7, 1
+    ADDI R5, R5, 2
+__main_9:
+    LOAD R4, 0x9778
+    CMP R7, R4
+    JC __main_7
+    CMPI R7, 0
+    JN __main_7
+    LOAD R4, 0x977C
+    STORE R4, 0xF000
+    LOAD R4, 0x977E
+    STORE R4, 0xF000
+    LOAD R4, 0x9780
+    STORE R4, 0xF000
+    LOAD R4, 0x9782
+    STORE R4, 0xF000
+    LOAD R4, 0x9784
+    STORE R4, 0xF000
+    LOAD R4, 0x9786
+    STORE R4, 0xF000
+    MOVI R4, 58
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R6
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    LOAD R4, 0x9788
+    STORE R4, 0xF000
+    LOAD R4, 0x978A
+    STORE R4, 0xF000
+    LOAD R4, 0x978C
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 44
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x978E
+    STORE R4, 0xF000
+    LOAD R4, 0x9784
+    STORE R4, 0xF000
+    LOAD R4, 0x9786
+    STORE R4, 0xF000
+    LOAD R4, 0x978A
+    STORE R4, 0xF000
+    LOAD R4, 0x9790
+    STORE R4, 0xF000
+    LOAD R4, 0x978C
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x8BB8
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 44
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x978E
+    STORE R4, 0xF000
+    LOAD R4, 0x9790
+    STORE R4, 0xF000
+    LOAD R4, 0x9792
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    LOAD R4, 0x976E
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    MOV R1, R4
+    CALL __print_int
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    LOAD R4, 0x9794
+    STORE R4, 0xF000
+    LOAD R4, 0x9796
+    STORE R4, 0xF000
+    LOAD R4, 0x9784
+    STORE R4, 0xF000
+    LOAD R4, 0x9798
+    STORE R4, 0xF000
+    LOAD R4, 0x979A
+    STORE R4, 0xF000
+    LOAD R4, 0x979C
+    STORE R4, 0xF000
+    LOAD R4, 0x979E
+    STORE R4, 0xF000
+    LOAD R4, 0x978E
+    STORE R4, 0xF000
+    MOVI R4, 58
+    STORE R4, 0xF000
+    MOVI R4, 32
+    STORE R4, 0xF000
+    PUSH R1
+    PUSH R3
+    PUSH R5
+    PUSH R6
+    PUSH R7
+    CALL __print_uint
+    POP R7
+    POP R6
+    POP R5
+    POP R3
+    POP R1
+    MOVI R4, 10
+    STORE R4, 0xF000
+    MOVI R0, 0
+    JMP __main_1
+__main_11:
+    MOVI R6, 0
+__main_12:
+    MOVI R4, 31
+    MUL R4, R1, R4
+    LOAD R2, [R5]
+    ADD R4, R4, R2
+    MOVI R2, -1
+    AND R1, R4, R2
+    JMP __main_8
+__main_16:
+    CMPI R3, 0
+    JN __main_11
+    JMP __main_12
+__main_1:
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
+
+; Signed R1 / R2 and R1 % R2 via unsigned DIV
+__divs:
+    XOR R6, R1, R2
+    CALL __abs_operands
+    DIV R0, R1, R2
+    JMP __apply_sign
+__apply_sign:
+    CMPI R6, 0
+    JN __apply_sign_negate
+    RET
+__apply_sign_negate:
+    NOT R0, R0
+    INC R0
+    RET
+__abs_operands:
+    CMPI R1, 0
+    JN __abs_operands_negate1
+__abs_operands_check2:
+    CMPI R2, 0
+    JN __abs_operands_negate2
+    RET
+__abs_operands_negate1:
+    NOT R1, R1
+    INC R1
+    JMP __abs_operands_check2
+__abs_operands_negate2:
+    NOT R2, R2
+    INC R2
+    RET
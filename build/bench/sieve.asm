@@ -0,0 +1,305 @@
+; Compiled from programs/bench/sieve.c
+
+__start:
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0xC000
+    MOVI R0, 32
+    SHLI R0, R0, 8
+    STORE R0, 0xC002
+    MOVI R0, 31
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0xC004
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    STORE R0, 0xC006
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xC008
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0xC00A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0xC00C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0xC00E
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0xC010
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xC012
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0xC014
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0xC016
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0xC018
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0xC01A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xC01C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0xC01E
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0xC020
+    CALL main
+    HALT
+
+; sieve
+sieve:
+    MOVI R5, 0
+    MOVI R6, 2
+    SHLI R7, R6, 1
+    LOAD R4, 0xC000
+    ADD R7, R7, R4
+    JMP __sieve_4
+__sieve_2:
+    MOVI R4, 1
+    STORE R4, [R7]
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__sieve_4:
+    LOAD R4, 0xC002
+    CMP R6, R4
+    JC __sieve_2
+    CMPI R6, 0
+    JN __sieve_2
+    MOVI R6, 2
+    SHLI R7, R6, 1
+    LOAD R4, 0xC000
+    ADD R7, R7, R4
+    JMP __sieve_9
+__sieve_7:
+    LOAD R4, [R7]
+    CMPI R4, 0
+    JNZ __sieve_11
+__sieve_8:
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__sieve_9:
+    MUL R4, R6, R6
+    LOAD R3, 0xC002
+    CMP R4, R3
+    JC __sieve_7
+    CMPI R4, 0
+    JN __sieve_7
+    MOVI R6, 2
+    SHLI R4, R6, 1
+    LOAD R3, 0xC000
+    ADD R4, R4, R3
+    JMP __sieve_21
+__sieve_11:
+    MUL R3, R6, R6
+    JMP __sieve_15
+__sieve_13:
+    SHLI R2, R3, 1
+    LOAD R1, 0xC000
+    ADD R2, R2, R1
+    MOVI R1, 0
+    STORE R1, [R2]
+    ADD R3, R3, R6
+__sieve_15:
+    LOAD R2, 0xC002
+    CMP R3, R2
+    JC __sieve_13
+    CMPI R3, 0
+    JN __sieve_13
+    JMP __sieve_8
+__sieve_19:
+    LOAD R7, [R4]
+    CMPI R7, 0
+    JNZ __sieve_23
+__sieve_20:
+    ADDI R6, R6, 1
+    ADDI R4, R4, 2
+__sieve_21:
+    LOAD R7, 0xC002
+    CMP R6, R7
+    JC __sieve_19
+    CMPI R6, 0
+    JN __sieve_19
+    MOV R0, R5
+    JMP __sieve_1
+__sieve_23:
+    ADDI R5, R5, 1
+    JMP __sieve_20
+__sieve_1:
+    RET
+
+; main
+main:
+    MOVI R0, 0
+    MOVI R1, 0
+    MOVI R5, 0
+    JMP __main_4
+__main_2:
+    PUSH R1
+    PUSH R5
+    CALL sieve
+    POP R5
+    POP R1
+    ADDI R5, R5, 1
+__main_4:
+    CMPI R5, 3
+    JC __main_2
+    CMPI R5, 0
+    JN __main_2
+    LOAD R5, 0xC004
+    SHLI R6, R5, 1
+    LOAD R7, 0xC000
+    ADD R6, R6, R7
+    JMP __main_9
+__main_7:
+    LOAD R7, [R6]
+    CMPI R7, 0
+    JNZ __main_11
+    ADDI R5, R5, -1
+    ADDI R6, R6, -2
+__main_9:
+    CMPI R5, 2
+    JC __main_10
+    CMPI R5, 0
+    JN __main_10
+    JMP __main_7
+__main_10:
+    LOAD R6, 0xC006
+    STORE R6, 0xF000
+    LOAD R6, 0xC008
+    STORE R6, 0xF000
+    LOAD R6, 0xC00A
+    STORE R6, 0xF000
+    LOAD R6, 0xC00C
+    STORE R6, 0xF000
+    LOAD R6, 0xC00E
+    STORE R6, 0xF000
+    LOAD R6, 0xC010
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0xC012
+    STORE R6, 0xF000
+    LOAD R6, 0xC00E
+    STORE R6, 0xF000
+    LOAD R6, 0xC014
+    STORE R6, 0xF000
+    LOAD R6, 0xC016
+    STORE R6, 0xF000
+    LOAD R6, 0xC018
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0xC002
+    PUSH R0
+    PUSH R1
+    PUSH R5
+    MOV R1, R6
+    CALL __print_int
+    POP R5
+    POP R1
+    POP R0
+    MOVI R6, 58
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    PUSH R0
+    PUSH R1
+    PUSH R5
+    MOV R1, R0
+    CALL __print_int
+    POP R5
+    POP R1
+    POP R0
+    MOVI R6, 10
+    STORE R6, 0xF000
+    LOAD R6, 0xC01A
+    STORE R6, 0xF000
+    LOAD R6, 0xC01C
+    STORE R6, 0xF000
+    LOAD R6, 0xC008
+    STORE R6, 0xF000
+    LOAD R6, 0xC01E
+    STORE R6, 0xF000
+    LOAD R6, 0xC00E
+    STORE R6, 0xF000
+    LOAD R6, 0xC010
+    STORE R6, 0xF000
+    LOAD R6, 0xC020
+    STORE R6, 0xF000
+    MOVI R6, 58
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    PUSH R0
+    PUSH R1
+    PUSH R5
+    CALL __print_int
+    POP R5
+    POP R1
+    POP R0
+    MOVI R6, 10
+    STORE R6, 0xF000
+    MOVI R6, 0
+    JMP __main_1
+__main_11:
+    MOV R1, R5
+    JMP __main_10
+__main_1:
+    MOV R0, R6
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
@@ -0,0 +1,569 @@
+; Compiled from programs/bench/strsearch.c
+
+__start:
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA040
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xA042
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0xA044
+    STORE R0, 0xA046
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA048
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xA04A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA04C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0xA04E
+    STORE R0, 0xA050
+    STORE R0, 0xA052
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA054
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xA056
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0xA058
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0xA05A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA05C
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xA05E
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0xA060
+    MOVI R0, -7
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    SHLI R0, R0, 4
+    STORE R0, 0xA062
+    MOVI R0, 8
+    SHLI R0, R0, 4
+    STORE R0, 0xA064
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 12
+    STORE R0, 0xA066
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0xA068
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 14
+    STORE R0, 0xA06A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 7
+    STORE R0, 0xA06C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0xA06E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0xA070
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 13
+    STORE R0, 0xA072
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0xA074
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0xA076
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0xA078
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    STORE R0, 0xA07A
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0xA07C
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0xA07E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0xA080
+    MOVI R0, 54
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    SHLI R0, R0, 4
+    ORI R0, R0, 9
+    STORE R0, 0xA082
+    MOVI R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    SHLI R0, R0, 4
+    STORE R0, 0xA084
+    MOVI R0, -6
+    SHLI R0, R0, 8
+    ORI R0, R0, 4
+    SHLI R0, R0, 4
+    STORE R0, 0xA086
+    MOVI R0, -6
+    SHLI R0, R0, 8
+    ORI R0, R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 6
+    STORE R0, 0xA088
+    MOVI R0, -6
+    SHLI R0, R0, 8
+    ORI R0, R0, 5
+    SHLI R0, R0, 4
+    STORE R0, 0xA08A
+    MOVI R0, -17
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    STORE R0, 0xEFFE
+    CALL main
+    HALT
+
+; naive_count (frame: 8 bytes)
+naive_count:
+    LOAD R7, 0xEFFE
+    MOVI R6, 8
+    SUB R7, R7, R6
+    STORE R7, 0xEFFE
+    STORE R1, [R7]
+    ADDI R6, R7, 2
+    STORE R2, [R6]
+    ADDI R6, R7, 4
+    STORE R3, [R6]
+    MOVI R4, 0
+    MOVI R0, 0
+    JMP __naive_count_4
+__naive_count_2:
+    MOVI R1, 0
+    JMP __naive_count_7
+__naive_count_3:
+    ADDI R0, R0, 1
+__naive_count_4:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    ADD R2, R0, R6
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    XOR R3, R5, R2
+    CMPI R3, 0
+    JN __naive_count_15
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    CMP R5, R2
+    JNC __naive_count_2
+__naive_count_5:
+    ADDI R6, R7, 6
+    STORE R4, [R6]
+    JMP __naive_count_1
+__naive_count_6:
+    ADDI R1, R1, 1
+__naive_count_7:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    XOR R2, R1, R6
+    CMPI R2, 0
+    JN __naive_count_11
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    CMP R1, R6
+    JC __naive_count_9
+__naive_count_8:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    CMP R1, R6
+    JZ __naive_count_12
+    JMP __naive_count_3
+__naive_count_9:
+    ADD R2, R0, R1
+    SHLI R2, R2, 1
+    LOAD R3, 0xA060
+    ADD R3, R2, R3
+    LOAD R3, [R3]
+    SHLI R2, R1, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    LOAD R2, [R2]
+    CMP R3, R2
+    JZ __naive_count_6
+    JMP __naive_count_8
+__naive_count_11:
+    CMPI R1, 0
+    JN __naive_count_9
+    JMP __naive_count_8
+__naive_count_12:
+    ADDI R4, R4, 1
+    JMP __naive_count_3
+__naive_count_15:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __naive_count_5
+    JMP __naive_count_2
+__naive_count_1:
+    ADDI R0, R7, 6
+    LOAD R0, [R0]
+    MOVI R6, 8
+    ADD R7, R7, R6
+    STORE R7, 0xEFFE
+    RET
+
+; horspool_count (frame: 8 bytes)
+horspool_count:
+    LOAD R7, 0xEFFE
+    MOVI R6, 8
+    SUB R7, R7, R6
+    STORE R7, 0xEFFE
+    STORE R1, [R7]
+    ADDI R6, R7, 2
+    STORE R2, [R6]
+    ADDI R6, R7, 4
+    STORE R3, [R6]
+    MOVI R4, 0
+    MOVI R0, 0
+    SHLI R1, R0, 1
+    LOAD R2, 0xA062
+    ADD R2, R1, R2
+    JMP __horspool_count_4
+__horspool_count_2:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    STORE R6, [R2]
+    ADDI R0, R0, 1
+    ADDI R2, R2, 2
+__horspool_count_4:
+    LOAD R1, 0xA064
+    CMP R0, R1
+    JC __horspool_count_2
+    CMPI R0, 0
+    JN __horspool_count_2
+    MOVI R0, 0
+    SHLI R2, R0, 1
+    LOAD R5, [R7]
+    ADD R2, R5, R2
+    JMP __horspool_count_9
+__horspool_count_7:
+    LOAD R1, [R2]
+    SHLI R1, R1, 1
+    LOAD R3, 0xA062
+    ADD R3, R1, R3
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SUBI R1, R5, 1
+    SUB R1, R1, R0
+    STORE R1, [R3]
+    ADDI R0, R0, 1
+    ADDI R2, R2, 2
+__horspool_count_9:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SUBI R3, R5, 1
+    XOR R1, R0, R3
+    CMPI R1, 0
+    JN __horspool_count_12
+    CMP R0, R3
+    JC __horspool_count_7
+__horspool_count_10:
+    MOVI R0, 0
+    JMP __horspool_count_14
+__horspool_count_12:
+    CMPI R0, 0
+    JN __horspool_count_7
+    JMP __horspool_count_10
+__horspool_count_13:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SUBI R3, R5, 1
+    JMP __horspool_count_17
+__horspool_count_14:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    ADD R2, R0, R6
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    XOR R1, R5, R2
+    CMPI R1, 0
+    JN __horspool_count_23
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    CMP R5, R2
+    JNC __horspool_count_13
+__horspool_count_15:
+    ADDI R6, R7, 6
+    STORE R4, [R6]
+    JMP __horspool_count_1
+__horspool_count_16:
+    ADDI R3, R3, -1
+__horspool_count_17:
+    CMPI R3, 0
+    JN __horspool_count_18
+    ADD R1, R0, R3
+    SHLI R1, R1, 1
+    LOAD R2, 0xA060
+    ADD R2, R1, R2
+    LOAD R2, [R2]
+    SHLI R1, R3, 1
+    LOAD R5, [R7]
+    ADD R1, R5, R1
+    LOAD R1, [R1]
+    CMP R2, R1
+    JZ __horspool_count_16
+__horspool_count_18:
+    CMPI R3, 0
+    JN __horspool_count_20
+    JMP __horspool_count_21
+__horspool_count_20:
+    ADDI R4, R4, 1
+__horspool_count_21:
+    ADDI R6, R7, 2
+    LOAD R6, [R6]
+    ADD R3, R0, R6
+    SUBI R3, R3, 1
+    SHLI R3, R3, 1
+    LOAD R2, 0xA060
+    ADD R3, R3, R2
+    LOAD R3, [R3]
+    SHLI R3, R3, 1
+    LOAD R2, 0xA062
+    ADD R3, R3, R2
+    LOAD R3, [R3]
+    ADD R0, R0, R3
+    JMP __horspool_count_14
+__horspool_count_23:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __horspool_count_15
+    JMP __horspool_count_13
+__horspool_count_1:
+    ADDI R0, R7, 6
+    LOAD R0, [R0]
+    MOVI R6, 8
+    ADD R7, R7, R6
+    STORE R7, 0xEFFE
+    RET
+
+; search
+search:
+    PUSH R1
+    PUSH R2
+    PUSH R3
+    CALL naive_count
+    POP R3
+    POP R2
+    POP R1
+    PUSH R0
+    PUSH R2
+    CALL horspool_count
+    MOV R5, R0
+    POP R2
+    POP R0
+    LOAD R6, 0xA066
+    STORE R6, 0xF000
+    LOAD R6, 0xA068
+    STORE R6, 0xF000
+    LOAD R6, 0xA06A
+    STORE R6, 0xF000
+    LOAD R6, 0xA06C
+    STORE R6, 0xF000
+    LOAD R6, 0xA06E
+    STORE R6, 0xF000
+    LOAD R6, 0xA070
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    PUSH R0
+    PUSH R5
+    MOV R1, R2
+    CALL __print_int
+    POP R5
+    POP R0
+    MOVI R6, 58
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    PUSH R0
+    PUSH R5
+    MOV R1, R0
+    CALL __print_int
+    POP R5
+    POP R0
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0xA072
+    STORE R6, 0xF000
+    LOAD R6, 0xA074
+    STORE R6, 0xF000
+    LOAD R6, 0xA06E
+    STORE R6, 0xF000
+    LOAD R6, 0xA076
+    STORE R6, 0xF000
+    LOAD R6, 0xA070
+    STORE R6, 0xF000
+    LOAD R6, 0xA068
+    STORE R6, 0xF000
+    LOAD R6, 0xA078
+    STORE R6, 0xF000
+    MOVI R6, 44
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0xA072
+    STORE R6, 0xF000
+    LOAD R6, 0xA068
+    STORE R6, 0xF000
+    LOAD R6, 0xA06E
+    STORE R6, 0xF000
+    LOAD R6, 0xA070
+    STORE R6, 0xF000
+    LOAD R6, 0xA07A
+    STORE R6, 0xF000
+    LOAD R6, 0xA07C
+    STORE R6, 0xF000
+    LOAD R6, 0xA078
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    LOAD R6, 0xA074
+    STORE R6, 0xF000
+    LOAD R6, 0xA06C
+    STORE R6, 0xF000
+    LOAD R6, 0xA07E
+    STORE R6, 0xF000
+    LOAD R6, 0xA068
+    STORE R6, 0xF000
+    LOAD R6, 0xA068
+    STORE R6, 0xF000
+    MOVI R6, 58
+    STORE R6, 0xF000
+    MOVI R6, 32
+    STORE R6, 0xF000
+    CMP R0, R5
+    JZ __search_2
+    MOVI R1, 0
+    JMP __search_4
+__search_2:
+    MOVI R1, 1
+__search_4:
+    CALL __print_int
+    MOVI R5, 10
+    STORE R5, 0xF000
+    RET
+
+; main
+main:
+    LOAD R5, 0xA076
+    MOVI R6, 0
+    SHLI R7, R6, 1
+    LOAD R4, 0xA060
+    ADD R7, R7, R4
+    JMP __main_4
+__main_2:
+    LOAD R4, 0xA080
+    MUL R4, R5, R4
+    LOAD R3, 0xA082
+    ADD R4, R4, R3
+    MOVI R3, -1
+    AND R5, R4, R3
+    SHRI R4, R5, 14
+    LOAD R3, 0xA074
+    ADD R4, R4, R3
+    STORE R4, [R7]
+    ADDI R6, R6, 1
+    ADDI R7, R7, 2
+__main_4:
+    LOAD R4, 0xA084
+    CMP R6, R4
+    JC __main_2
+    CMPI R6, 0
+    JN __main_2
+    LOAD R1, 0xA086
+    MOVI R2, 3
+    LOAD R3, 0xA084
+    CALL search
+    LOAD R1, 0xA088
+    MOVI R2, 5
+    LOAD R3, 0xA084
+    CALL search
+    LOAD R1, 0xA08A
+    MOVI R2, 8
+    LOAD R3, 0xA084
+    CALL search
+    MOVI R0, 0
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
@@ -0,0 +1,316 @@
+; Compiled from programs/fuzz/kv_parser.c
+
+__start:
+    MOVI R0, -8
+    SHLI R0, R0, 8
+    ORI R0, R0, 2
+    SHLI R0, R0, 4
+    STORE R0, 0x8040
+    MOVI R0, -8
+    SHLI R0, R0, 12
+    STORE R0, 0x8042
+    MOVI R0, -17
+    SHLI R0, R0, 4
+    ORI R0, R0, 15
+    SHLI R0, R0, 4
+    ORI R0, R0, 10
+    STORE R0, 0xEFFE
+    CALL main
+    HALT
+
+; main (frame: 10 bytes)
+main:
+    LOAD R7, 0xEFFE
+    MOVI R6, 10
+    SUB R7, R7, R6
+    STORE R7, 0xEFFE
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    MOVI R5, 0
+    STORE R5, [R7]
+    JMP __main_3
+__main_2:
+    MOVI R3, 1
+    MOVI R2, 45
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R2
+    JZ __main_5
+    JMP __main_6
+__main_3:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, -1
+    JNZ __main_2
+    MOVI R5, 0
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R0, R5, 1
+    LOAD R1, 0x8040
+    ADD R1, R0, R1
+    ADDI R6, R7, 4
+    STORE R1, [R6]
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    SHLI R0, R5, 1
+    LOAD R2, 0x8042
+    ADD R2, R0, R2
+    ADDI R6, R7, 6
+    STORE R2, [R6]
+    JMP __main_37
+__main_5:
+    MOVI R3, -1
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+__main_6:
+    MOVI R0, 0
+    MOVI R1, 0
+    JMP __main_8
+__main_7:
+    MOVI R2, 10
+    MUL R2, R0, R2
+    MOVI R6, 8
+    ADD R6, R6, R7
+    LOAD R6, [R6]
+    ADD R2, R2, R6
+    MOVI R4, 48
+    SUB R0, R2, R4
+    ADDI R1, R1, 1
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+__main_8:
+    MOVI R4, 48
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R4
+    JC __main_9
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_9
+    MOVI R4, 58
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R4
+    JC __main_7
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_7
+__main_9:
+    MUL R0, R0, R3
+    CMPI R1, 1
+    JC __main_30
+    CMPI R1, 0
+    JN __main_30
+    MOVI R4, 61
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R4
+    JNZ __main_30
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    MOVI R4, 0
+    MOVI R1, 0
+    JMP __main_18
+__main_17:
+    MOVI R3, 10
+    MUL R3, R4, R3
+    MOVI R6, 8
+    ADD R6, R6, R7
+    LOAD R6, [R6]
+    ADD R3, R3, R6
+    MOVI R2, 48
+    SUB R4, R3, R2
+    ADDI R1, R1, 1
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+__main_18:
+    MOVI R3, 48
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R3
+    JC __main_19
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_19
+    MOVI R3, 58
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R3
+    JC __main_17
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_17
+__main_19:
+    CMPI R1, 1
+    JC __main_30
+    CMPI R1, 0
+    JN __main_30
+    MOVI R3, 59
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R3
+    JZ __main_25
+    JMP __main_30
+__main_23:
+    SHLI R3, R0, 1
+    LOAD R2, 0x8042
+    ADD R3, R3, R2
+    STORE R4, [R3]
+    SHLI R3, R0, 1
+    LOAD R2, 0x8040
+    ADD R3, R3, R2
+    MOVI R2, 1
+    STORE R2, [R3]
+    JMP __main_30
+__main_25:
+    MOVI R3, 16
+    CMP R0, R3
+    JC __main_23
+    CMPI R0, 0
+    JN __main_23
+    JMP __main_30
+__main_29:
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+__main_30:
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMPI R5, -1
+    JNZ __main_32
+__main_31:
+    MOVI R4, 59
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R4
+    JZ __main_33
+    JMP __main_3
+__main_32:
+    MOVI R4, 59
+    MOVI R5, 8
+    ADD R5, R5, R7
+    LOAD R5, [R5]
+    CMP R5, R4
+    JNZ __main_29
+    JMP __main_31
+__main_33:
+    LOAD R5, 0xF001
+    MOVI R6, 8
+    ADD R6, R6, R7
+    STORE R5, [R6]
+    JMP __main_3
+__main_35:
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    LOAD R4, [R5]
+    CMPI R4, 0
+    JNZ __main_39
+__main_36:
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    ADDI R5, R5, 1
+    ADDI R6, R7, 2
+    STORE R5, [R6]
+    ADDI R5, R7, 4
+    LOAD R5, [R5]
+    ADDI R5, R5, 2
+    ADDI R6, R7, 4
+    STORE R5, [R6]
+    ADDI R5, R7, 6
+    LOAD R5, [R5]
+    ADDI R5, R5, 2
+    ADDI R6, R7, 6
+    STORE R5, [R6]
+__main_37:
+    MOVI R4, 16
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    CMP R5, R4
+    JC __main_35
+    ADDI R5, R7, 2
+    LOAD R5, [R5]
+    CMPI R5, 0
+    JN __main_35
+    PUSH R7
+    LOAD R1, [R7]
+    CALL __print_int
+    POP R7
+    MOVI R4, 10
+    STORE R4, 0xF000
+    MOVI R0, 0
+    JMP __main_1
+__main_39:
+    ADDI R5, R7, 6
+    LOAD R5, [R5]
+    LOAD R4, [R5]
+    LOAD R5, [R7]
+    ADD R5, R5, R4
+    STORE R5, [R7]
+    JMP __main_36
+__main_1:
+    MOVI R6, 10
+    ADD R7, R7, R6
+    STORE R7, 0xEFFE
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
@@ -0,0 +1,257 @@
+; Compiled from programs/specialize/filter.c
+
+__start:
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x8008
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x800A
+    MOVI R0, 4
+    SHLI R0, R0, 4
+    ORI R0, R0, 1
+    STORE R0, 0x800C
+    MOVI R0, 5
+    SHLI R0, R0, 4
+    ORI R0, R0, 11
+    STORE R0, 0x800E
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x8010
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 8
+    STORE R0, 0x8012
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 2
+    STORE R0, 0x8014
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 4
+    STORE R0, 0x8016
+    MOVI R0, 6
+    SHLI R0, R0, 4
+    ORI R0, R0, 5
+    STORE R0, 0x8018
+    MOVI R0, 7
+    SHLI R0, R0, 4
+    ORI R0, R0, 3
+    STORE R0, 0x801A
+    CALL main
+    HALT
+
+; main
+main:
+    MOVI R1, 0
+    LOAD R5, 0xF001
+    JMP __main_3
+__main_2:
+    LOAD R6, 0x8000
+    CMPI R6, 1
+    JZ __main_5
+    JMP __main_6
+__main_3:
+    CMPI R5, -1
+    JNZ __main_2
+    LOAD R6, 0x8006
+    CMPI R6, 1
+    JZ __main_32
+    JMP __main_33
+__main_5:
+    LOAD R6, 0x8008
+    CMP R5, R6
+    JC __main_6
+    CMPI R5, 0
+    JN __main_6
+    LOAD R6, 0x800A
+    CMP R5, R6
+    JC __main_7
+    CMPI R5, 0
+    JN __main_7
+__main_6:
+    LOAD R6, 0x8002
+    CMPI R6, 0
+    JNZ __main_12
+    JMP __main_13
+__main_7:
+    MOVI R6, 32
+    SUB R5, R5, R6
+    JMP __main_6
+__main_12:
+    LOAD R6, 0x8008
+    CMP R5, R6
+    JC __main_15
+    CMPI R5, 0
+    JN __main_15
+    LOAD R6, 0x800A
+    CMP R5, R6
+    JC __main_14
+    CMPI R5, 0
+    JN __main_14
+    JMP __main_15
+__main_13:
+    LOAD R6, 0x8004
+    CMPI R6, 1
+    JZ __main_28
+    JMP __main_26
+__main_14:
+    LOAD R6, 0x8008
+    SUB R6, R5, R6
+    LOAD R7, 0x8002
+    ADD R6, R6, R7
+    MOVI R2, 26
+    PUSH R1
+    PUSH R5
+    MOV R1, R6
+    CALL __mods
+    POP R5
+    POP R1
+    LOAD R6, 0x8008
+    ADD R5, R0, R6
+    JMP __main_13
+__main_15:
+    LOAD R6, 0x800C
+    CMP R5, R6
+    JC __main_13
+    CMPI R5, 0
+    JN __main_13
+    LOAD R6, 0x800E
+    CMP R5, R6
+    JC __main_20
+    CMPI R5, 0
+    JN __main_20
+    JMP __main_13
+__main_20:
+    LOAD R6, 0x800C
+    SUB R6, R5, R6
+    LOAD R7, 0x8002
+    ADD R6, R6, R7
+    MOVI R2, 26
+    PUSH R1
+    PUSH R5
+    MOV R1, R6
+    CALL __mods
+    POP R5
+    POP R1
+    LOAD R6, 0x800C
+    ADD R5, R0, R6
+    JMP __main_13
+__main_25:
+    LOAD R5, 0xF001
+    JMP __main_3
+__main_26:
+    STORE R5, 0xF000
+    ADDI R1, R1, 1
+    LOAD R5, 0xF001
+    JMP __main_3
+__main_27:
+    MOVI R6, 58
+    CMP R5, R6
+    JC __main_25
+    CMPI R5, 0
+    JN __main_25
+    JMP __main_26
+__main_28:
+    MOVI R6, 48
+    CMP R5, R6
+    JC __main_26
+    CMPI R5, 0
+    JN __main_26
+    JMP __main_27
+__main_32:
+    MOVI R5, 10
+    STORE R5, 0xF000
+    CALL __print_int
+    MOVI R5, 32
+    STORE R5, 0xF000
+    LOAD R5, 0x8010
+    STORE R5, 0xF000
+    LOAD R5, 0x8012
+    STORE R5, 0xF000
+    LOAD R5, 0x8008
+    STORE R5, 0xF000
+    LOAD R5, 0x8014
+    STORE R5, 0xF000
+    LOAD R5, 0x8008
+    STORE R5, 0xF000
+    LOAD R5, 0x8010
+    STORE R5, 0xF000
+    LOAD R5, 0x8016
+    STORE R5, 0xF000
+    LOAD R5, 0x8018
+    STORE R5, 0xF000
+    LOAD R5, 0x8014
+    STORE R5, 0xF000
+    LOAD R5, 0x801A
+    STORE R5, 0xF000
+    MOVI R5, 10
+    STORE R5, 0xF000
+__main_33:
+    MOVI R0, 0
+    RET
+
+; Print R1 in decimal
+__print_int:
+    CMPI R1, 0
+    JN __print_int_negative
+__print_uint:
+    MOVI R2, 10
+    MOVI R3, 0
+__print_uint_digit:
+    DIV R0, R1, R2
+    MUL R4, R0, R2
+    SUB R4, R1, R4
+    PUSH R4
+    INC R3
+    MOV R1, R0
+    CMPI R1, 0
+    JNZ __print_uint_digit
+    MOVI R5, 48
+__print_uint_out:
+    POP R4
+    ADD R4, R4, R5
+    STORE R4, 0xF000
+    DEC R3
+    JNZ __print_uint_out
+    RET
+__print_int_negative:
+    MOVI R0, 45
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP __print_uint
+
+; Signed R1 / R2 and R1 % R2 via unsigned DIV
+__mods:
+    MOV R6, R1
+    CALL __abs_operands
+    DIV R0, R1, R2
+    MUL R0, R0, R2
+    SUB R0, R1, R0
+__apply_sign:
+    CMPI R6, 0
+    JN __apply_sign_negate
+    RET
+__apply_sign_negate:
+    NOT R0, R0
+    INC R0
+    RET
+__abs_operands:
+    CMPI R1, 0
+    JN __abs_operands_negate1
+__abs_operands_check2:
+    CMPI R2, 0
+    JN __abs_operands_negate2
+    RET
+__abs_operands_negate1:
+    NOT R1, R1
+    INC R1
+    JMP __abs_operands_check2
+__abs_operands_negate2:
+    NOT R2, R2
+    INC R2
+    RET
@@ -0,0 +1,482 @@
+; Guest Runtime Library
+; Hand-optimized routines for programs running on the 16-bit CPU.
+;
+; Include it after a program's own code and assemble with -I lib:
+;   .include "runtime.asm"
+; The library contains no entry point of its own; call the routines below.
+;
+; Register Convention:
+; R1-R4: Arguments (32-bit values are passed low word first: R1 = low,
+;        R2 = high for the first operand; R3 = low, R4 = high for the second)
+; R0:    Result (R1 holds the high word of 32-bit results)
+; R7:    Preserved by every routine
+; R2-R6: Clobbered unless stated otherwise
+;
+; Strings are NUL-terminated bytes. Memory is byte addressed and word
+; accesses may be unaligned, so the string and block routines move two
+; bytes per LOAD/STORE. STORE always writes a full word: the byte after
+; the last one written is only preserved where noted.
+;
+; Data Used:
+; 0xEFFA: Bump allocator's next free byte (0 = not initialized)
+; 0xEFFC: Bump allocator's limit (0 = default of 0xE000)
+; The default arena starts at __data_end, the first byte after the
+; program's .data section, which the assembler and linker define.
+
+
+; ---------------------------------------------------------------------------
+; print_i16 - Print R1 as a signed decimal number
+; print_u16 - Print R1 as an unsigned decimal number
+; Clobbers R0-R6
+;
+; Divides by 10000/1000/100/10 directly instead of collecting digits on
+; the stack, so each digit costs five instructions.
+; ---------------------------------------------------------------------------
+print_i16:
+    CMPI R1, 0
+    JN print_i16_negative
+print_u16:
+    MOVI R5, 48           ; ASCII '0'
+    MOVI R2, 10
+    CMP R1, R2
+    JC print_u16_1
+    MUL R3, R2, R2        ; 100
+    CMP R1, R3
+    JC print_u16_2
+    MUL R4, R3, R2        ; 1000
+    CMP R1, R4
+    JC print_u16_3
+    MUL R0, R4, R2        ; 10000
+    CMP R1, R0
+    JC print_u16_4
+    DIV R6, R1, R0
+    MUL R0, R6, R0
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, 0xF000
+print_u16_4:
+    DIV R6, R1, R4
+    MUL R0, R6, R4
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, 0xF000
+print_u16_3:
+    DIV R6, R1, R3
+    MUL R0, R6, R3
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, 0xF000
+print_u16_2:
+    DIV R6, R1, R2
+    MUL R0, R6, R2
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, 0xF000
+print_u16_1:
+    ADD R1, R1, R5
+    STORE R1, 0xF000
+    RET
+print_i16_negative:
+    MOVI R0, 45           ; '-'
+    STORE R0, 0xF000
+    NOT R1, R1
+    INC R1
+    JMP print_u16
+
+
+; ---------------------------------------------------------------------------
+; utoa16 - Convert R1 to unsigned decimal text
+; Input:  R1 = value, R2 = buffer (at least 6 bytes)
+; Output: R0 = length, buffer holds the NUL-terminated digits
+; Clobbers R1-R6
+; ---------------------------------------------------------------------------
+utoa16:
+    PUSH R7
+    PUSH R2
+    MOV R7, R2            ; Output pointer
+    MOVI R5, 48
+    MOVI R2, 10
+    CMP R1, R2
+    JC utoa16_1
+    MUL R3, R2, R2
+    CMP R1, R3
+    JC utoa16_2
+    MUL R4, R3, R2
+    CMP R1, R4
+    JC utoa16_3
+    MUL R0, R4, R2
+    CMP R1, R0
+    JC utoa16_4
+    DIV R6, R1, R0
+    MUL R0, R6, R0
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, [R7]
+    INC R7
+utoa16_4:
+    DIV R6, R1, R4
+    MUL R0, R6, R4
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, [R7]
+    INC R7
+utoa16_3:
+    DIV R6, R1, R3
+    MUL R0, R6, R3
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, [R7]
+    INC R7
+utoa16_2:
+    DIV R6, R1, R2
+    MUL R0, R6, R2
+    SUB R1, R1, R0
+    ADD R6, R6, R5
+    STORE R6, [R7]
+    INC R7
+utoa16_1:
+    ADD R1, R1, R5
+    STORE R1, [R7]        ; The zero high byte terminates the string
+    INC R7
+    POP R6
+    SUB R0, R7, R6
+    POP R7
+    RET
+
+
+; ---------------------------------------------------------------------------
+; print_str - Print the NUL-terminated string at R1
+; Clobbers R1-R3
+; ---------------------------------------------------------------------------
+print_str:
+    MOVI R3, -1
+    SHRI R3, R3, 8        ; 0x00FF
+print_str_loop:
+    LOAD R2, [R1]
+    AND R0, R2, R3
+    JZ print_str_done
+    STORE R2, 0xF000      ; Console takes the low byte
+    SHRI R2, R2, 8
+    JZ print_str_done
+    STORE R2, 0xF000
+    ADDI R1, R1, 2
+    JMP print_str_loop
+print_str_done:
+    RET
+
+
+; ---------------------------------------------------------------------------
+; strlen - Length of the NUL-terminated string at R1
+; Output: R0 = length
+; Clobbers R2-R4
+; ---------------------------------------------------------------------------
+strlen:
+    MOV R0, R1
+    MOVI R3, -1
+    SHRI R3, R3, 8        ; 0x00FF
+strlen_loop:
+    LOAD R2, [R0]
+    AND R4, R2, R3
+    JZ strlen_done
+    SHRI R2, R2, 8
+    JZ strlen_odd
+    ADDI R0, R0, 2
+    LOAD R2, [R0]
+    AND R4, R2, R3
+    JZ strlen_done
+    SHRI R2, R2, 8
+    JZ strlen_odd
+    ADDI R0, R0, 2
+    JMP strlen_loop
+strlen_odd:
+    INC R0
+strlen_done:
+    SUB R0, R0, R1
+    RET
+
+
+; ---------------------------------------------------------------------------
+; memcpy - Copy R3 bytes from R2 to R1 (regions must not overlap)
+; Output: R0 = destination
+; Clobbers R1-R4, R6. The byte after the destination is preserved.
+; ---------------------------------------------------------------------------
+memcpy:
+    MOV R0, R1
+    SUBI R3, R3, 4
+    JC memcpy_tail
+memcpy_loop:
+    LOAD R4, [R2]
+    STORE R4, [R1]
+    ADDI R2, R2, 2
+    ADDI R1, R1, 2
+    LOAD R4, [R2]
+    STORE R4, [R1]
+    ADDI R2, R2, 2
+    ADDI R1, R1, 2
+    SUBI R3, R3, 4
+    JNC memcpy_loop
+memcpy_tail:
+    ADDI R3, R3, 4        ; 0-3 bytes left
+    CMPI R3, 2
+    JC memcpy_last
+    LOAD R4, [R2]
+    STORE R4, [R1]
+    ADDI R2, R2, 2
+    ADDI R1, R1, 2
+    SUBI R3, R3, 2
+memcpy_last:
+    CMPI R3, 0
+    JZ memcpy_done
+    LOAD R4, [R2]         ; Merge one byte into the destination word
+    SHLI R4, R4, 8
+    SHRI R4, R4, 8
+    LOAD R6, [R1]
+    SHRI R6, R6, 8
+    SHLI R6, R6, 8
+    OR R4, R4, R6
+    STORE R4, [R1]
+memcpy_done:
+    RET
+
+
+; ---------------------------------------------------------------------------
+; memset - Fill R3 bytes at R1 with the low byte of R2
+; Output: R0 = destination
+; Clobbers R1-R4, R6. The byte after the destination is preserved.
+; ---------------------------------------------------------------------------
+memset:
+    MOV R0, R1
+    SHLI R2, R2, 8
+    SHRI R4, R2, 8
+    OR R2, R2, R4         ; Byte repeated in both halves of the word
+    SUBI R3, R3, 4
+    JC memset_tail
+memset_loop:
+    STORE R2, [R1]
+    ADDI R1, R1, 2
+    STORE R2, [R1]
+    ADDI R1, R1, 2
+    SUBI R3, R3, 4
+    JNC memset_loop
+memset_tail:
+    ADDI R3, R3, 4
+    CMPI R3, 2
+    JC memset_last
+    STORE R2, [R1]
+    ADDI R1, R1, 2
+    SUBI R3, R3, 2
+memset_last:
+    CMPI R3, 0
+    JZ memset_done
+    LOAD R6, [R1]
+    SHRI R6, R6, 8
+    SHLI R6, R6, 8
+    OR R4, R4, R6         ; R4 still holds the fill byte
+    STORE R4, [R1]
+memset_done:
+    RET
+
+
+; ---------------------------------------------------------------------------
+; mul_u16 - Full 16x16 -> 32-bit unsigned multiply
+; Input:  R1, R2
+; Output: R1:R0 = product (high:low)
+; Clobbers R2-R6
+;
+; MUL yields the exact low word. The high word is assembled from the
+; four 8x8-bit partial products, which never overflow 16 bits.
+; ---------------------------------------------------------------------------
+mul_u16:
+    MUL R0, R1, R2        ; Low word
+    SHRI R3, R1, 8        ; ah
+    SHLI R1, R1, 8
+    SHRI R1, R1, 8        ; al
+    SHRI R4, R2, 8        ; bh
+    SHLI R2, R2, 8
+    SHRI R2, R2, 8        ; bl
+    MUL R5, R3, R4        ; ah*bh
+    MUL R6, R1, R4        ; al*bh
+    MUL R4, R1, R2        ; al*bl
+    MUL R1, R3, R2        ; ah*bl
+    SHRI R4, R4, 8        ; Carry column: (al*bl >> 8) + both middle low bytes
+    SHRI R2, R1, 8
+    ADD R5, R5, R2
+    SHLI R1, R1, 8
+    SHRI R1, R1, 8
+    ADD R4, R4, R1
+    SHRI R2, R6, 8
+    ADD R5, R5, R2
+    SHLI R6, R6, 8
+    SHRI R6, R6, 8
+    ADD R4, R4, R6
+    SHRI R4, R4, 8
+    ADD R1, R5, R4        ; High word
+    RET
+
+
+; ---------------------------------------------------------------------------
+; mul32 - 32x32 -> 32-bit multiply (signed or unsigned)
+; Input:  R2:R1, R4:R3
+; Output: R1:R0 = low 32 bits of the product
+; Clobbers R2-R6
+; ---------------------------------------------------------------------------
+mul32:
+    MUL R5, R1, R4        ; Cross terms only affect the high word
+    MUL R6, R2, R3
+    ADD R5, R5, R6
+    PUSH R5
+    MOV R2, R3
+    CALL mul_u16
+    POP R5
+    ADD R1, R1, R5
+    RET
+
+
+; ---------------------------------------------------------------------------
+; div32 - 32-bit unsigned division
+; Input:  R2:R1 = dividend, R4:R3 = divisor (nonzero)
+; Output: R1:R0 = quotient, R3:R2 = remainder
+; Clobbers R4-R6
+;
+; Divisors below 256 use three native DIVs on byte-sized chunks, and
+; 16-bit operands use one. Everything else runs shift-and-subtract,
+; skipping the first 16 steps whenever they cannot produce quotient bits.
+; ---------------------------------------------------------------------------
+div32:
+    CMPI R4, 0
+    JNZ div32_long
+    SHRI R5, R3, 8
+    JZ div32_by_byte
+    CMPI R2, 0
+    JNZ div32_long
+    DIV R0, R1, R3        ; 16-bit by 16-bit
+    MUL R2, R0, R3
+    SUB R2, R1, R2
+    MOVI R1, 0
+    MOVI R3, 0
+    RET
+div32_by_byte:
+    DIV R5, R2, R3        ; Quotient high word
+    MUL R6, R5, R3
+    SUB R2, R2, R6
+    SHLI R2, R2, 8
+    SHRI R6, R1, 8
+    OR R2, R2, R6         ; Remainder joined with the next byte
+    DIV R0, R2, R3
+    MUL R6, R0, R3
+    SUB R2, R2, R6
+    SHLI R2, R2, 8
+    SHLI R1, R1, 8
+    SHRI R1, R1, 8
+    OR R2, R2, R1         ; Remainder joined with the last byte
+    DIV R6, R2, R3
+    MUL R1, R6, R3
+    SUB R2, R2, R1        ; Final remainder
+    SHLI R0, R0, 8
+    OR R0, R0, R6
+    MOV R1, R5
+    MOVI R3, 0
+    RET
+div32_long:
+    PUSH R7
+    MOVI R5, 0            ; Remainder R6:R5
+    MOVI R6, 0
+    MOVI R0, 32           ; Steps left
+    CMPI R4, 0
+    JNZ div32_skip
+    CMP R2, R3
+    JNC div32_loop
+div32_skip:
+    MOV R5, R2            ; High dividend word < divisor: start 16 steps in
+    MOV R2, R1
+    MOVI R1, 0
+    MOVI R0, 16
+div32_loop:
+    SHRI R7, R5, 15
+    ADD R6, R6, R6        ; Carry = bit shifted out of the remainder
+    JC div32_overflow
+    OR R6, R6, R7
+    SHLI R5, R5, 1
+    SHRI R7, R2, 15
+    OR R5, R5, R7
+    SHLI R2, R2, 1
+    SHRI R7, R1, 15
+    OR R2, R2, R7
+    SHLI R1, R1, 1
+    CMP R6, R4
+    JC div32_next
+    JNZ div32_subtract
+    CMP R5, R3
+    JC div32_next
+div32_subtract:
+    SUB R5, R5, R3
+    JNC div32_no_borrow
+    DEC R6
+div32_no_borrow:
+    SUB R6, R6, R4
+    ORI R1, R1, 1         ; Quotient bit
+div32_next:
+    DEC R0
+    JNZ div32_loop
+    MOV R0, R1
+    MOV R1, R2
+    MOV R2, R5
+    MOV R3, R6
+    POP R7
+    RET
+div32_overflow:           ; A 33-bit remainder always exceeds the divisor
+    OR R6, R6, R7
+    SHLI R5, R5, 1
+    SHRI R7, R2, 15
+    OR R5, R5, R7
+    SHLI R2, R2, 1
+    SHRI R7, R1, 15
+    OR R2, R2, R7
+    SHLI R1, R1, 1
+    JMP div32_subtract
+
+
+; ---------------------------------------------------------------------------
+; heap_init - Set the bump allocator's arena to [R1, R2)
+; Optional: by default the arena is __data_end-0xE000
+; ---------------------------------------------------------------------------
+heap_init:
+    ADDI R1, R1, 1        ; Round the start up to a word boundary
+    SHRI R1, R1, 1
+    SHLI R1, R1, 1
+    STORE R1, 0xEFFA
+    STORE R2, 0xEFFC
+    RET
+
+
+; ---------------------------------------------------------------------------
+; alloc - Allocate R1 bytes from the bump allocator
+; Output: R0 = word-aligned block, or 0 when the arena is exhausted
+; Clobbers R1-R3. Blocks are never freed; heap_init resets the arena.
+; ---------------------------------------------------------------------------
+alloc:
+    LOAD R0, 0xEFFA
+    CMPI R0, 0
+    JNZ alloc_ready
+    LOAD R0, alloc_default_start  ; .data is a whole number of words
+alloc_ready:
+    ADDI R1, R1, 1        ; Keep blocks word aligned
+    SHRI R1, R1, 1
+    SHLI R1, R1, 1
+    ADD R2, R0, R1
+    JC alloc_fail
+    LOAD R3, 0xEFFC
+    CMPI R3, 0
+    JNZ alloc_check
+    MOVI R3, -2
+    SHLI R3, R3, 12       ; Default limit 0xE000
+alloc_check:
+    CMP R3, R2
+    JC alloc_fail
+    STORE R2, 0xEFFA
+    RET
+alloc_fail:
+    MOVI R0, 0
+    RET
+alloc_default_start:      ; Read, never executed
+    .word __data_end
@@ -0,0 +1,45 @@
+/**
+ * CRC-16 Benchmark
+ * CRC-16/CCITT-FALSE over a pseudo-random buffer, bit by bit.
+ */
+
+#include <stdio.h>
+
+int data[1024];
+
+unsigned crc16(int length) {
+    unsigned crc = 0xFFFF;
+    int i;
+    int bit;
+
+    for (i = 0; i < length; i++) {
+        crc = crc ^ (data[i] << 8);
+        for (bit = 0; bit < 8; bit++) {
+            if (crc & 0x8000) {
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF;
+            } else {
+                crc = (crc << 1) & 0xFFFF;
+            }
+        }
+    }
+    return crc;
+}
+
+int main() {
+    unsigned seed = 12345;
+    int i;
+
+    for (i = 0; i < 1024; i++) {
+        seed = (seed * 25173 + 13849) & 0xFFFF;
+        data[i] = seed >> 8;
+    }
+    printf("CRC of 16 bytes: 0x%x\n", crc16(16));
+    printf("CRC of 1024 bytes: 0x%x\n", crc16(1024));
+
+    // Check value from the CRC catalogue: "123456789" -> 0x29B1
+    for (i = 0; i < 9; i++) {
+        data[i] = '1' + i;
+    }
+    printf("CRC of \"123456789\": 0x%x\n", crc16(9));
+    return 0;
+}
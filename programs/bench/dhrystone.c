@@ -0,0 +1,206 @@
+/**
+ * Dhrystone-like Integer Benchmark
+ * The statement mix of Dhrystone 2.1 (assignments, procedure calls,
+ * array accesses, comparisons and character tests) without records or
+ * pointers, which this compiler does not support. Ch_* values hold
+ * character codes.
+ */
+
+#include <stdio.h>
+
+int Int_Glob;
+int Bool_Glob;
+int Ch_1_Glob;
+int Ch_2_Glob;
+int Arr_1_Glob[50];
+int Arr_2_Glob[400]; // 20x20, row-major
+int Rec_Int_Comp;
+int Rec_Enum_Comp;
+
+// Enumeration values
+int Ident_1 = 0;
+int Ident_2 = 1;
+int Ident_3 = 2;
+int Ident_4 = 3;
+int Ident_5 = 4;
+
+int Func_1(int Ch_1_Par_Val, int Ch_2_Par_Val) {
+    int Ch_1_Loc = Ch_1_Par_Val;
+    int Ch_2_Loc = Ch_1_Loc;
+
+    if (Ch_2_Loc != Ch_2_Par_Val) {
+        return Ident_1;
+    }
+    Ch_1_Glob = Ch_1_Loc;
+    return Ident_2;
+}
+
+int Func_3(int Enum_Par_Val) {
+    return Enum_Par_Val == Ident_3;
+}
+
+int Func_2(int a0, int a1, int b0, int b1) {
+    // Compares the strings "DHRYSTONE PROGRAM, 1'ST/2'ND STRING" by the
+    // two characters in which they differ
+    int Int_Loc = 2;
+    int Ch_Loc = 'A';
+
+    while (Int_Loc <= 2) {
+        if (Func_1(Int_Loc == 2 ? a1 : a0, Int_Loc == 2 ? b1 : b0 + 1) ==
+            Ident_1) {
+            Ch_Loc = 'A';
+            Int_Loc += 1;
+        }
+    }
+    if (Ch_Loc >= 'W' && Ch_Loc < 'Z') {
+        Int_Loc = 7;
+    }
+    if (Ch_Loc == 'R') {
+        return 1;
+    }
+    if (a1 > b1) {
+        Int_Loc += 7;
+        Int_Glob = Int_Loc;
+        return 1;
+    }
+    return 0;
+}
+
+int Proc_6(int Enum_Val_Par) {
+    int Enum_Ref_Par = Enum_Val_Par;
+
+    if (!Func_3(Enum_Val_Par)) {
+        Enum_Ref_Par = Ident_4;
+    }
+    if (Enum_Val_Par == Ident_1) {
+        Enum_Ref_Par = Ident_1;
+    } else if (Enum_Val_Par == Ident_2) {
+        if (Int_Glob > 100) {
+            Enum_Ref_Par = Ident_1;
+        } else {
+            Enum_Ref_Par = Ident_4;
+        }
+    } else if (Enum_Val_Par == Ident_3) {
+        Enum_Ref_Par = Ident_2;
+    } else if (Enum_Val_Par == Ident_5) {
+        Enum_Ref_Par = Ident_3;
+    }
+    return Enum_Ref_Par;
+}
+
+int Proc_7(int Int_1_Par_Val, int Int_2_Par_Val) {
+    int Int_Loc = Int_1_Par_Val + 2;
+    return Int_2_Par_Val + Int_Loc;
+}
+
+void Proc_8(int Int_1_Par_Val, int Int_2_Par_Val) {
+    int Int_Index;
+    int Int_Loc = Int_1_Par_Val + 5;
+
+    Arr_1_Glob[Int_Loc] = Int_2_Par_Val;
+    Arr_1_Glob[Int_Loc + 1] = Arr_1_Glob[Int_Loc];
+    Arr_1_Glob[Int_Loc + 30] = Int_Loc;
+    for (Int_Index = Int_Loc; Int_Index <= Int_Loc + 1; ++Int_Index) {
+        Arr_2_Glob[Int_Loc * 20 + Int_Index] = Int_Loc;
+    }
+    Arr_2_Glob[Int_Loc * 20 + Int_Loc - 1] += 1;
+    Arr_2_Glob[(Int_Loc + 10) * 20 + Int_Loc] = Arr_1_Glob[Int_Loc];
+    Int_Glob = 5;
+}
+
+int Proc_2(int Int_Par_Ref) {
+    int Int_Loc = Int_Par_Ref + 10;
+    int Enum_Loc = Ident_2;
+
+    while (1) {
+        if (Ch_1_Glob == 'A') {
+            Int_Loc -= 1;
+            Int_Par_Ref = Int_Loc - Int_Glob;
+            Enum_Loc = Ident_1;
+        }
+        if (Enum_Loc == Ident_1) {
+            break;
+        }
+    }
+    return Int_Par_Ref;
+}
+
+void Proc_3() {
+    Rec_Int_Comp = Proc_7(10, Int_Glob);
+}
+
+void Proc_1() {
+    int Next_Int_Comp = 5;
+    int Next_Enum_Comp;
+
+    Rec_Int_Comp = 5;
+    Proc_3();
+    Next_Enum_Comp = Rec_Enum_Comp;
+    if (Next_Enum_Comp == Ident_1) {
+        Next_Int_Comp = 6;
+        Next_Enum_Comp = Proc_6(Ident_3);
+        Next_Int_Comp = Proc_7(Next_Int_Comp, 10);
+    }
+    Rec_Int_Comp = Next_Int_Comp;
+}
+
+void Proc_4() {
+    int Bool_Loc = Ch_1_Glob == 'A';
+    Bool_Glob = Bool_Loc | Bool_Glob;
+    Ch_2_Glob = 'B';
+}
+
+void Proc_5() {
+    Ch_1_Glob = 'A';
+    Bool_Glob = 0;
+}
+
+int main() {
+    int Int_1_Loc = 0;
+    int Int_2_Loc = 0;
+    int Int_3_Loc = 0;
+    int Ch_Index;
+    int Enum_Loc = 0;
+    int Run_Index;
+    int Number_Of_Runs = 500;
+
+    Rec_Enum_Comp = Ident_3;
+    Arr_2_Glob[8 * 20 + 7] = 10;
+
+    for (Run_Index = 1; Run_Index <= Number_Of_Runs; ++Run_Index) {
+        Proc_5();
+        Proc_4();
+        Int_1_Loc = 2;
+        Int_2_Loc = 3;
+        Enum_Loc = Ident_2;
+        Bool_Glob = !Func_2('1', 'S', '2', 'N');
+        while (Int_1_Loc < Int_2_Loc) {
+            Int_3_Loc = 5 * Int_1_Loc - Int_2_Loc;
+            Int_3_Loc = Proc_7(Int_1_Loc, Int_2_Loc);
+            Int_1_Loc += 1;
+        }
+        Proc_8(Int_1_Loc, Int_3_Loc);
+        Proc_1();
+        for (Ch_Index = 'A'; Ch_Index <= Ch_2_Glob; ++Ch_Index) {
+            if (Enum_Loc == Func_1(Ch_Index, 'C')) {
+                Enum_Loc = Proc_6(Ident_1);
+                Int_2_Loc = Run_Index;
+                Int_Glob = Run_Index;
+            }
+        }
+        Int_2_Loc = Int_2_Loc * Int_1_Loc;
+        Int_1_Loc = Int_2_Loc / Int_3_Loc;
+        Int_2_Loc = 7 * (Int_2_Loc - Int_3_Loc) - Int_1_Loc;
+        Int_1_Loc = Proc_2(Int_1_Loc);
+    }
+
+    printf("Int_Glob: %d\n", Int_Glob);
+    printf("Bool_Glob: %d\n", Bool_Glob);
+    printf("Ch_1_Glob: %c, Ch_2_Glob: %c\n", Ch_1_Glob, Ch_2_Glob);
+    printf("Arr_1_Glob[8]: %d, Arr_2_Glob[8][7]: %d\n", Arr_1_Glob[8],
+           Arr_2_Glob[8 * 20 + 7]);
+    printf("Rec_Int_Comp: %d, Enum_Loc: %d\n", Rec_Int_Comp, Enum_Loc);
+    printf("Int_1_Loc: %d, Int_2_Loc: %d, Int_3_Loc: %d\n", Int_1_Loc,
+           Int_2_Loc, Int_3_Loc);
+    return 0;
+}
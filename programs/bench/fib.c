@@ -0,0 +1,21 @@
+/**
+ * Recursive Fibonacci Benchmark
+ * Exercises calls, returns and register saving around deep recursion.
+ */
+
+#include <stdio.h>
+
+int fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main() {
+    int n;
+    for (n = 0; n <= 20; n += 5) {
+        printf("fib(%d) = %d\n", n, fib(n));
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * Insertion Sort Benchmark
+ * Sorts 400 pseudo-random values; quadratic data movement.
+ */
+
+#include <stdio.h>
+
+int values[400];
+
+void insertion_sort(int a[], int n) {
+    int i;
+    int j;
+    int key;
+
+    for (i = 1; i < n; i++) {
+        key = a[i];
+        j = i - 1;
+        while (j >= 0 && a[j] > key) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = key;
+    }
+}
+
+int main() {
+    unsigned seed = 2024;
+    unsigned checksum = 0;
+    int sorted = 1;
+    int i;
+
+    for (i = 0; i < 400; i++) {
+        seed = (seed * 25173 + 13849) & 0xFFFF;
+        values[i] = (seed & 0x3FFF) - 8192;
+    }
+    insertion_sort(values, 400);
+
+    for (i = 0; i < 400; i++) {
+        if (i > 0 && values[i - 1] > values[i]) {
+            sorted = 0;
+        }
+        checksum = (checksum * 31 + values[i]) & 0xFFFF;
+    }
+    printf("Sorted: %d\n", sorted);
+    printf("Min %d, median %d, max %d\n", values[0], values[200], values[399]);
+    printf("Checksum: %u\n", checksum);
+    return 0;
+}
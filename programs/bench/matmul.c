@@ -0,0 +1,53 @@
+/**
+ * Matrix Multiply Benchmark
+ * Multiplies two 16x16 integer matrices (stored row-major) four times.
+ */
+
+#include <stdio.h>
+
+int a[256];
+int b[256];
+int c[256];
+
+void matmul(int n) {
+    int i;
+    int j;
+    int k;
+    int sum;
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            sum = 0;
+            for (k = 0; k < n; k++) {
+                sum += a[i * n + k] * b[k * n + j];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+int main() {
+    unsigned checksum = 0;
+    int trace = 0;
+    int i;
+    int iter;
+
+    for (i = 0; i < 256; i++) {
+        a[i] = (i * 7 + 3) % 11 - 5;
+        b[i] = (i * 5 + 1) % 13 - 6;
+    }
+    for (iter = 0; iter < 4; iter++) {
+        matmul(16);
+    }
+
+    for (i = 0; i < 256; i++) {
+        checksum = (checksum * 31 + c[i]) & 0xFFFF;
+    }
+    for (i = 0; i < 16; i++) {
+        trace += c[i * 16 + i];
+    }
+    printf("c[0][0] = %d, c[15][15] = %d\n", c[0], c[255]);
+    printf("Trace: %d\n", trace);
+    printf("Checksum: %u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * Quicksort Benchmark
+ * Recursive Lomuto-partition quicksort of 3000 pseudo-random values.
+ */
+
+#include <stdio.h>
+
+int values[3000];
+
+void quicksort(int a[], int lo, int hi) {
+    int pivot;
+    int i;
+    int j;
+    int t;
+
+    while (lo < hi) {
+        // Median-of-three pivot keeps the recursion shallow
+        int mid = lo + (hi - lo) / 2;
+        if (a[mid] < a[lo]) {
+            t = a[mid]; a[mid] = a[lo]; a[lo] = t;
+        }
+        if (a[hi] < a[lo]) {
+            t = a[hi]; a[hi] = a[lo]; a[lo] = t;
+        }
+        if (a[mid] < a[hi]) {
+            t = a[mid]; a[mid] = a[hi]; a[hi] = t;
+        }
+        pivot = a[hi];
+
+        i = lo;
+        for (j = lo; j < hi; j++) {
+            if (a[j] < pivot) {
+                t = a[i]; a[i] = a[j]; a[j] = t;
+                i++;
+            }
+        }
+        t = a[i]; a[i] = a[hi]; a[hi] = t;
+
+        // Recurse into the smaller half, loop on the larger
+        if (i - lo < hi - i) {
+            quicksort(a, lo, i - 1);
+            lo = i + 1;
+        } else {
+            quicksort(a, i + 1, hi);
+            hi = i - 1;
+        }
+    }
+}
+
+int main() {
+    unsigned seed = 7;
+    unsigned checksum = 0;
+    int sorted = 1;
+    int i;
+
+    for (i = 0; i < 3000; i++) {
+        seed = (seed * 25173 + 13849) & 0xFFFF;
+        values[i] = (seed >> 2) - 8000;
+    }
+    quicksort(values, 0, 2999);
+
+    for (i = 0; i < 3000; i++) {
+        if (i > 0 && values[i - 1] > values[i]) {
+            sorted = 0;
+        }
+        checksum = (checksum * 31 + values[i]) & 0xFFFF;
+    }
+    printf("Sorted: %d\n", sorted);
+    printf("Min %d, median %d, max %d\n", values[0], values[1500], values[2999]);
+    printf("Checksum: %u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * Sieve of Eratosthenes Benchmark
+ * Counts the primes below 8192 several times over a flag array.
+ */
+
+#include <stdio.h>
+
+int flags[8192];
+
+int sieve() {
+    int i;
+    int j;
+    int count = 0;
+
+    for (i = 2; i < 8192; i++) {
+        flags[i] = 1;
+    }
+    for (i = 2; i * i < 8192; i++) {
+        if (flags[i]) {
+            for (j = i * i; j < 8192; j += i) {
+                flags[j] = 0;
+            }
+        }
+    }
+    for (i = 2; i < 8192; i++) {
+        if (flags[i]) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int main() {
+    int iter;
+    int count = 0;
+    int last = 0;
+    int i;
+
+    for (iter = 0; iter < 3; iter++) {
+        count = sieve();
+    }
+    for (i = 8191; i > 1; i--) {
+        if (flags[i]) {
+            last = i;
+            break;
+        }
+    }
+    printf("Primes below %d: %d\n", 8192, count);
+    printf("Largest: %d\n", last);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * String Search Benchmark
+ * Counts pattern occurrences in a generated text, naively and with
+ * Boyer-Moore-Horspool, and checks that both agree.
+ */
+
+#include <stdio.h>
+
+int text[4000];
+int skip[128];
+int pattern1[3] = {'a', 'b', 'c'};
+int pattern2[5] = {'c', 'a', 'b', 'a', 'd'};
+int pattern3[8] = {'d', 'd', 'a', 'b', 'c', 'd', 'a', 'b'};
+
+int naive_count(int p[], int m, int n) {
+    int count = 0;
+    int i;
+    int j;
+
+    for (i = 0; i + m <= n; i++) {
+        j = 0;
+        while (j < m && text[i + j] == p[j]) {
+            j++;
+        }
+        if (j == m) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int horspool_count(int p[], int m, int n) {
+    int count = 0;
+    int i;
+    int j;
+
+    for (i = 0; i < 128; i++) {
+        skip[i] = m;
+    }
+    for (i = 0; i < m - 1; i++) {
+        skip[p[i]] = m - 1 - i;
+    }
+
+    i = 0;
+    while (i + m <= n) {
+        j = m - 1;
+        while (j >= 0 && text[i + j] == p[j]) {
+            j--;
+        }
+        if (j < 0) {
+            count++;
+        }
+        i += skip[text[i + m - 1]];
+    }
+    return count;
+}
+
+void search(int p[], int m, int n) {
+    int naive = naive_count(p, m, n);
+    int fast = horspool_count(p, m, n);
+    printf("Length %d: %d matches, methods agree: %d\n", m, naive,
+           naive == fast);
+}
+
+int main() {
+    unsigned seed = 99;
+    int i;
+
+    // Text over a four-letter alphabet so short patterns recur
+    for (i = 0; i < 4000; i++) {
+        seed = (seed * 25173 + 13849) & 0xFFFF;
+        text[i] = 'a' + (seed >> 14);
+    }
+    search(pattern1, 3, 4000);
+    search(pattern2, 5, 4000);
+    search(pattern3, 8, 4000);
+    return 0;
+}
@@ -0,0 +1,30 @@
+; Initialized Data
+; Prints a message and a counter that the assembler places in .data at
+; 0x8000. Their values reach the program only because the emulator loads
+; the data segment written beside the binary (<program>.data).
+;
+; Assemble with the runtime library:
+;   build/assembler -I lib programs/data_init.asm build/data_init.bin
+;
+; Expected output:
+;   count=1235
+
+__start:
+    LOAD R1, message_ptr
+    CALL print_str
+    LOAD R1, counter      ; .data stays writable
+    INC R1
+    STORE R1, counter
+    LOAD R1, counter
+    CALL print_u16
+    MOVI R3, '\n'
+    STORE R3, 0xF000
+    HALT
+
+.data
+message_ptr: .word message
+counter:     .word 1234
+message:     .byte 'c', 'o', 'u', 'n', 't', '=', 0
+
+.text
+.include "runtime.asm"
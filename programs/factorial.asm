@@ -31,34 +31,32 @@ START:
     ; SP starts at 0xFFFF
     
     ; Print 'F' for Factorial
-    MOVI R3, 60
+    MOVI R3, 'F' - 7      ; 'F' = 70 is beyond MOVI's range (-64 to 63)
     ADDI R3, R3, 7
-    ADDI R3, R3, 3        ; 'F' = 70
     STORE R3, 0xF000
     
     ; Print '('
-    MOVI R3, 40           ; '(' = 40
+    MOVI R3, '('
     STORE R3, 0xF000
     
     ; Print '5'
-    MOVI R3, 48
-    ADDI R3, R3, 5        ; '5' = 53
+    MOVI R3, '5'
     STORE R3, 0xF000
     
     ; Print ')'
-    MOVI R3, 41           ; ')' = 41
+    MOVI R3, ')'
     STORE R3, 0xF000
     
     ; Print ' '
-    MOVI R3, 32           ; ' ' = 32
+    MOVI R3, ' '
     STORE R3, 0xF000
     
     ; Print '='
-    MOVI R3, 61           ; '=' = 61
+    MOVI R3, '='
     STORE R3, 0xF000
     
     ; Print space
-    MOVI R3, 32           ; ' ' = 32
+    MOVI R3, ' '
     STORE R3, 0xF000
     
     ; Call factorial(5)
@@ -80,7 +78,7 @@ START:
     ; Print hundreds digit (skip if 0)
     CMPI R6, 0
     JZ SKIP_HUNDREDS
-    MOVI R3, 48
+    MOVI R3, '0'
     ADD R3, R3, R6        ; Convert to ASCII
     STORE R3, 0xF000
 SKIP_HUNDREDS:
@@ -92,17 +90,17 @@ SKIP_HUNDREDS:
     SUB R4, R4, R7        ; R4 = remaining % 10
     
     ; Print tens digit
-    MOVI R3, 48
+    MOVI R3, '0'
     ADD R3, R3, R6        ; Convert to ASCII
     STORE R3, 0xF000
     
     ; Print ones digit
-    MOVI R3, 48
+    MOVI R3, '0'
     ADD R3, R3, R4        ; Convert to ASCII
     STORE R3, 0xF000
     
     ; Print newline
-    MOVI R3, 10           ; '\n' = 10
+    MOVI R3, '\n'
     STORE R3, 0xF000
     
     ; Exit program
@@ -0,0 +1,69 @@
+/**
+ * Key-Value Parser (fuzzing target)
+ * Reads "<key>=<value>;" records from the console into a table of slots
+ * and prints the sum of the slots that were set. A record with a
+ * malformed key or value is skipped up to the next ';'.
+ *
+ * The bounds check on the key only tests the upper end, so a negative
+ * key ("-3=7;") stores below the table: into the code segment, which
+ * faults in Harvard mode.
+ */
+
+#include <stdio.h>
+
+int slots[16];
+int used[16];
+
+int main() {
+    int c = getchar();
+    int key;
+    int value;
+    int sign;
+    int digits;
+    int total = 0;
+    int i;
+
+    while (c != -1) {
+        sign = 1;
+        if (c == '-') {
+            sign = -1;
+            c = getchar();
+        }
+        key = 0;
+        digits = 0;
+        while (c >= '0' && c <= '9') {
+            key = key * 10 + c - '0';
+            digits++;
+            c = getchar();
+        }
+        key = key * sign;
+        if (digits > 0 && c == '=') {
+            c = getchar();
+            value = 0;
+            digits = 0;
+            while (c >= '0' && c <= '9') {
+                value = value * 10 + c - '0';
+                digits++;
+                c = getchar();
+            }
+            if (digits > 0 && c == ';' && key < 16) {
+                slots[key] = value;
+                used[key] = 1;
+            }
+        }
+        while (c != -1 && c != ';') {
+            c = getchar();
+        }
+        if (c == ';') {
+            c = getchar();
+        }
+    }
+
+    for (i = 0; i < 16; i++) {
+        if (used[i]) {
+            total = total + slots[i];
+        }
+    }
+    printf("%d\n", total);
+    return 0;
+}
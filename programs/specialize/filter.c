@@ -0,0 +1,47 @@
+/**
+ * Text Filter (specialization demo)
+ * Copies console input to the console, transformed according to a
+ * configuration header that a job loads at 0x8000 before the run:
+ *   config[0]  1 to upper-case letters
+ *   config[1]  rotation applied to letters (13 for ROT13), 0 for none
+ *   config[2]  1 to drop digits
+ *   config[3]  1 to print a count of output characters at the end
+ * Every input byte re-reads and re-tests the header, which is what the
+ * specializer removes once the header is known.
+ */
+
+#include <stdio.h>
+
+int config[4];
+
+int main() {
+    int c;
+    int count = 0;
+
+    c = getchar();
+    while (c != -1) {
+        if (config[0] == 1) {
+            if (c >= 'a' && c <= 'z') {
+                c = c - 32;
+            }
+        }
+        if (config[1] != 0) {
+            if (c >= 'a' && c <= 'z') {
+                c = 'a' + (c - 'a' + config[1]) % 26;
+            } else if (c >= 'A' && c <= 'Z') {
+                c = 'A' + (c - 'A' + config[1]) % 26;
+            }
+        }
+        if (config[2] == 1 && c >= '0' && c <= '9') {
+            c = getchar();
+            continue;
+        }
+        putchar(c);
+        count = count + 1;
+        c = getchar();
+    }
+    if (config[3] == 1) {
+        printf("\n%d characters\n", count);
+    }
+    return 0;
+}
@@ -7,13 +7,26 @@
  */
 
 #include "assembler.h"
+#include "module_cache.h"
 #include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
-Assembler::Assembler() : current_address(0), error_count(0) {}
+Assembler::Assembler()
+    : current_address(0), error_count(0), location_known(false),
+      current_section(SECTION_TEXT), object_mode(false),
+      optimize_enabled(false), inline_budget(16),
+      own_cache(new ModuleCache()), expansion_count(0), modules_included(0),
+      modules_cached(0), symbols_hidden(false), log(&std::cout),
+      diagnostics(&std::cerr) {
+  cache = own_cache;
+  for (int i = 0; i < NUM_SECTIONS; i++)
+    section_base[i] = section_address[i] = 0;
+}
+
+Assembler::~Assembler() { delete own_cache; }
 
 /**
  * Remove leading and trailing whitespace from a string
@@ -44,6 +57,39 @@ std::vector<std::string> Assembler::split(const std::string &str,
   return tokens;
 }
 
+/**
+ * Position of the first c outside a character literal, or npos
+ */
+static size_t find_unquoted(const std::string &str, char c) {
+  bool quoted = false;
+  for (size_t i = 0; i < str.size(); i++) {
+    if (str[i] == '\\' && quoted)
+      i++;
+    else if (str[i] == '\'')
+      quoted = !quoted;
+    else if (str[i] == c && !quoted)
+      return i;
+  }
+  return std::string::npos;
+}
+
+/**
+ * Split operands on commas, except inside character literals such as ','
+ */
+std::vector<std::string> Assembler::split_operands(const std::string &str) {
+  std::vector<std::string> tokens;
+  size_t start = 0;
+  for (;;) {
+    size_t comma = find_unquoted(str.substr(start), ',');
+    std::string token = trim(str.substr(start, comma));
+    if (!token.empty())
+      tokens.push_back(token);
+    if (comma == std::string::npos)
+      return tokens;
+    start += comma + 1;
+  }
+}
+
 /**
  * Parse a single line of assembly code
  * Handles labels, opcodes, operands, and comments
@@ -56,7 +102,7 @@ AssemblyLine Assembler::parse_line(const std::string &line, int line_number) {
 
   // Extract and remove comments (everything after ';')
   std::string code = line;
-  size_t comment_pos = code.find(';');
+  size_t comment_pos = find_unquoted(code, ';');
   if (comment_pos != std::string::npos) {
     result.comment = trim(code.substr(comment_pos + 1));
     code = code.substr(0, comment_pos);
@@ -67,7 +113,7 @@ AssemblyLine Assembler::parse_line(const std::string &line, int line_number) {
     return result;
 
   // Extract label if present (format: LABEL:)
-  size_t colon_pos = code.find(':');
+  size_t colon_pos = find_unquoted(code, ':');
   if (colon_pos != std::string::npos) {
     result.label = trim(code.substr(0, colon_pos));
     code = trim(code.substr(colon_pos + 1));
@@ -89,7 +135,7 @@ AssemblyLine Assembler::parse_line(const std::string &line, int line_number) {
         if (i < parts.size() - 1)
           operands_str += " ";
       }
-      result.operands = split(operands_str, ',');
+      result.operands = split_operands(operands_str);
     }
   }
 
@@ -205,52 +251,113 @@ bool Assembler::parse_register(const std::string &operand, byte_t &reg) {
   return false;
 }
 
+/**
+ * Immediates and addresses are constant expressions (expression.cpp),
+ * truncated to the 16 bits of the operand
+ */
 bool Assembler::parse_immediate(const std::string &operand, int16_t &value) {
-  try {
-    // Check for hex (0x prefix)
-    if (operand.length() > 2 && operand[0] == '0' &&
-        (operand[1] == 'x' || operand[1] == 'X')) {
-      value = (int16_t)std::stoi(operand.substr(2), nullptr, 16);
-      return true;
-    }
-    // Check for binary (0b prefix)
-    else if (operand.length() > 2 && operand[0] == '0' &&
-             (operand[1] == 'b' || operand[1] == 'B')) {
-      value = (int16_t)std::stoi(operand.substr(2), nullptr, 2);
-      return true;
-    }
-    // Decimal
-    else {
-      value = (int16_t)std::stoi(operand);
-      return true;
-    }
-  } catch (...) {
+  long result;
+  if (!evaluate(operand, result))
     return false;
-  }
+  value = (int16_t)result;
+  return true;
 }
 
-bool Assembler::parse_address(const std::string &operand, addr_t &address) {
-  // Check if it's a label
-  if (symbol_table.find(operand) != symbol_table.end()) {
-    address = symbol_table[operand];
-    return true;
-  }
-
-  // Try to parse as immediate
-  int16_t value;
-  if (parse_immediate(operand, value)) {
-    address = (addr_t)value;
+/**
+ * site is where the address word goes. In object mode a label there
+ * becomes a relocation and the word is left zero for the linker.
+ */
+bool Assembler::parse_address(const std::string &operand, addr_t &address,
+                              addr_t site) {
+  ExprValue result;
+  if (!evaluate_value(operand, result))
+    return false;
+  if (result.relocatable()) {
+    Relocation relocation = {
+        current_section, (addr_t)(site - section_base[current_section]),
+        result};
+    relocations.push_back(relocation);
+    address = 0;
     return true;
   }
-
-  return false;
+  address = (addr_t)result.value;
+  return true;
 }
 
 void Assembler::emit_byte(byte_t value) {
-  machine_code.push_back(value);
+  if (current_section == SECTION_DATA)
+    data_code.push_back(value);
+  else
+    machine_code.push_back(value);
   current_address++;
 }
 
+/**
+ * Continue the other section where it left off
+ */
+void Assembler::switch_section(int section) {
+  section_address[current_section] = current_address;
+  current_section = section;
+  current_address = section_address[section];
+}
+
+/**
+ * .text and .data switch sections; .word and .byte place their values in
+ * the current one, a .byte list padded to whole words to keep code
+ * aligned. In pass 1 (encode false) they only advance the location.
+ */
+bool Assembler::section_directive(const AssemblyLine &line, bool encode) {
+  std::string directive = line.opcode;
+  std::transform(directive.begin(), directive.end(), directive.begin(),
+                 ::toupper);
+
+  if (directive == ".TEXT" || directive == ".DATA") {
+    if (!line.operands.empty()) {
+      report_error(line.line_number, line.opcode + " takes no operands");
+      return false;
+    }
+    switch_section(directive == ".TEXT" ? SECTION_TEXT : SECTION_DATA);
+    return true;
+  }
+  if (directive != ".WORD" && directive != ".BYTE") {
+    report_error(line.line_number, "Unknown directive '" + line.opcode + "'");
+    return false;
+  }
+  if (line.operands.empty()) {
+    report_error(line.line_number, line.opcode + " requires a value");
+    return false;
+  }
+
+  size_t count = line.operands.size();
+  bool words = directive == ".WORD";
+  if (!encode) {
+    current_address += words ? 2 * count : (count + 1) & ~1;
+    return true;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (words) {
+      addr_t value;
+      if (!parse_address(line.operands[i], value, current_address)) {
+        report_error(line.line_number,
+                     "Invalid value '" + line.operands[i] + "'");
+        return false;
+      }
+      emit_word(value);
+    } else {
+      long value;
+      if (!evaluate(line.operands[i], value) || value < -128 || value > 255) {
+        report_error(line.line_number, "Byte value '" + line.operands[i] +
+                                           "' out of range (-128 to 255)");
+        return false;
+      }
+      emit_byte((byte_t)value);
+    }
+  }
+  if (!words && count % 2 != 0)
+    emit_byte(0);
+  return true;
+}
+
 void Assembler::emit_word(word_t value) {
   // Little-endian
   emit_byte((byte_t)(value & 0xFF));
@@ -258,14 +365,32 @@ void Assembler::emit_word(word_t value) {
 }
 
 void Assembler::report_error(int line_number, const std::string &message) {
-  std::cerr << "Error on line " << line_number << ": " << message << std::endl;
   error_count++;
+  std::string detail;
+  detail.swap(expression_error);
+  if (symbols_hidden)
+    return; // A trial encoding; the real pass reports it if it matters
+  *diagnostics << "Error ";
+  if (!error_file.empty())
+    *diagnostics << "in " << error_file << " ";
+  *diagnostics << "on line " << line_number << ": " << message;
+  if (!detail.empty())
+    *diagnostics << " (" << detail << ")";
+  *diagnostics << std::endl;
 }
 
+/**
+ * Labels are placed at offsets into their section; the data section's
+ * labels then move to DATA_START, out of the code segment, so that data
+ * stays writable in Harvard mode
+ */
 bool Assembler::first_pass() {
+  current_section = SECTION_TEXT;
   current_address = PROGRAM_START;
+  section_address[SECTION_DATA] = 0;
 
   for (const auto &line : lines) {
+    error_file = line.file;
     // Add label to symbol table
     if (!line.label.empty()) {
       if (symbol_table.find(line.label) != symbol_table.end()) {
@@ -273,39 +398,65 @@ bool Assembler::first_pass() {
         return false;
       }
       symbol_table[line.label] = current_address;
+      label_sections[line.label] = current_section;
     }
 
     // Calculate instruction size
-    if (!line.opcode.empty()) {
+    if (!line.encoded.empty()) {
+      current_address += 2 * line.encoded.size();
+    } else if (!line.opcode.empty() && line.opcode[0] == '.') {
+      if (!section_directive(line, false))
+        return false;
+    } else if (!line.opcode.empty()) {
       int opcode = get_opcode(line.opcode);
       if (opcode < 0) {
         report_error(line.line_number, "Unknown opcode '" + line.opcode + "'");
         return false;
       }
+      current_address += instruction_size(line, opcode);
+    }
+  }
+
+  switch_section(SECTION_TEXT);
+  section_base[SECTION_TEXT] = PROGRAM_START;
+  section_base[SECTION_DATA] = DATA_START;
+  for (std::map<std::string, int>::const_iterator it = label_sections.begin();
+       it != label_sections.end(); ++it) {
+    if (it->second == SECTION_DATA)
+      symbol_table[it->first] += section_base[SECTION_DATA];
+  }
+  // In an object the linker supplies it, once all .data is placed
+  if (!object_mode && !symbol_table.count(DATA_END_SYMBOL) &&
+      !constants.count(DATA_END_SYMBOL))
+    constants[DATA_END_SYMBOL] =
+        section_base[SECTION_DATA] + section_address[SECTION_DATA];
+  return true;
+}
 
-      // Most instructions are 2 bytes
-      current_address += 2;
+/**
+ * Compute the encoded size of an instruction in bytes
+ * Most instructions are one word; branches, calls and direct
+ * LOAD/STORE carry an extra address word
+ */
+int Assembler::instruction_size(const AssemblyLine &line, int opcode) {
+  if (opcode == OP_LOAD_DIR || opcode == OP_STORE_DIR || opcode == OP_JMP ||
+      opcode == OP_JZ || opcode == OP_JNZ || opcode == OP_JC ||
+      opcode == OP_JNC || opcode == OP_JN || opcode == OP_CALL) {
+    return 4;
+  }
 
-      // Some instructions have an additional word for address
-      if (opcode == OP_LOAD_DIR || opcode == OP_STORE_DIR || opcode == OP_JMP ||
-          opcode == OP_JZ || opcode == OP_JNZ || opcode == OP_JC ||
-          opcode == OP_JNC || opcode == OP_JN || opcode == OP_CALL) {
-        current_address += 2;
-      }
-      // Check if LOAD/STORE needs to be direct addressing
-      else if ((opcode == OP_LOAD_IND || opcode == OP_STORE_IND) &&
-               !line.operands.empty()) {
-        // If second operand is not [Rx], it's direct addressing
-        std::string op =
-            line.operands.size() > 1 ? line.operands[1] : line.operands[0];
-        if (op.find('[') == std::string::npos) {
-          current_address += 2; // Extra word for address
-        }
-      }
+  // Check if LOAD/STORE needs to be direct addressing
+  if ((opcode == OP_LOAD_IND || opcode == OP_STORE_IND) &&
+      !line.operands.empty()) {
+    // If second operand is not [Rx], it's direct addressing
+    std::string op =
+        line.operands.size() > 1 ? line.operands[1] : line.operands[0];
+    if (op.find('[') == std::string::npos) {
+      return 4; // Extra word for address
     }
   }
 
-  return true;
+  return 2;
 }
 
 bool Assembler::encode_instruction(const AssemblyLine &line) {
@@ -385,7 +536,7 @@ bool Assembler::encode_instruction(const AssemblyLine &line) {
     } else {
       // Direct addressing
       addr_t addr;
-      if (!parse_address(src, addr)) {
+      if (!parse_address(src, addr, current_address + 2)) {
         report_error(line.line_number, "Invalid address");
         return false;
       }
@@ -419,7 +570,7 @@ bool Assembler::encode_instruction(const AssemblyLine &line) {
     } else {
       // Direct addressing
       addr_t addr;
-      if (!parse_address(dst, addr)) {
+      if (!parse_address(dst, addr, current_address + 2)) {
         report_error(line.line_number, "Invalid address");
         return false;
       }
@@ -512,7 +663,7 @@ bool Assembler::encode_instruction(const AssemblyLine &line) {
       return false;
     }
     addr_t addr;
-    if (!parse_address(line.operands[0], addr)) {
+    if (!parse_address(line.operands[0], addr, current_address + 2)) {
       report_error(line.line_number, "Invalid address or label");
       return false;
     }
@@ -555,79 +706,155 @@ bool Assembler::encode_instruction(const AssemblyLine &line) {
 }
 
 bool Assembler::second_pass() {
-  current_address = PROGRAM_START;
+  current_section = SECTION_TEXT;
+  current_address = section_base[SECTION_TEXT];
+  section_address[SECTION_DATA] = section_base[SECTION_DATA];
   machine_code.clear();
+  data_code.clear();
+  placements.clear();
+  location_known = true; // '.' is current_address from here on
 
+  bool ok = true;
   for (const auto &line : lines) {
-    if (!line.opcode.empty()) {
-      if (!encode_instruction(line)) {
-        return false;
-      }
-    }
+    error_file = line.file;
+    LinePlacement place = {current_section, current_address, 0};
+    placements.push_back(place);
+    if (line.opcode.empty())
+      continue;
+    bool is_data = line.opcode[0] == '.';
+    if (!line.encoded.empty()) {
+      // Pre-encoded by the module cache
+      for (size_t i = 0; i < line.encoded.size(); i++)
+        emit_word(line.encoded[i]);
+    } else if (is_data ? !section_directive(line, true)
+                       : !encode_instruction(line)) {
+      ok = false;
+      break;
+    }
+
+    if (current_section == place.section)
+      placements.back().size = current_address - place.address;
+
+    // Execution never falls through to the next line
+    int opcode = get_opcode(line.opcode);
+    if (is_data || opcode == OP_JMP || opcode == OP_RET || opcode == OP_HALT)
+      flow_ends[current_section].insert(current_address -
+                                        section_base[current_section]);
   }
-
-  return true;
+  switch_section(SECTION_TEXT);
+  if (data_code.size() > (size_t)(DATA_END - DATA_START) + 1) {
+    *diagnostics << "Error: Data section is larger than the data segment"
+                 << std::endl;
+    error_count++;
+    ok = false;
+  }
+  location_known = false;
+  return ok;
 }
 
 bool Assembler::assemble(const std::string &input_file,
                          const std::string &output_file) {
-  // Read input file
-  std::ifstream infile(input_file);
-  if (!infile.is_open()) {
-    std::cerr << "Error: Could not open input file '" << input_file << "'"
-              << std::endl;
+  // Read and parse the input file
+  std::string text;
+  if (!read_source(input_file, text)) {
+    *diagnostics << "Error: Could not open input file '" << input_file
+                 << "'" << std::endl;
     return false;
   }
+  std::vector<AssemblyLine> source;
+  lex_source(text, source);
 
-  // Parse all lines
-  std::string line;
-  int line_number = 1;
-  while (std::getline(infile, line)) {
-    AssemblyLine parsed = parse_line(line, line_number);
-    if (!parsed.label.empty() || !parsed.opcode.empty()) {
-      lines.push_back(parsed);
-    }
-    line_number++;
+  *log << "Assembling '" << input_file << "'..." << std::endl;
+
+  // Expand constants, macros and included modules into lines. The input
+  // counts as included, so a module that includes it back is skipped.
+  source_path = input_file;
+  included.insert(ModuleCache::hash(text));
+  if (!preprocess(source, 0)) {
+    *diagnostics << "Assembly failed in preprocessor" << std::endl;
+    return false;
+  }
+  if (modules_included > 0) {
+    *log << "Included " << modules_included << " modules (" << modules_cached
+         << " from cache)" << std::endl;
   }
-  infile.close();
 
-  std::cout << "Assembling '" << input_file << "'..." << std::endl;
+  // Optional optimization: rewrite call sites before addresses are assigned
+  if (optimize_enabled && !optimize()) {
+    *diagnostics << "Assembly failed in optimizer" << std::endl;
+    return false;
+  }
 
   // First pass: build symbol table
-  std::cout << "Pass 1: Building symbol table..." << std::endl;
+  *log << "Pass 1: Building symbol table..." << std::endl;
   if (!first_pass()) {
-    std::cerr << "Assembly failed in first pass" << std::endl;
+    *diagnostics << "Assembly failed in first pass" << std::endl;
     return false;
   }
 
-  std::cout << "Found " << symbol_table.size() << " labels" << std::endl;
+  *log << "Found " << symbol_table.size() << " labels" << std::endl;
 
   // Second pass: generate machine code
-  std::cout << "Pass 2: Generating machine code..." << std::endl;
+  *log << "Pass 2: Generating machine code..." << std::endl;
   if (!second_pass()) {
-    std::cerr << "Assembly failed in second pass" << std::endl;
+    *diagnostics << "Assembly failed in second pass" << std::endl;
     return false;
   }
 
   if (error_count > 0) {
-    std::cerr << "Assembly failed with " << error_count << " errors"
-              << std::endl;
+    *diagnostics << "Assembly failed with " << error_count << " errors"
+                 << std::endl;
     return false;
   }
 
+  if (object_mode) {
+    ObjectFile object;
+    if (!build_object(object) || !object.write(output_file))
+      return false;
+    *log << "Successfully assembled " << object.atoms.size() << " atoms, "
+         << object.relocations.size() << " relocations to '" << output_file
+         << "'" << std::endl;
+    return true;
+  }
+
   // Write output file
   std::ofstream outfile(output_file, std::ios::binary);
   if (!outfile.is_open()) {
-    std::cerr << "Error: Could not create output file '" << output_file << "'"
-              << std::endl;
+    *diagnostics << "Error: Could not create output file '" << output_file
+                 << "'" << std::endl;
     return false;
   }
 
   outfile.write((char *)machine_code.data(), machine_code.size());
   outfile.close();
 
-  std::cout << "Successfully assembled " << machine_code.size() << " bytes to '"
-            << output_file << "'" << std::endl;
+  *log << "Successfully assembled " << machine_code.size() << " bytes to '"
+       << output_file << "'" << std::endl;
+
+  // The data section goes next to it; every loader of the binary places
+  // <output>.data at DATA_START
+  if (!data_code.empty()) {
+    std::string data_file = output_file + ".data";
+    std::ofstream data_out(data_file, std::ios::binary);
+    if (!data_out.is_open()) {
+      *diagnostics << "Error: Could not create output file '" << data_file
+                   << "'" << std::endl;
+      return false;
+    }
+    data_out.write((char *)data_code.data(), data_code.size());
+    *log << "Wrote " << data_code.size() << " data bytes to '" << data_file
+         << "' (loaded at 0x8000 with the binary)" << std::endl;
+  }
 
   return true;
 }
+
+/**
+ * Write the symbol table sorted by address, one label per line in the
+ * format of a perf map: hex start, hex size, name. A label's size runs to
+ * the next higher label or the end of the code.
+ */
+bool Assembler::write_symbol_map(const std::string &path) const {
+  return write_perf_map(path, symbol_table,
+                        (addr_t)(PROGRAM_START + machine_code.size()));
+}
@@ -3,7 +3,10 @@
 
 #include "../common/instructions.h"
 #include "../common/types.h"
+#include "object_file.h"
 #include <map>
+#include <ostream>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -13,34 +16,158 @@ struct AssemblyLine {
   std::string opcode;
   std::vector<std::string> operands;
   std::string comment;
+  std::string file; // Included module it came from, empty for the main file
+  std::vector<word_t> encoded; // Set when no operand needs a symbol
+};
+
+class ModuleCache;
+
+/**
+ * Value of a constant expression. In object mode a label is only known at
+ * link time: its value is an offset into one of this file's sections, or
+ * an external symbol plus an addend.
+ */
+struct ExprValue {
+  long value;         // Number, section offset or addend
+  int section;        // SECTION_TEXT or SECTION_DATA, -1 for a number
+  std::string symbol; // External symbol, if any
+  long anchor;        // Section offset of the label the value came from
+
+  ExprValue() : value(0), section(-1), anchor(0) {}
+  bool relocatable() const { return section >= 0 || !symbol.empty(); }
+};
+
+// An address word the linker fills in (object mode)
+struct Relocation {
+  int section;
+  addr_t site; // Section offset of the word
+  ExprValue target;
+};
+
+// Where pass 2 placed a line
+struct LinePlacement {
+  int section;
+  addr_t address;
+  int size; // Bytes
+};
+
+struct Finding;
+
+// Section offsets that must stay in one atom, since an expression
+// depends on the distance between them
+struct AtomSpan {
+  int section;
+  long low;
+  long high;
+};
+
+// A .macro definition: its parameter names and unexpanded body
+struct Macro {
+  std::vector<std::string> parameters;
+  std::vector<AssemblyLine> body;
 };
 
 class Assembler {
 private:
   std::map<std::string, addr_t> symbol_table; // Labels -> addresses
+  std::map<std::string, long> constants;      // .equ names -> values
+  std::map<std::string, Macro> macros;
   std::vector<AssemblyLine> lines;
   std::vector<byte_t> machine_code;
   addr_t current_address;
   int error_count;
+  std::string error_file; // Module of the line being processed
+  std::string source_path; // Main file, for resolving its .include lines
+  bool location_known;     // In pass 2, where '.' has a value
+  std::string expression_error; // Why the last expression failed
+
+  // Sections (.text/.data); data is placed at DATA_START, in an image of
+  // its own
+  int current_section;
+  addr_t section_base[NUM_SECTIONS];
+  addr_t section_address[NUM_SECTIONS]; // Where the other section resumes
+  std::vector<byte_t> data_code;          // machine_code holds the text
+  std::map<std::string, int> label_sections;
+
+  // Object mode: relocatable output for the linker (object.cpp)
+  bool object_mode;
+  std::vector<Relocation> relocations;
+  std::vector<AtomSpan> atom_spans;
+  std::set<addr_t> flow_ends[NUM_SECTIONS]; // Offsets nothing falls into
+  std::vector<LinePlacement> placements;    // Parallel to lines
+
+  // Optimizer settings
+  bool optimize_enabled;
+  int inline_budget; // Max bytes of a leaf body inlined at a call site
+
+  // Preprocessor state (preprocessor.cpp)
+  ModuleCache *cache;
+  ModuleCache *own_cache; // Used unless set_module_cache() gives one
+  std::vector<std::string> include_dirs;
+  int expansion_count;    // Numbers each macro expansion for \@
+  std::set<uint64_t> included; // Content hashes; each is included once
+  int modules_included;
+  int modules_cached;     // Of those, found already lexed
+  bool symbols_hidden;    // Pre-encoding: names must not resolve
+
+  // Where progress messages and errors go
+  std::ostream *log;
+  std::ostream *diagnostics;
 
   // Parsing helpers
   AssemblyLine parse_line(const std::string &line, int line_number);
   std::string trim(const std::string &str);
   std::vector<std::string> split(const std::string &str, char delimiter);
+  std::vector<std::string> split_operands(const std::string &str);
+
+  // Preprocessing: .equ, .macro/.endm and .include
+  bool preprocess(const std::vector<AssemblyLine> &source, int depth);
+  bool define_macro(const std::vector<AssemblyLine> &source, size_t &index);
+  bool expand_macro(const Macro &macro, const AssemblyLine &call, int depth);
+  bool include_module(const AssemblyLine &line, int depth);
+  bool read_source(const std::string &path, std::string &text);
+  void lex_source(const std::string &text, std::vector<AssemblyLine> &lexed);
+  void pre_encode(std::vector<AssemblyLine> &module);
 
   // Assembly passes
   bool first_pass();  // Build symbol table
   bool second_pass(); // Generate machine code
 
+  // Optimization passes (optimizer.cpp)
+  bool optimize();
+  int inline_leaf_calls();
+  int convert_tail_calls();
+
   // Code generation
+  int instruction_size(const AssemblyLine &line, int opcode);
   bool encode_instruction(const AssemblyLine &line);
+  bool section_directive(const AssemblyLine &line, bool encode);
+  void switch_section(int section);
   void emit_word(word_t value);
   void emit_byte(byte_t value);
 
+  // Constant expressions (expression.cpp)
+  bool evaluate(const std::string &text, long &value);
+  bool evaluate_value(const std::string &text, ExprValue &value);
+  bool parse_expression(const std::string &text, size_t &pos, int precedence,
+                        ExprValue &value);
+  bool parse_unary(const std::string &text, size_t &pos, ExprValue &value);
+  bool parse_primary(const std::string &text, size_t &pos, ExprValue &value);
+  bool combine(char op, ExprValue &value, const ExprValue &rhs);
+
   // Operand parsing
   bool parse_register(const std::string &operand, byte_t &reg);
   bool parse_immediate(const std::string &operand, int16_t &value);
-  bool parse_address(const std::string &operand, addr_t &address);
+  bool parse_address(const std::string &operand, addr_t &address,
+                     addr_t site);
+
+  // Object file construction (object.cpp)
+  bool build_object(ObjectFile &object);
+
+  // Code report checks (report.cpp)
+  bool register_dead(size_t from, int reg);
+  void find_encoding_candidates(std::vector<Finding> &shorter,
+                                std::vector<Finding> &overflows);
 
   // Opcode lookup
   int get_opcode(const std::string &mnemonic);
@@ -50,12 +177,41 @@ private:
 
 public:
   Assembler();
+  ~Assembler();
+  Assembler(const Assembler &) = delete;
+  Assembler &operator=(const Assembler &) = delete;
+
+  // Enable leaf inlining and tail-call conversion before pass 1
+  void set_optimize(bool enable) { optimize_enabled = enable; }
+  void set_inline_budget(int bytes) { inline_budget = bytes; }
+
+  // Share lexed modules between assemblers; the cache must outlive them
+  void set_module_cache(ModuleCache *shared) { cache = shared; }
+  // Searched for .include files after the including file's directory
+  void add_include_dir(const std::string &dir) { include_dirs.push_back(dir); }
+  // Send progress messages and errors elsewhere (default cout and cerr)
+  void set_output(std::ostream *progress, std::ostream *errors) {
+    log = progress;
+    diagnostics = errors;
+  }
+  // Write a relocatable object for the linker instead of an image
+  void set_object_mode(bool enable) { object_mode = enable; }
 
   // Main assembly function
   bool assemble(const std::string &input_file, const std::string &output_file);
 
   // Get assembled code
   const std::vector<byte_t> &get_machine_code() const { return machine_code; }
+  // The .data section, loaded at DATA_START (empty if there is none)
+  const std::vector<byte_t> &get_data_image() const { return data_code; }
+  const std::map<std::string, addr_t> &get_symbols() const {
+    return symbol_table;
+  }
+
+  // Write labels as "<address> <size> <name>" lines (perf map format)
+  bool write_symbol_map(const std::string &path) const;
+  // Write the JSON code-size and instruction-mix report ("-" for stdout)
+  bool write_report(const std::string &path);
 };
 
 #endif // ASSEMBLER_H
@@ -0,0 +1,156 @@
+/**
+ * Batch Assembly
+ *
+ * Assembles many sources in one process. Worker threads take the next
+ * file from a shared counter, each with its own Assembler; all of them
+ * share one module cache, so a runtime included by every file is lexed
+ * and pre-encoded once. Each file's messages are captured and its errors
+ * printed together, prefixed with the file name, when it finishes.
+ */
+
+#include "batch.h"
+#include "assembler.h"
+#include "module_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+bool read_batch_manifest(const std::string &path,
+                         std::vector<BatchJob> &jobs) {
+  std::ifstream file(path.c_str());
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)
+      line = line.substr(0, comment);
+    std::istringstream fields(line);
+    BatchJob job;
+    if (!(fields >> job.input))
+      continue;
+    fields >> job.output;
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+bool plan_batch_outputs(std::vector<BatchJob> &jobs,
+                        const BatchOptions &options) {
+  bool needs_dir = false;
+  for (size_t i = 0; i < jobs.size(); i++)
+    needs_dir = needs_dir || jobs[i].output.empty();
+  if (needs_dir && options.output_dir.empty()) {
+    std::cerr << "Error: Batch mode needs an output directory (-o <dir>)"
+              << std::endl;
+    return false;
+  }
+  if (needs_dir && mkdir(options.output_dir.c_str(), 0755) != 0 &&
+      errno != EEXIST) {
+    std::cerr << "Error: Could not create directory '" << options.output_dir
+              << "'" << std::endl;
+    return false;
+  }
+
+  std::set<std::string> outputs;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    BatchJob &job = jobs[i];
+    if (job.output.empty()) {
+      size_t slash = job.input.find_last_of('/');
+      std::string name =
+          slash == std::string::npos ? job.input : job.input.substr(slash + 1);
+      size_t dot = name.find_last_of('.');
+      if (dot != std::string::npos && dot > 0)
+        name = name.substr(0, dot);
+      job.output =
+          options.output_dir + "/" + name + (options.object ? ".o" : ".bin");
+    }
+    if (!outputs.insert(job.output).second) {
+      std::cerr << "Error: Two sources would be written to '" << job.output
+                << "'" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Shared by the worker threads
+ */
+struct BatchState {
+  const std::vector<BatchJob> &jobs;
+  const BatchOptions &options;
+  ModuleCache &cache;
+  std::atomic<size_t> next;
+  std::atomic<int> failed;
+  std::mutex report_lock; // One file's errors are printed together
+
+  BatchState(const std::vector<BatchJob> &all, const BatchOptions &settings,
+             ModuleCache &shared)
+      : jobs(all), options(settings), cache(shared), next(0), failed(0) {}
+};
+
+static void assemble_jobs(BatchState &state) {
+  for (;;) {
+    size_t index = state.next++;
+    if (index >= state.jobs.size())
+      return;
+    const BatchJob &job = state.jobs[index];
+
+    std::ostringstream progress;
+    std::ostringstream errors;
+    Assembler assembler;
+    assembler.set_output(&progress, &errors);
+    assembler.set_module_cache(&state.cache);
+    for (size_t i = 0; i < state.options.include_dirs.size(); i++)
+      assembler.add_include_dir(state.options.include_dirs[i]);
+    assembler.set_object_mode(state.options.object);
+    assembler.set_optimize(state.options.optimize);
+    if (state.options.inline_budget >= 0)
+      assembler.set_inline_budget(state.options.inline_budget);
+
+    if (assembler.assemble(job.input, job.output))
+      continue;
+    state.failed++;
+    std::lock_guard<std::mutex> guard(state.report_lock);
+    std::istringstream lines(errors.str());
+    std::string line;
+    while (std::getline(lines, line))
+      std::cerr << job.input << ": " << line << "\n";
+    std::cerr.flush();
+  }
+}
+
+int assemble_batch(const std::vector<BatchJob> &jobs,
+                   const BatchOptions &options, ModuleCache &cache) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  BatchState state(jobs, options, cache);
+
+  int threads = std::max(1, std::min(options.threads, (int)jobs.size()));
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.push_back(std::thread(assemble_jobs, std::ref(state)));
+  assemble_jobs(state);
+  for (size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  std::cout << "Assembled " << jobs.size() - state.failed << " of "
+            << jobs.size() << " files in " << (long)ms << " ms with "
+            << threads << " threads (module cache: " << cache.get_hits()
+            << " hits, " << cache.get_misses() << " misses)" << std::endl;
+  return state.failed;
+}
@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+
+class ModuleCache;
+
+struct BatchJob {
+  std::string input;
+  std::string output;
+};
+
+// Settings applied to every file of a batch
+struct BatchOptions {
+  std::string output_dir;
+  int threads;
+  bool object;
+  bool optimize;
+  int inline_budget; // -1 for the assembler's default
+  std::vector<std::string> include_dirs;
+};
+
+// Add the sources listed in a manifest: "<input.asm> [output]" per line,
+// '#' starting a comment
+bool read_batch_manifest(const std::string &path, std::vector<BatchJob> &jobs);
+
+// Name each job's output after its input inside the output directory,
+// unless the manifest gave one
+bool plan_batch_outputs(std::vector<BatchJob> &jobs,
+                        const BatchOptions &options);
+
+// Assemble every job on a pool of threads sharing the module cache;
+// returns the number that failed
+int assemble_batch(const std::vector<BatchJob> &jobs,
+                   const BatchOptions &options, ModuleCache &cache);
+
+#endif // BATCH_H
@@ -0,0 +1,351 @@
+/**
+ * Constant Expressions
+ *
+ * Every immediate and address operand is a constant expression, folded
+ * at assembly time. Operators, loosest binding first, as in C:
+ *
+ *   |   &   << >>   + -   * /   unary - ~
+ *
+ * Operands are decimal, 0x hex and 0b binary numbers, character literals
+ * ('F', '\n'), .equ constants, labels and '.', the address of the
+ * instruction being assembled. Labels and '.' are known in pass 2, so an
+ * .equ may use only numbers and earlier constants.
+ *
+ * In object mode labels, '.' and names defined by other objects are
+ * link-time addresses. Such an address plus or minus a number can fill an
+ * address word; the distance between two labels of one section is a
+ * number. Anything else made of them is an error.
+ */
+
+#include "assembler.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+static void skip_spaces(const std::string &text, size_t &pos) {
+  while (pos < text.size() && std::isspace((unsigned char)text[pos]))
+    pos++;
+}
+
+static bool is_word_char(char c) {
+  return std::isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * Binary operator at pos: its binding strength (higher binds tighter) and
+ * length, or 0 if there is none
+ */
+static int binary_operator(const std::string &text, size_t pos,
+                           size_t &length) {
+  if (pos >= text.size())
+    return 0;
+  length = 1;
+  switch (text[pos]) {
+  case '|':
+    return 1;
+  case '&':
+    return 2;
+  case '<':
+  case '>':
+    if (pos + 1 < text.size() && text[pos + 1] == text[pos]) {
+      length = 2;
+      return 3;
+    }
+    return 0;
+  case '+':
+  case '-':
+    return 4;
+  case '*':
+  case '/':
+    return 5;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Evaluate a whole operand to a number; it must fit in 16 bits, signed or
+ * unsigned
+ */
+bool Assembler::evaluate(const std::string &text, long &value) {
+  ExprValue result;
+  if (!evaluate_value(text, result))
+    return false;
+  if (result.relocatable()) {
+    expression_error = "'" + text +
+                       "' is a link-time address, allowed only in an "
+                       "address word";
+    return false;
+  }
+  value = result.value;
+  return true;
+}
+
+bool Assembler::evaluate_value(const std::string &text, ExprValue &value) {
+  expression_error.clear();
+  size_t pos = 0;
+  value = ExprValue();
+  if (!parse_expression(text, pos, 1, value))
+    return false;
+  skip_spaces(text, pos);
+  if (pos < text.size()) {
+    expression_error = "unexpected '" + text.substr(pos) + "'";
+    return false;
+  }
+  if (value.value < -32768 || value.value > 65535) {
+    expression_error = "value " + std::to_string(value.value) +
+                       " does not fit in 16 bits";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Precedence climbing: parse operators binding at least as tightly as
+ * precedence, left to right
+ */
+bool Assembler::parse_expression(const std::string &text, size_t &pos,
+                                 int precedence, ExprValue &value) {
+  if (!parse_unary(text, pos, value))
+    return false;
+  for (;;) {
+    skip_spaces(text, pos);
+    size_t length = 0;
+    int strength = binary_operator(text, pos, length);
+    if (strength == 0 || strength < precedence)
+      return true;
+    char op = text[pos];
+    pos += length;
+
+    ExprValue rhs;
+    if (!parse_expression(text, pos, strength + 1, rhs) ||
+        !combine(op, value, rhs))
+      return false;
+  }
+}
+
+/**
+ * Apply a binary operator, value = value op rhs
+ */
+bool Assembler::combine(char op, ExprValue &value, const ExprValue &rhs) {
+  if (op == '+' && !(value.relocatable() && rhs.relocatable())) {
+    long number = rhs.relocatable() ? value.value : rhs.value;
+    if (rhs.relocatable())
+      value = rhs;
+    value.value += number;
+    return true;
+  }
+  if (op == '-' && !rhs.relocatable()) {
+    value.value -= rhs.value;
+    return true;
+  }
+  if (op == '-' && value.relocatable() && value.symbol.empty() &&
+      rhs.symbol.empty() && value.section == rhs.section) {
+    // A distance within the section, as long as the linker keeps the
+    // code between the two ends together
+    AtomSpan span = {
+        value.section,
+        std::min(std::min(value.anchor, value.value),
+                 std::min(rhs.anchor, rhs.value)),
+        std::max(std::max(value.anchor, value.value),
+                 std::max(rhs.anchor, rhs.value))};
+    atom_spans.push_back(span);
+    value.value -= rhs.value;
+    value.section = -1;
+    return true;
+  }
+  if (value.relocatable() || rhs.relocatable()) {
+    std::string name(op == '<' || op == '>' ? 2 : 1, op);
+    expression_error =
+        "'" + name + "' cannot combine these link-time addresses";
+    return false;
+  }
+
+  switch (op) {
+  case '|':
+    value.value |= rhs.value;
+    break;
+  case '&':
+    value.value &= rhs.value;
+    break;
+  case '<':
+    value.value =
+        rhs.value >= 0 && rhs.value < 32 ? value.value << rhs.value : 0;
+    break;
+  case '>':
+    value.value =
+        rhs.value >= 0 && rhs.value < 32 ? value.value >> rhs.value : 0;
+    break;
+  case '+':
+    value.value += rhs.value;
+    break;
+  case '-':
+    value.value -= rhs.value;
+    break;
+  case '*':
+    value.value *= rhs.value;
+    break;
+  case '/':
+    if (rhs.value == 0) {
+      expression_error = "division by zero";
+      return false;
+    }
+    value.value /= rhs.value;
+    break;
+  }
+  return true;
+}
+
+bool Assembler::parse_unary(const std::string &text, size_t &pos,
+                            ExprValue &value) {
+  skip_spaces(text, pos);
+  if (pos < text.size() &&
+      (text[pos] == '-' || text[pos] == '~' || text[pos] == '+')) {
+    char op = text[pos++];
+    if (!parse_unary(text, pos, value))
+      return false;
+    if (op != '+' && value.relocatable()) {
+      expression_error = std::string("'") + op +
+                         "' cannot apply to a link-time address";
+      return false;
+    }
+    if (op == '-')
+      value.value = -value.value;
+    else if (op == '~')
+      value.value = ~value.value;
+    return true;
+  }
+  return parse_primary(text, pos, value);
+}
+
+bool Assembler::parse_primary(const std::string &text, size_t &pos,
+                              ExprValue &value) {
+  skip_spaces(text, pos);
+  if (pos >= text.size()) {
+    expression_error = "missing value";
+    return false;
+  }
+
+  // Parenthesized subexpression
+  if (text[pos] == '(') {
+    pos++;
+    if (!parse_expression(text, pos, 1, value))
+      return false;
+    skip_spaces(text, pos);
+    if (pos >= text.size() || text[pos] != ')') {
+      expression_error = "expected ')'";
+      return false;
+    }
+    pos++;
+    return true;
+  }
+
+  // Character literal, with \n \t \r \0 \\ and \' escapes
+  if (text[pos] == '\'') {
+    size_t close = pos + 2;
+    char c = pos + 1 < text.size() ? text[pos + 1] : '\0';
+    if (c == '\\' && pos + 2 < text.size()) {
+      switch (text[pos + 2]) {
+      case 'n':
+        c = '\n';
+        break;
+      case 't':
+        c = '\t';
+        break;
+      case 'r':
+        c = '\r';
+        break;
+      case '0':
+        c = '\0';
+        break;
+      default:
+        c = text[pos + 2];
+      }
+      close = pos + 3;
+    }
+    if (close >= text.size() || text[close] != '\'') {
+      expression_error = "invalid character literal";
+      return false;
+    }
+    value.value = (unsigned char)c;
+    pos = close + 1;
+    return true;
+  }
+
+  // The current location
+  if (text[pos] == '.' &&
+      (pos + 1 >= text.size() || !is_word_char(text[pos + 1]))) {
+    pos++;
+    if (!location_known || symbols_hidden) {
+      expression_error = "'.' is only known inside an instruction";
+      return false;
+    }
+    value.value = current_address;
+    if (object_mode) {
+      value.section = current_section;
+      value.value -= section_base[current_section];
+      value.anchor = value.value;
+    }
+    return true;
+  }
+
+  size_t end = pos;
+  while (end < text.size() && is_word_char(text[end]))
+    end++;
+  std::string word = text.substr(pos, end - pos);
+  if (word.empty()) {
+    expression_error = "unexpected '" + text.substr(pos) + "'";
+    return false;
+  }
+  pos = end;
+
+  // Number: decimal, 0x hex or 0b binary
+  if (std::isdigit((unsigned char)word[0])) {
+    int base = 10;
+    size_t digits = 0;
+    if (word.size() > 2 && word[0] == '0' &&
+        (word[1] == 'x' || word[1] == 'X')) {
+      base = 16;
+      digits = 2;
+    } else if (word.size() > 2 && word[0] == '0' &&
+               (word[1] == 'b' || word[1] == 'B')) {
+      base = 2;
+      digits = 2;
+    }
+    char *stop = NULL;
+    value.value = std::strtol(word.c_str() + digits, &stop, base);
+    if (*stop != '\0') {
+      expression_error = "invalid number '" + word + "'";
+      return false;
+    }
+    return true;
+  }
+
+  // Constant, then label
+  if (!symbols_hidden) {
+    std::map<std::string, long>::const_iterator constant =
+        constants.find(word);
+    if (constant != constants.end()) {
+      value.value = constant->second;
+      return true;
+    }
+    std::map<std::string, addr_t>::const_iterator label =
+        symbol_table.find(word);
+    if (label != symbol_table.end()) {
+      value.value = label->second;
+      if (object_mode) {
+        value.section = label_sections[word];
+        value.value -= section_base[value.section];
+        value.anchor = value.value;
+      }
+      return true;
+    }
+    // Left for the linker to find in another object
+    if (object_mode && location_known) {
+      value.symbol = word;
+      return true;
+    }
+  }
+  expression_error = "undefined symbol '" + word + "'";
+  return false;
+}
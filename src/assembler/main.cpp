@@ -10,29 +10,156 @@
  */
 
 #include "assembler.h"
+#include "batch.h"
+#include "module_cache.h"
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 void print_usage(const char *program_name) {
-  std::cout << "Usage: " << program_name << " <input.asm> <output.bin>\n";
+  std::cout << "Usage: " << program_name
+            << " [options] <input.asm> <output.bin>\n";
+  std::cout << "       " << program_name
+            << " -c [options] <input.asm> <output.o>\n";
+  std::cout << "       " << program_name
+            << " --batch [options] <a.asm> ... -o <dir> [-j <n>]\n";
   std::cout << "Assembles assembly code into binary machine code\n";
+  std::cout << "Options:\n";
+  std::cout << "  -c, --object           Write a relocatable object for the "
+               "linker\n";
+  std::cout << "  -O, --optimize         Inline small leaf subroutines and "
+               "convert tail calls\n";
+  std::cout << "  --inline-budget <n>    Max leaf body size in bytes to "
+               "inline (default 16)\n";
+  std::cout << "  -s, --symbols <file>   Also write a symbol map of the "
+               "labels\n";
+  std::cout << "  --report <file>        Also write a JSON code-size and "
+               "instruction-mix report\n";
+  std::cout << "                         (\"-\" prints it instead of "
+               "progress messages)\n";
+  std::cout << "  -I <dir>               Search a directory for .include "
+               "files\n";
+  std::cout << "  --cache-dir <dir>      Keep lexed .include modules there "
+               "between runs\n";
+  std::cout << "  --batch                Assemble every input into -o <dir>, "
+               "sharing included modules\n";
+  std::cout << "  --manifest <file>      Batch inputs listed one per line "
+               "(\"<input.asm> [output]\")\n";
+  std::cout << "  -j <n>                 Batch threads (default: one per "
+               "CPU)\n";
 }
 
 int main(int argc, char *argv[]) {
-  // Verify we received exactly two arguments: input and output files
-  if (argc != 3) {
+  std::vector<std::string> files;
+  bool optimize = false;
+  int inline_budget = -1;
+  std::string symbol_file;
+  std::string report_file;
+  std::vector<std::string> include_dirs;
+  std::string cache_dir;
+  bool object = false;
+  bool batch = false;
+  std::vector<BatchJob> jobs;
+  std::string output_dir;
+  int threads = (int)std::thread::hardware_concurrency();
+
+  // Separate options from the input and output file arguments
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-c" || arg == "--object") {
+      object = true;
+    } else if (arg == "-O" || arg == "--optimize") {
+      optimize = true;
+    } else if (arg == "--inline-budget" && i + 1 < argc) {
+      inline_budget = std::atoi(argv[++i]);
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      symbol_file = argv[++i];
+    } else if (arg == "--report" && i + 1 < argc) {
+      report_file = argv[++i];
+    } else if (arg == "-I" && i + 1 < argc) {
+      include_dirs.push_back(argv[++i]);
+    } else if (arg == "--cache-dir" && i + 1 < argc) {
+      cache_dir = argv[++i];
+    } else if (arg == "--batch") {
+      batch = true;
+    } else if (arg == "--manifest" && i + 1 < argc) {
+      batch = true;
+      if (!read_batch_manifest(argv[++i], jobs))
+        return 1;
+    } else if (arg == "-o" && i + 1 < argc) {
+      output_dir = argv[++i];
+    } else if (arg == "-j" && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  ModuleCache cache;
+  cache.set_directory(cache_dir);
+  if (batch) {
+    for (size_t i = 0; i < files.size(); i++) {
+      BatchJob job;
+      job.input = files[i];
+      jobs.push_back(job);
+    }
+    if (jobs.empty() || !symbol_file.empty() || !report_file.empty()) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    BatchOptions options;
+    options.output_dir = output_dir;
+    options.threads = threads;
+    options.object = object;
+    options.optimize = optimize;
+    options.inline_budget = inline_budget;
+    options.include_dirs = include_dirs;
+    if (!plan_batch_outputs(jobs, options))
+      return 1;
+    return assemble_batch(jobs, options, cache) == 0 ? 0 : 1;
+  }
+
+  // Verify we received both an input and an output file
+  if (files.size() != 2) {
     print_usage(argv[0]);
     return 1;
   }
-
-  std::string input_file = argv[1];
-  std::string output_file = argv[2];
+  const std::string &input_file = files[0];
+  const std::string &output_file = files[1];
 
   // Create assembler instance and process the file
   Assembler assembler;
+  assembler.set_module_cache(&cache);
+  for (size_t i = 0; i < include_dirs.size(); i++) {
+    assembler.add_include_dir(include_dirs[i]);
+  }
+  assembler.set_object_mode(object);
+  assembler.set_optimize(optimize);
+  if (inline_budget >= 0) {
+    assembler.set_inline_budget(inline_budget);
+  }
+  std::ostringstream progress; // Dropped when the report goes to stdout
+  if (report_file == "-") {
+    assembler.set_output(&progress, &std::cerr);
+  }
 
   if (!assembler.assemble(input_file, output_file)) {
     return 1;  // Assembly failed - errors already printed
   }
+  if (object && !symbol_file.empty()) {
+    std::cerr << "Note: objects have no addresses yet; the linker writes "
+                 "the symbol map" << std::endl;
+  } else if (!symbol_file.empty() &&
+             !assembler.write_symbol_map(symbol_file)) {
+    return 1;
+  }
+  if (!report_file.empty() && !assembler.write_report(report_file)) {
+    return 1;
+  }
 
   return 0;  
 }
@@ -0,0 +1,183 @@
+/**
+ * Module Cache
+ *
+ * On-disk format (little-endian): "C16M", u32 format version, u64 source
+ * hash, u32 line count, then per line an i32 line number, the label and
+ * opcode as u16-length strings, a u8 operand count and the operands, and
+ * a u8 count of pre-encoded words followed by the words.
+ */
+
+#include "module_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const char MODULE_MAGIC[4] = {'C', '1', '6', 'M'};
+static const uint32_t MODULE_VERSION = 2;
+
+/**
+ * FNV-1a, 64-bit
+ */
+uint64_t ModuleCache::hash(const std::string &text) {
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < text.size(); i++) {
+    h ^= (unsigned char)text[i];
+    h *= 0x100000001B3ULL;
+  }
+  return h;
+}
+
+std::string ModuleCache::path_for(uint64_t hash) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%016llx.mod", (unsigned long long)hash);
+  return directory + name;
+}
+
+const std::vector<AssemblyLine> *ModuleCache::find(uint64_t hash) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::map<uint64_t, std::vector<AssemblyLine> >::const_iterator it =
+      modules.find(hash);
+  if (it != modules.end()) {
+    hits++;
+    return &it->second;
+  }
+  std::vector<AssemblyLine> lines;
+  if (!directory.empty() && read_module(hash, lines)) {
+    hits++;
+    return &(modules[hash] = lines);
+  }
+  misses++;
+  return NULL;
+}
+
+const std::vector<AssemblyLine> &
+ModuleCache::store(uint64_t hash, const std::vector<AssemblyLine> &lines) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::pair<std::map<uint64_t, std::vector<AssemblyLine> >::iterator, bool>
+      inserted = modules.insert(std::make_pair(hash, lines));
+  if (inserted.second && !directory.empty())
+    write_module(hash, lines);
+  return inserted.first->second;
+}
+
+static void put_u32(std::string &out, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    out += (char)(value >> (8 * i));
+}
+
+static void put_string(std::string &out, const std::string &text) {
+  out += (char)(text.size() & 0xFF);
+  out += (char)(text.size() >> 8);
+  out += text;
+}
+
+/**
+ * A failed write only costs the next process a re-lex, so it is silent
+ */
+void ModuleCache::write_module(uint64_t hash,
+                               const std::vector<AssemblyLine> &lines) const {
+  std::string out(MODULE_MAGIC, 4);
+  put_u32(out, MODULE_VERSION);
+  put_u32(out, (uint32_t)hash);
+  put_u32(out, (uint32_t)(hash >> 32));
+  put_u32(out, (uint32_t)lines.size());
+  for (size_t i = 0; i < lines.size(); i++) {
+    const AssemblyLine &line = lines[i];
+    put_u32(out, (uint32_t)line.line_number);
+    put_string(out, line.label);
+    put_string(out, line.opcode);
+    out += (char)line.operands.size();
+    for (size_t j = 0; j < line.operands.size(); j++)
+      put_string(out, line.operands[j]);
+    out += (char)line.encoded.size();
+    for (size_t j = 0; j < line.encoded.size(); j++) {
+      out += (char)(line.encoded[j] & 0xFF);
+      out += (char)(line.encoded[j] >> 8);
+    }
+  }
+
+  // Write under a temporary name so a reader never sees half a module
+  std::string path = path_for(hash);
+  std::string temp = path + ".tmp";
+  std::ofstream file(temp.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return;
+  file.write(out.data(), out.size());
+  file.close();
+  if (!file || std::rename(temp.c_str(), path.c_str()) != 0)
+    std::remove(temp.c_str());
+}
+
+/**
+ * Sequential reader over a module file; fails sticky on overrun
+ */
+class ModuleReader {
+private:
+  const std::string &data;
+  size_t position;
+
+public:
+  bool failed;
+
+  ModuleReader(const std::string &bytes, size_t start)
+      : data(bytes), position(start), failed(false) {}
+
+  uint32_t u8() {
+    if (position >= data.size()) {
+      failed = true;
+      return 0;
+    }
+    return (unsigned char)data[position++];
+  }
+  uint32_t u16() {
+    uint32_t low = u8();
+    return low | (u8() << 8);
+  }
+  uint32_t u32() {
+    uint32_t low = u16();
+    return low | (u16() << 16);
+  }
+  std::string string() {
+    size_t size = u16();
+    if (data.size() - position < size) {
+      failed = true;
+      return "";
+    }
+    position += size;
+    return data.substr(position - size, size);
+  }
+};
+
+bool ModuleCache::read_module(uint64_t hash,
+                              std::vector<AssemblyLine> &lines) const {
+  std::ifstream file(path_for(hash).c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+  std::string data((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+
+  if (data.size() < 4 || std::memcmp(data.data(), MODULE_MAGIC, 4) != 0)
+    return false;
+  ModuleReader in(data, 4);
+  if (in.u32() != MODULE_VERSION)
+    return false;
+  uint64_t stored = in.u32();
+  stored |= (uint64_t)in.u32() << 32;
+  if (stored != hash)
+    return false;
+
+  uint32_t count = in.u32();
+  for (uint32_t i = 0; i < count && !in.failed; i++) {
+    AssemblyLine line;
+    line.line_number = (int)in.u32();
+    line.label = in.string();
+    line.opcode = in.string();
+    for (uint32_t n = in.u8(); n > 0; n--)
+      line.operands.push_back(in.string());
+    for (uint32_t n = in.u8(); n > 0; n--)
+      line.encoded.push_back((word_t)in.u16());
+    lines.push_back(line);
+  }
+  return !in.failed;
+}
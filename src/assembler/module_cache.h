@@ -0,0 +1,56 @@
+#ifndef MODULE_CACHE_H
+#define MODULE_CACHE_H
+
+#include "assembler.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Included modules in lexed form, keyed by a hash of their source text,
+ * so a file shared by many programs is lexed once. Instructions whose
+ * operands need no symbol are also stored already encoded. Held in
+ * memory for the cache's lifetime and, if a directory is set, saved
+ * there as <hash>.mod for later processes.
+ *
+ * Safe to share between threads: lines, once stored, never change or
+ * move, so find() may hand them out without holding the lock.
+ */
+class ModuleCache {
+private:
+  std::map<uint64_t, std::vector<AssemblyLine> > modules;
+  std::string directory; // Empty for a memory-only cache
+  int hits;
+  int misses;
+  mutable std::mutex lock;
+
+  std::string path_for(uint64_t hash) const;
+  bool read_module(uint64_t hash, std::vector<AssemblyLine> &lines) const;
+  void write_module(uint64_t hash,
+                    const std::vector<AssemblyLine> &lines) const;
+
+public:
+  ModuleCache() : hits(0), misses(0) {}
+
+  void set_directory(const std::string &dir) { directory = dir; }
+
+  static uint64_t hash(const std::string &text);
+
+  // Lines of the module with this hash, or NULL on a miss
+  const std::vector<AssemblyLine> *find(uint64_t hash);
+  // The first lines stored under a hash win; later ones are dropped
+  const std::vector<AssemblyLine> &store(uint64_t hash,
+                                         const std::vector<AssemblyLine> &lines);
+
+  int get_hits() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return hits;
+  }
+  int get_misses() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return misses;
+  }
+};
+
+#endif // MODULE_CACHE_H
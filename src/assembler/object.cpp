@@ -0,0 +1,130 @@
+/**
+ * Relocatable Objects
+ *
+ * With -c, pass 2 leaves every label reference in an address word as a
+ * relocation, and the sections are cut into atoms that the linker keeps
+ * or strips one by one. A section is cut at each label execution cannot
+ * fall into: one after a JMP, RET, HALT or data, and every label in
+ * .data. A cut is dropped when an expression measures across it or uses
+ * an offset from a label that lands past it, so stripping never changes
+ * a distance the code depends on.
+ */
+
+#include "assembler.h"
+#include <algorithm>
+#include <iostream>
+
+typedef std::map<long, uint32_t> AtomStarts; // Section offset -> atom
+
+/**
+ * The atom holding a section offset; an offset at the very end of the
+ * section belongs to the last atom
+ */
+static bool find_atom(const AtomStarts &starts, long offset, uint32_t &atom,
+                      long &start) {
+  AtomStarts::const_iterator it = starts.upper_bound(offset);
+  if (it == starts.begin())
+    return false;
+  --it;
+  atom = it->second;
+  start = it->first;
+  return true;
+}
+
+bool Assembler::build_object(ObjectFile &object) {
+  const std::vector<byte_t> *code[NUM_SECTIONS] = {&machine_code, &data_code};
+
+  // Cut each section at labels nothing falls into
+  std::set<long> cuts[NUM_SECTIONS];
+  for (std::map<std::string, int>::const_iterator it = label_sections.begin();
+       it != label_sections.end(); ++it) {
+    int section = it->second;
+    long offset = (long)symbol_table[it->first] - section_base[section];
+    if (offset > 0 && offset < (long)code[section]->size() &&
+        (section == SECTION_DATA || flow_ends[section].count(offset)))
+      cuts[section].insert(offset);
+  }
+
+  // Keep each label together with the offsets used from it
+  std::vector<AtomSpan> spans(atom_spans);
+  for (size_t i = 0; i < relocations.size(); i++) {
+    const ExprValue &target = relocations[i].target;
+    if (target.symbol.empty()) {
+      AtomSpan span = {target.section, std::min(target.anchor, target.value),
+                       std::max(target.anchor, target.value)};
+      spans.push_back(span);
+    }
+  }
+  for (size_t i = 0; i < spans.size(); i++) {
+    std::set<long> &section_cuts = cuts[spans[i].section];
+    section_cuts.erase(section_cuts.upper_bound(spans[i].low),
+                       section_cuts.upper_bound(spans[i].high));
+  }
+
+  AtomStarts starts[NUM_SECTIONS];
+  for (int section = 0; section < NUM_SECTIONS; section++) {
+    if (code[section]->empty())
+      continue;
+    cuts[section].insert(0);
+    for (std::set<long>::const_iterator it = cuts[section].begin();
+         it != cuts[section].end(); ++it) {
+      std::set<long>::const_iterator next = it;
+      ++next;
+      long end = next == cuts[section].end() ? (long)code[section]->size()
+                                             : *next;
+      starts[section][*it] = (uint32_t)object.atoms.size();
+      ObjectAtom atom;
+      atom.section = (uint8_t)section;
+      atom.bytes.assign(code[section]->begin() + *it,
+                        code[section]->begin() + end);
+      object.atoms.push_back(atom);
+    }
+  }
+
+  // Every label, with those starting "__" local to this object
+  for (std::map<std::string, int>::const_iterator it = label_sections.begin();
+       it != label_sections.end(); ++it) {
+    long offset = (long)symbol_table[it->first] - section_base[it->second];
+    ObjectSymbol symbol;
+    long start = 0;
+    if (!find_atom(starts[it->second], offset, symbol.atom, start))
+      continue; // In an empty section, so nothing can use it
+    symbol.name = it->first;
+    symbol.offset = (uint16_t)(offset - start);
+    symbol.global = it->first.compare(0, 2, "__") != 0;
+    object.symbols.push_back(symbol);
+  }
+
+  std::map<std::string, uint32_t> externals;
+  for (size_t i = 0; i < relocations.size(); i++) {
+    const Relocation &relocation = relocations[i];
+    const ExprValue &target = relocation.target;
+    ObjectRelocation r;
+    long start = 0;
+    find_atom(starts[relocation.section], relocation.site, r.atom, start);
+    r.offset = (uint16_t)(relocation.site - start);
+    r.external = !target.symbol.empty();
+    if (r.external) {
+      std::map<std::string, uint32_t>::iterator name =
+          externals.find(target.symbol);
+      if (name == externals.end()) {
+        name = externals.insert(std::make_pair(
+            target.symbol, (uint32_t)object.externals.size())).first;
+        object.externals.push_back(target.symbol);
+      }
+      r.target = name->second;
+      r.addend = (int32_t)target.value;
+    } else {
+      if (!find_atom(starts[target.section], target.anchor, r.target,
+                     start)) {
+        *diagnostics << "Error: An address refers to the empty "
+                     << (target.section == SECTION_DATA ? ".data" : ".text")
+                     << " section" << std::endl;
+        return false;
+      }
+      r.addend = (int32_t)(target.value - start);
+    }
+    object.relocations.push_back(r);
+  }
+  return true;
+}
@@ -0,0 +1,205 @@
+/**
+ * Relocatable Object Files
+ */
+
+#include "object_file.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const char OBJECT_MAGIC[4] = {'C', '1', '6', 'O'};
+static const uint32_t OBJECT_VERSION = 1;
+
+static void put_u8(std::string &out, uint32_t value) { out += (char)value; }
+
+static void put_u16(std::string &out, uint32_t value) {
+  put_u8(out, value & 0xFF);
+  put_u8(out, (value >> 8) & 0xFF);
+}
+
+static void put_u32(std::string &out, uint32_t value) {
+  put_u16(out, value & 0xFFFF);
+  put_u16(out, value >> 16);
+}
+
+static void put_string(std::string &out, const std::string &text) {
+  put_u16(out, (uint32_t)text.size());
+  out += text;
+}
+
+bool ObjectFile::write(const std::string &path) const {
+  std::string out(OBJECT_MAGIC, 4);
+  put_u32(out, OBJECT_VERSION);
+
+  put_u32(out, (uint32_t)atoms.size());
+  for (size_t i = 0; i < atoms.size(); i++) {
+    put_u8(out, atoms[i].section);
+    put_u32(out, (uint32_t)atoms[i].bytes.size());
+    out.append(atoms[i].bytes.begin(), atoms[i].bytes.end());
+  }
+  put_u32(out, (uint32_t)symbols.size());
+  for (size_t i = 0; i < symbols.size(); i++) {
+    put_string(out, symbols[i].name);
+    put_u32(out, symbols[i].atom);
+    put_u16(out, symbols[i].offset);
+    put_u8(out, symbols[i].global ? 1 : 0);
+  }
+  put_u32(out, (uint32_t)externals.size());
+  for (size_t i = 0; i < externals.size(); i++)
+    put_string(out, externals[i]);
+  put_u32(out, (uint32_t)relocations.size());
+  for (size_t i = 0; i < relocations.size(); i++) {
+    const ObjectRelocation &r = relocations[i];
+    put_u32(out, r.atom);
+    put_u16(out, r.offset);
+    put_u8(out, r.external ? 1 : 0);
+    put_u32(out, r.target);
+    put_u32(out, (uint32_t)r.addend);
+  }
+
+  std::ofstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not create object file '" << path << "'"
+              << std::endl;
+    return false;
+  }
+  file.write(out.data(), out.size());
+  return true;
+}
+
+/**
+ * Sequential reader; fails sticky on overrun
+ */
+class ObjectReader {
+private:
+  const std::string &data;
+  size_t position;
+
+public:
+  bool failed;
+
+  ObjectReader(const std::string &bytes, size_t start)
+      : data(bytes), position(start), failed(false) {}
+
+  uint32_t u8() {
+    if (position >= data.size()) {
+      failed = true;
+      return 0;
+    }
+    return (unsigned char)data[position++];
+  }
+  uint32_t u16() {
+    uint32_t low = u8();
+    return low | (u8() << 8);
+  }
+  uint32_t u32() {
+    uint32_t low = u16();
+    return low | (u16() << 16);
+  }
+  std::string bytes(size_t size) {
+    if (data.size() - position < size) {
+      failed = true;
+      return "";
+    }
+    position += size;
+    return data.substr(position - size, size);
+  }
+  std::string string() { return bytes(u16()); }
+};
+
+bool ObjectFile::read(const std::string &path) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open object file '" << path << "'"
+              << std::endl;
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  ObjectReader in(data, 4);
+  if (data.size() < 4 || std::memcmp(data.data(), OBJECT_MAGIC, 4) != 0 ||
+      in.u32() != OBJECT_VERSION) {
+    std::cerr << "Error: '" << path << "' is not an object file" << std::endl;
+    return false;
+  }
+
+  for (uint32_t n = in.u32(); n > 0 && !in.failed; n--) {
+    ObjectAtom atom;
+    atom.section = (uint8_t)in.u8();
+    std::string bytes = in.bytes(in.u32());
+    atom.bytes.assign(bytes.begin(), bytes.end());
+    atoms.push_back(atom);
+  }
+  for (uint32_t n = in.u32(); n > 0 && !in.failed; n--) {
+    ObjectSymbol symbol;
+    symbol.name = in.string();
+    symbol.atom = in.u32();
+    symbol.offset = (uint16_t)in.u16();
+    symbol.global = in.u8() != 0;
+    symbols.push_back(symbol);
+  }
+  for (uint32_t n = in.u32(); n > 0 && !in.failed; n--)
+    externals.push_back(in.string());
+  for (uint32_t n = in.u32(); n > 0 && !in.failed; n--) {
+    ObjectRelocation r;
+    r.atom = in.u32();
+    r.offset = (uint16_t)in.u16();
+    r.external = in.u8() != 0;
+    r.target = in.u32();
+    r.addend = (int32_t)in.u32();
+    relocations.push_back(r);
+  }
+
+  // Every index must point inside this object
+  bool valid = !in.failed;
+  for (size_t i = 0; valid && i < atoms.size(); i++)
+    valid = atoms[i].section < NUM_SECTIONS;
+  for (size_t i = 0; valid && i < symbols.size(); i++)
+    valid = symbols[i].atom < atoms.size();
+  for (size_t i = 0; valid && i < relocations.size(); i++) {
+    const ObjectRelocation &r = relocations[i];
+    valid = r.atom < atoms.size() &&
+            (size_t)r.offset + 2 <= atoms[r.atom].bytes.size() &&
+            r.target < (r.external ? externals.size() : atoms.size());
+  }
+  if (!valid) {
+    std::cerr << "Error: Object file '" << path << "' is damaged" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool write_perf_map(const std::string &path,
+                    const std::map<std::string, addr_t> &symbols,
+                    addr_t code_end) {
+  std::vector<std::pair<addr_t, std::string> > sorted;
+  for (std::map<std::string, addr_t>::const_iterator it = symbols.begin();
+       it != symbols.end(); ++it)
+    sorted.push_back(std::make_pair(it->second, it->first));
+  std::sort(sorted.begin(), sorted.end());
+
+  std::ofstream out(path.c_str());
+  if (!out.is_open()) {
+    std::cerr << "Error: Could not create symbol map '" << path << "'"
+              << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < sorted.size(); i++) {
+    addr_t end = code_end;
+    for (size_t j = i + 1; j < sorted.size(); j++) {
+      if (sorted[j].first > sorted[i].first) {
+        end = sorted[j].first;
+        break;
+      }
+    }
+    // The last code label stops at the end of the code, not at the data
+    if (sorted[i].first < code_end && end > code_end)
+      end = code_end;
+    out << std::hex << sorted[i].first << " "
+        << (end > sorted[i].first ? end - sorted[i].first : 0) << std::dec
+        << " " << sorted[i].second << "\n";
+  }
+  return true;
+}
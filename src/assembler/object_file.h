@@ -0,0 +1,67 @@
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include "../common/types.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Sections of an assembled program; the linker places all text first
+enum Section { SECTION_TEXT = 0, SECTION_DATA = 1, NUM_SECTIONS = 2 };
+
+/**
+ * The smallest unit the linker keeps or strips: a run of a section that
+ * execution can only enter through a label, so nothing falls into it
+ */
+struct ObjectAtom {
+  uint8_t section;
+  std::vector<byte_t> bytes;
+};
+
+struct ObjectSymbol {
+  std::string name;
+  uint32_t atom;
+  uint16_t offset; // Within the atom
+  bool global;     // Labels starting with "__" stay local to the object
+};
+
+/**
+ * An address word to fill in at link time: the address of a symbol this
+ * object references but does not define, or of a place in one of its own
+ * atoms, plus addend
+ */
+struct ObjectRelocation {
+  uint32_t atom;
+  uint16_t offset; // Of the word within the atom
+  bool external;
+  uint32_t target; // Index into externals, or an atom of this object
+  int32_t addend;
+};
+
+/**
+ * Relocatable object file written by "assembler -c" and read by the
+ * linker.
+ *
+ * Layout (little-endian): "C16O", u32 version, then u32-counted lists of
+ * atoms (u8 section, u32 size, bytes), symbols (u16-length name, u32
+ * atom, u16 offset, u8 global), externals (u16-length names) and
+ * relocations (u32 atom, u16 offset, u8 external, u32 target, i32 addend).
+ */
+struct ObjectFile {
+  std::vector<ObjectAtom> atoms;
+  std::vector<ObjectSymbol> symbols;
+  std::vector<std::string> externals;
+  std::vector<ObjectRelocation> relocations;
+
+  bool write(const std::string &path) const;
+  bool read(const std::string &path);
+};
+
+// Write "<address> <size> <name>" lines (perf map format), sorted by
+// address; a symbol's size runs to the next higher one, stopping at
+// code_end for symbols in the code
+bool write_perf_map(const std::string &path,
+                    const std::map<std::string, addr_t> &symbols,
+                    addr_t code_end);
+
+#endif // OBJECT_FILE_H
@@ -0,0 +1,180 @@
+/**
+ * Assembler Optimization Passes
+ *
+ * These passes rewrite the parsed source lines before pass 1 assigns
+ * addresses, so every label still resolves correctly afterwards.
+ *
+ *   - Leaf inlining: a CALL to a small straight-line subroutine that
+ *     ends in RET is replaced by a copy of the subroutine body, saving
+ *     the CALL push, the two-word jump and the RET pop.
+ *   - Tail-call conversion: "CALL X" immediately followed by "RET"
+ *     becomes "JMP X", so X returns straight to our caller.
+ *
+ * The original subroutines are left in place, so jumps or data
+ * references to their labels keep working.
+ */
+
+#include "assembler.h"
+#include <iostream>
+
+// Upper bound on inlining rounds (inlining can turn callers into leaves)
+static const int MAX_INLINE_ROUNDS = 4;
+
+bool Assembler::optimize() {
+  int inlined = 0;
+  for (int round = 0; round < MAX_INLINE_ROUNDS; round++) {
+    int count = inline_leaf_calls();
+    if (count == 0)
+      break;
+    inlined += count;
+  }
+  int tail_calls = convert_tail_calls();
+
+  *log << "Optimizer: inlined " << inlined << " call sites, converted "
+       << tail_calls << " tail calls" << std::endl;
+  return true;
+}
+
+/**
+ * Inline calls to small leaf subroutines
+ *
+ * A leaf qualifies when the code from its label up to the first RET:
+ *   - contains no other label (nothing else can jump into it)
+ *   - contains no CALL, JMP or conditional branch
+ *   - keeps PUSH/POP balanced and never pops below its entry depth
+ *     (it never touches its own return address)
+ *   - encodes to at most inline_budget bytes, excluding the RET
+ *
+ * Returns the number of call sites that were inlined.
+ */
+int Assembler::inline_leaf_calls() {
+  // Collect the body of every qualifying leaf, keyed by label
+  std::map<std::string, std::vector<AssemblyLine> > leaves;
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (lines[i].label.empty())
+      continue;
+
+    std::vector<AssemblyLine> body;
+    int size = 0;
+    int depth = 0;
+    bool is_leaf = false;
+
+    for (size_t j = i; j < lines.size(); j++) {
+      const AssemblyLine &line = lines[j];
+      if (j > i && !line.label.empty())
+        break; // Another entry point inside the body
+      if (line.opcode.empty())
+        continue;
+
+      int opcode = get_opcode(line.opcode);
+      if (opcode < 0)
+        break; // Reported later by pass 1
+      if (opcode == OP_RET) {
+        is_leaf = (depth == 0);
+        break;
+      }
+      if (opcode == OP_CALL || opcode == OP_JMP || opcode == OP_JZ ||
+          opcode == OP_JNZ || opcode == OP_JC || opcode == OP_JNC ||
+          opcode == OP_JN) {
+        break;
+      }
+      if (opcode == OP_PUSH) {
+        depth++;
+      } else if (opcode == OP_POP && --depth < 0) {
+        break;
+      }
+
+      size += instruction_size(line, opcode);
+      if (size > inline_budget)
+        break;
+
+      AssemblyLine copy = line;
+      copy.label.clear();
+      copy.comment = "inlined from " + lines[i].label;
+      body.push_back(copy);
+    }
+
+    if (is_leaf) {
+      leaves[lines[i].label] = body;
+    }
+  }
+
+  if (leaves.empty())
+    return 0;
+
+  // Replace each qualifying CALL with the leaf body
+  std::vector<AssemblyLine> result;
+  int inlined = 0;
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    const AssemblyLine &line = lines[i];
+    std::map<std::string, std::vector<AssemblyLine> >::const_iterator leaf =
+        leaves.end();
+    if (!line.opcode.empty() && get_opcode(line.opcode) == OP_CALL &&
+        line.operands.size() == 1) {
+      leaf = leaves.find(line.operands[0]);
+    }
+
+    if (leaf == leaves.end()) {
+      result.push_back(line);
+      continue;
+    }
+
+    // Keep the call site's label on the first inlined instruction
+    const std::vector<AssemblyLine> &body = leaf->second;
+    if (body.empty()) {
+      if (!line.label.empty()) {
+        AssemblyLine label_only;
+        label_only.line_number = line.line_number;
+        label_only.label = line.label;
+        result.push_back(label_only);
+      }
+    } else {
+      for (size_t j = 0; j < body.size(); j++) {
+        result.push_back(body[j]);
+        if (j == 0)
+          result.back().label = line.label;
+      }
+    }
+    inlined++;
+  }
+
+  lines.swap(result);
+  return inlined;
+}
+
+/**
+ * Convert "CALL X; RET" into "JMP X"
+ *
+ * The RET is dropped when nothing can reach it (it has no label);
+ * a labeled RET is kept for the other paths that jump to it.
+ *
+ * Returns the number of calls that were converted.
+ */
+int Assembler::convert_tail_calls() {
+  std::vector<AssemblyLine> result;
+  int converted = 0;
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    result.push_back(lines[i]);
+
+    if (i + 1 >= lines.size() || lines[i].opcode.empty() ||
+        lines[i + 1].opcode.empty())
+      continue;
+    if (get_opcode(lines[i].opcode) != OP_CALL ||
+        get_opcode(lines[i + 1].opcode) != OP_RET)
+      continue;
+
+    result.back().opcode = "JMP";
+    result.back().encoded.clear();
+    converted++;
+
+    if (lines[i + 1].label.empty()) {
+      i++; // Skip the unreachable RET
+    }
+  }
+
+  lines.swap(result);
+  return converted;
+}
@@ -0,0 +1,359 @@
+/**
+ * Assembler Preprocessor
+ *
+ * Runs before the optimizer and pass 1, flattening the lexed source into
+ * the lines the passes work on:
+ *
+ *   .equ NAME, value       Named constant, usable wherever an immediate
+ *                          or an address is
+ *   .macro NAME [p, ...]   The lines up to .endm are recorded; a later
+ *   .endm                  "NAME a, ..." expands them with each parameter
+ *                          replaced by its argument and \@ by a number
+ *                          unique to the expansion
+ *   .include "file"        The file's lines, looked up beside the
+ *                          including file and then in the -I directories.
+ *                          A file with the same contents is included once,
+ *                          and the file being assembled counts as included.
+ *
+ * Included files come from the module cache, so a runtime shared by many
+ * programs is lexed and pre-encoded once per cache.
+ */
+
+#include "assembler.h"
+#include "module_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+// Limit on nested includes and macro expansions, to stop recursion
+static const int MAX_PREPROCESS_DEPTH = 16;
+
+static std::string upper_case(const std::string &text) {
+  std::string upper = text;
+  std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+  return upper;
+}
+
+static bool is_word_char(char c) {
+  return std::isalnum((unsigned char)c) || c == '_';
+}
+
+static bool is_identifier(const std::string &text) {
+  if (text.empty() || std::isdigit((unsigned char)text[0]))
+    return false;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (!is_word_char(text[i]))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Replace whole-word parameter names and \@ in a label or operand.
+ * Quoted characters are copied as they are.
+ */
+static std::string substitute(const std::string &text, const Macro &macro,
+                              const std::vector<std::string> &arguments,
+                              int expansion) {
+  std::string result;
+  size_t i = 0;
+  while (i < text.size()) {
+    if (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '@') {
+      result += std::to_string(expansion);
+      i += 2;
+    } else if (text[i] == '\'') {
+      size_t close = text.find('\'', i + 1);
+      size_t end = close == std::string::npos ? text.size() : close + 1;
+      result += text.substr(i, end - i);
+      i = end;
+    } else if (is_word_char(text[i])) {
+      size_t end = i;
+      while (end < text.size() && is_word_char(text[end]))
+        end++;
+      std::string word = text.substr(i, end - i);
+      std::vector<std::string>::const_iterator parameter =
+          std::find(macro.parameters.begin(), macro.parameters.end(), word);
+      result += parameter == macro.parameters.end()
+                    ? word
+                    : arguments[parameter - macro.parameters.begin()];
+      i = end;
+    } else {
+      result += text[i++];
+    }
+  }
+  return result;
+}
+
+bool Assembler::read_source(const std::string &path, std::string &text) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+  text.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  return true;
+}
+
+void Assembler::lex_source(const std::string &text,
+                           std::vector<AssemblyLine> &lexed) {
+  std::istringstream in(text);
+  std::string line;
+  int line_number = 1;
+  while (std::getline(in, line)) {
+    AssemblyLine parsed = parse_line(line, line_number);
+    if (!parsed.label.empty() || !parsed.opcode.empty()) {
+      lexed.push_back(parsed);
+    }
+    line_number++;
+  }
+}
+
+bool Assembler::preprocess(const std::vector<AssemblyLine> &source,
+                           int depth) {
+  for (size_t i = 0; i < source.size(); i++) {
+    const AssemblyLine &line = source[i];
+    error_file = line.file;
+    std::string directive = upper_case(line.opcode);
+    std::map<std::string, Macro>::const_iterator macro =
+        macros.find(line.opcode);
+
+    // A label on a directive or macro call marks the next real line
+    bool is_directive = !directive.empty() && directive[0] == '.';
+    if (!line.label.empty() && (is_directive || macro != macros.end())) {
+      AssemblyLine label_only;
+      label_only.line_number = line.line_number;
+      label_only.label = line.label;
+      label_only.file = line.file;
+      lines.push_back(label_only);
+    }
+
+    if (directive == ".EQU") {
+      long value;
+      if (line.operands.size() != 2 || !is_identifier(line.operands[0])) {
+        report_error(line.line_number, ".equ requires a name and a value");
+        return false;
+      }
+      if (constants.count(line.operands[0])) {
+        report_error(line.line_number,
+                     "Duplicate constant '" + line.operands[0] + "'");
+        return false;
+      }
+      if (!evaluate(line.operands[1], value)) {
+        report_error(line.line_number,
+                     "Invalid value for '" + line.operands[0] + "'");
+        return false;
+      }
+      constants[line.operands[0]] = value;
+    } else if (directive == ".MACRO") {
+      if (!define_macro(source, i))
+        return false;
+    } else if (directive == ".ENDM") {
+      report_error(line.line_number, ".endm without .macro");
+      return false;
+    } else if (directive == ".INCLUDE") {
+      if (!include_module(line, depth))
+        return false;
+    } else if (macro != macros.end()) {
+      if (!expand_macro(macro->second, line, depth))
+        return false;
+    } else {
+      lines.push_back(line);
+      if (is_directive)
+        lines.back().label.clear(); // Already placed above
+    }
+  }
+  return true;
+}
+
+/**
+ * Record the macro starting at source[index] and leave index on its .endm
+ */
+bool Assembler::define_macro(const std::vector<AssemblyLine> &source,
+                             size_t &index) {
+  const AssemblyLine &header = source[index];
+  if (header.operands.empty()) {
+    report_error(header.line_number, ".macro requires a name");
+    return false;
+  }
+
+  // The lexer splits on commas only, so the first operand is "NAME p1"
+  std::string first = header.operands[0];
+  size_t space = first.find_first_of(" \t");
+  std::string name = first.substr(0, space);
+  Macro macro;
+  if (space != std::string::npos)
+    macro.parameters.push_back(trim(first.substr(space)));
+  for (size_t i = 1; i < header.operands.size(); i++)
+    macro.parameters.push_back(header.operands[i]);
+
+  if (!is_identifier(name) || get_opcode(name) >= 0) {
+    report_error(header.line_number, "Invalid macro name '" + name + "'");
+    return false;
+  }
+  if (macros.count(name)) {
+    report_error(header.line_number, "Duplicate macro '" + name + "'");
+    return false;
+  }
+  for (size_t i = 0; i < macro.parameters.size(); i++) {
+    if (!is_identifier(macro.parameters[i])) {
+      report_error(header.line_number, "Invalid macro parameter '" +
+                                           macro.parameters[i] + "'");
+      return false;
+    }
+  }
+
+  for (size_t i = index + 1; i < source.size(); i++) {
+    std::string directive = upper_case(source[i].opcode);
+    if (directive == ".ENDM") {
+      if (!source[i].label.empty()) {
+        AssemblyLine label_only = source[i];
+        label_only.opcode.clear();
+        label_only.operands.clear();
+        macro.body.push_back(label_only);
+      }
+      macros[name] = macro;
+      index = i;
+      return true;
+    }
+    if (directive == ".MACRO") {
+      report_error(source[i].line_number, "Nested .macro definition");
+      return false;
+    }
+    macro.body.push_back(source[i]);
+  }
+  report_error(header.line_number, "Macro '" + name + "' has no .endm");
+  return false;
+}
+
+/**
+ * Expanded lines are reported at the call's line
+ */
+bool Assembler::expand_macro(const Macro &macro, const AssemblyLine &call,
+                             int depth) {
+  if (call.operands.size() != macro.parameters.size()) {
+    report_error(call.line_number,
+                 "Macro '" + call.opcode + "' expects " +
+                     std::to_string(macro.parameters.size()) + " arguments");
+    return false;
+  }
+  if (depth >= MAX_PREPROCESS_DEPTH) {
+    report_error(call.line_number, "Macros or includes nested too deeply");
+    return false;
+  }
+
+  int expansion = ++expansion_count;
+  std::vector<AssemblyLine> body;
+  for (size_t i = 0; i < macro.body.size(); i++) {
+    AssemblyLine line = macro.body[i];
+    line.line_number = call.line_number;
+    line.file = call.file;
+    line.label = substitute(line.label, macro, call.operands, expansion);
+    for (size_t j = 0; j < line.operands.size(); j++)
+      line.operands[j] =
+          substitute(line.operands[j], macro, call.operands, expansion);
+    line.encoded.clear();
+    body.push_back(line);
+  }
+  return preprocess(body, depth + 1);
+}
+
+bool Assembler::include_module(const AssemblyLine &line, int depth) {
+  if (line.operands.size() != 1) {
+    report_error(line.line_number, ".include requires a file name");
+    return false;
+  }
+  if (depth >= MAX_PREPROCESS_DEPTH) {
+    report_error(line.line_number, "Macros or includes nested too deeply");
+    return false;
+  }
+  std::string name = line.operands[0];
+  if (name.size() >= 2 && name[0] == '"' && name[name.size() - 1] == '"')
+    name = name.substr(1, name.size() - 2);
+  if (name.empty()) {
+    report_error(line.line_number, ".include requires a file name");
+    return false;
+  }
+
+  // Beside the including file first, then each include directory
+  std::vector<std::string> candidates;
+  const std::string &including = line.file.empty() ? source_path : line.file;
+  size_t slash = including.find_last_of('/');
+  if (name[0] == '/' || slash == std::string::npos)
+    candidates.push_back(name);
+  else
+    candidates.push_back(including.substr(0, slash + 1) + name);
+  for (size_t i = 0; i < include_dirs.size() && name[0] != '/'; i++)
+    candidates.push_back(include_dirs[i] + "/" + name);
+
+  std::string path;
+  std::string text;
+  for (size_t i = 0; i < candidates.size() && path.empty(); i++) {
+    if (read_source(candidates[i], text))
+      path = candidates[i];
+  }
+  if (path.empty()) {
+    report_error(line.line_number, "Could not find include file '" + name +
+                                       "'");
+    return false;
+  }
+
+  uint64_t key = ModuleCache::hash(text);
+  if (!included.insert(key).second)
+    return true;
+  const std::vector<AssemblyLine> *module = cache->find(key);
+  modules_included++;
+  if (module) {
+    modules_cached++;
+  } else {
+    std::vector<AssemblyLine> lexed;
+    lex_source(text, lexed);
+    pre_encode(lexed);
+    module = &cache->store(key, lexed);
+  }
+
+  std::vector<AssemblyLine> tagged(*module);
+  for (size_t i = 0; i < tagged.size(); i++)
+    tagged[i].file = path;
+  return preprocess(tagged, depth + 1);
+}
+
+/**
+ * Encode every instruction of a freshly lexed module that needs no
+ * symbol, constant or macro argument. The trial runs with names hidden
+ * and errors silenced; any line it cannot finish is encoded in pass 2 as
+ * usual.
+ */
+void Assembler::pre_encode(std::vector<AssemblyLine> &module) {
+  std::vector<byte_t> saved_code;
+  machine_code.swap(saved_code);
+  addr_t saved_address = current_address;
+  int saved_errors = error_count;
+  symbols_hidden = true;
+
+  bool in_macro = false;
+  for (size_t i = 0; i < module.size(); i++) {
+    AssemblyLine &line = module[i];
+    std::string directive = upper_case(line.opcode);
+    if (directive == ".MACRO")
+      in_macro = true;
+    else if (directive == ".ENDM")
+      in_macro = false;
+    if (in_macro || line.opcode.empty() || get_opcode(line.opcode) < 0)
+      continue;
+
+    machine_code.clear();
+    int errors = error_count;
+    if (encode_instruction(line) && error_count == errors) {
+      for (size_t b = 0; b + 1 < machine_code.size(); b += 2)
+        line.encoded.push_back(
+            (word_t)(machine_code[b] | (machine_code[b + 1] << 8)));
+    }
+  }
+
+  symbols_hidden = false;
+  machine_code.swap(saved_code);
+  current_address = saved_address;
+  error_count = saved_errors;
+}
@@ -0,0 +1,443 @@
+/**
+ * Static Code Report
+ *
+ * With --report, a successful assembly also writes a JSON summary for
+ * tracking code size:
+ *
+ *   - each function (CALL targets and the entry code) with its address,
+ *     size and instruction count
+ *   - instruction counts by class, and how many take two words
+ *   - "shorter_encodings": sequences with a smaller equivalent, such as a
+ *     MOVI into a scratch register whose value would fit the ALU op's
+ *     4-bit immediate, a JMP to the next instruction, or a conditional
+ *     branch around a JMP that an inverted branch could replace
+ *   - "immediate_overflows": constants too wide for a 4-bit or 7-bit
+ *     field, with the instructions they cost: MOVI/SHLI/ORI chains, MOVIs
+ *     standing in for an immediate operand, and 4-bit immediates the
+ *     encoder truncates
+ *
+ * The checks look at neighbouring lines only, so a finding is a candidate
+ * for review rather than a proven saving.
+ */
+
+#include "assembler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+struct FunctionStats {
+  std::string name;
+  addr_t address;
+  int bytes;
+  int instructions;
+};
+
+struct Finding {
+  const AssemblyLine *line;
+  addr_t address;
+  std::string kind;
+  std::string detail;
+  int cost;  // Bytes saved, or extra instructions
+  long value; // Immediate overflows only
+  int field_bits;
+};
+
+enum InstructionClass {
+  CLASS_ALU,
+  CLASS_MOVE,
+  CLASS_MEMORY,
+  CLASS_BRANCH,
+  CLASS_STACK,
+  CLASS_OTHER,
+  NUM_CLASSES
+};
+
+static const char *CLASS_NAMES[NUM_CLASSES] = {"alu",    "move",  "memory",
+                                               "branch", "stack", "other"};
+
+// NOP shares its opcode with MOV, so it is told apart by name
+static InstructionClass instruction_class(const std::string &mnemonic,
+                                          int opcode) {
+  if (mnemonic == "NOP")
+    return CLASS_OTHER;
+  switch (opcode) {
+  case OP_MOV:
+  case OP_MOVI:
+    return CLASS_MOVE;
+  case OP_LOAD_IND:
+  case OP_LOAD_DIR:
+  case OP_STORE_IND:
+  case OP_STORE_DIR:
+    return CLASS_MEMORY;
+  case OP_JMP:
+  case OP_JZ:
+  case OP_JNZ:
+  case OP_JC:
+  case OP_JNC:
+  case OP_JN:
+  case OP_CALL:
+  case OP_RET:
+    return CLASS_BRANCH;
+  case OP_PUSH:
+  case OP_POP:
+    return CLASS_STACK;
+  case OP_HALT:
+    return CLASS_OTHER;
+  default:
+    return CLASS_ALU;
+  }
+}
+
+static int register_operand(const std::string &text) {
+  std::string reg;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] != '[' && text[i] != ']' && text[i] != ' ')
+      reg += text[i];
+  }
+  if (reg.size() == 2 && (reg[0] == 'R' || reg[0] == 'r') && reg[1] >= '0' &&
+      reg[1] < '0' + NUM_REGISTERS)
+    return reg[1] - '0';
+  return -1;
+}
+
+static int register_bit(const AssemblyLine &line, size_t operand) {
+  if (operand >= line.operands.size())
+    return 0;
+  int reg = register_operand(line.operands[operand]);
+  return reg < 0 ? 0 : 1 << reg;
+}
+
+/**
+ * Registers an instruction reads and writes, as bit masks; false for
+ * control flow, past which nothing is known
+ */
+static bool register_use(const AssemblyLine &line, int opcode, int &reads,
+                         int &writes) {
+  reads = writes = 0;
+  switch (opcode) {
+  case OP_JMP:
+  case OP_JZ:
+  case OP_JNZ:
+  case OP_JC:
+  case OP_JNC:
+  case OP_JN:
+  case OP_CALL:
+  case OP_RET:
+  case OP_HALT:
+    return false;
+  case OP_STORE_IND:
+  case OP_CMP:
+  case OP_CMPI:
+  case OP_PUSH:
+    reads = register_bit(line, 0) | register_bit(line, 1);
+    return true;
+  case OP_INC:
+  case OP_DEC:
+    reads = writes = register_bit(line, 0);
+    return true;
+  default:
+    writes = register_bit(line, 0);
+    reads = register_bit(line, 1) | register_bit(line, 2);
+    return true;
+  }
+}
+
+static std::string json_string(const std::string &text) {
+  std::string out = "\"";
+  for (size_t i = 0; i < text.size(); i++) {
+    unsigned char c = (unsigned char)text[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += (char)c;
+    } else if (c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += (char)c;
+    }
+  }
+  return out + "\"";
+}
+
+static std::string upper_case(const std::string &text) {
+  std::string upper = text;
+  std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+  return upper;
+}
+
+/**
+ * Whether reg is overwritten before anything reads it, looking forward
+ * from lines[from] to the end of the basic block
+ */
+bool Assembler::register_dead(size_t from, int reg) {
+  for (size_t i = from; i < lines.size(); i++) {
+    const AssemblyLine &line = lines[i];
+    if (!line.label.empty())
+      return false;
+    if (line.opcode.empty())
+      continue;
+    int reads, writes;
+    int opcode = get_opcode(line.opcode);
+    if (opcode < 0 || !register_use(line, opcode, reads, writes) ||
+        (reads & (1 << reg)))
+      return false;
+    if (writes & (1 << reg))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Next line with an instruction or directive, or lines.size() if a label
+ * comes first
+ */
+static size_t next_code_line(const std::vector<AssemblyLine> &lines,
+                             size_t from) {
+  for (size_t i = from; i < lines.size(); i++) {
+    if (!lines[i].label.empty())
+      return lines.size();
+    if (!lines[i].opcode.empty())
+      return i;
+  }
+  return lines.size();
+}
+
+void Assembler::find_encoding_candidates(std::vector<Finding> &shorter,
+                                         std::vector<Finding> &overflows) {
+  for (size_t i = 0; i < lines.size(); i++) {
+    const AssemblyLine &line = lines[i];
+    const LinePlacement &place = placements[i];
+    if (place.section != SECTION_TEXT || line.opcode.empty())
+      continue;
+    int opcode = get_opcode(line.opcode);
+    std::string name = upper_case(line.opcode);
+    size_t next = next_code_line(lines, i + 1);
+    const AssemblyLine *after = next < lines.size() ? &lines[next] : NULL;
+    std::string after_name = after ? upper_case(after->opcode) : "";
+    long value;
+
+    // A constant built by MOVI followed by SHLI/ORI into the same register
+    if (opcode == OP_MOVI && line.operands.size() == 2 &&
+        evaluate(line.operands[1], value)) {
+      int reg = register_operand(line.operands[0]);
+      long built = value;
+      int steps = 0;
+      size_t j = next;
+      while (j < lines.size() && lines[j].operands.size() == 3 &&
+             register_operand(lines[j].operands[0]) == reg &&
+             register_operand(lines[j].operands[1]) == reg) {
+        std::string step = upper_case(lines[j].opcode);
+        long amount;
+        if ((step != "SHLI" && step != "ORI") ||
+            !evaluate(lines[j].operands[2], amount))
+          break;
+        built = step == "SHLI" ? built << (amount & 0x0F)
+                               : built | (amount & 0x0F);
+        steps++;
+        j = next_code_line(lines, j + 1);
+      }
+      if (steps > 0) {
+        Finding finding = {&line, place.address, "constant_chain",
+                           "MOVI with " + std::to_string(steps) +
+                               " SHLI/ORI builds " +
+                               std::to_string((int16_t)built),
+                           steps, (long)(int16_t)built, 7};
+        overflows.push_back(finding);
+        continue;
+      }
+    }
+
+    // MOVI into a scratch register that only feeds an ALU op's operand
+    if (opcode == OP_MOVI && line.operands.size() == 2 && after &&
+        evaluate(line.operands[1], value)) {
+      static const char *const FORMS[][2] = {
+          {"ADD", "ADDI"}, {"SUB", "SUBI"}, {"AND", "ANDI"},
+          {"OR", "ORI"},   {"SHL", "SHLI"}, {"SHR", "SHRI"},
+          {"CMP", "CMPI"}};
+      int reg = register_operand(line.operands[0]);
+      bool is_cmp = after_name == "CMP";
+      size_t source = is_cmp ? 1 : 2; // Operand that can become immediate
+      const char *form = NULL;
+      for (size_t f = 0; f < sizeof(FORMS) / sizeof(FORMS[0]); f++) {
+        if (after_name == FORMS[f][0])
+          form = FORMS[f][1];
+      }
+      if (form && after->operands.size() == source + 1 &&
+          register_operand(after->operands[source]) == reg &&
+          register_operand(after->operands[source - 1]) != reg &&
+          ((!is_cmp && register_operand(after->operands[0]) == reg) ||
+           register_dead(next + 1, reg))) {
+        bool is_signed = after_name == "ADD" || after_name == "SUB" || is_cmp;
+        bool fits = is_signed ? value >= -8 && value <= 7
+                              : value >= 0 && value <= 15;
+        std::string pair =
+            "MOVI " + line.operands[1] + " + " + after_name + " ";
+        if (fits) {
+          Finding finding = {&line, place.address, "register_immediate",
+                             pair + "could be " + form, 2, 0, 0};
+          shorter.push_back(finding);
+        } else {
+          Finding finding = {&line, place.address, "register_operand",
+                             pair + "because the value does not fit " + form,
+                             1, value, 4};
+          overflows.push_back(finding);
+        }
+        continue;
+      }
+    }
+
+    // 4-bit immediates that the encoder truncates
+    if ((name == "ADDI" || name == "SUBI" || name == "CMPI" ||
+         name == "ANDI" || name == "ORI" || name == "SHLI" ||
+         name == "SHRI") &&
+        !line.operands.empty() && evaluate(line.operands.back(), value)) {
+      bool is_signed = name == "ADDI" || name == "SUBI" || name == "CMPI";
+      if (is_signed ? value < -8 || value > 7 : value < 0 || value > 15) {
+        Finding finding = {&line, place.address, "truncated",
+                           name + " keeps only the low 4 bits of " +
+                               std::to_string(value),
+                           0, value, 4};
+        overflows.push_back(finding);
+      }
+      continue;
+    }
+
+    // JMP to the next instruction
+    if (opcode == OP_JMP && line.operands.size() == 1 &&
+        evaluate(line.operands[0], value) && value == place.address + 4) {
+      Finding finding = {&line, place.address, "jump_to_next",
+                         "JMP to the next instruction", 4, 0, 0};
+      shorter.push_back(finding);
+      continue;
+    }
+
+    // Jcc over a JMP: the inverted branch alone does the same
+    static const char *const INVERSES[][2] = {
+        {"JZ", "JNZ"}, {"JNZ", "JZ"}, {"JC", "JNC"}, {"JNC", "JC"}};
+    for (size_t k = 0; k < sizeof(INVERSES) / sizeof(INVERSES[0]); k++) {
+      if (name == INVERSES[k][0] && after_name == "JMP" &&
+          line.operands.size() == 1 &&
+          evaluate(line.operands[0], value) &&
+          value == place.address + 8) {
+        Finding finding = {&line, place.address, "branch_over_jump",
+                           name + " over JMP could be " + INVERSES[k][1], 4,
+                           0, 0};
+        shorter.push_back(finding);
+      }
+    }
+  }
+}
+
+static void write_findings(std::ostream &out, const char *name,
+                           const std::vector<Finding> &findings,
+                           const char *cost_name, const std::string &source,
+                           bool overflow) {
+  out << "  " << json_string(name) << ": [";
+  for (size_t i = 0; i < findings.size(); i++) {
+    const Finding &f = findings[i];
+    out << (i ? ",\n" : "\n") << "    {\"file\": "
+        << json_string(f.line->file.empty() ? source : f.line->file)
+        << ", \"line\": " << f.line->line_number
+        << ", \"address\": " << f.address
+        << ", \"kind\": " << json_string(f.kind);
+    if (overflow)
+      out << ", \"value\": " << f.value
+          << ", \"field_bits\": " << f.field_bits;
+    out << ", \"" << cost_name << "\": " << f.cost
+        << ", \"detail\": " << json_string(f.detail) << "}";
+  }
+  out << (findings.empty() ? "]" : "\n  ]");
+}
+
+bool Assembler::write_report(const std::string &path) {
+  std::set<std::string> callees;
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (!lines[i].opcode.empty() && get_opcode(lines[i].opcode) == OP_CALL &&
+        lines[i].operands.size() == 1 &&
+        symbol_table.count(lines[i].operands[0]))
+      callees.insert(lines[i].operands[0]);
+  }
+
+  std::vector<FunctionStats> functions;
+  int classes[NUM_CLASSES] = {0};
+  int section_bytes[NUM_SECTIONS] = {0};
+  int instructions = 0;
+  int two_word = 0;
+  for (size_t i = 0; i < lines.size(); i++) {
+    const AssemblyLine &line = lines[i];
+    const LinePlacement &place = placements[i];
+    section_bytes[place.section] += place.size;
+    if (place.section != SECTION_TEXT)
+      continue;
+    if (!line.label.empty() &&
+        (functions.empty() || callees.count(line.label))) {
+      FunctionStats function = {line.label, place.address, 0, 0};
+      functions.push_back(function);
+    }
+    if (line.opcode.empty())
+      continue;
+    if (functions.empty()) {
+      FunctionStats entry = {"(entry)", place.address, 0, 0};
+      functions.push_back(entry);
+    }
+    functions.back().bytes += place.size;
+    if (line.opcode[0] == '.')
+      continue;
+    int opcode = get_opcode(line.opcode);
+    functions.back().instructions++;
+    instructions++;
+    classes[instruction_class(upper_case(line.opcode), opcode)]++;
+    if (place.size == 4)
+      two_word++;
+  }
+
+  std::vector<Finding> shorter;
+  std::vector<Finding> overflows;
+  find_encoding_candidates(shorter, overflows);
+  int saved_bytes = 0;
+  for (size_t i = 0; i < shorter.size(); i++)
+    saved_bytes += shorter[i].cost;
+  int extra_instructions = 0;
+  for (size_t i = 0; i < overflows.size(); i++)
+    extra_instructions += overflows[i].cost;
+
+  std::ofstream file;
+  if (path != "-") {
+    file.open(path.c_str());
+    if (!file.is_open()) {
+      *diagnostics << "Error: Could not create report '" << path << "'"
+                   << std::endl;
+      return false;
+    }
+  }
+  std::ostream &out = path == "-" ? std::cout : file;
+
+  out << "{\n  \"source\": " << json_string(source_path) << ",\n"
+      << "  \"code_bytes\": " << section_bytes[SECTION_TEXT] << ",\n"
+      << "  \"data_bytes\": " << section_bytes[SECTION_DATA] << ",\n"
+      << "  \"instructions\": " << instructions << ",\n"
+      << "  \"two_word_instructions\": " << two_word << ",\n"
+      << "  \"classes\": {";
+  for (int c = 0; c < NUM_CLASSES; c++)
+    out << (c ? ", " : "") << json_string(CLASS_NAMES[c]) << ": "
+        << classes[c];
+  out << "},\n  \"functions\": [";
+  for (size_t i = 0; i < functions.size(); i++) {
+    out << (i ? ",\n" : "\n") << "    {\"name\": "
+        << json_string(functions[i].name)
+        << ", \"address\": " << functions[i].address
+        << ", \"bytes\": " << functions[i].bytes
+        << ", \"instructions\": " << functions[i].instructions << "}";
+  }
+  out << (functions.empty() ? "],\n" : "\n  ],\n");
+  write_findings(out, "shorter_encodings", shorter, "saves_bytes",
+                 source_path, false);
+  out << ",\n  \"shorter_encoding_bytes\": " << saved_bytes << ",\n";
+  write_findings(out, "immediate_overflows", overflows,
+                 "extra_instructions", source_path, true);
+  out << ",\n  \"overflow_extra_instructions\": " << extra_instructions
+      << "\n}\n";
+  return true;
+}
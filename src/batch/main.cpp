@@ -0,0 +1,578 @@
+/**
+ * Sharded Batch Runner
+ *
+ * Runs every binary in a job manifest to completion on the emulator. The
+ * coordinator forks worker processes, one per NUMA node by default, and
+ * each runs one worker thread per CPU of its node, pinned to that CPU.
+ * Every worker thread owns a contiguous shard of the manifest and keeps
+ * its VM memory on its own node; when its shard runs dry it steals from
+ * workers on the same node before going remote. Results go straight into
+ * a shared-memory table (shm_open); when a process dies, the jobs its
+ * threads held are handed out again up to a retry limit and the process
+ * is replaced.
+ *
+ * With --cores, every job stopped by its instruction limit leaves a
+ * compressed core file (core_dump.h) for inspection with emulator --core.
+ *
+ * Manifest format, one job per line ('#' starts a comment):
+ *   <binary> [max_instructions]
+ */
+
+#include "../emulator/core_dump.h"
+#include "../emulator/cpu.h"
+#include "../emulator/memory.h"
+#include "numa.h"
+#include "result_table.h"
+#include "telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+const uint64_t DEFAULT_INSTRUCTION_LIMIT = 100000000;
+// Instructions between updates of a worker's live counter
+const uint64_t PROGRESS_CHUNK = 1000000;
+
+struct Job {
+  std::string binary;
+  uint64_t max_instructions;
+};
+
+// A worker process and the worker threads (table slots) it runs
+struct ProcessPlan {
+  int node;         // Index into the detected nodes
+  int first_worker; // Table slot of its first thread
+  int num_threads;
+  pid_t pid;
+};
+
+struct BatchOptions {
+  int processes_per_node;
+  int threads_per_process; // 0 = the node's CPUs split over its processes
+  uint32_t max_retries;
+  uint64_t instruction_limit;
+  bool quiet;
+  int inject_crash; // Job whose first attempt kills its worker, or -1
+  std::string telemetry_path; // Empty when telemetry is off
+  double telemetry_interval;  // Seconds between snapshots
+  std::string core_dir;       // Empty unless cores are kept
+};
+
+static bool read_manifest(const std::string &path, uint64_t default_limit,
+                          std::vector<Job> &jobs) {
+  std::ifstream file(path.c_str());
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
+    return false;
+  }
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)
+      line = line.substr(0, comment);
+    std::istringstream fields(line);
+    Job job;
+    if (!(fields >> job.binary))
+      continue;
+    job.max_instructions = default_limit;
+    std::string limit;
+    if (fields >> limit) {
+      char *end = NULL;
+      job.max_instructions = std::strtoull(limit.c_str(), &end, 0);
+      if (*end != '\0' || job.max_instructions == 0) {
+        std::cerr << "Error on line " << line_number
+                  << ": Invalid instruction limit" << std::endl;
+        return false;
+      }
+    }
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+static uint32_t fnv1a(const std::string &data) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < data.size(); i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static bool read_binary(const std::string &path, std::vector<byte_t> &image) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+  image.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return true;
+}
+
+/**
+ * Execute one claimed job and publish its result
+ */
+static void run_job(ResultTable &table, uint32_t index, int worker,
+                    const Job &job, Memory &memory, CPU &cpu,
+                    const BatchOptions &options) {
+  JobSlot *slot = table.slot(index);
+  std::ostringstream console;
+  memory.set_console(&console);
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::vector<byte_t> image;
+  std::vector<byte_t> data_segment;
+  memory.clear();
+  bool loaded = read_binary(job.binary, image) && memory.load_image(image) &&
+                Memory::read_data_file(job.binary, data_segment) &&
+                memory.load_image(data_segment, DATA_START);
+  cpu.reset();
+
+  // Publish progress in chunks so long jobs show up in the telemetry
+  WorkerSlot &w = table.header()->workers[worker];
+  uint64_t published = 0;
+  while (loaded && !cpu.is_halted() &&
+         cpu.get_instruction_count() < job.max_instructions) {
+    cpu.run_limited(
+        std::min(job.max_instructions, published + PROGRESS_CHUNK));
+    w.instructions.fetch_add(cpu.get_instruction_count() - published,
+                             std::memory_order_relaxed);
+    published = cpu.get_instruction_count();
+  }
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+  slot->outcome = !loaded           ? OUTCOME_LOAD_ERROR
+                  : cpu.is_halted() ? OUTCOME_HALTED
+                                    : OUTCOME_LIMIT;
+  slot->instructions = cpu.get_instruction_count();
+  slot->nanoseconds = ns;
+  slot->output_hash = fnv1a(console.str());
+  slot->output_bytes = (uint32_t)console.str().size();
+  for (int r = 0; r < NUM_REGISTERS; r++)
+    slot->registers[r] = cpu.get_register(r);
+  if (slot->outcome == OUTCOME_LIMIT && !options.core_dir.empty()) {
+    std::ostringstream path;
+    path << options.core_dir << "/job-" << index << ".core";
+    write_core(path.str(), cpu.get_state(), memory, true);
+  }
+
+  w.jobs_done.fetch_add(1, std::memory_order_relaxed);
+  w.busy_ns.fetch_add(ns, std::memory_order_relaxed);
+  table.finish(index, worker, JOB_DONE);
+}
+
+/**
+ * Take and run jobs from one worker's shard until it is empty
+ */
+static void drain_shard(ResultTable &table, int worker, int victim,
+                        const std::vector<Job> &jobs, Memory &memory,
+                        CPU &cpu, const BatchOptions &options) {
+  WorkerSlot &v = table.header()->workers[victim];
+  for (;;) {
+    uint32_t index = v.cursor.fetch_add(1, std::memory_order_relaxed);
+    if (index >= v.shard_end)
+      return;
+    if (!table.claim(index, worker))
+      continue;
+    if ((int)index == options.inject_crash &&
+        table.slot(index)->attempts == 1)
+      raise(SIGKILL);
+    if (victim != worker)
+      table.header()->workers[worker].jobs_stolen.fetch_add(1);
+    run_job(table, index, worker, jobs[index], memory, cpu, options);
+  }
+}
+
+/**
+ * Worker thread body: pin to a CPU, place the VM memory on that CPU's
+ * node, drain the own shard, then steal from same-node workers first
+ */
+static void worker_thread(ResultTable &table, int worker, int num_workers,
+                          const std::vector<Job> &jobs,
+                          const BatchOptions &options) {
+  WorkerSlot &self = table.header()->workers[worker];
+  pin_to_cpus(std::vector<int>(1, self.cpu));
+
+  bool bound = false;
+  void *backing = alloc_on_node(sizeof(Memory), self.node, bound);
+  if (!backing) {
+    std::cerr << "Error: Worker " << worker << " could not allocate memory"
+              << std::endl;
+    return;
+  }
+  self.memory_bound.store(bound ? 1 : 0);
+  Memory *memory = new (backing) Memory();
+  CPU cpu(*memory);
+
+  drain_shard(table, worker, worker, jobs, *memory, cpu, options);
+  for (int pass = 0; pass < 2; pass++) {
+    for (int k = 1; k < num_workers; k++) {
+      int victim = (worker + k) % num_workers;
+      bool local = table.header()->workers[victim].node == self.node;
+      if (local == (pass == 0))
+        drain_shard(table, worker, victim, jobs, *memory, cpu, options);
+    }
+  }
+
+  // Jobs requeued after a crash sit behind the cursors; sweep for them
+  for (uint32_t index = 0; index < jobs.size(); index++) {
+    if (table.slot(index)->state(std::memory_order_relaxed) == JOB_PENDING &&
+        table.claim(index, worker))
+      run_job(table, index, worker, jobs[index], *memory, cpu, options);
+  }
+
+  memory->~Memory();
+  free_on_node(backing, sizeof(Memory));
+}
+
+static pid_t spawn_process(ResultTable &table, const ProcessPlan &plan,
+                           int num_workers, const std::vector<Job> &jobs,
+                           const std::vector<NumaNode> &nodes,
+                           const BatchOptions &options) {
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid == 0) {
+    pin_to_cpus(nodes[plan.node].cpus);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < plan.num_threads; t++) {
+      threads.push_back(std::thread(worker_thread, std::ref(table),
+                                    plan.first_worker + t, num_workers,
+                                    std::cref(jobs), std::cref(options)));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+      threads[t].join();
+    std::cout.flush();
+    _exit(0);
+  }
+  for (int t = 0; pid > 0 && t < plan.num_threads; t++)
+    table.header()->workers[plan.first_worker + t].pid = pid;
+  return pid;
+}
+
+/**
+ * A worker died: give its job back or fail it after too many attempts.
+ * current_job is published before the claim, so it may name a job the
+ * worker never got; only a job still running under this worker is its.
+ */
+static void recover_job(ResultTable &table, int worker,
+                        const BatchOptions &options) {
+  WorkerSlot &w = table.header()->workers[worker];
+  int32_t index = w.current_job.load();
+  w.current_job.store(-1);
+  if (index < 0)
+    return;
+
+  JobSlot *slot = table.slot((uint32_t)index);
+  if (slot->status.load() != job_status(JOB_RUNNING, worker))
+    return;
+  if (slot->attempts > options.max_retries) {
+    slot->outcome = OUTCOME_CRASHED;
+    slot->status.store(job_status(JOB_FAILED, worker));
+    table.header()->completed.fetch_add(1);
+    std::cerr << "Job " << index << " failed after " << slot->attempts
+              << " attempts" << std::endl;
+  } else {
+    slot->status.store(job_status(JOB_PENDING, worker));
+  }
+}
+
+static const char *outcome_name(const JobSlot *slot) {
+  if (slot->state() == JOB_FAILED)
+    return "crashed";
+  switch (slot->outcome) {
+  case OUTCOME_HALTED:
+    return "halted";
+  case OUTCOME_LIMIT:
+    return "limit";
+  case OUTCOME_LOAD_ERROR:
+    return "load-error";
+  default:
+    return "crashed";
+  }
+}
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options] <manifest>\n";
+  std::cout << "Options:\n";
+  std::cout << "  -p <count>          Worker processes per NUMA node "
+               "(default 1)\n";
+  std::cout << "  -t <count>          Worker threads per process (default: "
+               "one per CPU)\n";
+  std::cout << "  -r <count>          Retries after a worker crash "
+               "(default 2)\n";
+  std::cout << "  -l <instructions>   Default per-job instruction limit\n";
+  std::cout << "  -q, --quiet         Print only the summary\n";
+  std::cout << "  --telemetry <file>  Rewrite a JSON progress snapshot "
+               "periodically\n";
+  std::cout << "  --telemetry-interval <seconds>  Snapshot period "
+               "(default 1)\n";
+  std::cout << "  --cores <dir>       Write <dir>/job-<n>.core for jobs "
+               "stopped by their limit\n";
+  std::cout << "  --inject-crash <n>  Kill the worker on job n's first "
+               "attempt\n";
+  std::cout << "  -h, --help          Show this help message\n";
+}
+
+int main(int argc, char *argv[]) {
+  BatchOptions options;
+  options.processes_per_node = 1;
+  options.threads_per_process = 0;
+  options.max_retries = 2;
+  options.instruction_limit = DEFAULT_INSTRUCTION_LIMIT;
+  options.quiet = false;
+  options.inject_crash = -1;
+  options.telemetry_interval = 1.0;
+  std::string manifest;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg == "-p" && has_value) {
+      options.processes_per_node = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "-t" && has_value) {
+      options.threads_per_process = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "-r" && has_value) {
+      options.max_retries = (uint32_t)std::atoi(argv[++i]);
+    } else if (arg == "-l" && has_value) {
+      options.instruction_limit = std::strtoull(argv[++i], NULL, 0);
+    } else if (arg == "-q" || arg == "--quiet") {
+      options.quiet = true;
+    } else if (arg == "--telemetry" && has_value) {
+      options.telemetry_path = argv[++i];
+    } else if (arg == "--telemetry-interval" && has_value) {
+      options.telemetry_interval = std::max(0.01, std::atof(argv[++i]));
+    } else if (arg == "--cores" && has_value) {
+      options.core_dir = argv[++i];
+    } else if (arg == "--inject-crash" && has_value) {
+      options.inject_crash = std::atoi(argv[++i]);
+    } else if (manifest.empty() && arg[0] != '-') {
+      manifest = arg;
+    } else {
+      std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (manifest.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Job> jobs;
+  if (!read_manifest(manifest, options.instruction_limit, jobs))
+    return 1;
+  if (jobs.empty()) {
+    std::cerr << "Error: Manifest '" << manifest << "' has no jobs"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<NumaNode> nodes = detect_numa_nodes();
+  uint32_t n = (uint32_t)jobs.size();
+
+  // Processes per node, threads per process, one CPU per thread
+  std::vector<ProcessPlan> processes;
+  int num_workers = 0;
+  for (size_t node = 0; node < nodes.size(); node++) {
+    int threads = options.threads_per_process;
+    if (threads == 0)
+      threads = std::max(1, (int)nodes[node].cpus.size() /
+                                options.processes_per_node);
+    for (int p = 0; p < options.processes_per_node; p++) {
+      ProcessPlan plan;
+      plan.node = (int)node;
+      plan.first_worker = num_workers;
+      plan.num_threads = std::min(threads, MAX_BATCH_WORKERS - num_workers);
+      plan.num_threads = std::min(plan.num_threads, (int)n - num_workers);
+      plan.pid = -1;
+      if (plan.num_threads <= 0)
+        break;
+      processes.push_back(plan);
+      num_workers += plan.num_threads;
+    }
+  }
+
+  ResultTable table;
+  std::ostringstream shm_name;
+  shm_name << "/cpu16-batch-" << getpid();
+  if (!table.create(shm_name.str(), n))
+    return 1;
+
+  // Contiguous shards, numbered so each node's shards are adjacent
+  for (size_t p = 0; p < processes.size(); p++) {
+    const ProcessPlan &plan = processes[p];
+    const std::vector<int> &cpus = nodes[plan.node].cpus;
+    for (int t = 0; t < plan.num_threads; t++) {
+      int w = plan.first_worker + t;
+      WorkerSlot &slot = table.header()->workers[w];
+      slot.node = nodes[plan.node].id;
+      slot.cpu = cpus[(p * plan.num_threads + t) % cpus.size()];
+      slot.shard_begin = (uint32_t)((uint64_t)n * w / num_workers);
+      slot.shard_end = (uint32_t)((uint64_t)n * (w + 1) / num_workers);
+      slot.cursor.store(slot.shard_begin);
+    }
+  }
+
+  std::cout << "Running " << n << " jobs on " << num_workers
+            << " worker threads in " << processes.size()
+            << " processes across " << nodes.size()
+            << " NUMA node(s), results in " << table.get_name() << std::endl;
+
+  Telemetry telemetry(options.telemetry_path);
+  bool live = !options.telemetry_path.empty();
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  int alive = 0;
+  for (size_t p = 0; p < processes.size(); p++) {
+    processes[p].pid =
+        spawn_process(table, processes[p], num_workers, jobs, nodes, options);
+    if (processes[p].pid > 0)
+      alive++;
+  }
+
+  // Replace crashed processes, but not forever
+  int respawns_left = (int)(n * (options.max_retries + 1)) + num_workers;
+  while (alive > 0) {
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, live ? WNOHANG : 0);
+    if (pid < 0)
+      break;
+    if (pid == 0) {
+      // Telemetry is on: poll, and snapshot whenever the period is up
+      if (telemetry.since_last() >= options.telemetry_interval)
+        live = telemetry.publish(table, num_workers, false);
+      usleep(10000);
+      continue;
+    }
+    size_t p = 0;
+    while (p < processes.size() && processes[p].pid != pid)
+      p++;
+    if (p == processes.size())
+      continue;
+    alive--;
+    processes[p].pid = -1;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+      continue;
+
+    std::cerr << "Worker process " << p << " (pid " << pid << ") ";
+    if (WIFSIGNALED(status))
+      std::cerr << "killed by signal " << WTERMSIG(status);
+    else
+      std::cerr << "exited with status " << WEXITSTATUS(status);
+    std::cerr << std::endl;
+    for (int t = 0; t < processes[p].num_threads; t++)
+      recover_job(table, processes[p].first_worker + t, options);
+
+    if (table.header()->completed.load() < n && respawns_left-- > 0) {
+      processes[p].pid = spawn_process(table, processes[p], num_workers, jobs,
+                                       nodes, options);
+      if (processes[p].pid > 0)
+        alive++;
+    }
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  // Anything still unfinished had no worker left to run it
+  for (uint32_t i = 0; i < n; i++) {
+    JobSlot *slot = table.slot(i);
+    JobState state = slot->state();
+    if (state == JOB_PENDING || state == JOB_RUNNING) {
+      slot->outcome = OUTCOME_CRASHED;
+      slot->status.store(job_status(JOB_FAILED, slot->worker()));
+    }
+  }
+  if (!options.telemetry_path.empty())
+    telemetry.publish(table, num_workers, true);
+
+  uint64_t total_instructions = 0;
+  uint32_t failed = 0;
+  if (!options.quiet) {
+    std::cout << std::left << std::setw(6) << "Job" << std::setw(32)
+              << "Binary" << std::setw(11) << "Outcome" << std::right
+              << std::setw(13) << "Instructions" << std::setw(11) << "Time ms"
+              << std::setw(10) << "Output" << std::setw(9) << "Attempts"
+              << std::setw(8) << "Worker" << std::endl;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    const JobSlot *slot = table.slot(i);
+    bool ok = slot->state() == JOB_DONE &&
+              slot->outcome == OUTCOME_HALTED;
+    if (!ok)
+      failed++;
+    if (slot->state() == JOB_DONE)
+      total_instructions += slot->instructions;
+    if (options.quiet)
+      continue;
+    std::cout << std::setfill(' ') << std::left << std::setw(6) << i
+              << std::setw(32) << jobs[i].binary << std::setw(11)
+              << outcome_name(slot) << std::right << std::setw(13)
+              << slot->instructions << std::fixed << std::setprecision(2)
+              << std::setw(11) << slot->nanoseconds / 1e6 << "  "
+              << std::hex << std::setfill('0') << std::setw(8)
+              << slot->output_hash << std::dec << std::setfill(' ')
+              << std::setw(9) << slot->attempts << std::setw(8)
+              << slot->worker() << std::endl;
+  }
+
+  // Per-node totals show how well shards and stealing stayed local
+  if (!options.quiet) {
+    std::cout << std::left << std::setw(6) << "Node" << std::right
+              << std::setw(9) << "Workers" << std::setw(8) << "Jobs"
+              << std::setw(8) << "Stolen" << std::setw(15) << "Instructions"
+              << std::setw(8) << "MIPS" << std::setw(7) << "Busy"
+              << "  Memory" << std::endl;
+  }
+  for (size_t node = 0; node < nodes.size() && !options.quiet; node++) {
+    int workers = 0, bound = 0;
+    uint64_t done = 0, stolen = 0, instructions = 0, busy = 0;
+    for (int w = 0; w < num_workers; w++) {
+      const WorkerSlot &slot = table.header()->workers[w];
+      if (slot.node != nodes[node].id)
+        continue;
+      workers++;
+      bound += slot.memory_bound.load() ? 1 : 0;
+      done += slot.jobs_done.load();
+      stolen += slot.jobs_stolen.load();
+      instructions += slot.instructions.load();
+      busy += slot.busy_ns.load();
+    }
+    if (workers == 0)
+      continue;
+    std::cout << std::left << std::setw(6) << nodes[node].id << std::right
+              << std::setw(9) << workers << std::setw(8) << done
+              << std::setw(8) << stolen << std::setw(15) << instructions
+              << std::fixed << std::setprecision(1) << std::setw(8)
+              << instructions / seconds / 1e6 << std::setw(6)
+              << 100.0 * busy / (seconds * 1e9 * workers) << "%  "
+              << (bound == workers ? "mbind"
+                  : bound == 0     ? "first-touch"
+                                   : "mixed")
+              << std::endl;
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << n - failed << "/" << n
+            << " jobs halted, " << total_instructions
+            << " instructions in " << seconds << " s ("
+            << total_instructions / seconds / 1e6 << " MIPS)" << std::endl;
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * NUMA Topology Detection and CPU Pinning
+ */
+
+#include "numa.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * Parse a kernel CPU list such as "0-3,8-11"
+ */
+static std::vector<int> parse_cpu_list(const std::string &text) {
+  std::vector<int> cpus;
+  std::stringstream stream(text);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty() || range[0] < '0' || range[0] > '9')
+      continue;
+    size_t dash = range.find('-');
+    int first = std::atoi(range.c_str());
+    int last = dash == std::string::npos
+                   ? first
+                   : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+std::vector<NumaNode> detect_numa_nodes() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+
+  std::vector<NumaNode> nodes;
+  DIR *dir = opendir("/sys/devices/system/node");
+  if (dir) {
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          name[4] < '0' || name[4] > '9')
+        continue;
+
+      std::ifstream file(("/sys/devices/system/node/" + name + "/cpulist")
+                             .c_str());
+      std::string list;
+      std::getline(file, list);
+      NumaNode node;
+      node.id = std::atoi(name.c_str() + 4);
+      std::vector<int> cpus = parse_cpu_list(list);
+      for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &allowed))
+          node.cpus.push_back(cpus[i]);
+      }
+      if (!node.cpus.empty())
+        nodes.push_back(node);
+    }
+    closedir(dir);
+  }
+
+  if (nodes.empty()) {
+    NumaNode node;
+    node.id = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed))
+        node.cpus.push_back(cpu);
+    }
+    nodes.push_back(node);
+  }
+
+  // Directory order is arbitrary; keep nodes sorted by id
+  std::sort(nodes.begin(), nodes.end(),
+            [](const NumaNode &a, const NumaNode &b) { return a.id < b.id; });
+  return nodes;
+}
+
+bool pin_to_cpus(const std::vector<int> &cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < cpus.size(); i++)
+    CPU_SET(cpus[i], &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+void *alloc_on_node(size_t size, int node, bool &bound) {
+  bound = false;
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    return NULL;
+
+  const int bits = 8 * sizeof(unsigned long);
+  unsigned long mask[16] = {0};
+  if (node >= 0 && node < 16 * bits) {
+    mask[node / bits] = 1UL << (node % bits);
+    bound = syscall(__NR_mbind, memory, size, MPOL_PREFERRED, mask,
+                    16 * bits, 0) == 0;
+  }
+  memset(memory, 0, size); // First touch from the calling thread
+  return memory;
+}
+
+void free_on_node(void *memory, size_t size) {
+  if (memory)
+    munmap(memory, size);
+}
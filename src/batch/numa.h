@@ -0,0 +1,31 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+#include <vector>
+
+struct NumaNode {
+  int id;
+  std::vector<int> cpus; // CPUs this process may run on
+};
+
+/**
+ * NUMA topology from /sys/devices/system/node, restricted to the CPUs in
+ * this process's affinity mask. Machines without NUMA information are
+ * reported as a single node 0 holding every allowed CPU.
+ */
+std::vector<NumaNode> detect_numa_nodes();
+
+// Restrict the calling thread to the given CPUs
+bool pin_to_cpus(const std::vector<int> &cpus);
+
+/**
+ * Page-aligned memory whose pages prefer the given node (mbind). The
+ * pages are touched before returning, so if mbind is unavailable the
+ * calling thread's first touch still places them on its own node.
+ * bound reports whether mbind succeeded.
+ */
+void *alloc_on_node(size_t size, int node, bool &bound);
+void free_on_node(void *memory, size_t size);
+
+#endif // NUMA_H
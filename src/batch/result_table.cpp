@@ -0,0 +1,128 @@
+/**
+ * Shared-Memory Result Table
+ *
+ * A header followed by one fixed-size JobSlot per job. Slots are updated
+ * with atomic state transitions only, so workers never serialize results
+ * or take locks.
+ */
+
+#include "result_table.h"
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t TABLE_MAGIC = 0x42415443; // "BATC"
+
+ResultTable::ResultTable() : base(NULL), size(0), owner(false) {}
+
+ResultTable::~ResultTable() {
+  if (base)
+    munmap(base, size);
+  if (owner)
+    unlink();
+}
+
+bool ResultTable::create(const std::string &shm_name, uint32_t num_jobs) {
+  name = shm_name;
+  size = sizeof(TableHeader) + (size_t)num_jobs * sizeof(JobSlot);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    std::cerr << "Error: Could not create shared memory '" << name << "'"
+              << std::endl;
+    return false;
+  }
+  owner = true;
+  if (ftruncate(fd, (off_t)size) != 0) {
+    std::cerr << "Error: Could not size shared memory '" << name << "'"
+              << std::endl;
+    close(fd);
+    return false;
+  }
+  base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    base = NULL;
+    std::cerr << "Error: Could not map shared memory '" << name << "'"
+              << std::endl;
+    return false;
+  }
+
+  // The mapping starts zeroed; construct the atomics in place
+  TableHeader *h = new (base) TableHeader();
+  h->magic = TABLE_MAGIC;
+  h->num_jobs = num_jobs;
+  h->completed.store(0);
+  for (int w = 0; w < MAX_BATCH_WORKERS; w++)
+    h->workers[w].current_job.store(-1);
+  for (uint32_t i = 0; i < num_jobs; i++) {
+    JobSlot *s = new (slot(i)) JobSlot();
+    s->status.store(job_status(JOB_PENDING, -1));
+  }
+  return true;
+}
+
+/**
+ * Map an existing table read-write, e.g. from a monitoring process
+ */
+bool ResultTable::attach(const std::string &shm_name) {
+  name = shm_name;
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    std::cerr << "Error: Could not open shared memory '" << name << "'"
+              << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TableHeader)) {
+    close(fd);
+    std::cerr << "Error: Shared memory '" << name << "' is not a table"
+              << std::endl;
+    return false;
+  }
+  size = (size_t)st.st_size;
+  base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED || header()->magic != TABLE_MAGIC) {
+    if (base != MAP_FAILED)
+      munmap(base, size);
+    base = NULL;
+    std::cerr << "Error: Shared memory '" << name << "' is not a table"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void ResultTable::unlink() {
+  shm_unlink(name.c_str());
+  owner = false;
+}
+
+bool ResultTable::claim(uint32_t index, int worker) {
+  JobSlot *s = slot(index);
+  uint32_t expected = s->status.load();
+  if ((expected & 0xFF) != JOB_PENDING)
+    return false;
+  WorkerSlot &w = header()->workers[worker];
+  w.current_job.store((int32_t)index);
+  if (!s->status.compare_exchange_strong(expected,
+                                         job_status(JOB_RUNNING, worker),
+                                         std::memory_order_acquire)) {
+    w.current_job.store(-1);
+    return false;
+  }
+  s->attempts++;
+  return true;
+}
+
+void ResultTable::finish(uint32_t index, int worker, JobState state) {
+  WorkerSlot &w = header()->workers[worker];
+  slot(index)->status.store(job_status(state, worker),
+                            std::memory_order_release);
+  header()->completed.fetch_add(1);
+  w.current_job.store(-1);
+}
@@ -0,0 +1,116 @@
+#ifndef RESULT_TABLE_H
+#define RESULT_TABLE_H
+
+#include "../common/types.h"
+#include <atomic>
+#include <string>
+
+// Lifecycle of a job in the shared table
+enum JobState {
+  JOB_PENDING = 0, // Waiting for a worker
+  JOB_RUNNING = 1, // Claimed by the worker in JobSlot::worker()
+  JOB_DONE = 2,    // Result fields are valid
+  JOB_FAILED = 3   // Gave up after repeated worker crashes
+};
+
+// How a finished job ended
+enum JobOutcome {
+  OUTCOME_HALTED = 0,     // Program executed HALT
+  OUTCOME_LIMIT = 1,      // Instruction limit reached first
+  OUTCOME_LOAD_ERROR = 2, // Binary could not be loaded
+  OUTCOME_CRASHED = 3     // Its worker died on every attempt
+};
+
+// A JobSlot status word: the state in the low byte, the worker that
+// claimed the job last (plus one, so 0 is none) above it
+inline uint32_t job_status(JobState state, int worker) {
+  return (uint32_t)state | ((uint32_t)(worker + 1) << 8);
+}
+
+/**
+ * One job's entry. The state and its owner share one atomic word, so a
+ * claim sets both in a single compare-and-swap. Workers write the result
+ * fields, then publish them by storing JOB_DONE with release ordering.
+ */
+struct JobSlot {
+  std::atomic<uint32_t> status;
+  uint32_t attempts; // Claims so far, including crashed ones
+  uint32_t outcome;
+  uint64_t instructions;
+  uint64_t nanoseconds;
+  uint32_t output_hash; // FNV-1a of the console output
+  uint32_t output_bytes;
+  word_t registers[NUM_REGISTERS];
+
+  JobState state(std::memory_order order = std::memory_order_seq_cst) const {
+    return (JobState)(status.load(order) & 0xFF);
+  }
+  // Worker that claimed it last, -1 if none has
+  int worker() const { return (int)(status.load() >> 8) - 1; }
+};
+
+const int MAX_BATCH_WORKERS = 256;
+
+/**
+ * Per-worker record. current_job is set before a claim is attempted, so
+ * after a crash the coordinator knows which job to hand out again. The
+ * worker's shard is [shard_begin, shard_end); cursor is the next job of
+ * it to take, advanced by the owner and by thieves alike. Only the owner
+ * writes the counters; each slot has its own cache line so workers never
+ * contend on them.
+ */
+struct alignas(64) WorkerSlot {
+  std::atomic<int32_t> current_job; // -1 when idle
+  int32_t pid;
+  int32_t node; // NUMA node the worker is pinned to
+  int32_t cpu;
+  uint32_t shard_begin;
+  uint32_t shard_end;
+  std::atomic<uint32_t> cursor;
+  std::atomic<uint32_t> memory_bound; // VM memory placed with mbind
+  std::atomic<uint64_t> jobs_done;
+  std::atomic<uint64_t> jobs_stolen; // Taken from another worker's shard
+  std::atomic<uint64_t> instructions; // Updated while a job runs
+  std::atomic<uint64_t> busy_ns;
+};
+
+struct TableHeader {
+  uint32_t magic;
+  uint32_t num_jobs;
+  std::atomic<uint32_t> completed; // Jobs in JOB_DONE or JOB_FAILED
+  WorkerSlot workers[MAX_BATCH_WORKERS];
+};
+
+/**
+ * Job results in POSIX shared memory (shm_open), mapped by the
+ * coordinator and inherited by every worker process it forks
+ */
+class ResultTable {
+private:
+  std::string name;
+  void *base;
+  size_t size;
+  bool owner;
+
+public:
+  ResultTable();
+  ~ResultTable();
+
+  bool create(const std::string &shm_name, uint32_t num_jobs);
+  bool attach(const std::string &shm_name);
+  void unlink();
+
+  TableHeader *header() const { return (TableHeader *)base; }
+  JobSlot *slot(uint32_t index) const {
+    return (JobSlot *)((char *)base + sizeof(TableHeader)) + index;
+  }
+  uint32_t num_jobs() const { return base ? header()->num_jobs : 0; }
+  const std::string &get_name() const { return name; }
+
+  // Claim a pending job for a worker; false if someone else got it first
+  bool claim(uint32_t index, int worker);
+  // Publish a claimed job's result fields
+  void finish(uint32_t index, int worker, JobState state);
+};
+
+#endif // RESULT_TABLE_H
@@ -0,0 +1,115 @@
+/**
+ * Batch Telemetry
+ *
+ * Snapshot fields:
+ *   elapsed_s, finished        wall time since the run started
+ *   mips, average_mips         since the previous snapshot / since start
+ *   jobs                       total, done, failed, running, queued
+ *   workers                    worker threads in the run
+ *   engine, instructions       the engine every job runs on (always the
+ *                              interpreter) and the guest instructions it
+ *                              has executed so far
+ *   latency_ms                 p50 / p99 over the jobs finished so far
+ *
+ * Jobs need an instruction limit, which only the interpreter's
+ * run_limited() enforces, so there are no trusted or tiered totals and
+ * no verifier or tier cache counters to report.
+ */
+
+#include "telemetry.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+Telemetry::Telemetry(const std::string &output_path)
+    : path(output_path), start(std::chrono::steady_clock::now()),
+      last(start), last_instructions(0) {}
+
+double Telemetry::since_last() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       last)
+      .count();
+}
+
+static double percentile_ms(std::vector<uint64_t> &ns, double fraction) {
+  if (ns.empty())
+    return 0.0;
+  size_t k = (size_t)(fraction * (ns.size() - 1) + 0.5);
+  std::nth_element(ns.begin(), ns.begin() + k, ns.end());
+  return ns[k] / 1e6;
+}
+
+bool Telemetry::publish(const ResultTable &table, int num_workers,
+                        bool finished) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - start).count();
+  double interval = std::chrono::duration<double>(now - last).count();
+
+  uint64_t instructions = 0;
+  for (int w = 0; w < num_workers; w++) {
+    instructions += table.header()->workers[w].instructions.load(
+        std::memory_order_relaxed);
+  }
+
+  uint32_t done = 0, failed = 0, running = 0, queued = 0;
+  std::vector<uint64_t> latencies;
+  for (uint32_t i = 0; i < table.num_jobs(); i++) {
+    const JobSlot *slot = table.slot(i);
+    switch (slot->state(std::memory_order_acquire)) {
+    case JOB_DONE:
+      done++;
+      latencies.push_back(slot->nanoseconds);
+      break;
+    case JOB_FAILED:
+      failed++;
+      break;
+    case JOB_RUNNING:
+      running++;
+      break;
+    default:
+      queued++;
+      break;
+    }
+  }
+
+  std::string temp = path + ".tmp";
+  std::ofstream out(temp.c_str());
+  if (!out.is_open()) {
+    std::cerr << "Error: Could not write telemetry file '" << temp << "'"
+              << std::endl;
+    return false;
+  }
+  out << std::fixed << std::setprecision(3);
+  out << "{\n";
+  out << "  \"elapsed_s\": " << elapsed << ",\n";
+  out << "  \"finished\": " << (finished ? "true" : "false") << ",\n";
+  out << "  \"mips\": "
+      << (interval > 0 ? (instructions - last_instructions) / interval / 1e6
+                       : 0.0)
+      << ",\n";
+  out << "  \"average_mips\": "
+      << (elapsed > 0 ? instructions / elapsed / 1e6 : 0.0) << ",\n";
+  out << "  \"jobs\": {\"total\": " << table.num_jobs()
+      << ", \"done\": " << done << ", \"failed\": " << failed
+      << ", \"running\": " << running << ", \"queued\": " << queued
+      << "},\n";
+  out << "  \"workers\": " << num_workers << ",\n";
+  out << "  \"engine\": \"interpreter\",\n";
+  out << "  \"instructions\": " << instructions << ",\n";
+  out << "  \"latency_ms\": {\"p50\": " << percentile_ms(latencies, 0.50)
+      << ", \"p99\": " << percentile_ms(latencies, 0.99) << "}\n";
+  out << "}\n";
+  out.close();
+
+  if (!out || std::rename(temp.c_str(), path.c_str()) != 0) {
+    std::cerr << "Error: Could not write telemetry file '" << path << "'"
+              << std::endl;
+    return false;
+  }
+  last = now;
+  last_instructions = instructions;
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "result_table.h"
+#include <chrono>
+#include <string>
+
+/**
+ * Periodic progress snapshots of a batch run, written as a small JSON
+ * document. Each snapshot replaces the previous one atomically (write to
+ * a temporary file, then rename), so readers never see a partial file.
+ *
+ * Everything is derived from the shared result table: workers only bump
+ * their own relaxed counters, and all aggregation happens here in the
+ * coordinator.
+ */
+class Telemetry {
+private:
+  std::string path;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point last;
+  uint64_t last_instructions;
+
+public:
+  explicit Telemetry(const std::string &output_path);
+
+  const std::string &get_path() const { return path; }
+  // Seconds since the last snapshot
+  double since_last() const;
+  bool publish(const ResultTable &table, int num_workers, bool finished);
+};
+
+#endif // TELEMETRY_H
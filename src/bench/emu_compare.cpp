@@ -0,0 +1,382 @@
+/**
+ * Native-vs-Emulated Comparison Harness
+ *
+ * For each corpus program, times the host-compiled version (built with
+ * native_driver.c) and the compiled guest binary on every execution
+ * engine, then reports the slowdown, guest MIPS and, where the kernel
+ * allows perf_event_open, host instructions retired per guest instruction.
+ * Both versions must reproduce the program's expected output.
+ *
+ * Arguments ending in .bin are guest-only programs, such as those from
+ * progen: they are timed on each engine without a native baseline.
+ */
+
+#include "../emulator/cpu.h"
+#include "../emulator/memory.h"
+#include "../emulator/tiers.h"
+#include "../emulator/verifier.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char *BENCH_BUILD_DIR = "build/bench";
+const char *BENCH_SOURCE_DIR = "programs/bench";
+
+/**
+ * Counts user-space instructions retired by this thread
+ */
+class InstructionCounter {
+private:
+  int fd;
+
+public:
+  InstructionCounter() : fd(-1) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~InstructionCounter() {
+#ifdef __linux__
+    if (fd >= 0)
+      close(fd);
+#endif
+  }
+
+  bool available() const { return fd >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  uint64_t stop() {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count))
+        count = 0;
+    }
+#endif
+    return count;
+  }
+};
+
+// An execution engine runs a loaded CPU until it halts; false if the
+// program could not run on that engine alone
+struct Engine {
+  const char *name;
+  bool (*run)(CPU &cpu, const Memory &memory, size_t code_size);
+};
+
+static bool run_interpreter(CPU &cpu, const Memory &, size_t) {
+  cpu.run();
+  return true;
+}
+
+// Verification is part of the measured time, as it is on every load. A
+// program the verifier rejects, or one that leaves verified code, finishes
+// on the interpreter so its output can still be checked, but the time is
+// not the trusted engine's.
+static bool run_trusted(CPU &cpu, const Memory &memory, size_t code_size) {
+  Verifier verifier;
+  if (verifier.verify(memory, code_size) && cpu.run_trusted(verifier))
+    return true;
+  cpu.run();
+  return false;
+}
+
+// Block compilation is part of the measured time, as it is on every run
+static bool run_tiered(CPU &cpu, const Memory &, size_t) {
+  TierCache cache;
+  cpu.run_tiered(cache);
+  return true;
+}
+
+static const Engine ENGINES[] = {{"interpreter", run_interpreter},
+                                 {"trusted", run_trusted},
+                                 {"tiered", run_tiered}};
+static const size_t NUM_ENGINES = sizeof(ENGINES) / sizeof(ENGINES[0]);
+
+struct EmulatedResult {
+  bool ok;
+  bool unverifiable;           // Ran on the interpreter instead
+  uint64_t guest_instructions;
+  double seconds;              // Per run
+  uint64_t host_instructions;  // Per run, 0 if not counted
+};
+
+static bool read_file(const std::string &path, std::string &contents) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+/**
+ * Run a shell command and collect what it prints
+ */
+static bool capture(const std::string &command, std::string &output) {
+  FILE *pipe = popen(command.c_str(), "r");
+  if (!pipe)
+    return false;
+  char buffer[256];
+  size_t n;
+  output.clear();
+  while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    output.append(buffer, n);
+  return pclose(pipe) == 0;
+}
+
+/**
+ * Time the native build; returns nanoseconds per run or a negative value
+ */
+static double run_native(const std::string &name, const std::string &expected,
+                         double min_seconds) {
+  std::string binary = std::string(BENCH_BUILD_DIR) + "/" + name + ".native";
+  std::string output;
+  if (!capture(binary, output)) {
+    std::cerr << "Error: Could not run '" << binary << "'" << std::endl;
+    return -1;
+  }
+  if (output != expected) {
+    std::cerr << "Error: Native " << name << " output differs from expected"
+              << std::endl;
+    return -1;
+  }
+
+  std::ostringstream command;
+  command << binary << " " << min_seconds << " 2>&1";
+  if (!capture(command.str(), output)) {
+    std::cerr << "Error: Timing run of '" << binary << "' failed" << std::endl;
+    return -1;
+  }
+  return std::atof(output.c_str());
+}
+
+/**
+ * Run the guest binary on one engine until min_seconds have passed
+ */
+static EmulatedResult run_emulated(const std::string &binary,
+                                   const std::string *expected,
+                                   const Engine &engine, double min_seconds,
+                                   InstructionCounter &counter) {
+  EmulatedResult result = {false, false, 0, 0.0, 0};
+  Memory memory;
+  CPU cpu(memory);
+
+  int runs = 0;
+  double total = 0.0;
+  uint64_t host_total = 0;
+  do {
+    // The console is captured so it can be checked, and so the harness
+    // measures emulation rather than the terminal
+    std::ostringstream console;
+    std::streambuf *saved = std::cout.rdbuf(console.rdbuf());
+    memory.clear();
+    bool loaded = memory.load_program(binary);
+    std::ifstream file(binary.c_str(), std::ios::binary | std::ios::ate);
+    size_t code_size = loaded ? (size_t)file.tellg() : 0;
+    console.str("");
+    cpu.reset();
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    counter.start();
+    if (loaded && !engine.run(cpu, memory, code_size))
+      result.unverifiable = true;
+    host_total += counter.stop();
+    total += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+    std::cout.rdbuf(saved);
+
+    if (!loaded) {
+      std::cerr << "Error: Could not load '" << binary << "'" << std::endl;
+      return result;
+    }
+    if (expected && console.str() != *expected) {
+      std::cerr << "Error: " << binary << " on " << engine.name
+                << " output differs from expected" << std::endl;
+      return result;
+    }
+    runs++;
+  } while (total < min_seconds && !result.unverifiable);
+
+  result.ok = true;
+  result.guest_instructions = cpu.get_instruction_count();
+  result.seconds = total / runs;
+  result.host_instructions = host_total / runs;
+  return result;
+}
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options] <program>...\n";
+  std::cout << "Programs are corpus names, built as " << BENCH_BUILD_DIR
+            << "/<name>.bin and .native,\n";
+  std::cout << "or paths to guest-only .bin files\n";
+  std::cout << "Options:\n";
+  std::cout << "  -t <seconds>   Minimum time per measurement (default 0.2)\n";
+  std::cout << "  -h, --help     Show this help message\n";
+}
+
+int main(int argc, char *argv[]) {
+  double min_seconds = 0.2;
+  std::vector<std::string> programs;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-t" && i + 1 < argc) {
+      min_seconds = std::atof(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else {
+      programs.push_back(arg);
+    }
+  }
+  if (programs.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  InstructionCounter counter;
+  if (!counter.available()) {
+    std::cout << "Note: perf_event_open unavailable, host instruction "
+                 "counts not reported"
+              << std::endl;
+  }
+
+  std::cout << std::left << std::setw(16) << "Program" << std::setw(13)
+            << "Engine" << std::right << std::setw(12) << "Guest instr"
+            << std::setw(12) << "Native us" << std::setw(12) << "Emulated ms"
+            << std::setw(10) << "Slowdown" << std::setw(8) << "MIPS"
+            << std::setw(12) << "Host/guest" << std::endl;
+
+  bool all_ok = true;
+  std::vector<double> slowdowns[NUM_ENGINES];
+  uint64_t guest_total[NUM_ENGINES] = {0};
+  double seconds_total[NUM_ENGINES] = {0.0};
+
+  for (size_t p = 0; p < programs.size(); p++) {
+    std::string name = programs[p];
+    std::string binary;
+    std::string expected;
+    double native_ns = 0.0;
+    bool guest_only = name.size() > 4 &&
+                      name.compare(name.size() - 4, 4, ".bin") == 0;
+
+    if (guest_only) {
+      binary = name;
+      size_t slash = name.find_last_of('/');
+      if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+      name = name.substr(0, name.size() - 4);
+    } else {
+      binary = std::string(BENCH_BUILD_DIR) + "/" + name + ".bin";
+      std::string path =
+          std::string(BENCH_SOURCE_DIR) + "/" + name + ".expected";
+      if (!read_file(path, expected)) {
+        std::cerr << "Error: Could not open file '" << path << "'"
+                  << std::endl;
+        all_ok = false;
+        continue;
+      }
+      native_ns = run_native(name, expected, min_seconds);
+      if (native_ns <= 0) {
+        all_ok = false;
+        continue;
+      }
+    }
+
+    for (size_t e = 0; e < NUM_ENGINES; e++) {
+      EmulatedResult r =
+          run_emulated(binary, guest_only ? NULL : &expected, ENGINES[e],
+                       min_seconds, counter);
+      if (!r.ok) {
+        all_ok = false;
+        continue;
+      }
+      if (r.unverifiable) {
+        std::cout << std::setfill(' ') << std::left << std::setw(16) << name
+                  << std::setw(13) << ENGINES[e].name
+                  << "n/a (unverifiable)" << std::endl;
+        continue;
+      }
+
+      double mips = r.guest_instructions / r.seconds / 1e6;
+      guest_total[e] += r.guest_instructions;
+      seconds_total[e] += r.seconds;
+
+      // Loading a program leaves the console's fill character at '0'
+      std::cout << std::setfill(' ') << std::left << std::setw(16) << name
+                << std::setw(13) << ENGINES[e].name << std::right
+                << std::setw(12) << r.guest_instructions << std::fixed
+                << std::setprecision(1);
+      if (guest_only) {
+        std::cout << std::setw(12) << "-" << std::setw(12)
+                  << r.seconds * 1e3 << std::setw(10) << "-";
+      } else {
+        double slowdown = r.seconds * 1e9 / native_ns;
+        slowdowns[e].push_back(slowdown);
+        std::cout << std::setw(12) << native_ns / 1e3 << std::setw(12)
+                  << r.seconds * 1e3 << std::setw(10) << slowdown;
+      }
+      std::cout << std::setw(8) << mips << std::setw(12);
+      if (counter.available())
+        std::cout << (double)r.host_instructions / r.guest_instructions;
+      else
+        std::cout << "n/a";
+      std::cout << std::endl;
+    }
+  }
+
+  // One number per engine to track over time
+  for (size_t e = 0; e < NUM_ENGINES; e++) {
+    if (seconds_total[e] <= 0.0)
+      continue;
+    std::cout << ENGINES[e].name << ": " << std::fixed << std::setprecision(1);
+    if (!slowdowns[e].empty()) {
+      double log_sum = 0.0;
+      for (size_t i = 0; i < slowdowns[e].size(); i++)
+        log_sum += std::log(slowdowns[e][i]);
+      std::cout << "geometric mean slowdown "
+                << std::exp(log_sum / slowdowns[e].size()) << "x, ";
+    }
+    std::cout << guest_total[e] / seconds_total[e] / 1e6 << " guest MIPS"
+              << std::endl;
+  }
+
+  return all_ok ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+/**
+ * Native Benchmark Driver
+ *
+ * Linked with a corpus program compiled with -Dmain=guest_main. With no
+ * arguments it runs the program once, printing its output. Given a
+ * duration in seconds, it reruns the program with output discarded until
+ * that much time has passed and prints nanoseconds per run to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int guest_main();
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    return guest_main();
+  }
+
+  double min_seconds = atof(argv[1]);
+  if (freopen("/dev/null", "w", stdout) == NULL) {
+    fprintf(stderr, "Error: Could not discard program output\n");
+    return 1;
+  }
+
+  long runs = 0;
+  double start = now_seconds();
+  double elapsed;
+  do {
+    guest_main();
+    runs++;
+    elapsed = now_seconds() - start;
+  } while (elapsed < min_seconds);
+
+  fflush(stdout);
+  fprintf(stderr, "%.1f\n", elapsed * 1e9 / runs);
+  return 0;
+}
@@ -0,0 +1,468 @@
+/**
+ * Random Program Generator
+ *
+ * Emits valid, terminating random programs for dispatch and decoder
+ * stress benchmarks. The opcode mix, branch density, data footprint and
+ * call depth are controlled from the command line, and the same seed
+ * always produces the same program, as .asm text or an assembled .bin.
+ *
+ * Generated programs terminate by construction: the only backward branch
+ * is main's loop on R7, every other branch jumps forward within its
+ * function, and functions only call functions one level deeper.
+ *
+ * Register Usage:
+ * R0-R4: Random operands
+ * R5:    Address scratch for memory operations
+ * R6:    Base of the data footprint (DATA_START)
+ * R7:    Main loop counter
+ */
+
+#include "../assembler/assembler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Instruction classes the opcode mix is expressed in
+enum InstrClass {
+  CLASS_ALU,    // Register-register arithmetic, logic and shifts
+  CLASS_IMM,    // Immediate forms and MOVI
+  CLASS_MULDIV, // MUL and DIV
+  CLASS_MEM,    // LOAD/STORE inside the data footprint
+  CLASS_STACK,  // Balanced PUSH/POP pairs
+  CLASS_CALL,   // CALL into the next level of functions
+  NUM_CLASSES
+};
+
+const char *const CLASS_NAMES[NUM_CLASSES] = {"alu", "imm",   "muldiv",
+                                              "mem", "stack", "call"};
+
+struct GeneratorOptions {
+  unsigned seed;
+  int body_length;       // Instruction slots per function body
+  int iterations;        // Trips around main's loop (1-65535)
+  int functions;         // Functions per call level
+  int call_depth;        // Levels of functions below main
+  int footprint;         // Bytes of data touched (rounded down to 2^n)
+  double branch_density; // Fraction of slots that are branches
+  int smc_sites;         // Instructions main rewrites on every iteration
+  int weights[NUM_CLASSES];
+
+  GeneratorOptions()
+      : seed(1), body_length(200), iterations(1000), functions(4),
+        call_depth(2), footprint(1024), branch_density(0.15), smc_sites(0) {
+    const int defaults[NUM_CLASSES] = {40, 25, 5, 20, 5, 5};
+    for (int i = 0; i < NUM_CLASSES; i++)
+      weights[i] = defaults[i];
+  }
+};
+
+class ProgramGenerator {
+private:
+  GeneratorOptions options;
+  std::mt19937 rng;
+  std::ostringstream out;
+  int footprint_shift; // SHRI amount mapping a register into the footprint
+  int label_count;
+  int slot_count;
+
+  int random(int n) { return (int)(rng() % (unsigned)n); }
+  std::string reg() { return "R" + std::to_string(random(5)); }
+  std::string function_name(int level, int index);
+
+  void emit(const std::string &line) { out << "    " << line << "\n"; }
+  void emit_constant(const std::string &reg, int value);
+  void emit_branch(std::map<int, std::vector<std::string> > &pending,
+                   int slot, int length);
+  void emit_slot(InstrClass c, int level);
+  void emit_body(int level, int length, int patch_every);
+
+public:
+  ProgramGenerator(const GeneratorOptions &opts);
+
+  std::string generate();
+  int get_slot_count() const { return slot_count; }
+};
+
+ProgramGenerator::ProgramGenerator(const GeneratorOptions &opts)
+    : options(opts), rng(opts.seed), footprint_shift(0), label_count(0),
+      slot_count(0) {
+  while ((0x10000 >> footprint_shift) > options.footprint)
+    footprint_shift++;
+}
+
+std::string ProgramGenerator::function_name(int level, int index) {
+  return "f" + std::to_string(level) + "_" + std::to_string(index);
+}
+
+/**
+ * Load any 16-bit constant with MOVI and shifts of 4-bit chunks
+ */
+void ProgramGenerator::emit_constant(const std::string &reg, int value) {
+  value &= 0xFFFF;
+  if (value < 64) {
+    emit("MOVI " + reg + ", " + std::to_string(value));
+    return;
+  }
+  int shift = 12;
+  while ((value >> shift) == 0)
+    shift -= 4;
+  emit("MOVI " + reg + ", " + std::to_string(value >> shift));
+  while (shift > 0) {
+    shift -= 4;
+    emit("SHLI " + reg + ", " + reg + ", 4");
+    if ((value >> shift) & 0xF)
+      emit("ORI " + reg + ", " + reg + ", " +
+           std::to_string((value >> shift) & 0xF));
+  }
+}
+
+/**
+ * A forward branch to a label placed up to 16 slots ahead
+ */
+void ProgramGenerator::emit_branch(
+    std::map<int, std::vector<std::string> > &pending, int slot, int length) {
+  static const char *const conditions[] = {"JZ", "JNZ", "JC", "JNC", "JN"};
+  std::string label = "L" + std::to_string(label_count++);
+  int target = slot + 1 + random(16);
+  pending[target < length ? target : length].push_back(label);
+
+  int kind = random(8);
+  if (kind == 0) {
+    emit("JMP " + label);
+    return;
+  }
+  if (kind <= 3)
+    emit("CMP " + reg() + ", " + reg());
+  else if (kind <= 5)
+    emit("CMPI " + reg() + ", " + std::to_string(random(16) - 8));
+  // Otherwise the flags of the previous instruction decide
+  emit(std::string(conditions[random(5)]) + " " + label);
+}
+
+void ProgramGenerator::emit_slot(InstrClass c, int level) {
+  static const char *const alu_ops[] = {"ADD", "SUB", "AND", "OR",
+                                        "XOR", "SHL", "SHR"};
+  static const char *const imm_ops[] = {"ADDI", "SUBI", "ANDI",
+                                        "ORI",  "SHLI", "SHRI"};
+
+  switch (c) {
+  case CLASS_ALU: {
+    int kind = random(10);
+    if (kind < 7)
+      emit(std::string(alu_ops[kind]) + " " + reg() + ", " + reg() + ", " +
+           reg());
+    else if (kind == 7)
+      emit("NOT " + reg() + ", " + reg());
+    else if (kind == 8)
+      emit(std::string(random(2) ? "INC " : "DEC ") + reg());
+    else
+      emit("MOV " + reg() + ", " + reg());
+    break;
+  }
+
+  case CLASS_IMM: {
+    int kind = random(7);
+    if (kind == 6) {
+      emit("MOVI " + reg() + ", " + std::to_string(random(128) - 64));
+    } else {
+      // ADDI/SUBI take a signed 4-bit immediate, the rest 0-15
+      int imm = kind < 2 ? random(16) - 8 : random(16);
+      emit(std::string(imm_ops[kind]) + " " + reg() + ", " + reg() + ", " +
+           std::to_string(imm));
+    }
+    break;
+  }
+
+  case CLASS_MULDIV:
+    emit(std::string(random(2) ? "MUL " : "DIV ") + reg() + ", " + reg() +
+         ", " + reg());
+    break;
+
+  case CLASS_MEM: {
+    if (random(4) == 0) {
+      // Direct form at a fixed address inside the footprint
+      std::ostringstream address;
+      address << "0x" << std::hex << std::uppercase
+              << DATA_START + (random(options.footprint) & ~1);
+      if (random(2))
+        emit("LOAD " + reg() + ", " + address.str());
+      else
+        emit("STORE " + reg() + ", " + address.str());
+      break;
+    }
+    emit("SHRI R5, " + reg() + ", " + std::to_string(footprint_shift));
+    emit("ADD R5, R5, R6");
+    if (random(2))
+      emit("LOAD " + reg() + ", [R5]");
+    else
+      emit("STORE " + reg() + ", [R5]");
+    break;
+  }
+
+  case CLASS_STACK: {
+    int depth = 1 + random(3);
+    for (int i = 0; i < depth; i++)
+      emit("PUSH " + reg());
+    emit(std::string(alu_ops[random(7)]) + " " + reg() + ", " + reg() +
+         ", " + reg());
+    for (int i = 0; i < depth; i++)
+      emit("POP " + reg());
+    break;
+  }
+
+  case CLASS_CALL:
+    emit("CALL " + function_name(level + 1, random(options.functions)));
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+ * One function body; every patch_every-th slot of main becomes a MOVI
+ * that main's loop rewrites
+ */
+void ProgramGenerator::emit_body(int level, int length, int patch_every) {
+  int total_weight = 0;
+  for (int i = 0; i < NUM_CLASSES; i++) {
+    if (i != CLASS_CALL || level < options.call_depth)
+      total_weight += options.weights[i];
+  }
+
+  std::map<int, std::vector<std::string> > pending; // Slot -> labels
+  int patches = 0;
+  for (int slot = 0; slot < length; slot++) {
+    std::map<int, std::vector<std::string> >::iterator it =
+        pending.find(slot);
+    if (it != pending.end()) {
+      for (size_t i = 0; i < it->second.size(); i++)
+        out << it->second[i] << ":\n";
+      pending.erase(it);
+    }
+    slot_count++;
+
+    if (patch_every > 0 && patches < options.smc_sites &&
+        slot % patch_every == 0) {
+      out << "patch" << patches++ << ":\n";
+      emit("MOVI " + reg() + ", " + std::to_string(random(64)));
+      continue;
+    }
+    if ((rng() % 1000000) < options.branch_density * 1000000) {
+      emit_branch(pending, slot, length);
+      continue;
+    }
+
+    if (total_weight == 0) {
+      emit_slot(CLASS_ALU, level);
+      continue;
+    }
+    int pick = random(total_weight);
+    int c = 0;
+    for (; c < NUM_CLASSES - 1; c++) {
+      if (c == CLASS_CALL && level >= options.call_depth)
+        continue;
+      if (pick < options.weights[c])
+        break;
+      pick -= options.weights[c];
+    }
+    emit_slot((InstrClass)c, level);
+  }
+
+  for (std::map<int, std::vector<std::string> >::iterator it =
+           pending.begin();
+       it != pending.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); i++)
+      out << it->second[i] << ":\n";
+  }
+}
+
+std::string ProgramGenerator::generate() {
+  out << "; Random program: seed " << options.seed << ", " << options.body_length
+      << " slots per body, " << options.iterations << " iterations\n";
+  out << "; " << options.functions << " functions per level, call depth "
+      << options.call_depth << ", footprint " << options.footprint
+      << " bytes, branch density " << options.branch_density
+      << ", smc sites " << options.smc_sites << "\n";
+  out << "; Mix:";
+  for (int i = 0; i < NUM_CLASSES; i++)
+    out << " " << CLASS_NAMES[i] << "=" << options.weights[i];
+  out << "\n\n";
+
+  out << "main:\n";
+  emit_constant("R6", DATA_START);
+  for (int r = 0; r < 5; r++)
+    emit("MOVI R" + std::to_string(r) + ", " + std::to_string(random(128) - 64));
+  emit_constant("R7", options.iterations);
+
+  out << "main_loop:\n";
+  // Toggle bit 0 of each patched MOVI so its immediate changes every trip
+  for (int i = 0; i < options.smc_sites; i++) {
+    std::string site = "patch" + std::to_string(i);
+    emit("LOAD R5, " + site);
+    emit("PUSH R0");
+    emit("MOVI R0, 1");
+    emit("XOR R5, R5, R0");
+    emit("POP R0");
+    emit("STORE R5, " + site);
+  }
+  int patch_every = 0;
+  if (options.smc_sites > 0)
+    patch_every = std::max(1, options.body_length / options.smc_sites);
+  emit_body(0, options.body_length, patch_every);
+  emit("DEC R7");
+  emit("JNZ main_loop");
+  emit("HALT");
+
+  for (int level = 1; level <= options.call_depth; level++) {
+    for (int f = 0; f < options.functions; f++) {
+      out << "\n" << function_name(level, f) << ":\n";
+      emit_body(level, options.body_length, 0);
+      emit("RET");
+    }
+  }
+  return out.str();
+}
+
+static bool parse_mix(const std::string &spec, GeneratorOptions &options) {
+  std::stringstream stream(spec);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == std::string::npos)
+      return false;
+    std::string name = item.substr(0, eq);
+    int c = 0;
+    while (c < NUM_CLASSES && name != CLASS_NAMES[c])
+      c++;
+    if (c == NUM_CLASSES)
+      return false;
+    options.weights[c] = std::max(0, std::atoi(item.substr(eq + 1).c_str()));
+  }
+  return true;
+}
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options] <output.asm|.bin>\n";
+  std::cout << "Options:\n";
+  std::cout << "  -s <seed>        Random seed (default 1)\n";
+  std::cout << "  -n <slots>       Instruction slots per function (default "
+               "200)\n";
+  std::cout << "  -i <count>       Main loop iterations, 1-65535 (default "
+               "1000)\n";
+  std::cout << "  -f <count>       Functions per call level (default 4)\n";
+  std::cout << "  -d <depth>       Call depth below main (default 2)\n";
+  std::cout << "  -m <bytes>       Data footprint, 2-16384 (default 1024)\n";
+  std::cout << "  -b <fraction>    Branch density (default 0.15)\n";
+  std::cout << "  -x <count>       Self-modified instructions (default 0)\n";
+  std::cout << "  --mix <weights>  Class weights, e.g. "
+               "alu=40,imm=25,muldiv=5,mem=20,stack=5,call=5\n";
+  std::cout << "  -h, --help       Show this help message\n";
+}
+
+int main(int argc, char *argv[]) {
+  GeneratorOptions options;
+  std::string output_file;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg == "-s" && has_value) {
+      options.seed = (unsigned)std::strtoul(argv[++i], NULL, 0);
+    } else if (arg == "-n" && has_value) {
+      options.body_length = std::atoi(argv[++i]);
+    } else if (arg == "-i" && has_value) {
+      options.iterations = std::atoi(argv[++i]);
+    } else if (arg == "-f" && has_value) {
+      options.functions = std::atoi(argv[++i]);
+    } else if (arg == "-d" && has_value) {
+      options.call_depth = std::atoi(argv[++i]);
+    } else if (arg == "-m" && has_value) {
+      options.footprint = std::atoi(argv[++i]);
+    } else if (arg == "-b" && has_value) {
+      options.branch_density = std::atof(argv[++i]);
+    } else if (arg == "-x" && has_value) {
+      options.smc_sites = std::atoi(argv[++i]);
+    } else if (arg == "--mix" && has_value) {
+      if (!parse_mix(argv[++i], options)) {
+        std::cerr << "Error: Invalid mix '" << argv[i] << "'" << std::endl;
+        return 1;
+      }
+    } else if (output_file.empty() && arg[0] != '-') {
+      output_file = arg;
+    } else {
+      std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (output_file.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (options.iterations < 1 || options.iterations > 0xFFFF ||
+      options.body_length < 1 || options.functions < 1 ||
+      options.call_depth < 0 || options.footprint < 2 ||
+      options.footprint > 0x4000 || options.smc_sites < 0 ||
+      options.smc_sites > options.body_length) {
+    std::cerr << "Error: Option out of range" << std::endl;
+    return 1;
+  }
+
+  ProgramGenerator generator(options);
+  std::string program = generator.generate();
+
+  bool binary = output_file.size() > 4 &&
+                output_file.compare(output_file.size() - 4, 4, ".bin") == 0;
+  if (!binary) {
+    std::ofstream file(output_file.c_str());
+    if (!file.is_open()) {
+      std::cerr << "Error: Could not create file '" << output_file << "'"
+                << std::endl;
+      return 1;
+    }
+    file << program;
+  } else {
+    // Assemble through a temporary source file, quietly
+    char temp_name[] = "/tmp/progen_XXXXXX";
+    int fd = mkstemp(temp_name);
+    if (fd < 0) {
+      std::cerr << "Error: Could not create a temporary file" << std::endl;
+      return 1;
+    }
+    close(fd);
+    std::ofstream(temp_name) << program;
+
+    Assembler assembler;
+    std::ostringstream quiet;
+    std::streambuf *saved = std::cout.rdbuf(quiet.rdbuf());
+    bool ok = assembler.assemble(temp_name, output_file);
+    std::cout.rdbuf(saved);
+    std::remove(temp_name);
+    if (!ok) {
+      std::cerr << quiet.str();
+      return 1;
+    }
+    if (assembler.get_machine_code().size() > PROGRAM_END + 1u) {
+      std::cerr << "Error: Program does not fit the code segment" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "Generated " << generator.get_slot_count() << " slots in "
+            << 1 + options.functions * options.call_depth
+            << " functions to '" << output_file << "'" << std::endl;
+  return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * Guest Runtime Library Benchmark
+ *
+ * Assembles lib/runtime.asm, then calls each routine on the emulated CPU
+ * with representative inputs. Every call is checked against the host's
+ * answer and its cost is reported in emulated instructions (cycles).
+ */
+
+#include "../assembler/assembler.h"
+#include "../emulator/cpu.h"
+#include "../emulator/memory.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+// A HALT placed here is where every benchmarked routine returns to
+const addr_t RETURN_ADDRESS = PROGRAM_END - 1;
+
+// Scratch buffers for string and block routines
+const addr_t BUFFER_A = 0x9000;
+const addr_t BUFFER_B = 0xA000;
+
+class RuntimeBench {
+private:
+  Memory memory;
+  CPU cpu;
+  std::vector<byte_t> code;
+  std::map<std::string, addr_t> symbols;
+  std::string output; // Console output of the last call
+  int failures;
+
+public:
+  RuntimeBench() : cpu(memory), failures(0) {}
+
+  bool load(const std::string &source, const std::string &binary);
+  void reset();
+  uint64_t call(const std::string &routine, word_t r1 = 0, word_t r2 = 0,
+                word_t r3 = 0, word_t r4 = 0);
+  void report(const std::string &routine, const std::string &what,
+              uint64_t cycles, bool ok);
+
+  word_t reg(int r) const { return cpu.get_register(r); }
+  uint32_t pair(int lo, int hi) const {
+    return ((uint32_t)reg(hi) << 16) | reg(lo);
+  }
+  const std::string &console() const { return output; }
+  Memory &mem() { return memory; }
+  int get_failures() const { return failures; }
+};
+
+/**
+ * Assemble the library and keep its code and labels
+ */
+bool RuntimeBench::load(const std::string &source, const std::string &binary) {
+  Assembler assembler;
+  std::ostringstream quiet;
+  std::streambuf *saved = std::cout.rdbuf(quiet.rdbuf());
+  bool ok = assembler.assemble(source, binary);
+  std::cout.rdbuf(saved);
+  if (!ok) {
+    std::cerr << quiet.str();
+    return false;
+  }
+  code = assembler.get_machine_code();
+  symbols = assembler.get_symbols();
+  return true;
+}
+
+/**
+ * Fresh memory holding only the library and the return HALT
+ */
+void RuntimeBench::reset() {
+  memory.clear();
+  for (size_t i = 0; i < code.size(); i++) {
+    memory.write_byte(PROGRAM_START + i, code[i]);
+  }
+  memory.write_word(RETURN_ADDRESS, MAKE_INSTR(OP_HALT, 0, 0, 0));
+}
+
+/**
+ * Run one routine to completion, returning the instructions it executed
+ */
+uint64_t RuntimeBench::call(const std::string &routine, word_t r1, word_t r2,
+                            word_t r3, word_t r4) {
+  std::map<std::string, addr_t>::const_iterator it = symbols.find(routine);
+  if (it == symbols.end()) {
+    std::cerr << "Error: Routine '" << routine << "' not found" << std::endl;
+    std::exit(1);
+  }
+
+  cpu.reset();
+  cpu.set_register(1, r1);
+  cpu.set_register(2, r2);
+  cpu.set_register(3, r3);
+  cpu.set_register(4, r4);
+  cpu.call(it->second, RETURN_ADDRESS);
+
+  // Capture what the routine prints instead of mixing it into the table
+  std::ostringstream captured;
+  std::streambuf *saved = std::cout.rdbuf(captured.rdbuf());
+  while (!cpu.is_halted() && cpu.get_instruction_count() < 1000000) {
+    cpu.step();
+  }
+  std::cout.rdbuf(saved);
+  output = captured.str();
+
+  if (!cpu.is_halted()) {
+    std::cerr << "Error: Routine '" << routine << "' did not return"
+              << std::endl;
+    std::exit(1);
+  }
+  return cpu.get_instruction_count() - 1; // The HALT is not part of it
+}
+
+void RuntimeBench::report(const std::string &routine, const std::string &what,
+                          uint64_t cycles, bool ok) {
+  std::cout << std::left << std::setw(12) << routine << std::setw(30) << what
+            << std::right << std::setw(8) << cycles << "  "
+            << (ok ? "OK" : "FAIL") << std::endl;
+  if (!ok)
+    failures++;
+}
+
+static void write_string(Memory &memory, addr_t address,
+                         const std::string &s) {
+  for (size_t i = 0; i < s.size(); i++) {
+    memory.write_byte(address + i, s[i]);
+  }
+  memory.write_byte(address + s.size(), 0);
+}
+
+static std::string hex32(uint32_t value) {
+  std::ostringstream out;
+  out << "0x" << std::hex << std::uppercase << std::setw(8)
+      << std::setfill('0') << value;
+  return out.str();
+}
+
+static void bench_print(RuntimeBench &b) {
+  const word_t values[] = {7, 42, 1234, 65535};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    b.reset();
+    uint64_t cycles = b.call("print_u16", values[i]);
+    std::ostringstream expected;
+    expected << values[i];
+    b.report("print_u16", expected.str(), cycles,
+             b.console() == expected.str());
+  }
+
+  const int16_t signed_values[] = {-32768, -1234, 5};
+  for (size_t i = 0; i < sizeof(signed_values) / sizeof(signed_values[0]);
+       i++) {
+    b.reset();
+    uint64_t cycles = b.call("print_i16", (word_t)signed_values[i]);
+    std::ostringstream expected;
+    expected << signed_values[i];
+    b.report("print_i16", expected.str(), cycles,
+             b.console() == expected.str());
+  }
+
+  b.reset();
+  uint64_t cycles = b.call("utoa16", 40503, BUFFER_A);
+  std::string text;
+  for (addr_t a = BUFFER_A; b.mem().read_byte(a) != 0; a++) {
+    text += (char)b.mem().read_byte(a);
+  }
+  b.report("utoa16", "40503", cycles, text == "40503" && b.reg(0) == 5);
+
+  const std::string message = "Hello from the runtime!";
+  b.reset();
+  write_string(b.mem(), BUFFER_A, message);
+  cycles = b.call("print_str", BUFFER_A);
+  b.report("print_str", "23 chars", cycles, b.console() == message);
+}
+
+static void bench_strings(RuntimeBench &b) {
+  const size_t lengths[] = {0, 7, 64};
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    b.reset();
+    write_string(b.mem(), BUFFER_A, std::string(lengths[i], 'x'));
+    uint64_t cycles = b.call("strlen", BUFFER_A);
+    std::ostringstream what;
+    what << lengths[i] << " chars";
+    b.report("strlen", what.str(), cycles, b.reg(0) == lengths[i]);
+  }
+
+  const word_t sizes[] = {7, 64, 256};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    b.reset();
+    for (word_t k = 0; k <= sizes[i]; k++) {
+      b.mem().write_byte(BUFFER_A + k, (byte_t)(k * 7 + 1));
+      b.mem().write_byte(BUFFER_B + k, 0xEE);
+    }
+    uint64_t cycles = b.call("memcpy", BUFFER_B, BUFFER_A, sizes[i]);
+    bool ok = b.reg(0) == BUFFER_B &&
+              b.mem().read_byte(BUFFER_B + sizes[i]) == 0xEE;
+    for (word_t k = 0; k < sizes[i]; k++) {
+      ok = ok && b.mem().read_byte(BUFFER_B + k) == (byte_t)(k * 7 + 1);
+    }
+    std::ostringstream what;
+    what << sizes[i] << " bytes";
+    b.report("memcpy", what.str(), cycles, ok);
+
+    b.reset();
+    for (word_t k = 0; k <= sizes[i]; k++) {
+      b.mem().write_byte(BUFFER_A + k, 0xEE);
+    }
+    cycles = b.call("memset", BUFFER_A, 0x5A, sizes[i]);
+    ok = b.reg(0) == BUFFER_A &&
+         b.mem().read_byte(BUFFER_A + sizes[i]) == 0xEE;
+    for (word_t k = 0; k < sizes[i]; k++) {
+      ok = ok && b.mem().read_byte(BUFFER_A + k) == 0x5A;
+    }
+    b.report("memset", what.str(), cycles, ok);
+  }
+}
+
+static void bench_arithmetic(RuntimeBench &b) {
+  const word_t factors[][2] = {{1234, 5678}, {0xFFFF, 0xFFFF}};
+  for (size_t i = 0; i < sizeof(factors) / sizeof(factors[0]); i++) {
+    b.reset();
+    uint64_t cycles = b.call("mul_u16", factors[i][0], factors[i][1]);
+    uint32_t expected = (uint32_t)factors[i][0] * factors[i][1];
+    b.report("mul_u16", hex32(expected), cycles, b.pair(0, 1) == expected);
+  }
+
+  b.reset();
+  uint32_t x = 0x12345678, y = 0x9ABCDEF0;
+  uint64_t cycles = b.call("mul32", x & 0xFFFF, x >> 16, y & 0xFFFF, y >> 16);
+  b.report("mul32", hex32(x * y), cycles, b.pair(0, 1) == x * y);
+
+  // One case per div32 path: byte divisor, 16-bit, short and full long
+  // division, and the 33-bit remainder case
+  const uint32_t divisions[][2] = {{1000000, 7},
+                                   {50000, 300},
+                                   {0x12345678, 0x1234},
+                                   {0xFFFFFFFF, 0x00012345},
+                                   {0xFFFFFFFF, 0x80010000}};
+  for (size_t i = 0; i < sizeof(divisions) / sizeof(divisions[0]); i++) {
+    uint32_t n = divisions[i][0], d = divisions[i][1];
+    b.reset();
+    cycles = b.call("div32", n & 0xFFFF, n >> 16, d & 0xFFFF, d >> 16);
+    b.report("div32", hex32(n) + " / " + hex32(d), cycles,
+             b.pair(0, 1) == n / d && b.pair(2, 3) == n % d);
+  }
+
+  // Random operands cover the carries and borrows the fixed cases miss
+  srand(1);
+  uint64_t mul_total = 0, div_total = 0;
+  bool mul_ok = true, div_ok = true;
+  const int trials = 1000;
+  for (int i = 0; i < trials; i++) {
+    uint32_t p = ((uint32_t)(rand() & 0xFFFF) << 16) | (rand() & 0xFFFF);
+    uint32_t q = ((uint32_t)(rand() & 0xFFFF) << 16) | (rand() & 0xFFFF);
+    q >>= rand() % 32;
+    if (q == 0)
+      q = 1;
+
+    b.reset();
+    mul_total += b.call("mul32", p & 0xFFFF, p >> 16, q & 0xFFFF, q >> 16);
+    mul_ok = mul_ok && b.pair(0, 1) == p * q;
+
+    b.reset();
+    div_total += b.call("div32", p & 0xFFFF, p >> 16, q & 0xFFFF, q >> 16);
+    div_ok = div_ok && b.pair(0, 1) == p / q && b.pair(2, 3) == p % q;
+  }
+  b.report("mul32", "1000 random (average)", mul_total / trials, mul_ok);
+  b.report("div32", "1000 random (average)", div_total / trials, div_ok);
+}
+
+static void bench_heap(RuntimeBench &b) {
+  b.reset();
+  uint64_t cycles = b.call("alloc", 10);
+  bool ok = b.reg(0) == DATA_START;
+  cycles += b.call("alloc", 3);
+  ok = ok && b.reg(0) == DATA_START + 10;
+  b.report("alloc", "2 blocks (total)", cycles,
+           ok && b.mem().read_word(RUNTIME_HEAP_PTR) == DATA_START + 14);
+
+  b.reset();
+  b.call("heap_init", BUFFER_A + 1, BUFFER_A + 32);
+  cycles = b.call("alloc", 20);
+  ok = b.reg(0) == BUFFER_A + 2;
+  uint64_t fail_cycles = b.call("alloc", 20);
+  b.report("alloc", "after heap_init", cycles, ok);
+  b.report("alloc", "exhausted arena", fail_cycles, b.reg(0) == 0);
+}
+
+int main(int argc, char *argv[]) {
+  std::string source = argc > 1 ? argv[1] : "lib/runtime.asm";
+  std::string binary = argc > 2 ? argv[2] : "build/runtime.bin";
+
+  RuntimeBench bench;
+  if (!bench.load(source, binary)) {
+    return 1;
+  }
+
+  std::cout << "=== Guest Runtime Library Benchmark ===" << std::endl;
+  std::cout << std::left << std::setw(12) << "Routine" << std::setw(30)
+            << "Case" << std::right << std::setw(8) << "Cycles" << std::endl;
+
+  bench_print(bench);
+  bench_strings(bench);
+  bench_arithmetic(bench);
+  bench_heap(bench);
+
+  if (bench.get_failures() > 0) {
+    std::cout << bench.get_failures() << " case(s) failed" << std::endl;
+    return 1;
+  }
+  std::cout << "All routines correct" << std::endl;
+  return 0;
+}
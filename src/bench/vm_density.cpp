@@ -0,0 +1,439 @@
+/**
+ * VM Density and Start-up Benchmark
+ *
+ * How fast one more guest starts and how many fit in memory, for each
+ * way of hosting a VM:
+ *   process     one emulator process per guest, as the emulator's main()
+ *   cow-fork    a zygote holding a loaded VM forks one child per guest;
+ *               guest memory is shared copy-on-write until written
+ *   in-process  a new CPU and Memory per guest inside one process
+ *   pooled      VMs created up front, reset and reloaded per guest
+ *
+ * The in-process models are measured once per execution engine, since
+ * each engine adds its own per-VM caches: the verifier's decoded program
+ * for the trusted engine, and the hotness and block tables for the tiered
+ * one. The process models run the interpreter.
+ *
+ * Start-up is the time from creating the VM (or the process) to its first
+ * executed instruction. For the process model that instant is not visible
+ * from outside, so it is bounded by the exit of a guest whose first
+ * instruction is HALT. Resident memory is the VM's share of RSS: Pss of
+ * live guest processes, or the RSS growth per VM in this process. The
+ * in-process models are allocated up to the cap; the process models'
+ * counts are extrapolated from a sample of live processes.
+ *
+ * Probe guests are written to a temporary directory: one that halts at
+ * once, and one that spins on a jump so its process stays live.
+ */
+
+#include "../common/instructions.h"
+#include "../emulator/cpu.h"
+#include "../emulator/memory.h"
+#include "../emulator/tiers.h"
+#include "../emulator/verifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <signal.h>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+const char *DEFAULT_EMULATOR = "build/emulator";
+const int DEFAULT_STARTUP_SAMPLES = 20;
+const int DEFAULT_LIVE_PROCESSES = 16;
+const size_t DEFAULT_CAP_MB = 256;
+// Time for live guest processes to get past start-up before measuring
+const int SETTLE_MS = 100;
+
+typedef std::chrono::steady_clock Clock;
+
+enum EngineKind {
+  ENGINE_INTERPRETER = 0,
+  ENGINE_TRUSTED,
+  ENGINE_TIERED,
+  NUM_ENGINES
+};
+static const char *const ENGINE_NAMES[NUM_ENGINES] = {"interpreter",
+                                                      "trusted", "tiered"};
+
+struct ModelResult {
+  const char *name;
+  const char *engine;
+  std::vector<double> startup_us;
+  double resident_kb; // Per VM
+  long fits;          // VMs within the cap
+  bool extrapolated;
+};
+
+static double elapsed_us(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+static std::vector<byte_t> probe_image(bool spin) {
+  std::vector<byte_t> image;
+  word_t words[2] = {(word_t)MAKE_INSTR(spin ? OP_JMP : OP_HALT, 0, 0, 0),
+                     PROGRAM_START};
+  for (int i = 0; i < (spin ? 2 : 1); i++) {
+    image.push_back((byte_t)(words[i] & 0xFF));
+    image.push_back((byte_t)(words[i] >> 8));
+  }
+  return image;
+}
+
+static bool write_probe(const std::string &path, bool spin) {
+  std::vector<byte_t> image = probe_image(spin);
+  std::ofstream file(path.c_str(), std::ios::binary);
+  file.write((const char *)&image[0], image.size());
+  if (!file) {
+    std::cerr << "Error: Could not write '" << path << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Proportional set size of a process in KB, or its RSS where the kernel
+ * has no smaps_rollup
+ */
+static double resident_kb(pid_t pid) {
+  std::ostringstream path;
+  path << "/proc/" << pid << "/smaps_rollup";
+  std::ifstream rollup(path.str().c_str());
+  std::string key;
+  double kb;
+  while (rollup >> key) {
+    if (key == "Pss:" && rollup >> kb)
+      return kb;
+    rollup.ignore(1 << 16, '\n');
+  }
+
+  path.str("");
+  path << "/proc/" << pid << "/statm";
+  std::ifstream statm(path.str().c_str());
+  long size, resident = 0;
+  statm >> size >> resident;
+  return resident * (sysconf(_SC_PAGESIZE) / 1024.0);
+}
+
+static pid_t spawn_emulator(const std::string &emulator,
+                            const std::string &probe) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0)
+      dup2(null, STDOUT_FILENO);
+    execl(emulator.c_str(), emulator.c_str(), probe.c_str(), "-q",
+          (char *)NULL);
+    _exit(127);
+  }
+  return pid;
+}
+
+static double average_resident_kb(const std::vector<pid_t> &pids) {
+  usleep(SETTLE_MS * 1000);
+  double total = 0.0;
+  for (size_t i = 0; i < pids.size(); i++)
+    total += resident_kb(pids[i]);
+  for (size_t i = 0; i < pids.size(); i++) {
+    kill(pids[i], SIGKILL);
+    waitpid(pids[i], NULL, 0);
+  }
+  return pids.empty() ? 0.0 : total / pids.size();
+}
+
+static bool measure_process(const std::string &emulator,
+                            const std::string &halt_probe,
+                            const std::string &spin_probe, int samples,
+                            int live, ModelResult &result) {
+  for (int i = 0; i < samples; i++) {
+    Clock::time_point start = Clock::now();
+    pid_t pid = spawn_emulator(emulator, halt_probe);
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      std::cerr << "Error: Could not run '" << emulator << "'" << std::endl;
+      return false;
+    }
+    result.startup_us.push_back(elapsed_us(start));
+  }
+
+  std::vector<pid_t> pids;
+  for (int i = 0; i < live; i++) {
+    pid_t pid = spawn_emulator(emulator, spin_probe);
+    if (pid > 0)
+      pids.push_back(pid);
+  }
+  result.resident_kb = average_resident_kb(pids);
+  return true;
+}
+
+/**
+ * A child of the zygote runs its first instruction and reports it over a
+ * pipe; a spinning child then runs on until it is killed
+ */
+static pid_t fork_guest(CPU &cpu, int ready) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    cpu.step();
+    char byte = 1;
+    if (write(ready, &byte, 1) != 1)
+      _exit(1);
+    cpu.run();
+    _exit(0);
+  }
+  return pid;
+}
+
+static bool measure_cow_fork(int samples, int live, ModelResult &result) {
+  int ready[2];
+  if (pipe(ready) != 0) {
+    std::cerr << "Error: Could not create a pipe" << std::endl;
+    return false;
+  }
+
+  Memory memory;
+  CPU cpu(memory);
+  memory.load_image(probe_image(false), PROGRAM_START);
+  for (int i = 0; i < samples; i++) {
+    Clock::time_point start = Clock::now();
+    pid_t pid = fork_guest(cpu, ready[1]);
+    char byte;
+    if (pid < 0 || read(ready[0], &byte, 1) != 1) {
+      std::cerr << "Error: Could not fork a guest" << std::endl;
+      close(ready[0]);
+      close(ready[1]);
+      return false;
+    }
+    result.startup_us.push_back(elapsed_us(start));
+    waitpid(pid, NULL, 0);
+  }
+
+  memory.clear();
+  memory.load_image(probe_image(true), PROGRAM_START);
+  std::vector<pid_t> pids;
+  for (int i = 0; i < live; i++) {
+    pid_t pid = fork_guest(cpu, ready[1]);
+    char byte;
+    if (pid > 0 && read(ready[0], &byte, 1) == 1)
+      pids.push_back(pid);
+  }
+  result.resident_kb = average_resident_kb(pids);
+  close(ready[0]);
+  close(ready[1]);
+  return true;
+}
+
+// One guest hosted inside this process, with the caches its engine keeps
+struct VM {
+  Memory memory;
+  CPU cpu;
+  std::unique_ptr<Verifier> verifier; // Trusted: the decoded program
+  std::unique_ptr<TierCache> tiers;   // Tiered: hotness and blocks
+
+  explicit VM(EngineKind engine) : cpu(memory) {
+    if (engine == ENGINE_TRUSTED)
+      verifier.reset(new Verifier());
+    else if (engine == ENGINE_TIERED)
+      tiers.reset(new TierCache());
+  }
+
+  // Load a guest and run its first instruction. The engine's caches are
+  // filled as they are before it runs; the instruction itself is stepped,
+  // as the spinning probe never returns from the engine's run loop.
+  void start(const std::vector<byte_t> &image) {
+    memory.load_image(image, PROGRAM_START);
+    if (verifier)
+      verifier->verify(memory, image.size());
+    cpu.step();
+  }
+
+  void reset() {
+    memory.clear();
+    cpu.reset();
+    if (tiers)
+      tiers->invalidate();
+  }
+};
+
+static void measure_in_process(EngineKind engine, int samples,
+                               ModelResult &result) {
+  std::vector<byte_t> image = probe_image(false);
+  for (int i = 0; i < samples; i++) {
+    Clock::time_point start = Clock::now();
+    VM *vm = new VM(engine);
+    vm->start(image);
+    result.startup_us.push_back(elapsed_us(start));
+    delete vm;
+  }
+}
+
+static void measure_pooled(EngineKind engine, int samples,
+                           ModelResult &result) {
+  std::vector<byte_t> image = probe_image(false);
+  std::vector<VM *> pool;
+  for (int i = 0; i < samples; i++) {
+    pool.push_back(new VM(engine));
+    pool.back()->start(image);
+  }
+  for (int i = 0; i < samples; i++) {
+    Clock::time_point start = Clock::now();
+    VM *vm = pool[i];
+    vm->reset();
+    vm->start(image);
+    result.startup_us.push_back(elapsed_us(start));
+  }
+  for (size_t i = 0; i < pool.size(); i++)
+    delete pool[i];
+}
+
+/**
+ * Allocate live VMs on one engine, each with its first instruction run,
+ * until RSS has grown by the cap; the VMs are freed again afterwards
+ */
+static long fill_cap(EngineKind engine, size_t cap_kb, double &per_vm_kb) {
+  std::vector<byte_t> image = probe_image(true);
+  double base = resident_kb(getpid());
+  double grown = 0.0;
+  std::vector<VM *> vms;
+  while (grown < cap_kb) {
+    VM *vm = new (std::nothrow) VM(engine);
+    if (!vm)
+      break;
+    vm->start(image);
+    vms.push_back(vm);
+    if (vms.size() % 64 == 0)
+      grown = resident_kb(getpid()) - base;
+  }
+  grown = resident_kb(getpid()) - base;
+  per_vm_kb = vms.empty() ? 0.0 : grown / vms.size();
+  long count = (long)vms.size();
+  if (grown > cap_kb && per_vm_kb > 0)
+    count -= (long)((grown - cap_kb) / per_vm_kb + 0.5);
+  for (size_t i = 0; i < vms.size(); i++)
+    delete vms[i];
+  return count;
+}
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Measures VM start-up latency, resident memory per VM and "
+               "VMs per memory cap\n";
+  std::cout << "Options:\n";
+  std::cout << "  -e <emulator>  Emulator for the process model (default "
+            << DEFAULT_EMULATOR << ")\n";
+  std::cout << "  -n <samples>   Start-ups timed per model (default "
+            << DEFAULT_STARTUP_SAMPLES << ")\n";
+  std::cout << "  -p <count>     Live processes sampled for resident memory "
+               "(default "
+            << DEFAULT_LIVE_PROCESSES << ")\n";
+  std::cout << "  --cap <MB>     Memory cap for the VM count (default "
+            << DEFAULT_CAP_MB << ")\n";
+  std::cout << "  -h, --help     Show this help message\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::string emulator = DEFAULT_EMULATOR;
+  int samples = DEFAULT_STARTUP_SAMPLES;
+  int live = DEFAULT_LIVE_PROCESSES;
+  size_t cap_mb = DEFAULT_CAP_MB;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-e" && i + 1 < argc) {
+      emulator = argv[++i];
+    } else if (arg == "-n" && i + 1 < argc) {
+      samples = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "-p" && i + 1 < argc) {
+      live = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--cap" && i + 1 < argc) {
+      cap_mb = (size_t)std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  char scratch[] = "/tmp/vm_density.XXXXXX";
+  if (!mkdtemp(scratch)) {
+    std::cerr << "Error: Could not create a temporary directory"
+              << std::endl;
+    return 1;
+  }
+  std::string halt_probe = std::string(scratch) + "/halt.bin";
+  std::string spin_probe = std::string(scratch) + "/spin.bin";
+  if (!write_probe(halt_probe, false) || !write_probe(spin_probe, true))
+    return 1;
+
+  size_t cap_kb = cap_mb * 1024;
+  const char *interpreter = ENGINE_NAMES[ENGINE_INTERPRETER];
+  std::vector<ModelResult> results;
+  ModelResult process = {"process", interpreter, {}, 0.0, 0, true};
+  ModelResult cow_fork = {"cow-fork", interpreter, {}, 0.0, 0, true};
+  results.push_back(process);
+  results.push_back(cow_fork);
+
+  // The forking models go first, while this process is still small
+  bool ok = measure_process(emulator, halt_probe, spin_probe, samples, live,
+                            results[0]) &&
+            measure_cow_fork(samples, live, results[1]);
+  std::remove(halt_probe.c_str());
+  std::remove(spin_probe.c_str());
+  rmdir(scratch);
+  if (!ok)
+    return 1;
+  for (size_t m = 0; m < results.size(); m++)
+    results[m].fits = results[m].resident_kb > 0
+                          ? (long)(cap_kb / results[m].resident_kb)
+                          : 0;
+
+  for (int e = 0; e < NUM_ENGINES; e++) {
+    EngineKind engine = (EngineKind)e;
+    ModelResult in_process = {"in-process", ENGINE_NAMES[e], {}, 0.0, 0,
+                              false};
+    ModelResult pooled = {"pooled", ENGINE_NAMES[e], {}, 0.0, 0, false};
+    measure_in_process(engine, samples, in_process);
+    measure_pooled(engine, samples, pooled);
+    in_process.fits = fill_cap(engine, cap_kb, in_process.resident_kb);
+    pooled.fits = in_process.fits;
+    pooled.resident_kb = in_process.resident_kb;
+    results.push_back(in_process);
+    results.push_back(pooled);
+  }
+
+  std::cout << "VM object: CPU " << sizeof(CPU) << " bytes, Memory "
+            << sizeof(Memory) << " bytes" << std::endl;
+  std::cout << std::left << std::setw(12) << "Model" << std::setw(13)
+            << "Engine" << std::right << std::setw(14) << "Start us p50"
+            << std::setw(14) << "Start us max" << std::setw(12)
+            << "KB per VM" << std::setw(10) << "VMs in " << cap_mb << " MB"
+            << std::endl;
+  for (size_t m = 0; m < results.size(); m++) {
+    std::vector<double> &startup = results[m].startup_us;
+    std::sort(startup.begin(), startup.end());
+    std::cout << std::left << std::setw(12) << results[m].name
+              << std::setw(13) << results[m].engine << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14)
+              << startup[startup.size() / 2] << std::setw(14)
+              << startup.back() << std::setw(12) << results[m].resident_kb
+              << std::setw(10) << results[m].fits
+              << (results[m].extrapolated ? " *" : "") << std::endl;
+  }
+  std::cout << "* extrapolated from " << live << " live processes"
+            << std::endl;
+  return 0;
+}
@@ -54,7 +54,8 @@ enum Opcode {
   OP_PUSH = 0x28,
   OP_POP = 0x29,
 
-  // System (0x3F)
+  // System (0x3E-0x3F)
+  OP_BRK = 0x3E, // Reserved: planted by the debugger over a breakpoint
   OP_HALT = 0x3F
 };
 
@@ -75,7 +76,7 @@ const char *const OPCODE_NAMES[] = {
     "???",   "???",   "???",  "???",
     "???",   "???",   "???",  "???", // 0x30-0x37
     "???",   "???",   "???",  "???",
-    "???",   "???",   "???",  "HALT" // 0x38-0x3F
+    "???",   "???",   "BRK",  "HALT" // 0x38-0x3F
 };
 
 // Helper function to get opcode name
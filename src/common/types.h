@@ -40,6 +40,16 @@ const addr_t IO_TIMER_CTRL = 0xF002;  // Timer control register
 const addr_t IO_TIMER_VAL = 0xF003;   // Timer value register
 
 
+// Guest Runtime Library (lib/runtime.asm)
+
+const addr_t RUNTIME_HEAP_PTR = 0xEFFA;   // Bump allocator's next free byte
+const addr_t RUNTIME_HEAP_LIMIT = 0xEFFC; // Bump allocator's arena limit
+
+// Defined by the assembler and linker as the first byte after the .data
+// section; the runtime's default heap starts there
+const char *const DATA_END_SYMBOL = "__data_end";
+
+
 // CPU Architecture Parameters
 
 const int NUM_REGISTERS = 8; // R0-R7: general-purpose registers
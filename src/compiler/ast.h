@@ -0,0 +1,113 @@
+#ifndef AST_H
+#define AST_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lexical tokens
+
+enum TokenKind { TK_IDENT, TK_NUMBER, TK_STRING, TK_PUNCT, TK_EOF };
+
+struct Token {
+  TokenKind kind;
+  std::string text; // Identifier, punctuator or decoded string literal
+  int value;        // Numeric value (TK_NUMBER)
+  bool is_unsigned; // Number had a 'u' suffix or does not fit in int
+  int line;
+};
+
+// Expressions
+
+enum ExprKind {
+  E_NUMBER, // value
+  E_STRING, // text (only valid as a printf format)
+  E_VAR,    // name
+  E_INDEX,  // name[lhs]
+  E_CALL,   // name(args)
+  E_UNARY,  // op lhs        ('-', '!', '~')
+  E_BINARY, // lhs op rhs    (arithmetic, bitwise, comparison)
+  E_LOGAND, // lhs && rhs
+  E_LOGOR,  // lhs || rhs
+  E_COND,   // lhs ? args[0] : args[1]
+  E_ASSIGN, // lhs op= rhs   (op is "=" for plain assignment)
+  E_INCDEC  // ++lhs, lhs++, --lhs, lhs-- (op is "++" or "--")
+};
+
+struct Expr {
+  ExprKind kind;
+  int line;
+  int value;
+  bool is_unsigned; // Literal type (E_NUMBER)
+  bool postfix;     // E_INCDEC
+  std::string name;
+  std::string op;
+  std::string text;
+  std::unique_ptr<Expr> lhs;
+  std::unique_ptr<Expr> rhs;
+  std::vector<std::unique_ptr<Expr> > args;
+
+  Expr(ExprKind k, int l)
+      : kind(k), line(l), value(0), is_unsigned(false), postfix(false) {}
+};
+
+// Statements
+
+enum StmtKind {
+  S_EMPTY,
+  S_EXPR,     // expr
+  S_DECL,     // local declarations (decls)
+  S_BLOCK,    // { body }
+  S_IF,       // if (expr) body[0] [else body[1]]
+  S_WHILE,    // while (expr) body[0]
+  S_DO,       // do body[0] while (expr)
+  S_FOR,      // for (init; expr; step) body[0]
+  S_RETURN,   // return [expr]
+  S_BREAK,
+  S_CONTINUE
+};
+
+// A single declarator: "int x = 1", "unsigned a[4] = {1, 2}" or a parameter
+struct VarDecl {
+  std::string name;
+  bool is_unsigned;
+  bool is_array;
+  int array_size;                          // Elements (0 for array params)
+  std::unique_ptr<Expr> init;              // Scalar initializer
+  std::vector<std::unique_ptr<Expr> > init_list; // Array initializer
+  int line;
+
+  VarDecl() : is_unsigned(false), is_array(false), array_size(0), line(0) {}
+};
+
+struct Stmt {
+  StmtKind kind;
+  int line;
+  std::unique_ptr<Expr> expr;
+  std::unique_ptr<Stmt> init; // S_FOR
+  std::unique_ptr<Expr> step; // S_FOR
+  std::vector<std::unique_ptr<Stmt> > body;
+  std::vector<std::unique_ptr<VarDecl> > decls;
+
+  Stmt(StmtKind k, int l) : kind(k), line(l) {}
+};
+
+// Top level
+
+struct FunctionDecl {
+  std::string name;
+  bool returns_value;
+  bool returns_unsigned;
+  std::vector<std::unique_ptr<VarDecl> > params;
+  std::unique_ptr<Stmt> body; // Null for a prototype
+  int line;
+
+  FunctionDecl() : returns_value(true), returns_unsigned(false), line(0) {}
+};
+
+struct Program {
+  std::vector<std::unique_ptr<VarDecl> > globals;
+  std::vector<std::unique_ptr<FunctionDecl> > functions;
+};
+
+#endif // AST_H
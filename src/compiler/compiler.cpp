@@ -0,0 +1,94 @@
+/**
+ * C Subset Compiler
+ *
+ * Drives the pipeline for each function:
+ *   lexer -> parser -> IR generation -> CFG cleanup -> linear-scan
+ *   register allocation -> assembly emission
+ *
+ * The output is a plain .asm file for build/assembler, starting with a
+ * small startup stub that calls main and halts.
+ */
+
+#include "compiler.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+Compiler::Compiler()
+    : tok(0), error_count(0), next_global(DATA_START), fn(nullptr),
+      fn_decl(nullptr), cur_block(0), exit_block(0), ret_vreg(-1),
+      uses_frame(false), spill_bytes(0), frame_total(0), emit_fn(nullptr),
+      uses_software_stack(false), stat_functions(0), stat_spills(0),
+      stat_frames_elided(0) {}
+
+void Compiler::report_error(int line_number, const std::string &message) {
+  std::cerr << "Error on line " << line_number << ": " << message << std::endl;
+  error_count++;
+}
+
+bool Compiler::compile(const std::string &input_file,
+                       const std::string &output_file) {
+  std::ifstream infile(input_file);
+  if (!infile.is_open()) {
+    std::cerr << "Error: Could not open input file '" << input_file << "'"
+              << std::endl;
+    return false;
+  }
+  std::stringstream source;
+  source << infile.rdbuf();
+  infile.close();
+
+  std::cout << "Compiling '" << input_file << "'..." << std::endl;
+
+  if (!tokenize(source.str()) || !parse_program() || !declare_globals()) {
+    std::cerr << "Compilation failed" << std::endl;
+    return false;
+  }
+
+  // Compile each function down to assembly
+  for (size_t i = 0; i < program.functions.size(); i++) {
+    const FunctionDecl &decl = *program.functions[i];
+    if (!decl.body)
+      continue;
+    IrFunction ir;
+    if (!gen_function(decl, ir)) {
+      std::cerr << "Compilation failed in '" << decl.name << "'" << std::endl;
+      return false;
+    }
+    simplify_cfg(ir);
+    allocate_registers(ir);
+    uses_software_stack = uses_software_stack || uses_frame;
+    emit_function(ir);
+    stat_functions++;
+  }
+  if (next_global > COMPILER_SP_ADDR - 0x0400) {
+    std::cerr << "Error: Globals and constants do not fit in the data segment"
+              << std::endl;
+    return false;
+  }
+
+  // The startup stub must come first: it is the program entry point
+  std::vector<std::string> functions_text;
+  functions_text.swap(output);
+  output.push_back("; Compiled from " + input_file);
+  output.push_back("");
+  emit_startup();
+  output.insert(output.end(), functions_text.begin(), functions_text.end());
+  emit_helpers();
+
+  std::ofstream outfile(output_file);
+  if (!outfile.is_open()) {
+    std::cerr << "Error: Could not create output file '" << output_file << "'"
+              << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < output.size(); i++)
+    outfile << output[i] << "\n";
+  outfile.close();
+
+  std::cout << "Compiled " << stat_functions << " functions to '"
+            << output_file << "' (" << stat_spills << " spilled values, "
+            << stat_frames_elided << " without a frame)"
+            << std::endl;
+  return true;
+}
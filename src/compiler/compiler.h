@@ -0,0 +1,206 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "../common/types.h"
+#include "ast.h"
+#include "ir.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Software stack used for frames of functions with local arrays or spills.
+// The stack pointer itself lives in memory at COMPILER_SP_ADDR and frames
+// grow downward from COMPILER_STACK_TOP, below the runtime library's words;
+// globals are laid out upward from DATA_START.
+const addr_t COMPILER_SP_ADDR = DATA_END - 1;
+const addr_t COMPILER_STACK_TOP = RUNTIME_HEAP_PTR;
+const int MAX_PARAMS = 4; // Arguments are passed in R1..R4
+
+// Frame pointer and spill scratch registers (only reserved when needed)
+const int REG_FP = 7;
+const int REG_SCRATCH_A = 5;
+const int REG_SCRATCH_B = 6;
+
+struct GlobalSymbol {
+  addr_t address;
+  bool is_unsigned;
+  bool is_array;
+  int size; // Elements
+};
+
+enum LocalKind { LOCAL_SCALAR, LOCAL_ARRAY, LOCAL_ARRAY_PARAM };
+
+struct LocalSymbol {
+  LocalKind kind;
+  int vreg;   // LOCAL_SCALAR value or LOCAL_ARRAY_PARAM base address
+  int offset; // LOCAL_ARRAY offset in the frame
+  bool is_unsigned;
+};
+
+// Result of evaluating an expression: a folded constant or a vreg
+struct Value {
+  bool is_const;
+  int imm;
+  int vreg;
+  bool is_unsigned;
+};
+
+enum LValueKind { LV_VREG, LV_GLOBAL, LV_MEMORY };
+
+struct LValue {
+  LValueKind kind;
+  int vreg;    // LV_VREG variable or LV_MEMORY address
+  int address; // LV_GLOBAL
+  bool is_unsigned;
+};
+
+// Where the register allocator placed a vreg
+struct Location {
+  int reg;  // Physical register, or -1 when spilled
+  int slot; // Frame offset of the spill slot
+};
+
+class Compiler {
+private:
+  // Lexer state
+  std::vector<Token> tokens;
+  size_t tok;
+  int error_count;
+
+  // Parsed program and symbols
+  Program program;
+  std::map<std::string, GlobalSymbol> globals;
+  std::map<std::string, const FunctionDecl *> functions;
+  addr_t next_global;
+
+  // IR generation state for the function being compiled
+  IrFunction *fn;
+  const FunctionDecl *fn_decl;
+  int cur_block;
+  int exit_block;
+  int ret_vreg;
+  std::vector<std::map<std::string, LocalSymbol> > scopes;
+  std::vector<int> break_targets;
+  std::vector<int> continue_targets;
+  std::map<std::string, int> index_pointers; // Strength-reduced a[i]
+  std::set<std::string> helpers_used;
+
+  // Register allocation results for the function being emitted
+  std::vector<int> live_start; // Interval of each vreg (-2 if never live)
+  std::vector<int> live_end;
+  std::vector<Location> locations;
+  bool uses_frame;
+  int spill_bytes; // Spill slots, below the local arrays in the frame
+  int frame_total;
+
+  // Assembly output
+  std::vector<std::string> output;
+  const IrFunction *emit_fn;
+  bool uses_software_stack; // Some function has a frame
+  std::map<int, addr_t> constant_pool; // Value -> data address
+  int stat_functions;
+  int stat_spills;
+  int stat_frames_elided;
+
+  // Lexer (lexer.cpp)
+  bool tokenize(const std::string &source);
+
+  // Parser (parser.cpp)
+  const Token &peek(int ahead = 0) const;
+  bool is_punct(const char *p) const;
+  bool is_ident(const char *name) const;
+  bool accept(const char *p);
+  bool expect(const char *p);
+  bool is_type_start() const;
+  bool parse_type(bool &is_void, bool &is_unsigned);
+  bool parse_program();
+  bool parse_external();
+  bool parse_declarators(bool is_unsigned,
+                         std::vector<std::unique_ptr<VarDecl> > &out);
+  bool parse_params(FunctionDecl &fn);
+  std::unique_ptr<Stmt> parse_statement();
+  std::unique_ptr<Stmt> parse_block();
+  std::unique_ptr<Expr> parse_expr();
+  std::unique_ptr<Expr> parse_assign();
+  std::unique_ptr<Expr> parse_conditional();
+  std::unique_ptr<Expr> parse_binary(int min_prec);
+  std::unique_ptr<Expr> parse_unary();
+  std::unique_ptr<Expr> parse_postfix();
+  std::unique_ptr<Expr> parse_primary();
+  bool eval_const(const Expr *e, int &value);
+
+  // IR generation (irgen.cpp)
+  bool declare_globals();
+  bool gen_function(const FunctionDecl &decl, IrFunction &out);
+  int new_vreg();
+  int new_block();
+  IrInstr &emit(const IrInstr &instr);
+  bool block_terminated() const;
+  void emit_jump(int target);
+  void emit_branch(IrCond cond, const Value &a, const Value &b, int t, int f);
+  int to_vreg(const Value &v);
+  void assign_vreg(int var, const Value &v, int watermark);
+  Value const_value(int imm, bool is_unsigned);
+  Value vreg_value(int vreg, bool is_unsigned);
+  const LocalSymbol *find_local(const std::string &name) const;
+  bool gen_stmt(const Stmt &s);
+  bool gen_decl(const VarDecl &d);
+  bool gen_for(const Stmt &s);
+  bool gen_cond(const Expr &e, int t, int f);
+  bool gen_compare(const std::string &op, const Value &a, const Value &b,
+                   int t, int f);
+  bool gen_expr(const Expr &e, Value &out);
+  bool gen_binary(const std::string &op, const Value &a, const Value &b,
+                  int line, Value &out);
+  bool gen_call(const Expr &e, Value &out, bool want_value);
+  bool gen_printf(const Expr &e);
+  bool gen_array_address(const Expr &e, Value &out, bool &is_unsigned);
+  bool gen_lvalue(const Expr &e, LValue &out);
+  Value load_lvalue(const LValue &lv);
+  void store_lvalue(const LValue &lv, const Value &v, int watermark);
+  void gen_putchar(const Value &v);
+  bool find_induction_step(const Stmt &s, std::string &var, int &step);
+  bool assigns_to(const Stmt *s, const Expr *e, const std::string &name);
+  void collect_indexed_arrays(const Stmt *s, const Expr *e,
+                              const std::string &var,
+                              std::vector<std::string> &arrays);
+
+  // Optimization and register allocation (regalloc.cpp)
+  void simplify_cfg(IrFunction &f);
+  void allocate_registers(IrFunction &f);
+  bool linear_scan(IrFunction &f, int num_regs, const std::vector<int> &hint,
+                   int &spill_slots);
+
+  // Assembly emission (emitter.cpp)
+  void emit_line(const std::string &text);
+  void emit_label(const std::string &label);
+  std::string block_label(int block) const;
+  addr_t pool_address(int value);
+  void emit_constant(int reg, int value);
+  void emit_synthesized(int reg, int value);
+  void emit_frame_address(int reg, int offset);
+  void emit_spill_load(int reg, int slot);
+  void emit_spill_store(int reg, int slot);
+  int use_reg(int vreg, int scratch);
+  int def_reg(int vreg);
+  void finish_def(int vreg, int reg);
+  void emit_function(const IrFunction &f);
+  void emit_instruction(const IrInstr &in, int position, int next_block);
+  void emit_branch_jumps(IrCond cond, int t, int f, int next_block);
+  void emit_call(const IrInstr &in, int position);
+  void emit_frame_adjust(bool allocate);
+  void emit_startup();
+  void emit_helpers();
+
+  // Error reporting
+  void report_error(int line_number, const std::string &message);
+
+public:
+  Compiler();
+
+  // Compile a C source file into assembly for build/assembler
+  bool compile(const std::string &input_file, const std::string &output_file);
+};
+
+#endif // COMPILER_H
@@ -0,0 +1,620 @@
+/**
+ * Assembly Emitter
+ *
+ * Turns allocated IR into assembly accepted by build/assembler.
+ *
+ * Calling convention:
+ *   - Arguments in R1..R4, return value in R0
+ *   - Every register is caller-saved; call sites PUSH only the registers
+ *     holding values that are still needed after the call
+ *   - Functions with local arrays or spilled values get a frame on a
+ *     software stack whose pointer lives at COMPILER_SP_ADDR, with R7 as
+ *     the frame pointer. Functions without one have no prologue at all.
+ *
+ * Constants outside MOVI's range are read from a literal pool placed
+ * after the globals; the startup code fills the pool once.
+ */
+
+#include "compiler.h"
+#include <cstdio>
+
+static std::string reg_name(int reg) { return "R" + std::to_string(reg); }
+
+static std::string hex_address(int address) {
+  char text[8];
+  snprintf(text, sizeof(text), "0x%04X", address & 0xFFFF);
+  return text;
+}
+
+static bool fits_movi(int value) {
+  int16_t s = (int16_t)value;
+  return s >= -64 && s <= 63;
+}
+
+void Compiler::emit_line(const std::string &text) {
+  output.push_back("    " + text);
+}
+
+void Compiler::emit_label(const std::string &label) {
+  output.push_back(label + ":");
+}
+
+std::string Compiler::block_label(int block) const {
+  return "__" + emit_fn->name + "_" + std::to_string(block);
+}
+
+/**
+ * Data address of a pooled constant, allocated on first use
+ */
+addr_t Compiler::pool_address(int value) {
+  value &= 0xFFFF;
+  std::map<int, addr_t>::const_iterator it = constant_pool.find(value);
+  if (it != constant_pool.end())
+    return it->second;
+  addr_t address = next_global;
+  next_global = (addr_t)(next_global + 2);
+  constant_pool[value] = address;
+  return address;
+}
+
+/**
+ * Load a constant: one MOVI, or one LOAD from the literal pool
+ */
+void Compiler::emit_constant(int reg, int value) {
+  if (fits_movi(value)) {
+    emit_line("MOVI " + reg_name(reg) + ", " +
+              std::to_string((int16_t)value));
+    return;
+  }
+  emit_line("LOAD " + reg_name(reg) + ", " +
+            hex_address(pool_address(value)));
+}
+
+/**
+ * Build a constant from MOVI, SHLI and ORI alone (used before the pool
+ * has been filled). The top bits come from a sign-extended MOVI, then
+ * each remaining nonzero nibble is shifted in.
+ */
+void Compiler::emit_synthesized(int reg, int value) {
+  int16_t s = (int16_t)value;
+  int nibbles = 0;
+  while ((s >> (4 * nibbles)) < -64 || (s >> (4 * nibbles)) > 63)
+    nibbles++;
+  emit_line("MOVI " + reg_name(reg) + ", " +
+            std::to_string(s >> (4 * nibbles)));
+  int shift = 0;
+  for (int i = nibbles - 1; i >= 0; i--) {
+    shift += 4;
+    int nibble = (value >> (4 * i)) & 0x0F;
+    if (nibble == 0 && i > 0)
+      continue;
+    emit_line("SHLI " + reg_name(reg) + ", " + reg_name(reg) + ", " +
+              std::to_string(shift));
+    shift = 0;
+    if (nibble != 0)
+      emit_line("ORI " + reg_name(reg) + ", " + reg_name(reg) + ", " +
+                std::to_string(nibble));
+  }
+}
+
+void Compiler::emit_frame_address(int reg, int offset) {
+  if (offset == 0) {
+    emit_line("MOV " + reg_name(reg) + ", " + reg_name(REG_FP));
+  } else if (offset <= 7) {
+    emit_line("ADDI " + reg_name(reg) + ", " + reg_name(REG_FP) + ", " +
+              std::to_string(offset));
+  } else {
+    emit_constant(reg, offset);
+    emit_line("ADD " + reg_name(reg) + ", " + reg_name(reg) + ", " +
+              reg_name(REG_FP));
+  }
+}
+
+void Compiler::emit_spill_load(int reg, int slot) {
+  int address = REG_FP;
+  if (slot != 0) {
+    emit_frame_address(reg, slot);
+    address = reg;
+  }
+  emit_line("LOAD " + reg_name(reg) + ", [" + reg_name(address) + "]");
+}
+
+void Compiler::emit_spill_store(int reg, int slot) {
+  int address = REG_FP;
+  if (slot != 0) {
+    emit_frame_address(REG_SCRATCH_B, slot);
+    address = REG_SCRATCH_B;
+  }
+  emit_line("STORE " + reg_name(reg) + ", [" + reg_name(address) + "]");
+}
+
+/**
+ * Register holding vreg for reading; spilled values are reloaded into
+ * the given scratch register
+ */
+int Compiler::use_reg(int vreg, int scratch) {
+  if (locations[vreg].reg >= 0)
+    return locations[vreg].reg;
+  emit_spill_load(scratch, locations[vreg].slot);
+  return scratch;
+}
+
+int Compiler::def_reg(int vreg) {
+  return locations[vreg].reg >= 0 ? locations[vreg].reg : REG_SCRATCH_A;
+}
+
+void Compiler::finish_def(int vreg, int reg) {
+  if (locations[vreg].reg < 0)
+    emit_spill_store(reg, locations[vreg].slot);
+}
+
+/**
+ * Move the software stack pointer to allocate or release the frame
+ * R6 is free here: only parameters (R1..R4) or the result (R0) are live
+ */
+void Compiler::emit_frame_adjust(bool allocate) {
+  std::string fp = reg_name(REG_FP);
+  if (frame_total <= 7) {
+    emit_line(std::string(allocate ? "SUBI " : "ADDI ") + fp + ", " + fp +
+              ", " + std::to_string(frame_total));
+  } else {
+    emit_constant(REG_SCRATCH_B, frame_total);
+    emit_line(std::string(allocate ? "SUB " : "ADD ") + fp + ", " + fp + ", " +
+              reg_name(REG_SCRATCH_B));
+  }
+  emit_line("STORE " + fp + ", " + hex_address(COMPILER_SP_ADDR));
+}
+
+void Compiler::emit_function(const IrFunction &f) {
+  emit_fn = &f;
+  output.push_back("");
+  output.push_back("; " + f.name + (uses_frame ? " (frame: " +
+                                                    std::to_string(frame_total) +
+                                                    " bytes)"
+                                              : ""));
+  emit_label(f.name);
+
+  if (uses_frame) {
+    emit_line("LOAD " + reg_name(REG_FP) + ", " +
+              hex_address(COMPILER_SP_ADDR));
+    emit_frame_adjust(true);
+    for (size_t i = 0; i < f.params.size(); i++) {
+      int v = f.params[i];
+      if (live_start[v] != -2 && locations[v].reg < 0)
+        emit_spill_store(1 + (int)i, locations[v].slot);
+    }
+  }
+
+  // Only blocks that are jumped to get a label, so straight-line leaf
+  // functions stay inlinable by the assembler's -O pass
+  std::set<int> targets;
+  for (size_t i = 0; i < f.layout.size(); i++) {
+    const IrInstr &term = f.blocks[f.layout[i]].code.back();
+    int next = i + 1 < f.layout.size() ? f.layout[i + 1] : -1;
+    if (term.op == IR_RET)
+      continue;
+    if (term.target != next || term.cond == C_MI)
+      targets.insert(term.target);
+    if ((term.op == IR_BR || term.op == IR_BRI) && term.target2 != next)
+      targets.insert(term.target2);
+  }
+
+  int position = 0;
+  for (size_t i = 0; i < f.layout.size(); i++) {
+    int b = f.layout[i];
+    int next = i + 1 < f.layout.size() ? f.layout[i + 1] : -1;
+    if (targets.count(b))
+      emit_label(block_label(b));
+    const std::vector<IrInstr> &code = f.blocks[b].code;
+    for (size_t j = 0; j < code.size(); j++)
+      emit_instruction(code[j], position++, next);
+  }
+}
+
+static const char *ALU_MNEMONICS[] = {
+    nullptr, nullptr, "ADD",  "SUB",  "MUL",  "DIV",  "AND",  "OR",
+    "XOR",   "SHL",   "SHR",  "ADDI", "SUBI", "ANDI", "ORI",  "SHLI",
+    "SHRI"};
+
+void Compiler::emit_instruction(const IrInstr &in, int position,
+                                int next_block) {
+  // Values nobody reads (e.g. an ignored getchar()) have no location
+  if (in.op != IR_CALL && in.dst >= 0 && live_start[in.dst] == -2)
+    return;
+
+  switch (in.op) {
+  case IR_LI: {
+    int d = def_reg(in.dst);
+    emit_constant(d, in.imm);
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_MOV: {
+    int s = use_reg(in.a, REG_SCRATCH_A);
+    if (locations[in.dst].reg < 0) {
+      emit_spill_store(s, locations[in.dst].slot);
+    } else if (locations[in.dst].reg != s) {
+      emit_line("MOV " + reg_name(locations[in.dst].reg) + ", " +
+                reg_name(s));
+    }
+    break;
+  }
+
+  case IR_ADD:
+  case IR_SUB:
+  case IR_MUL:
+  case IR_DIV:
+  case IR_AND:
+  case IR_OR:
+  case IR_XOR:
+  case IR_SHL:
+  case IR_SHR: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    int y = use_reg(in.b, REG_SCRATCH_B);
+    int d = def_reg(in.dst);
+    emit_line(std::string(ALU_MNEMONICS[in.op]) + " " + reg_name(d) + ", " +
+              reg_name(x) + ", " + reg_name(y));
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_ADDI:
+  case IR_SUBI:
+  case IR_ANDI:
+  case IR_ORI:
+  case IR_SHLI:
+  case IR_SHRI: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    int d = def_reg(in.dst);
+    int imm = (in.op == IR_ADDI || in.op == IR_SUBI) ? (int16_t)in.imm
+                                                     : in.imm & 0x0F;
+    emit_line(std::string(ALU_MNEMONICS[in.op]) + " " + reg_name(d) + ", " +
+              reg_name(x) + ", " + std::to_string(imm));
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_NOT: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    int d = def_reg(in.dst);
+    emit_line("NOT " + reg_name(d) + ", " + reg_name(x));
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_LOAD: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    int d = def_reg(in.dst);
+    emit_line("LOAD " + reg_name(d) + ", [" + reg_name(x) + "]");
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_STORE: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    int y = use_reg(in.b, REG_SCRATCH_B);
+    emit_line("STORE " + reg_name(y) + ", [" + reg_name(x) + "]");
+    break;
+  }
+
+  case IR_LOADG: {
+    int d = def_reg(in.dst);
+    emit_line("LOAD " + reg_name(d) + ", " + hex_address(in.imm));
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_STOREG: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    emit_line("STORE " + reg_name(x) + ", " + hex_address(in.imm));
+    break;
+  }
+
+  case IR_FRAME: {
+    int d = def_reg(in.dst);
+    emit_frame_address(d, spill_bytes + in.imm);
+    finish_def(in.dst, d);
+    break;
+  }
+
+  case IR_CALL:
+    emit_call(in, position);
+    break;
+
+  case IR_BR:
+  case IR_BRI: {
+    int x = use_reg(in.a, REG_SCRATCH_A);
+    if (in.op == IR_BR) {
+      int y = use_reg(in.b, REG_SCRATCH_B);
+      emit_line("CMP " + reg_name(x) + ", " + reg_name(y));
+    } else {
+      emit_line("CMPI " + reg_name(x) + ", " +
+                std::to_string((int16_t)in.imm));
+    }
+    emit_branch_jumps(in.cond, in.target, in.target2, next_block);
+    break;
+  }
+
+  case IR_JMP:
+    if (in.target != next_block)
+      emit_line("JMP " + block_label(in.target));
+    break;
+
+  case IR_RET:
+    if (in.a >= 0 && live_start[in.a] != -2) {
+      if (locations[in.a].reg < 0)
+        emit_spill_load(0, locations[in.a].slot);
+      else if (locations[in.a].reg != 0)
+        emit_line("MOV R0, " + reg_name(locations[in.a].reg));
+    }
+    if (uses_frame)
+      emit_frame_adjust(false);
+    emit_line("RET");
+    break;
+  }
+}
+
+/**
+ * Emit the jumps after a compare, falling through where possible
+ */
+void Compiler::emit_branch_jumps(IrCond cond, int t, int f, int next_block) {
+  static const char *const JUMPS[] = {"JZ", "JNZ", "JC", "JNC", "JN", nullptr};
+  static const IrCond INVERSE[] = {C_NE, C_EQ, C_GEU, C_LTU, C_PL, C_MI};
+
+  if (f == next_block) {
+    emit_line(std::string(JUMPS[cond]) + " " + block_label(t));
+    return;
+  }
+  if (t == next_block && JUMPS[INVERSE[cond]]) {
+    emit_line(std::string(JUMPS[INVERSE[cond]]) + " " + block_label(f));
+    return;
+  }
+  // There is no jump-if-positive, so a sign test that must jump on the
+  // false edge uses JN plus JMP
+  emit_line(std::string(JUMPS[cond]) + " " + block_label(t));
+  emit_line("JMP " + block_label(f));
+}
+
+/**
+ * Emit a call: save live registers, move arguments into R1..R4, CALL,
+ * fetch the result from R0 and restore the saved registers
+ */
+void Compiler::emit_call(const IrInstr &in, int position) {
+  std::vector<int> saved;
+  bool is_saved[NUM_REGISTERS] = {false};
+  for (size_t v = 0; v < locations.size(); v++) {
+    int reg = locations[v].reg;
+    if (reg >= 0 && (int)v != in.dst && live_start[v] < position &&
+        live_end[v] > position)
+      is_saved[reg] = true;
+  }
+  if (uses_frame)
+    is_saved[REG_FP] = true;
+  for (int r = 0; r < NUM_REGISTERS; r++) {
+    if (is_saved[r]) {
+      saved.push_back(r);
+      emit_line("PUSH " + reg_name(r));
+    }
+  }
+
+  // Parallel move of register arguments; cycles are broken with a
+  // register that is neither a source nor a destination
+  std::vector<std::pair<int, int> > moves; // (destination, source)
+  for (size_t i = 0; i < in.args.size(); i++) {
+    int reg = locations[in.args[i]].reg;
+    if (reg >= 0 && reg != 1 + (int)i)
+      moves.push_back(std::make_pair(1 + (int)i, reg));
+  }
+  while (!moves.empty()) {
+    size_t ready = moves.size();
+    for (size_t i = 0; i < moves.size() && ready == moves.size(); i++) {
+      bool blocked = false;
+      for (size_t j = 0; j < moves.size(); j++)
+        blocked = blocked || (j != i && moves[j].second == moves[i].first);
+      if (!blocked)
+        ready = i;
+    }
+    if (ready < moves.size()) {
+      emit_line("MOV " + reg_name(moves[ready].first) + ", " +
+                reg_name(moves[ready].second));
+      moves.erase(moves.begin() + ready);
+      continue;
+    }
+    int temp = -1;
+    for (int r = 0; r < NUM_REGISTERS && temp < 0; r++) {
+      bool busy = uses_frame && r == REG_FP;
+      for (size_t j = 0; j < moves.size(); j++)
+        busy = busy || moves[j].first == r || moves[j].second == r;
+      if (!busy)
+        temp = r;
+    }
+    int freed = moves[0].first;
+    emit_line("MOV " + reg_name(temp) + ", " + reg_name(freed));
+    for (size_t j = 0; j < moves.size(); j++) {
+      if (moves[j].second == freed)
+        moves[j].second = temp;
+    }
+  }
+  for (size_t i = 0; i < in.args.size(); i++) {
+    if (locations[in.args[i]].reg < 0)
+      emit_spill_load(1 + (int)i, locations[in.args[i]].slot);
+  }
+
+  emit_line("CALL " + in.callee);
+
+  // A spilled result is stored once the frame pointer (pushed last, so
+  // popped first) is back, and before R0 itself could be restored
+  bool spill_result = in.dst >= 0 && live_start[in.dst] != -2 &&
+                      locations[in.dst].reg < 0;
+  if (in.dst >= 0 && live_start[in.dst] != -2 && locations[in.dst].reg > 0)
+    emit_line("MOV " + reg_name(locations[in.dst].reg) + ", R0");
+  for (size_t i = saved.size(); i-- > 0;) {
+    emit_line("POP " + reg_name(saved[i]));
+    if (spill_result && saved[i] == REG_FP) {
+      emit_spill_store(0, locations[in.dst].slot);
+      spill_result = false;
+    }
+  }
+  if (spill_result)
+    emit_spill_store(0, locations[in.dst].slot);
+}
+
+/**
+ * Program entry: set up the software stack pointer, fill the literal
+ * pool and initialized globals, then run main
+ */
+void Compiler::emit_startup() {
+  emit_label("__start");
+
+  std::map<addr_t, int> initial; // Address -> nonzero initial value
+  if (uses_software_stack)
+    initial[COMPILER_SP_ADDR] = COMPILER_STACK_TOP;
+  for (std::map<int, addr_t>::const_iterator it = constant_pool.begin();
+       it != constant_pool.end(); ++it)
+    initial[it->second] = it->first;
+  for (size_t i = 0; i < program.globals.size(); i++) {
+    const VarDecl &d = *program.globals[i];
+    addr_t address = globals[d.name].address;
+    int value = 0;
+    if (d.init && eval_const(d.init.get(), value) && value != 0)
+      initial[address] = value & 0xFFFF;
+    for (size_t j = 0; j < d.init_list.size(); j++) {
+      if (eval_const(d.init_list[j].get(), value) && value != 0)
+        initial[(addr_t)(address + 2 * j)] = value & 0xFFFF;
+    }
+  }
+
+  int loaded = -1;
+  for (std::map<addr_t, int>::const_iterator it = initial.begin();
+       it != initial.end(); ++it) {
+    if (it->second != loaded)
+      emit_synthesized(0, it->second);
+    loaded = it->second;
+    emit_line("STORE R0, " + hex_address(it->first));
+  }
+
+  emit_line("CALL main");
+  emit_line("HALT");
+}
+
+/**
+ * Runtime helpers used by printf and signed division
+ */
+void Compiler::emit_helpers() {
+  bool print_int = helpers_used.count("__print_int") > 0;
+  bool print_uint = print_int || helpers_used.count("__print_uint") > 0;
+  std::string out = hex_address(IO_CONSOLE_OUT);
+
+  if (print_uint) {
+    output.push_back("");
+    output.push_back("; Print R1 in decimal");
+    if (print_int) {
+      emit_label("__print_int");
+      emit_line("CMPI R1, 0");
+      emit_line("JN __print_int_negative");
+    }
+    emit_label("__print_uint");
+    emit_line("MOVI R2, 10");
+    emit_line("MOVI R3, 0");
+    emit_label("__print_uint_digit");
+    emit_line("DIV R0, R1, R2");
+    emit_line("MUL R4, R0, R2");
+    emit_line("SUB R4, R1, R4");
+    emit_line("PUSH R4");
+    emit_line("INC R3");
+    emit_line("MOV R1, R0");
+    emit_line("CMPI R1, 0");
+    emit_line("JNZ __print_uint_digit");
+    emit_line("MOVI R5, 48");
+    emit_label("__print_uint_out");
+    emit_line("POP R4");
+    emit_line("ADD R4, R4, R5");
+    emit_line("STORE R4, " + out);
+    emit_line("DEC R3");
+    emit_line("JNZ __print_uint_out");
+    emit_line("RET");
+    if (print_int) {
+      emit_label("__print_int_negative");
+      emit_line("MOVI R0, 45");
+      emit_line("STORE R0, " + out);
+      emit_line("NOT R1, R1");
+      emit_line("INC R1");
+      emit_line("JMP __print_uint");
+    }
+  }
+
+  if (helpers_used.count("__print_hex")) {
+    output.push_back("");
+    output.push_back("; Print R1 in hexadecimal");
+    emit_label("__print_hex");
+    emit_line("MOVI R3, 0");
+    emit_label("__print_hex_digit");
+    emit_line("ANDI R4, R1, 15");
+    emit_line("PUSH R4");
+    emit_line("INC R3");
+    emit_line("SHRI R1, R1, 4");
+    emit_line("CMPI R1, 0");
+    emit_line("JNZ __print_hex_digit");
+    emit_line("MOVI R2, 10");
+    emit_line("MOVI R5, 48");
+    emit_line("MOVI R6, 39");
+    emit_label("__print_hex_out");
+    emit_line("POP R4");
+    emit_line("CMP R4, R2");
+    emit_line("JC __print_hex_decimal");
+    emit_line("ADD R4, R4, R6");
+    emit_label("__print_hex_decimal");
+    emit_line("ADD R4, R4, R5");
+    emit_line("STORE R4, " + out);
+    emit_line("DEC R3");
+    emit_line("JNZ __print_hex_out");
+    emit_line("RET");
+  }
+
+  bool divs = helpers_used.count("__divs") > 0;
+  bool mods = helpers_used.count("__mods") > 0;
+  if (!divs && !mods)
+    return;
+
+  output.push_back("");
+  output.push_back("; Signed R1 / R2 and R1 % R2 via unsigned DIV");
+  if (divs) {
+    emit_label("__divs");
+    emit_line("XOR R6, R1, R2");
+    emit_line("CALL __abs_operands");
+    emit_line("DIV R0, R1, R2");
+    emit_line("JMP __apply_sign");
+  }
+  if (mods) {
+    emit_label("__mods");
+    emit_line("MOV R6, R1");
+    emit_line("CALL __abs_operands");
+    emit_line("DIV R0, R1, R2");
+    emit_line("MUL R0, R0, R2");
+    emit_line("SUB R0, R1, R0");
+  }
+  emit_label("__apply_sign");
+  emit_line("CMPI R6, 0");
+  emit_line("JN __apply_sign_negate");
+  emit_line("RET");
+  emit_label("__apply_sign_negate");
+  emit_line("NOT R0, R0");
+  emit_line("INC R0");
+  emit_line("RET");
+  emit_label("__abs_operands");
+  emit_line("CMPI R1, 0");
+  emit_line("JN __abs_operands_negate1");
+  emit_label("__abs_operands_check2");
+  emit_line("CMPI R2, 0");
+  emit_line("JN __abs_operands_negate2");
+  emit_line("RET");
+  emit_label("__abs_operands_negate1");
+  emit_line("NOT R1, R1");
+  emit_line("INC R1");
+  emit_line("JMP __abs_operands_check2");
+  emit_label("__abs_operands_negate2");
+  emit_line("NOT R2, R2");
+  emit_line("INC R2");
+  emit_line("RET");
+}
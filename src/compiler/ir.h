@@ -0,0 +1,87 @@
+#ifndef IR_H
+#define IR_H
+
+#include <string>
+#include <vector>
+
+// Three-address intermediate representation over virtual registers.
+// Each function is a list of basic blocks; the last instruction of a
+// block is its terminator (IR_BR, IR_BRI, IR_JMP or IR_RET).
+
+enum IrOp {
+  IR_LI,  // dst = imm
+  IR_MOV, // dst = a
+
+  // dst = a op b
+  IR_ADD,
+  IR_SUB,
+  IR_MUL,
+  IR_DIV, // Unsigned
+  IR_AND,
+  IR_OR,
+  IR_XOR,
+  IR_SHL,
+  IR_SHR, // Logical
+
+  // dst = a op imm (imm must fit the 4-bit field of the instruction)
+  IR_ADDI,
+  IR_SUBI,
+  IR_ANDI,
+  IR_ORI,
+  IR_SHLI,
+  IR_SHRI,
+
+  IR_NOT,    // dst = ~a
+  IR_LOAD,   // dst = [a]
+  IR_STORE,  // [a] = b
+  IR_LOADG,  // dst = [imm]
+  IR_STOREG, // [imm] = a
+  IR_FRAME,  // dst = frame base + imm
+  IR_CALL,   // dst = callee(args), dst may be -1
+
+  // Terminators
+  IR_BR,  // if (a cond b) goto target else target2
+  IR_BRI, // if (a cond imm) goto target else target2
+  IR_JMP, // goto target
+  IR_RET  // return a, a may be -1
+};
+
+// Branch conditions. C_MI/C_PL test the sign of a alone.
+enum IrCond { C_EQ, C_NE, C_LTU, C_GEU, C_MI, C_PL };
+
+struct IrInstr {
+  IrOp op;
+  int dst;
+  int a;
+  int b;
+  int imm;
+  IrCond cond;
+  int target;
+  int target2;
+  std::string callee;
+  std::vector<int> args;
+
+  IrInstr(IrOp o)
+      : op(o), dst(-1), a(-1), b(-1), imm(0), cond(C_EQ), target(-1),
+        target2(-1) {}
+};
+
+struct IrBlock {
+  std::vector<IrInstr> code;
+};
+
+struct IrFunction {
+  std::string name;
+  std::vector<int> params; // Vreg of each parameter, passed in R1..R4
+  std::vector<IrBlock> blocks;
+  std::vector<int> layout; // Reachable blocks in emission order
+  int exit_block;          // Single block holding the IR_RET
+  int num_vregs;
+  int frame_size; // Bytes of local arrays in the software stack frame
+  bool has_calls;
+
+  IrFunction()
+      : exit_block(-1), num_vregs(0), frame_size(0), has_calls(false) {}
+};
+
+#endif // IR_H
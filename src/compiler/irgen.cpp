@@ -0,0 +1,1439 @@
+/**
+ * IR Generation
+ *
+ * Lowers the AST of each function into the three-address IR of ir.h.
+ * Constants are folded as expressions are generated, and operations are
+ * strength-reduced where the ISA has a cheaper form:
+ *   - multiply by a power of two becomes SHLI
+ *   - unsigned divide/modulo by a power of two become SHRI/ANDI
+ *   - small constants use the immediate forms (ADDI, CMPI, ...)
+ *   - a[i] inside a for loop stepping i by a constant becomes a pointer
+ *     that is advanced alongside i instead of re-scaling i every access
+ *
+ * Signed comparisons have no direct branch in this ISA (there is no
+ * branch on overflow), so they are lowered to unsigned compares plus
+ * sign tests.
+ */
+
+#include "compiler.h"
+#include <iostream>
+
+static bool fits_simm4(int v) { return v <= 7 || v >= 0xFFF8; }
+static bool fits_uimm4(int v) { return v >= 0 && v <= 15; }
+
+static int log2_exact(int v) {
+  for (int k = 0; k < 16; k++) {
+    if (v == (1 << k))
+      return k;
+  }
+  return -1;
+}
+
+static bool is_comparison(const std::string &op) {
+  return op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" ||
+         op == ">=";
+}
+
+/**
+ * Lay out globals upward from DATA_START and index the functions
+ */
+bool Compiler::declare_globals() {
+  next_global = DATA_START;
+
+  for (size_t i = 0; i < program.functions.size(); i++) {
+    const FunctionDecl *f = program.functions[i].get();
+    std::map<std::string, const FunctionDecl *>::iterator it =
+        functions.find(f->name);
+    if (it != functions.end()) {
+      if (it->second->body && f->body) {
+        report_error(f->line, "Redefinition of function '" + f->name + "'");
+        return false;
+      }
+      if (it->second->params.size() != f->params.size()) {
+        report_error(f->line, "Conflicting declaration of '" + f->name + "'");
+        return false;
+      }
+      if (!f->body)
+        continue;
+    }
+    functions[f->name] = f;
+  }
+
+  for (size_t i = 0; i < program.globals.size(); i++) {
+    const VarDecl &d = *program.globals[i];
+    if (globals.count(d.name) || functions.count(d.name)) {
+      report_error(d.line, "Redefinition of '" + d.name + "'");
+      return false;
+    }
+    GlobalSymbol g;
+    g.address = next_global;
+    g.is_unsigned = d.is_unsigned;
+    g.is_array = d.is_array;
+    g.size = d.is_array ? d.array_size : 1;
+    if ((long)next_global + 2L * g.size > (long)COMPILER_SP_ADDR - 0x0400) {
+      report_error(d.line, "Globals do not fit in the data segment");
+      return false;
+    }
+    next_global = (addr_t)(next_global + 2 * g.size);
+    globals[d.name] = g;
+
+    // Initial values are stored by the startup code, so must be constant
+    int value;
+    if (d.init && !eval_const(d.init.get(), value))
+      return false;
+    for (size_t j = 0; j < d.init_list.size(); j++) {
+      if (!eval_const(d.init_list[j].get(), value))
+        return false;
+    }
+  }
+
+  if (!functions.count("main") || !functions["main"]->body) {
+    report_error(1, "No definition of 'main'");
+    return false;
+  }
+  return true;
+}
+
+int Compiler::new_vreg() { return fn->num_vregs++; }
+
+int Compiler::new_block() {
+  fn->blocks.push_back(IrBlock());
+  return (int)fn->blocks.size() - 1;
+}
+
+bool Compiler::block_terminated() const {
+  const std::vector<IrInstr> &code = fn->blocks[cur_block].code;
+  if (code.empty())
+    return false;
+  IrOp op = code.back().op;
+  return op == IR_BR || op == IR_BRI || op == IR_JMP || op == IR_RET;
+}
+
+/**
+ * Append an instruction to the current block
+ * Code after a terminator (e.g. after return) goes to a fresh block that
+ * nothing jumps to, and is removed later as unreachable
+ */
+IrInstr &Compiler::emit(const IrInstr &instr) {
+  if (block_terminated())
+    cur_block = new_block();
+  fn->blocks[cur_block].code.push_back(instr);
+  return fn->blocks[cur_block].code.back();
+}
+
+void Compiler::emit_jump(int target) {
+  IrInstr j(IR_JMP);
+  j.target = target;
+  emit(j);
+}
+
+Value Compiler::const_value(int imm, bool is_unsigned) {
+  Value v;
+  v.is_const = true;
+  v.imm = imm & 0xFFFF;
+  v.vreg = -1;
+  v.is_unsigned = is_unsigned;
+  return v;
+}
+
+Value Compiler::vreg_value(int vreg, bool is_unsigned) {
+  Value v;
+  v.is_const = false;
+  v.imm = 0;
+  v.vreg = vreg;
+  v.is_unsigned = is_unsigned;
+  return v;
+}
+
+int Compiler::to_vreg(const Value &v) {
+  if (!v.is_const)
+    return v.vreg;
+  IrInstr li(IR_LI);
+  li.dst = new_vreg();
+  li.imm = v.imm;
+  emit(li);
+  return li.dst;
+}
+
+/**
+ * Emit "dst = a op b" or "dst = a op imm" into a new vreg
+ */
+static IrInstr make_op(IrOp op, int dst, int a, int b, int imm) {
+  IrInstr in(op);
+  in.dst = dst;
+  in.a = a;
+  in.b = b;
+  in.imm = imm;
+  return in;
+}
+
+/**
+ * Emit a conditional branch comparing a with b
+ * Constants that fit CMPI's sign-extended 4-bit field use IR_BRI
+ */
+void Compiler::emit_branch(IrCond cond, const Value &a, const Value &b,
+                           int t, int f) {
+  IrInstr br(IR_BR);
+  br.cond = cond;
+  br.target = t;
+  br.target2 = f;
+  br.a = to_vreg(a);
+  if (cond == C_MI || cond == C_PL) {
+    br.op = IR_BRI;
+    br.imm = 0;
+  } else if (b.is_const && fits_simm4(b.imm)) {
+    br.op = IR_BRI;
+    br.imm = b.imm;
+  } else {
+    br.b = to_vreg(b);
+  }
+  emit(br);
+}
+
+/**
+ * Store a value into a variable's vreg
+ * When the value was just computed into a fresh temporary, the defining
+ * instruction is retargeted to the variable instead of adding a MOV
+ */
+void Compiler::assign_vreg(int var, const Value &v, int watermark) {
+  if (v.is_const) {
+    IrInstr li(IR_LI);
+    li.dst = var;
+    li.imm = v.imm;
+    emit(li);
+    return;
+  }
+  if (v.vreg == var)
+    return;
+  std::vector<IrInstr> &code = fn->blocks[cur_block].code;
+  if (v.vreg >= watermark && !code.empty() && code.back().dst == v.vreg) {
+    code.back().dst = var;
+    return;
+  }
+  emit(make_op(IR_MOV, var, v.vreg, -1, 0));
+}
+
+const LocalSymbol *Compiler::find_local(const std::string &name) const {
+  for (size_t i = scopes.size(); i-- > 0;) {
+    std::map<std::string, LocalSymbol>::const_iterator it =
+        scopes[i].find(name);
+    if (it != scopes[i].end())
+      return &it->second;
+  }
+  return nullptr;
+}
+
+bool Compiler::gen_function(const FunctionDecl &decl, IrFunction &out) {
+  fn = &out;
+  fn_decl = &decl;
+  fn->name = decl.name;
+  scopes.clear();
+  scopes.push_back(std::map<std::string, LocalSymbol>());
+  break_targets.clear();
+  continue_targets.clear();
+  index_pointers.clear();
+
+  cur_block = new_block();
+  exit_block = new_block();
+  fn->exit_block = exit_block;
+
+  for (size_t i = 0; i < decl.params.size(); i++) {
+    const VarDecl &p = *decl.params[i];
+    if (scopes[0].count(p.name)) {
+      report_error(p.line, "Duplicate parameter '" + p.name + "'");
+      return false;
+    }
+    LocalSymbol sym;
+    sym.kind = p.is_array ? LOCAL_ARRAY_PARAM : LOCAL_SCALAR;
+    sym.vreg = new_vreg();
+    sym.offset = 0;
+    sym.is_unsigned = p.is_unsigned;
+    scopes[0][p.name] = sym;
+    fn->params.push_back(sym.vreg);
+  }
+  ret_vreg = decl.returns_value ? new_vreg() : -1;
+
+  if (!gen_stmt(*decl.body))
+    return false;
+  if (!block_terminated())
+    emit_jump(exit_block);
+
+  cur_block = exit_block;
+  IrInstr ret(IR_RET);
+  ret.a = ret_vreg;
+  fn->blocks[exit_block].code.push_back(ret);
+  return true;
+}
+
+bool Compiler::gen_decl(const VarDecl &d) {
+  if (scopes.back().count(d.name)) {
+    report_error(d.line, "Redefinition of '" + d.name + "'");
+    return false;
+  }
+
+  LocalSymbol sym;
+  sym.is_unsigned = d.is_unsigned;
+  sym.offset = 0;
+  sym.vreg = -1;
+
+  if (!d.is_array) {
+    sym.kind = LOCAL_SCALAR;
+    sym.vreg = new_vreg();
+    if (d.init) {
+      int watermark = fn->num_vregs;
+      Value v;
+      if (!gen_expr(*d.init, v))
+        return false;
+      assign_vreg(sym.vreg, v, watermark);
+    }
+    scopes.back()[d.name] = sym;
+    return true;
+  }
+
+  // Local arrays live in the software stack frame
+  sym.kind = LOCAL_ARRAY;
+  sym.offset = fn->frame_size;
+  fn->frame_size += 2 * d.array_size;
+  scopes.back()[d.name] = sym;
+
+  if (d.init_list.empty())
+    return true;
+
+  // Elements without an initializer are zeroed, as in C
+  int base = new_vreg();
+  IrInstr frame(IR_FRAME);
+  frame.dst = base;
+  frame.imm = sym.offset;
+  emit(frame);
+  int zero = -1;
+  for (int i = 0; i < d.array_size; i++) {
+    int value;
+    if (i < (int)d.init_list.size()) {
+      Value v;
+      if (!gen_expr(*d.init_list[i], v))
+        return false;
+      value = to_vreg(v);
+    } else {
+      if (zero < 0)
+        zero = to_vreg(const_value(0, false));
+      value = zero;
+    }
+    int addr = base;
+    if (i > 0) {
+      addr = new_vreg();
+      emit(make_op(IR_ADDI, addr, base, -1, 0));
+      if (fits_simm4(2 * i)) {
+        fn->blocks[cur_block].code.back().imm = 2 * i;
+      } else {
+        fn->blocks[cur_block].code.back() =
+            make_op(IR_ADD, addr, base, to_vreg(const_value(2 * i, true)), 0);
+      }
+    }
+    IrInstr st(IR_STORE);
+    st.a = addr;
+    st.b = value;
+    emit(st);
+  }
+  return true;
+}
+
+bool Compiler::gen_stmt(const Stmt &s) {
+  switch (s.kind) {
+  case S_EMPTY:
+    return true;
+
+  case S_EXPR: {
+    Value v;
+    if (s.expr->kind == E_CALL)
+      return gen_call(*s.expr, v, false);
+    return gen_expr(*s.expr, v);
+  }
+
+  case S_DECL:
+    for (size_t i = 0; i < s.decls.size(); i++) {
+      if (!gen_decl(*s.decls[i]))
+        return false;
+    }
+    return true;
+
+  case S_BLOCK: {
+    scopes.push_back(std::map<std::string, LocalSymbol>());
+    for (size_t i = 0; i < s.body.size(); i++) {
+      if (!gen_stmt(*s.body[i]))
+        return false;
+    }
+    scopes.pop_back();
+    return true;
+  }
+
+  case S_IF: {
+    int then_block = new_block();
+    int else_block = s.body.size() > 1 ? new_block() : -1;
+    int join = new_block();
+    if (!gen_cond(*s.expr, then_block, else_block >= 0 ? else_block : join))
+      return false;
+    cur_block = then_block;
+    if (!gen_stmt(*s.body[0]))
+      return false;
+    emit_jump(join);
+    if (else_block >= 0) {
+      cur_block = else_block;
+      if (!gen_stmt(*s.body[1]))
+        return false;
+      emit_jump(join);
+    }
+    cur_block = join;
+    return true;
+  }
+
+  case S_WHILE: {
+    // Rotated loop: test at the bottom, so each iteration takes one branch
+    int body = new_block();
+    int test = new_block();
+    int exit = new_block();
+    emit_jump(test);
+    cur_block = body;
+    break_targets.push_back(exit);
+    continue_targets.push_back(test);
+    if (!gen_stmt(*s.body[0]))
+      return false;
+    break_targets.pop_back();
+    continue_targets.pop_back();
+    emit_jump(test);
+    cur_block = test;
+    if (!gen_cond(*s.expr, body, exit))
+      return false;
+    cur_block = exit;
+    return true;
+  }
+
+  case S_DO: {
+    int body = new_block();
+    int test = new_block();
+    int exit = new_block();
+    emit_jump(body);
+    cur_block = body;
+    break_targets.push_back(exit);
+    continue_targets.push_back(test);
+    if (!gen_stmt(*s.body[0]))
+      return false;
+    break_targets.pop_back();
+    continue_targets.pop_back();
+    emit_jump(test);
+    cur_block = test;
+    if (!gen_cond(*s.expr, body, exit))
+      return false;
+    cur_block = exit;
+    return true;
+  }
+
+  case S_FOR:
+    return gen_for(s);
+
+  case S_RETURN:
+    if (s.expr) {
+      if (ret_vreg < 0) {
+        report_error(s.line, "Returning a value from a void function");
+        return false;
+      }
+      int watermark = fn->num_vregs;
+      Value v;
+      if (!gen_expr(*s.expr, v))
+        return false;
+      assign_vreg(ret_vreg, v, watermark);
+    }
+    emit_jump(exit_block);
+    return true;
+
+  case S_BREAK:
+  case S_CONTINUE: {
+    std::vector<int> &targets =
+        s.kind == S_BREAK ? break_targets : continue_targets;
+    if (targets.empty()) {
+      report_error(s.line, s.kind == S_BREAK ? "'break' outside of a loop"
+                                             : "'continue' outside of a loop");
+      return false;
+    }
+    emit_jump(targets.back());
+    return true;
+  }
+  }
+  return false;
+}
+
+/**
+ * Recognize a loop step of the form i++, i--, i += c, i -= c or
+ * i = i +/- c, where i is a local scalar
+ */
+bool Compiler::find_induction_step(const Stmt &s, std::string &var,
+                                   int &step) {
+  const Expr *e = s.step.get();
+  if (!e)
+    return false;
+
+  const Expr *target = e->lhs.get();
+  if (!target || target->kind != E_VAR)
+    return false;
+  const LocalSymbol *sym = find_local(target->name);
+  if (!sym || sym->kind != LOCAL_SCALAR)
+    return false;
+  var = target->name;
+
+  if (e->kind == E_INCDEC) {
+    step = e->op == "++" ? 1 : -1;
+    return true;
+  }
+  if (e->kind != E_ASSIGN)
+    return false;
+
+  const Expr *amount = e->rhs.get();
+  std::string op = e->op;
+  if (op == "=") {
+    // i = i + c / i = i - c
+    if (amount->kind != E_BINARY || (amount->op != "+" && amount->op != "-") ||
+        amount->lhs->kind != E_VAR || amount->lhs->name != var)
+      return false;
+    op = amount->op;
+    amount = amount->rhs.get();
+  }
+  if ((op != "+" && op != "-") || amount->kind != E_NUMBER)
+    return false;
+  step = op == "+" ? amount->value : -amount->value;
+  return step != 0 && step >= -0x4000 && step < 0x4000;
+}
+
+/**
+ * True if the statement or expression assigns to (or redeclares) name
+ */
+bool Compiler::assigns_to(const Stmt *s, const Expr *e,
+                          const std::string &name) {
+  if (e) {
+    if ((e->kind == E_ASSIGN || e->kind == E_INCDEC) && e->lhs &&
+        e->lhs->kind == E_VAR && e->lhs->name == name)
+      return true;
+    if (e->lhs && assigns_to(nullptr, e->lhs.get(), name))
+      return true;
+    if (e->rhs && assigns_to(nullptr, e->rhs.get(), name))
+      return true;
+    for (size_t i = 0; i < e->args.size(); i++) {
+      if (assigns_to(nullptr, e->args[i].get(), name))
+        return true;
+    }
+  }
+  if (s) {
+    for (size_t i = 0; i < s->decls.size(); i++) {
+      if (s->decls[i]->name == name)
+        return true;
+    }
+    if (assigns_to(s->init.get(), s->expr.get(), name) ||
+        assigns_to(nullptr, s->step.get(), name))
+      return true;
+    for (size_t i = 0; i < s->body.size(); i++) {
+      if (assigns_to(s->body[i].get(), nullptr, name))
+        return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Collect the names of arrays indexed exactly as name[var]
+ */
+void Compiler::collect_indexed_arrays(const Stmt *s, const Expr *e,
+                                      const std::string &var,
+                                      std::vector<std::string> &arrays) {
+  if (e) {
+    if (e->kind == E_INDEX && e->lhs->kind == E_VAR && e->lhs->name == var) {
+      bool seen = false;
+      for (size_t i = 0; i < arrays.size(); i++)
+        seen = seen || arrays[i] == e->name;
+      if (!seen)
+        arrays.push_back(e->name);
+    }
+    if (e->lhs)
+      collect_indexed_arrays(nullptr, e->lhs.get(), var, arrays);
+    if (e->rhs)
+      collect_indexed_arrays(nullptr, e->rhs.get(), var, arrays);
+    for (size_t i = 0; i < e->args.size(); i++)
+      collect_indexed_arrays(nullptr, e->args[i].get(), var, arrays);
+  }
+  if (s) {
+    collect_indexed_arrays(s->init.get(), s->expr.get(), var, arrays);
+    collect_indexed_arrays(nullptr, s->step.get(), var, arrays);
+    for (size_t i = 0; i < s->decls.size(); i++) {
+      if (s->decls[i]->init)
+        collect_indexed_arrays(nullptr, s->decls[i]->init.get(), var, arrays);
+      for (size_t j = 0; j < s->decls[i]->init_list.size(); j++)
+        collect_indexed_arrays(nullptr, s->decls[i]->init_list[j].get(), var,
+                               arrays);
+    }
+    for (size_t i = 0; i < s->body.size(); i++)
+      collect_indexed_arrays(s->body[i].get(), nullptr, var, arrays);
+  }
+}
+
+// Most arrays given a strength-reduced pointer in a single loop
+static const size_t MAX_LOOP_POINTERS = 3;
+
+bool Compiler::gen_for(const Stmt &s) {
+  scopes.push_back(std::map<std::string, LocalSymbol>());
+  if (!gen_stmt(*s.init))
+    return false;
+
+  int body = new_block();
+  int step = new_block();
+  int test = new_block();
+  int exit = new_block();
+
+  // Strength reduction: replace a[i] by a pointer advanced with i
+  std::vector<std::string> reduced;
+  std::vector<int> pointers;
+  std::string var;
+  int step_amount = 0;
+  if (find_induction_step(s, var, step_amount) &&
+      !assigns_to(s.body[0].get(), s.expr.get(), var)) {
+    std::vector<std::string> arrays;
+    collect_indexed_arrays(s.body[0].get(), s.expr.get(), var, arrays);
+    for (size_t i = 0; i < arrays.size() && reduced.size() < MAX_LOOP_POINTERS;
+         i++) {
+      std::string key = arrays[i] + "[" + var + "]";
+      if (index_pointers.count(key) ||
+          assigns_to(s.body[0].get(), nullptr, arrays[i]))
+        continue;
+      Expr index(E_INDEX, s.line);
+      index.name = arrays[i];
+      index.lhs.reset(new Expr(E_VAR, s.line));
+      index.lhs->name = var;
+      Value addr;
+      bool is_unsigned;
+      if (!gen_array_address(index, addr, is_unsigned))
+        return false;
+      int pointer = new_vreg();
+      assign_vreg(pointer, addr, pointer);
+      reduced.push_back(key);
+      pointers.push_back(pointer);
+    }
+    for (size_t i = 0; i < reduced.size(); i++)
+      index_pointers[reduced[i]] = pointers[i];
+  }
+
+  emit_jump(test);
+  cur_block = body;
+  break_targets.push_back(exit);
+  continue_targets.push_back(step);
+  if (!gen_stmt(*s.body[0]))
+    return false;
+  break_targets.pop_back();
+  continue_targets.pop_back();
+  emit_jump(step);
+
+  cur_block = step;
+  if (s.step) {
+    Value v;
+    if (!gen_expr(*s.step, v))
+      return false;
+  }
+  for (size_t i = 0; i < pointers.size(); i++) {
+    int delta = (2 * step_amount) & 0xFFFF;
+    if (fits_simm4(delta)) {
+      emit(make_op(IR_ADDI, pointers[i], pointers[i], -1, delta));
+    } else {
+      emit(make_op(IR_ADD, pointers[i], pointers[i],
+                   to_vreg(const_value(delta, true)), 0));
+    }
+  }
+  emit_jump(test);
+
+  cur_block = test;
+  if (s.expr) {
+    if (!gen_cond(*s.expr, body, exit))
+      return false;
+  } else {
+    emit_jump(body);
+  }
+
+  cur_block = exit;
+  for (size_t i = 0; i < reduced.size(); i++)
+    index_pointers.erase(reduced[i]);
+  scopes.pop_back();
+  return true;
+}
+
+/**
+ * Generate a branch to t if the expression is true, else to f
+ */
+bool Compiler::gen_cond(const Expr &e, int t, int f) {
+  if (e.kind == E_LOGAND || e.kind == E_LOGOR) {
+    int mid = new_block();
+    if (!gen_cond(*e.lhs, e.kind == E_LOGAND ? mid : t,
+                  e.kind == E_LOGAND ? f : mid))
+      return false;
+    cur_block = mid;
+    return gen_cond(*e.rhs, t, f);
+  }
+  if (e.kind == E_UNARY && e.op == "!")
+    return gen_cond(*e.lhs, f, t);
+
+  if (e.kind == E_BINARY && is_comparison(e.op)) {
+    Value a, b;
+    if (!gen_expr(*e.lhs, a) || !gen_expr(*e.rhs, b))
+      return false;
+    return gen_compare(e.op, a, b, t, f);
+  }
+
+  Value v;
+  if (!gen_expr(e, v))
+    return false;
+  if (v.is_const) {
+    emit_jump(v.imm != 0 ? t : f);
+    return true;
+  }
+  emit_branch(C_NE, v, const_value(0, false), t, f);
+  return true;
+}
+
+/**
+ * Branch on a comparison. Everything is reduced to a < b:
+ *   a > b  == b < a,   a >= b == !(a < b),   a <= b == !(b < a)
+ */
+bool Compiler::gen_compare(const std::string &op, const Value &a0,
+                           const Value &b0, int t, int f) {
+  bool is_unsigned = a0.is_unsigned || b0.is_unsigned;
+
+  if (a0.is_const && b0.is_const) {
+    int x = a0.imm, y = b0.imm;
+    if (!is_unsigned) {
+      x = (int16_t)x;
+      y = (int16_t)y;
+    }
+    bool result = (op == "==")   ? x == y
+                  : (op == "!=") ? x != y
+                  : (op == "<")  ? x < y
+                  : (op == "<=") ? x <= y
+                  : (op == ">")  ? x > y
+                                 : x >= y;
+    emit_jump(result ? t : f);
+    return true;
+  }
+
+  if (op == "==" || op == "!=") {
+    const Value &x = a0.is_const ? b0 : a0;
+    const Value &y = a0.is_const ? a0 : b0;
+    emit_branch(op == "==" ? C_EQ : C_NE, x, y, t, f);
+    return true;
+  }
+
+  Value a = a0, b = b0;
+  if (op == ">" || op == "<=")
+    std::swap(a, b);
+  if (op == ">=" || op == "<=")
+    std::swap(t, f);
+
+  // A constant on the left: c < b  ==  !(b < c + 1)
+  if (a.is_const) {
+    int limit = is_unsigned ? 0xFFFF : 0x7FFF;
+    if (a.imm == limit) {
+      emit_jump(f);
+      return true;
+    }
+    Value c = const_value(a.imm + 1, a.is_unsigned);
+    a = b;
+    b = c;
+    std::swap(t, f);
+  }
+
+  if (is_unsigned) {
+    if (b.is_const && b.imm == 0) {
+      emit_jump(f); // Nothing is below zero
+    } else if (b.is_const && b.imm == 1) {
+      emit_branch(C_EQ, a, const_value(0, true), t, f);
+    } else {
+      emit_branch(C_LTU, a, b, t, f);
+    }
+    return true;
+  }
+
+  if (b.is_const) {
+    int c = (int16_t)b.imm;
+    if (c == 0) {
+      emit_branch(C_MI, a, b, t, f);
+    } else if (c > 0) {
+      // a < c  ==  a <u c  or  a negative
+      int check_sign = new_block();
+      emit_branch(C_LTU, a, b, t, check_sign);
+      cur_block = check_sign;
+      emit_branch(C_MI, a, b, t, f);
+    } else {
+      // a < c (c negative)  ==  a negative and a <u c
+      int check_value = new_block();
+      emit_branch(C_MI, a, b, check_value, f);
+      cur_block = check_value;
+      emit_branch(C_LTU, a, b, t, f);
+    }
+    return true;
+  }
+
+  // Same signs: unsigned order matches signed order.
+  // Different signs: a < b exactly when a is negative.
+  int diff = new_vreg();
+  emit(make_op(IR_XOR, diff, a.vreg, b.vreg, 0));
+  int same_sign = new_block();
+  int other_sign = new_block();
+  emit_branch(C_MI, vreg_value(diff, false), b, other_sign, same_sign);
+  cur_block = same_sign;
+  emit_branch(C_LTU, a, b, t, f);
+  cur_block = other_sign;
+  emit_branch(C_MI, a, b, t, f);
+  return true;
+}
+
+/**
+ * Materialize a condition as 0 or 1
+ */
+static bool is_condition(const Expr &e) {
+  return e.kind == E_LOGAND || e.kind == E_LOGOR ||
+         (e.kind == E_UNARY && e.op == "!") ||
+         (e.kind == E_BINARY && is_comparison(e.op));
+}
+
+bool Compiler::gen_expr(const Expr &e, Value &out) {
+  if (is_condition(e)) {
+    int result = new_vreg();
+    int when_true = new_block();
+    int when_false = new_block();
+    int join = new_block();
+    if (!gen_cond(e, when_true, when_false))
+      return false;
+    cur_block = when_true;
+    assign_vreg(result, const_value(1, false), result);
+    emit_jump(join);
+    cur_block = when_false;
+    assign_vreg(result, const_value(0, false), result);
+    emit_jump(join);
+    cur_block = join;
+    out = vreg_value(result, false);
+    return true;
+  }
+
+  switch (e.kind) {
+  case E_NUMBER:
+    out = const_value(e.value, e.is_unsigned);
+    return true;
+
+  case E_STRING:
+    report_error(e.line, "String literals are only supported as printf "
+                         "formats");
+    return false;
+
+  case E_VAR: {
+    const LocalSymbol *local = find_local(e.name);
+    if (local) {
+      if (local->kind == LOCAL_ARRAY) {
+        IrInstr frame(IR_FRAME);
+        frame.dst = new_vreg();
+        frame.imm = local->offset;
+        emit(frame);
+        out = vreg_value(frame.dst, true);
+      } else {
+        out = vreg_value(local->vreg, local->is_unsigned);
+      }
+      return true;
+    }
+    std::map<std::string, GlobalSymbol>::const_iterator g =
+        globals.find(e.name);
+    if (g == globals.end()) {
+      report_error(e.line, "Undeclared identifier '" + e.name + "'");
+      return false;
+    }
+    if (g->second.is_array) {
+      out = const_value(g->second.address, true);
+      return true;
+    }
+    IrInstr load(IR_LOADG);
+    load.dst = new_vreg();
+    load.imm = g->second.address;
+    emit(load);
+    out = vreg_value(load.dst, g->second.is_unsigned);
+    return true;
+  }
+
+  case E_INDEX: {
+    Value addr;
+    bool is_unsigned;
+    if (!gen_array_address(e, addr, is_unsigned))
+      return false;
+    IrInstr load(addr.is_const ? IR_LOADG : IR_LOAD);
+    load.dst = new_vreg();
+    load.a = addr.vreg;
+    load.imm = addr.imm;
+    emit(load);
+    out = vreg_value(load.dst, is_unsigned);
+    return true;
+  }
+
+  case E_CALL:
+    return gen_call(e, out, true);
+
+  case E_UNARY: {
+    Value a;
+    if (!gen_expr(*e.lhs, a))
+      return false;
+    if (e.op == "(unsigned)" || e.op == "(int)") {
+      out = a;
+      out.is_unsigned = e.op == "(unsigned)";
+      return true;
+    }
+    if (a.is_const) {
+      out = const_value(e.op == "-" ? -a.imm : ~a.imm, a.is_unsigned);
+      return true;
+    }
+    int inverted = new_vreg();
+    emit(make_op(IR_NOT, inverted, a.vreg, -1, 0));
+    if (e.op == "~") {
+      out = vreg_value(inverted, a.is_unsigned);
+      return true;
+    }
+    int negated = new_vreg(); // -x == ~x + 1
+    emit(make_op(IR_ADDI, negated, inverted, -1, 1));
+    out = vreg_value(negated, a.is_unsigned);
+    return true;
+  }
+
+  case E_BINARY: {
+    Value a, b;
+    if (!gen_expr(*e.lhs, a) || !gen_expr(*e.rhs, b))
+      return false;
+    return gen_binary(e.op, a, b, e.line, out);
+  }
+
+  case E_COND: {
+    int result = new_vreg();
+    int then_block = new_block();
+    int else_block = new_block();
+    int join = new_block();
+    if (!gen_cond(*e.lhs, then_block, else_block))
+      return false;
+    Value a, b;
+    cur_block = then_block;
+    if (!gen_expr(*e.args[0], a))
+      return false;
+    assign_vreg(result, a, result);
+    emit_jump(join);
+    cur_block = else_block;
+    if (!gen_expr(*e.args[1], b))
+      return false;
+    assign_vreg(result, b, result);
+    emit_jump(join);
+    cur_block = join;
+    out = vreg_value(result, a.is_unsigned || b.is_unsigned);
+    return true;
+  }
+
+  case E_ASSIGN: {
+    LValue lv;
+    if (!gen_lvalue(*e.lhs, lv))
+      return false;
+    int watermark = fn->num_vregs;
+    Value rhs;
+    if (!gen_expr(*e.rhs, rhs))
+      return false;
+    Value result = rhs;
+    if (e.op != "=") {
+      Value old = load_lvalue(lv);
+      if (!gen_binary(e.op, old, rhs, e.line, result))
+        return false;
+    }
+    result.is_unsigned = lv.is_unsigned;
+    store_lvalue(lv, result, watermark);
+    out = lv.kind == LV_VREG ? vreg_value(lv.vreg, lv.is_unsigned) : result;
+    return true;
+  }
+
+  case E_INCDEC: {
+    LValue lv;
+    if (!gen_lvalue(*e.lhs, lv))
+      return false;
+    int delta = e.op == "++" ? 1 : -1;
+    Value old = load_lvalue(lv);
+    if (lv.kind == LV_VREG) {
+      if (e.postfix) {
+        int copy = new_vreg();
+        emit(make_op(IR_MOV, copy, lv.vreg, -1, 0));
+        old = vreg_value(copy, lv.is_unsigned);
+      }
+      emit(make_op(IR_ADDI, lv.vreg, lv.vreg, -1, delta & 0xFFFF));
+      out = e.postfix ? old : vreg_value(lv.vreg, lv.is_unsigned);
+      return true;
+    }
+    int updated = new_vreg();
+    emit(make_op(IR_ADDI, updated, old.vreg, -1, delta & 0xFFFF));
+    store_lvalue(lv, vreg_value(updated, lv.is_unsigned), updated);
+    out = e.postfix ? old : vreg_value(updated, lv.is_unsigned);
+    return true;
+  }
+
+  default:
+    break;
+  }
+  report_error(e.line, "Unsupported expression");
+  return false;
+}
+
+/**
+ * Generate a binary arithmetic, bitwise or shift operation
+ */
+bool Compiler::gen_binary(const std::string &op, const Value &a0,
+                          const Value &b0, int line, Value &out) {
+  bool is_unsigned = a0.is_unsigned || b0.is_unsigned;
+  Value a = a0, b = b0;
+
+  if (is_comparison(op)) {
+    int result = new_vreg();
+    int when_true = new_block();
+    int when_false = new_block();
+    int join = new_block();
+    if (!gen_compare(op, a, b, when_true, when_false))
+      return false;
+    cur_block = when_true;
+    assign_vreg(result, const_value(1, false), result);
+    emit_jump(join);
+    cur_block = when_false;
+    assign_vreg(result, const_value(0, false), result);
+    emit_jump(join);
+    cur_block = join;
+    out = vreg_value(result, false);
+    return true;
+  }
+
+  // Constant folding
+  if (a.is_const && b.is_const) {
+    int x = a.imm, y = b.imm, r = 0;
+    int sx = (int16_t)x, sy = (int16_t)y;
+    if (op == "+")
+      r = x + y;
+    else if (op == "-")
+      r = x - y;
+    else if (op == "*")
+      r = x * y;
+    else if (op == "&")
+      r = x & y;
+    else if (op == "|")
+      r = x | y;
+    else if (op == "^")
+      r = x ^ y;
+    else if (op == "<<")
+      r = x << (y & 15);
+    else if (op == ">>")
+      r = is_unsigned ? x >> (y & 15) : sx >> (y & 15);
+    else if (op == "/" || op == "%") {
+      if (y == 0) {
+        report_error(line, "Division by zero");
+        return false;
+      }
+      if (is_unsigned)
+        r = op == "/" ? x / y : x % y;
+      else
+        r = op == "/" ? sx / sy : sx % sy;
+    }
+    out = const_value(r, is_unsigned);
+    return true;
+  }
+
+  // Commutative operations take the constant on the right
+  if (a.is_const && (op == "+" || op == "*" || op == "&" || op == "|" ||
+                     op == "^"))
+    std::swap(a, b);
+
+  int dst = new_vreg();
+  out = vreg_value(dst, is_unsigned);
+
+  if (op == "+" || op == "-") {
+    if (b.is_const && b.imm == 0) {
+      out = a;
+      out.is_unsigned = is_unsigned;
+      return true;
+    }
+    if (b.is_const && fits_simm4(b.imm)) {
+      emit(make_op(op == "+" ? IR_ADDI : IR_SUBI, dst, a.vreg, -1, b.imm));
+      return true;
+    }
+    emit(make_op(op == "+" ? IR_ADD : IR_SUB, dst, to_vreg(a), to_vreg(b), 0));
+    return true;
+  }
+
+  if (op == "*") {
+    if (b.is_const) {
+      if (b.imm == 0) {
+        out = const_value(0, is_unsigned);
+        return true;
+      }
+      if (b.imm == 1) {
+        out = a;
+        out.is_unsigned = is_unsigned;
+        return true;
+      }
+      int shift = log2_exact(b.imm);
+      if (shift > 0) {
+        emit(make_op(IR_SHLI, dst, a.vreg, -1, shift));
+        return true;
+      }
+    }
+    emit(make_op(IR_MUL, dst, to_vreg(a), to_vreg(b), 0));
+    return true;
+  }
+
+  if (op == "/" || op == "%") {
+    if (b.is_const && b.imm == 0) {
+      report_error(line, "Division by zero");
+      return false;
+    }
+    if (b.is_const && b.imm == 1) {
+      out = op == "/" ? a : const_value(0, is_unsigned);
+      out.is_unsigned = is_unsigned;
+      return true;
+    }
+    if (!is_unsigned) {
+      // Signed division goes through a runtime helper around DIV
+      IrInstr call(IR_CALL);
+      call.dst = dst;
+      call.callee = op == "/" ? "__divs" : "__mods";
+      call.args.push_back(to_vreg(a));
+      call.args.push_back(to_vreg(b));
+      emit(call);
+      helpers_used.insert(call.callee);
+      fn->has_calls = true;
+      return true;
+    }
+    int shift = b.is_const ? log2_exact(b.imm) : -1;
+    if (shift > 0 && op == "/") {
+      emit(make_op(IR_SHRI, dst, to_vreg(a), -1, shift));
+      return true;
+    }
+    if (shift > 0) {
+      int mask = b.imm - 1;
+      if (fits_uimm4(mask))
+        emit(make_op(IR_ANDI, dst, to_vreg(a), -1, mask));
+      else
+        emit(make_op(IR_AND, dst, to_vreg(a),
+                     to_vreg(const_value(mask, true)), 0));
+      return true;
+    }
+    int x = to_vreg(a), y = to_vreg(b);
+    if (op == "/") {
+      emit(make_op(IR_DIV, dst, x, y, 0));
+      return true;
+    }
+    // a % b == a - (a / b) * b
+    int quotient = new_vreg();
+    int product = new_vreg();
+    emit(make_op(IR_DIV, quotient, x, y, 0));
+    emit(make_op(IR_MUL, product, quotient, y, 0));
+    emit(make_op(IR_SUB, dst, x, product, 0));
+    return true;
+  }
+
+  if (op == "&" || op == "|") {
+    if (b.is_const && fits_uimm4(b.imm)) {
+      emit(make_op(op == "&" ? IR_ANDI : IR_ORI, dst, a.vreg, -1, b.imm));
+      return true;
+    }
+    emit(make_op(op == "&" ? IR_AND : IR_OR, dst, to_vreg(a), to_vreg(b), 0));
+    return true;
+  }
+
+  if (op == "^") {
+    emit(make_op(IR_XOR, dst, to_vreg(a), to_vreg(b), 0));
+    return true;
+  }
+
+  if (op == "<<" || (op == ">>" && a.is_unsigned)) {
+    out.is_unsigned = a.is_unsigned; // Shifts keep the left operand's type
+    if (b.is_const) {
+      if ((b.imm & 15) == 0) {
+        out = a;
+        return true;
+      }
+      emit(make_op(op == "<<" ? IR_SHLI : IR_SHRI, dst, to_vreg(a), -1,
+                   b.imm & 15));
+      return true;
+    }
+    emit(make_op(op == "<<" ? IR_SHL : IR_SHR, dst, to_vreg(a), to_vreg(b),
+                 0));
+    return true;
+  }
+
+  if (op == ">>") {
+    // Arithmetic shift: ((a ^ 0x8000) >> n) - (0x8000 >> n)
+    out.is_unsigned = false;
+    if (b.is_const && (b.imm & 15) == 0) {
+      out = a;
+      return true;
+    }
+    int biased = new_vreg();
+    int shifted = new_vreg();
+    int sign = to_vreg(const_value(0x8000, true));
+    emit(make_op(IR_XOR, biased, to_vreg(a), sign, 0));
+    if (b.is_const) {
+      int n = b.imm & 15;
+      emit(make_op(IR_SHRI, shifted, biased, -1, n));
+      Value bias = const_value(0x8000 >> n, true);
+      if (fits_simm4(bias.imm))
+        emit(make_op(IR_SUBI, dst, shifted, -1, bias.imm));
+      else
+        emit(make_op(IR_SUB, dst, shifted, to_vreg(bias), 0));
+      return true;
+    }
+    int amount = to_vreg(b);
+    int bias = new_vreg();
+    emit(make_op(IR_SHR, shifted, biased, amount, 0));
+    emit(make_op(IR_SHR, bias, sign, amount, 0));
+    emit(make_op(IR_SUB, dst, shifted, bias, 0));
+    return true;
+  }
+
+  report_error(line, "Unsupported operator '" + op + "'");
+  return false;
+}
+
+/**
+ * Compute the address of name[index]
+ * Addresses known at compile time (global array, constant index) come
+ * back as constants so the access can use direct LOAD/STORE
+ */
+bool Compiler::gen_array_address(const Expr &e, Value &out,
+                                 bool &is_unsigned) {
+  Value base;
+  const LocalSymbol *local = find_local(e.name);
+  if (local) {
+    if (local->kind == LOCAL_SCALAR) {
+      report_error(e.line, "'" + e.name + "' is not an array");
+      return false;
+    }
+    is_unsigned = local->is_unsigned;
+    if (local->kind == LOCAL_ARRAY_PARAM) {
+      base = vreg_value(local->vreg, true);
+    } else {
+      IrInstr frame(IR_FRAME);
+      frame.dst = new_vreg();
+      frame.imm = local->offset;
+      emit(frame);
+      base = vreg_value(frame.dst, true);
+    }
+  } else {
+    std::map<std::string, GlobalSymbol>::const_iterator g =
+        globals.find(e.name);
+    if (g == globals.end() || !g->second.is_array) {
+      report_error(e.line, "'" + e.name + "' is not an array");
+      return false;
+    }
+    is_unsigned = g->second.is_unsigned;
+    base = const_value(g->second.address, true);
+  }
+
+  // Strength-reduced pointer from an enclosing for loop
+  if (e.lhs->kind == E_VAR) {
+    std::map<std::string, int>::const_iterator p =
+        index_pointers.find(e.name + "[" + e.lhs->name + "]");
+    if (p != index_pointers.end()) {
+      out = vreg_value(p->second, true);
+      return true;
+    }
+  }
+
+  Value index;
+  if (!gen_expr(*e.lhs, index))
+    return false;
+
+  if (index.is_const) {
+    Value offset = const_value(2 * index.imm, true);
+    return gen_binary("+", base, offset, e.line, out);
+  }
+
+  int scaled = new_vreg();
+  emit(make_op(IR_SHLI, scaled, index.vreg, -1, 1));
+  return gen_binary("+", base, vreg_value(scaled, true), e.line, out);
+}
+
+bool Compiler::gen_lvalue(const Expr &e, LValue &out) {
+  if (e.kind == E_VAR) {
+    const LocalSymbol *local = find_local(e.name);
+    if (local && local->kind == LOCAL_SCALAR) {
+      out.kind = LV_VREG;
+      out.vreg = local->vreg;
+      out.address = 0;
+      out.is_unsigned = local->is_unsigned;
+      return true;
+    }
+    std::map<std::string, GlobalSymbol>::const_iterator g =
+        globals.find(e.name);
+    if (!local && g != globals.end() && !g->second.is_array) {
+      out.kind = LV_GLOBAL;
+      out.vreg = -1;
+      out.address = g->second.address;
+      out.is_unsigned = g->second.is_unsigned;
+      return true;
+    }
+  } else if (e.kind == E_INDEX) {
+    Value addr;
+    if (!gen_array_address(e, addr, out.is_unsigned))
+      return false;
+    out.kind = addr.is_const ? LV_GLOBAL : LV_MEMORY;
+    out.vreg = addr.vreg;
+    out.address = addr.imm;
+    return true;
+  }
+  report_error(e.line, "Expression is not assignable");
+  return false;
+}
+
+Value Compiler::load_lvalue(const LValue &lv) {
+  if (lv.kind == LV_VREG)
+    return vreg_value(lv.vreg, lv.is_unsigned);
+  IrInstr load(lv.kind == LV_GLOBAL ? IR_LOADG : IR_LOAD);
+  load.dst = new_vreg();
+  load.a = lv.vreg;
+  load.imm = lv.address;
+  emit(load);
+  return vreg_value(load.dst, lv.is_unsigned);
+}
+
+void Compiler::store_lvalue(const LValue &lv, const Value &v, int watermark) {
+  if (lv.kind == LV_VREG) {
+    assign_vreg(lv.vreg, v, watermark);
+    return;
+  }
+  IrInstr store(lv.kind == LV_GLOBAL ? IR_STOREG : IR_STORE);
+  if (lv.kind == LV_GLOBAL) {
+    store.a = to_vreg(v);
+    store.imm = lv.address;
+  } else {
+    store.b = to_vreg(v);
+    store.a = lv.vreg;
+  }
+  emit(store);
+}
+
+void Compiler::gen_putchar(const Value &v) {
+  IrInstr store(IR_STOREG);
+  store.a = to_vreg(v);
+  store.imm = IO_CONSOLE_OUT;
+  emit(store);
+}
+
+/**
+ * Generate a call to a user function or a builtin
+ * Builtins: putchar(c), getchar() and printf with a literal format
+ */
+bool Compiler::gen_call(const Expr &e, Value &out, bool want_value) {
+  if (e.name == "printf" && !find_local(e.name) && !functions.count(e.name)) {
+    out = const_value(0, false);
+    return gen_printf(e);
+  }
+  if (e.name == "putchar" && !functions.count(e.name)) {
+    if (e.args.size() != 1) {
+      report_error(e.line, "putchar takes one argument");
+      return false;
+    }
+    if (!gen_expr(*e.args[0], out))
+      return false;
+    gen_putchar(out);
+    return true;
+  }
+  if (e.name == "getchar" && !functions.count(e.name)) {
+    IrInstr load(IR_LOADG);
+    load.dst = new_vreg();
+    load.imm = IO_CONSOLE_IN;
+    emit(load);
+    out = vreg_value(load.dst, false);
+    return true;
+  }
+
+  std::map<std::string, const FunctionDecl *>::const_iterator it =
+      functions.find(e.name);
+  if (it == functions.end()) {
+    report_error(e.line, "Call to undeclared function '" + e.name + "'");
+    return false;
+  }
+  const FunctionDecl &callee = *it->second;
+  if (callee.params.size() != e.args.size()) {
+    report_error(e.line, "Wrong number of arguments to '" + e.name + "'");
+    return false;
+  }
+  if (want_value && !callee.returns_value) {
+    report_error(e.line, "'" + e.name + "' does not return a value");
+    return false;
+  }
+
+  IrInstr call(IR_CALL);
+  call.callee = e.name;
+  for (size_t i = 0; i < e.args.size(); i++) {
+    Value arg;
+    if (!gen_expr(*e.args[i], arg))
+      return false;
+    call.args.push_back(to_vreg(arg));
+  }
+  if (callee.returns_value) {
+    call.dst = new_vreg();
+    out = vreg_value(call.dst, callee.returns_unsigned);
+  } else {
+    out = const_value(0, false);
+  }
+  emit(call);
+  fn->has_calls = true;
+  return true;
+}
+
+/**
+ * Expand printf with a literal format into putchar stores and calls to
+ * the number printing helpers. Supports %d, %u, %x, %c and %%.
+ */
+bool Compiler::gen_printf(const Expr &e) {
+  if (e.args.empty() || e.args[0]->kind != E_STRING) {
+    report_error(e.line, "printf needs a literal format string");
+    return false;
+  }
+  const std::string &format = e.args[0]->text;
+  size_t next_arg = 1;
+
+  for (size_t i = 0; i < format.size(); i++) {
+    if (format[i] != '%' || i + 1 == format.size()) {
+      gen_putchar(const_value((unsigned char)format[i], false));
+      continue;
+    }
+    char spec = format[++i];
+    if (spec == '%') {
+      gen_putchar(const_value('%', false));
+      continue;
+    }
+    if (spec != 'd' && spec != 'u' && spec != 'x' && spec != 'c') {
+      report_error(e.line, std::string("Unsupported printf conversion '%") +
+                               spec + "'");
+      return false;
+    }
+    if (next_arg >= e.args.size()) {
+      report_error(e.line, "Too few arguments for printf format");
+      return false;
+    }
+    Value v;
+    if (!gen_expr(*e.args[next_arg++], v))
+      return false;
+    if (spec == 'c') {
+      gen_putchar(v);
+      continue;
+    }
+    IrInstr call(IR_CALL);
+    call.callee = spec == 'd' ? "__print_int"
+                  : spec == 'u' ? "__print_uint"
+                                : "__print_hex";
+    call.args.push_back(to_vreg(v));
+    emit(call);
+    helpers_used.insert(call.callee);
+    fn->has_calls = true;
+  }
+
+  if (next_arg != e.args.size()) {
+    report_error(e.line, "Too many arguments for printf format");
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,210 @@
+/**
+ * C Subset Lexer
+ *
+ * Splits the source into identifiers, numbers, string literals and
+ * punctuators. Comments and preprocessor lines (#include ...) are
+ * skipped, so ordinary host C files such as programs/factorial.c can
+ * be compiled unchanged.
+ */
+
+#include "compiler.h"
+#include <cctype>
+#include <cstring>
+
+// Multi-character punctuators, longest first
+static const char *const PUNCTUATORS[] = {
+    "<<=", ">>=", "++", "--", "+=", "-=", "*=", "/=", "%=", "&=", "|=",
+    "^=",  "<<",  ">>", "<=", ">=", "==", "!=", "&&", "||"};
+
+/**
+ * Decode one (possibly escaped) character of a char or string literal
+ * Returns false on an unknown escape sequence
+ */
+static bool read_char(const std::string &src, size_t &pos, int &value) {
+  if (src[pos] != '\\') {
+    value = (unsigned char)src[pos++];
+    return true;
+  }
+  pos++;
+  if (pos >= src.size())
+    return false;
+  switch (src[pos++]) {
+  case 'n':
+    value = '\n';
+    return true;
+  case 't':
+    value = '\t';
+    return true;
+  case 'r':
+    value = '\r';
+    return true;
+  case '0':
+    value = 0;
+    return true;
+  case '\\':
+    value = '\\';
+    return true;
+  case '\'':
+    value = '\'';
+    return true;
+  case '"':
+    value = '"';
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool Compiler::tokenize(const std::string &src) {
+  size_t pos = 0;
+  int line = 1;
+  bool line_start = true;
+
+  while (pos < src.size()) {
+    char c = src[pos];
+
+    if (c == '\n') {
+      line++;
+      pos++;
+      line_start = true;
+      continue;
+    }
+    if (isspace((unsigned char)c)) {
+      pos++;
+      continue;
+    }
+
+    // Preprocessor directives are ignored
+    if (c == '#' && line_start) {
+      while (pos < src.size() && src[pos] != '\n')
+        pos++;
+      continue;
+    }
+    line_start = false;
+
+    // Comments
+    if (c == '/' && pos + 1 < src.size() && src[pos + 1] == '/') {
+      while (pos < src.size() && src[pos] != '\n')
+        pos++;
+      continue;
+    }
+    if (c == '/' && pos + 1 < src.size() && src[pos + 1] == '*') {
+      size_t end = src.find("*/", pos + 2);
+      if (end == std::string::npos) {
+        report_error(line, "Unterminated comment");
+        return false;
+      }
+      for (size_t i = pos; i < end; i++) {
+        if (src[i] == '\n')
+          line++;
+      }
+      pos = end + 2;
+      continue;
+    }
+
+    Token t;
+    t.line = line;
+    t.value = 0;
+    t.is_unsigned = false;
+
+    if (isalpha((unsigned char)c) || c == '_') {
+      size_t start = pos;
+      while (pos < src.size() &&
+             (isalnum((unsigned char)src[pos]) || src[pos] == '_'))
+        pos++;
+      t.kind = TK_IDENT;
+      t.text = src.substr(start, pos - start);
+    } else if (isdigit((unsigned char)c)) {
+      size_t start = pos;
+      int base = 10;
+      if (c == '0' && pos + 1 < src.size() &&
+          (src[pos + 1] == 'x' || src[pos + 1] == 'X')) {
+        base = 16;
+        pos += 2;
+        start = pos;
+      }
+      long value = 0;
+      while (pos < src.size() && isxdigit((unsigned char)src[pos])) {
+        int digit = isdigit((unsigned char)src[pos])
+                        ? src[pos] - '0'
+                        : tolower((unsigned char)src[pos]) - 'a' + 10;
+        if (digit >= base)
+          break;
+        value = value * base + digit;
+        if (value > 0xFFFF) {
+          report_error(line, "Integer constant does not fit in 16 bits");
+          return false;
+        }
+        pos++;
+      }
+      if (pos == start) {
+        report_error(line, "Malformed number");
+        return false;
+      }
+      t.kind = TK_NUMBER;
+      t.value = (int)value;
+      t.is_unsigned = value > 0x7FFF;
+      while (pos < src.size() && (src[pos] == 'u' || src[pos] == 'U' ||
+                                  src[pos] == 'l' || src[pos] == 'L')) {
+        if (src[pos] == 'u' || src[pos] == 'U')
+          t.is_unsigned = true;
+        pos++;
+      }
+    } else if (c == '\'') {
+      pos++;
+      int value;
+      if (pos >= src.size() || !read_char(src, pos, value) ||
+          pos >= src.size() || src[pos] != '\'') {
+        report_error(line, "Malformed character constant");
+        return false;
+      }
+      pos++;
+      t.kind = TK_NUMBER;
+      t.value = value;
+    } else if (c == '"') {
+      pos++;
+      t.kind = TK_STRING;
+      while (pos < src.size() && src[pos] != '"' && src[pos] != '\n') {
+        int value;
+        if (!read_char(src, pos, value)) {
+          report_error(line, "Unknown escape sequence in string");
+          return false;
+        }
+        t.text += (char)value;
+      }
+      if (pos >= src.size() || src[pos] != '"') {
+        report_error(line, "Unterminated string literal");
+        return false;
+      }
+      pos++;
+    } else {
+      t.kind = TK_PUNCT;
+      for (size_t i = 0; i < sizeof(PUNCTUATORS) / sizeof(PUNCTUATORS[0]);
+           i++) {
+        size_t len = strlen(PUNCTUATORS[i]);
+        if (src.compare(pos, len, PUNCTUATORS[i]) == 0) {
+          t.text = PUNCTUATORS[i];
+          break;
+        }
+      }
+      if (t.text.empty()) {
+        if (!strchr("+-*/%&|^~!=<>()[]{},;?:", c)) {
+          report_error(line, std::string("Unexpected character '") + c + "'");
+          return false;
+        }
+        t.text = std::string(1, c);
+      }
+      pos += t.text.size();
+    }
+
+    tokens.push_back(t);
+  }
+
+  Token eof;
+  eof.kind = TK_EOF;
+  eof.value = 0;
+  eof.is_unsigned = false;
+  eof.line = line;
+  tokens.push_back(eof);
+  return true;
+}
@@ -0,0 +1,34 @@
+/**
+ * Compiler Entry Point
+ *
+ * Compiles a subset of C (int/unsigned scalars and arrays, functions,
+ * if/while/do/for, printf with a literal format) into assembly source
+ * for build/assembler.
+ */
+
+#include "compiler.h"
+#include <iostream>
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " <input.c> <output.asm>\n";
+  std::cout << "Compiles a C subset into assembly code\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (argc == 2 && (std::string(argv[1]) == "-h" ||
+                    std::string(argv[1]) == "--help")) {
+    print_usage(argv[0]);
+    return 0;
+  }
+  if (argc != 3) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  Compiler compiler;
+  if (!compiler.compile(argv[1], argv[2])) {
+    return 1; // Compilation failed - errors already printed
+  }
+
+  return 0;
+}
@@ -0,0 +1,688 @@
+/**
+ * C Subset Parser
+ *
+ * Recursive-descent parser that builds the AST for the supported subset:
+ *   - types: int and unsigned (16-bit), void for functions
+ *   - global and local scalars and one-dimensional arrays
+ *   - functions with up to four parameters (arrays passed by address)
+ *   - if/else, while, do/while, for, break, continue, return
+ *   - the usual C expression operators, including compound assignment,
+ *     ++/--, &&, || and ?:
+ */
+
+#include "compiler.h"
+#include <cstring>
+
+static const char *const KEYWORDS[] = {
+    "int",   "unsigned", "signed", "void",     "if",     "else",
+    "while", "do",       "for",    "break",    "continue", "return"};
+
+static bool is_keyword(const std::string &name) {
+  for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); i++) {
+    if (name == KEYWORDS[i])
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Binary operator precedence (higher binds tighter), 0 if not binary
+ */
+static int binary_precedence(const Token &t) {
+  if (t.kind != TK_PUNCT)
+    return 0;
+  const std::string &op = t.text;
+  if (op == "||")
+    return 1;
+  if (op == "&&")
+    return 2;
+  if (op == "|")
+    return 3;
+  if (op == "^")
+    return 4;
+  if (op == "&")
+    return 5;
+  if (op == "==" || op == "!=")
+    return 6;
+  if (op == "<" || op == "<=" || op == ">" || op == ">=")
+    return 7;
+  if (op == "<<" || op == ">>")
+    return 8;
+  if (op == "+" || op == "-")
+    return 9;
+  if (op == "*" || op == "/" || op == "%")
+    return 10;
+  return 0;
+}
+
+const Token &Compiler::peek(int ahead) const {
+  size_t index = tok + ahead;
+  if (index >= tokens.size())
+    return tokens.back();
+  return tokens[index];
+}
+
+bool Compiler::is_punct(const char *p) const {
+  return peek().kind == TK_PUNCT && peek().text == p;
+}
+
+bool Compiler::is_ident(const char *name) const {
+  return peek().kind == TK_IDENT && peek().text == name;
+}
+
+bool Compiler::accept(const char *p) {
+  if (is_punct(p)) {
+    tok++;
+    return true;
+  }
+  return false;
+}
+
+bool Compiler::expect(const char *p) {
+  if (accept(p))
+    return true;
+  report_error(peek().line, std::string("Expected '") + p + "'");
+  return false;
+}
+
+bool Compiler::is_type_start() const {
+  return is_ident("int") || is_ident("unsigned") || is_ident("signed") ||
+         is_ident("void");
+}
+
+/**
+ * Parse a type specifier: void, int, signed [int] or unsigned [int]
+ */
+bool Compiler::parse_type(bool &is_void, bool &is_unsigned) {
+  is_void = false;
+  is_unsigned = false;
+  if (is_ident("void")) {
+    is_void = true;
+    tok++;
+    return true;
+  }
+  if (is_ident("unsigned") || is_ident("signed")) {
+    is_unsigned = is_ident("unsigned");
+    tok++;
+    if (is_ident("int"))
+      tok++;
+    return true;
+  }
+  if (is_ident("int")) {
+    tok++;
+    return true;
+  }
+  report_error(peek().line, "Expected a type");
+  return false;
+}
+
+bool Compiler::parse_program() {
+  while (peek().kind != TK_EOF) {
+    if (!parse_external())
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Parse a function definition, prototype or global declaration
+ */
+bool Compiler::parse_external() {
+  int line = peek().line;
+  bool is_void, is_unsigned;
+  if (!parse_type(is_void, is_unsigned))
+    return false;
+
+  if (peek().kind != TK_IDENT || is_keyword(peek().text)) {
+    report_error(peek().line, "Expected an identifier");
+    return false;
+  }
+
+  // Function definition or prototype
+  if (peek(1).kind == TK_PUNCT && peek(1).text == "(") {
+    std::unique_ptr<FunctionDecl> fn(new FunctionDecl());
+    fn->name = peek().text;
+    fn->line = line;
+    fn->returns_value = !is_void;
+    fn->returns_unsigned = is_unsigned;
+    tok += 2;
+    if (!parse_params(*fn))
+      return false;
+    if (!accept(";")) {
+      fn->body = parse_block();
+      if (!fn->body)
+        return false;
+    }
+    program.functions.push_back(std::move(fn));
+    return true;
+  }
+
+  if (is_void) {
+    report_error(line, "Variables cannot have type void");
+    return false;
+  }
+  if (!parse_declarators(is_unsigned, program.globals))
+    return false;
+  return expect(";");
+}
+
+/**
+ * Parse "name[size] = init, ..." after the type of a declaration
+ */
+bool Compiler::parse_declarators(bool is_unsigned,
+                                 std::vector<std::unique_ptr<VarDecl> > &out) {
+  do {
+    if (peek().kind != TK_IDENT || is_keyword(peek().text)) {
+      report_error(peek().line, "Expected an identifier");
+      return false;
+    }
+    std::unique_ptr<VarDecl> d(new VarDecl());
+    d->name = peek().text;
+    d->line = peek().line;
+    d->is_unsigned = is_unsigned;
+    tok++;
+
+    if (accept("[")) {
+      d->is_array = true;
+      if (!is_punct("]")) {
+        std::unique_ptr<Expr> size = parse_conditional();
+        if (!size || !eval_const(size.get(), d->array_size))
+          return false;
+        if (d->array_size <= 0) {
+          report_error(d->line, "Array size must be positive");
+          return false;
+        }
+      }
+      if (!expect("]"))
+        return false;
+    }
+
+    if (accept("=")) {
+      if (d->is_array) {
+        if (!expect("{"))
+          return false;
+        if (!is_punct("}")) {
+          do {
+            std::unique_ptr<Expr> e = parse_assign();
+            if (!e)
+              return false;
+            d->init_list.push_back(std::move(e));
+          } while (accept(",") && !is_punct("}"));
+        }
+        if (!expect("}"))
+          return false;
+        if (d->array_size == 0)
+          d->array_size = (int)d->init_list.size();
+        if ((int)d->init_list.size() > d->array_size) {
+          report_error(d->line, "Too many initializers for '" + d->name + "'");
+          return false;
+        }
+      } else {
+        d->init = parse_assign();
+        if (!d->init)
+          return false;
+      }
+    }
+
+    if (d->is_array && d->array_size == 0) {
+      report_error(d->line, "Array '" + d->name + "' needs a size");
+      return false;
+    }
+    out.push_back(std::move(d));
+  } while (accept(","));
+  return true;
+}
+
+/**
+ * Parse a parameter list after '(' up to and including ')'
+ */
+bool Compiler::parse_params(FunctionDecl &fn) {
+  if (is_ident("void") && peek(1).kind == TK_PUNCT && peek(1).text == ")") {
+    tok++;
+  }
+  if (accept(")"))
+    return true;
+
+  do {
+    bool is_void, is_unsigned;
+    if (!parse_type(is_void, is_unsigned))
+      return false;
+    if (is_void || peek().kind != TK_IDENT || is_keyword(peek().text)) {
+      report_error(peek().line, "Expected a parameter name");
+      return false;
+    }
+    std::unique_ptr<VarDecl> p(new VarDecl());
+    p->name = peek().text;
+    p->line = peek().line;
+    p->is_unsigned = is_unsigned;
+    tok++;
+    if (accept("[")) {
+      // Array parameters decay to their address; any size is ignored
+      p->is_array = true;
+      while (!is_punct("]") && peek().kind != TK_EOF)
+        tok++;
+      if (!expect("]"))
+        return false;
+    }
+    fn.params.push_back(std::move(p));
+  } while (accept(","));
+
+  if ((int)fn.params.size() > MAX_PARAMS) {
+    report_error(fn.line, "Function '" + fn.name + "' has more than 4 "
+                                                   "parameters");
+    return false;
+  }
+  return expect(")");
+}
+
+std::unique_ptr<Stmt> Compiler::parse_block() {
+  std::unique_ptr<Stmt> block(new Stmt(S_BLOCK, peek().line));
+  if (!expect("{"))
+    return nullptr;
+  while (!is_punct("}")) {
+    if (peek().kind == TK_EOF) {
+      report_error(peek().line, "Expected '}'");
+      return nullptr;
+    }
+    std::unique_ptr<Stmt> s = parse_statement();
+    if (!s)
+      return nullptr;
+    block->body.push_back(std::move(s));
+  }
+  tok++;
+  return block;
+}
+
+std::unique_ptr<Stmt> Compiler::parse_statement() {
+  int line = peek().line;
+
+  if (is_punct("{"))
+    return parse_block();
+
+  if (accept(";"))
+    return std::unique_ptr<Stmt>(new Stmt(S_EMPTY, line));
+
+  if (is_type_start()) {
+    std::unique_ptr<Stmt> s(new Stmt(S_DECL, line));
+    bool is_void, is_unsigned;
+    if (!parse_type(is_void, is_unsigned))
+      return nullptr;
+    if (is_void) {
+      report_error(line, "Variables cannot have type void");
+      return nullptr;
+    }
+    if (!parse_declarators(is_unsigned, s->decls) || !expect(";"))
+      return nullptr;
+    return s;
+  }
+
+  if (is_ident("if") || is_ident("while")) {
+    std::unique_ptr<Stmt> s(new Stmt(is_ident("if") ? S_IF : S_WHILE, line));
+    tok++;
+    if (!expect("("))
+      return nullptr;
+    s->expr = parse_expr();
+    if (!s->expr || !expect(")"))
+      return nullptr;
+    std::unique_ptr<Stmt> body = parse_statement();
+    if (!body)
+      return nullptr;
+    s->body.push_back(std::move(body));
+    if (s->kind == S_IF && is_ident("else")) {
+      tok++;
+      std::unique_ptr<Stmt> other = parse_statement();
+      if (!other)
+        return nullptr;
+      s->body.push_back(std::move(other));
+    }
+    return s;
+  }
+
+  if (is_ident("do")) {
+    std::unique_ptr<Stmt> s(new Stmt(S_DO, line));
+    tok++;
+    std::unique_ptr<Stmt> body = parse_statement();
+    if (!body)
+      return nullptr;
+    s->body.push_back(std::move(body));
+    if (!is_ident("while")) {
+      report_error(peek().line, "Expected 'while'");
+      return nullptr;
+    }
+    tok++;
+    if (!expect("("))
+      return nullptr;
+    s->expr = parse_expr();
+    if (!s->expr || !expect(")") || !expect(";"))
+      return nullptr;
+    return s;
+  }
+
+  if (is_ident("for")) {
+    std::unique_ptr<Stmt> s(new Stmt(S_FOR, line));
+    tok++;
+    if (!expect("("))
+      return nullptr;
+    s->init = parse_statement(); // Declaration, expression or ';'
+    if (!s->init)
+      return nullptr;
+    if (s->init->kind != S_DECL && s->init->kind != S_EXPR &&
+        s->init->kind != S_EMPTY) {
+      report_error(line, "Invalid for-loop initializer");
+      return nullptr;
+    }
+    if (!is_punct(";")) {
+      s->expr = parse_expr();
+      if (!s->expr)
+        return nullptr;
+    }
+    if (!expect(";"))
+      return nullptr;
+    if (!is_punct(")")) {
+      s->step = parse_expr();
+      if (!s->step)
+        return nullptr;
+    }
+    if (!expect(")"))
+      return nullptr;
+    std::unique_ptr<Stmt> body = parse_statement();
+    if (!body)
+      return nullptr;
+    s->body.push_back(std::move(body));
+    return s;
+  }
+
+  if (is_ident("return")) {
+    std::unique_ptr<Stmt> s(new Stmt(S_RETURN, line));
+    tok++;
+    if (!is_punct(";")) {
+      s->expr = parse_expr();
+      if (!s->expr)
+        return nullptr;
+    }
+    if (!expect(";"))
+      return nullptr;
+    return s;
+  }
+
+  if (is_ident("break") || is_ident("continue")) {
+    std::unique_ptr<Stmt> s(
+        new Stmt(is_ident("break") ? S_BREAK : S_CONTINUE, line));
+    tok++;
+    if (!expect(";"))
+      return nullptr;
+    return s;
+  }
+
+  std::unique_ptr<Stmt> s(new Stmt(S_EXPR, line));
+  s->expr = parse_expr();
+  if (!s->expr || !expect(";"))
+    return nullptr;
+  return s;
+}
+
+std::unique_ptr<Expr> Compiler::parse_expr() { return parse_assign(); }
+
+std::unique_ptr<Expr> Compiler::parse_assign() {
+  std::unique_ptr<Expr> lhs = parse_conditional();
+  if (!lhs)
+    return nullptr;
+
+  static const char *const ASSIGN_OPS[] = {"=",  "+=", "-=", "*=",
+                                           "/=", "%=", "&=", "|=",
+                                           "^=", "<<=", ">>="};
+  for (size_t i = 0; i < sizeof(ASSIGN_OPS) / sizeof(ASSIGN_OPS[0]); i++) {
+    if (!is_punct(ASSIGN_OPS[i]))
+      continue;
+    std::unique_ptr<Expr> e(new Expr(E_ASSIGN, peek().line));
+    tok++;
+    e->op = ASSIGN_OPS[i];
+    if (e->op != "=")
+      e->op = e->op.substr(0, e->op.size() - 1); // "+=" -> "+"
+    e->lhs = std::move(lhs);
+    e->rhs = parse_assign();
+    if (!e->rhs)
+      return nullptr;
+    return e;
+  }
+  return lhs;
+}
+
+std::unique_ptr<Expr> Compiler::parse_conditional() {
+  std::unique_ptr<Expr> cond = parse_binary(1);
+  if (!cond || !is_punct("?"))
+    return cond;
+
+  std::unique_ptr<Expr> e(new Expr(E_COND, peek().line));
+  tok++;
+  e->lhs = std::move(cond);
+  std::unique_ptr<Expr> then_expr = parse_expr();
+  if (!then_expr || !expect(":"))
+    return nullptr;
+  std::unique_ptr<Expr> else_expr = parse_conditional();
+  if (!else_expr)
+    return nullptr;
+  e->args.push_back(std::move(then_expr));
+  e->args.push_back(std::move(else_expr));
+  return e;
+}
+
+/**
+ * Precedence climbing over the binary operators
+ */
+std::unique_ptr<Expr> Compiler::parse_binary(int min_prec) {
+  std::unique_ptr<Expr> lhs = parse_unary();
+  if (!lhs)
+    return nullptr;
+
+  for (;;) {
+    int prec = binary_precedence(peek());
+    if (prec == 0 || prec < min_prec)
+      return lhs;
+
+    std::string op = peek().text;
+    int line = peek().line;
+    tok++;
+    std::unique_ptr<Expr> rhs = parse_binary(prec + 1);
+    if (!rhs)
+      return nullptr;
+
+    ExprKind kind = E_BINARY;
+    if (op == "&&")
+      kind = E_LOGAND;
+    else if (op == "||")
+      kind = E_LOGOR;
+    std::unique_ptr<Expr> e(new Expr(kind, line));
+    e->op = op;
+    e->lhs = std::move(lhs);
+    e->rhs = std::move(rhs);
+    lhs = std::move(e);
+  }
+}
+
+std::unique_ptr<Expr> Compiler::parse_unary() {
+  int line = peek().line;
+
+  if (is_punct("-") || is_punct("!") || is_punct("~")) {
+    std::unique_ptr<Expr> e(new Expr(E_UNARY, line));
+    e->op = peek().text;
+    tok++;
+    e->lhs = parse_unary();
+    if (!e->lhs)
+      return nullptr;
+    return e;
+  }
+  if (accept("+"))
+    return parse_unary();
+
+  if (is_punct("++") || is_punct("--")) {
+    std::unique_ptr<Expr> e(new Expr(E_INCDEC, line));
+    e->op = peek().text;
+    tok++;
+    e->lhs = parse_unary();
+    if (!e->lhs)
+      return nullptr;
+    return e;
+  }
+
+  // Cast: (int) or (unsigned)
+  if (is_punct("(") && peek(1).kind == TK_IDENT &&
+      (peek(1).text == "int" || peek(1).text == "unsigned" ||
+       peek(1).text == "signed")) {
+    tok++;
+    bool is_void, is_unsigned;
+    if (!parse_type(is_void, is_unsigned) || !expect(")"))
+      return nullptr;
+    std::unique_ptr<Expr> e(new Expr(E_UNARY, line));
+    e->op = is_unsigned ? "(unsigned)" : "(int)";
+    e->lhs = parse_unary();
+    if (!e->lhs)
+      return nullptr;
+    return e;
+  }
+
+  return parse_postfix();
+}
+
+std::unique_ptr<Expr> Compiler::parse_postfix() {
+  std::unique_ptr<Expr> e = parse_primary();
+  if (!e)
+    return nullptr;
+
+  for (;;) {
+    int line = peek().line;
+    if (is_punct("[")) {
+      if (e->kind != E_VAR) {
+        report_error(line, "Only named arrays can be indexed");
+        return nullptr;
+      }
+      tok++;
+      std::unique_ptr<Expr> index(new Expr(E_INDEX, line));
+      index->name = e->name;
+      index->lhs = parse_expr();
+      if (!index->lhs || !expect("]"))
+        return nullptr;
+      e = std::move(index);
+    } else if (is_punct("(")) {
+      if (e->kind != E_VAR) {
+        report_error(line, "Only named functions can be called");
+        return nullptr;
+      }
+      tok++;
+      std::unique_ptr<Expr> call(new Expr(E_CALL, line));
+      call->name = e->name;
+      if (!is_punct(")")) {
+        do {
+          std::unique_ptr<Expr> arg = parse_assign();
+          if (!arg)
+            return nullptr;
+          call->args.push_back(std::move(arg));
+        } while (accept(","));
+      }
+      if (!expect(")"))
+        return nullptr;
+      e = std::move(call);
+    } else if (is_punct("++") || is_punct("--")) {
+      std::unique_ptr<Expr> inc(new Expr(E_INCDEC, line));
+      inc->op = peek().text;
+      inc->postfix = true;
+      tok++;
+      inc->lhs = std::move(e);
+      e = std::move(inc);
+    } else {
+      return e;
+    }
+  }
+}
+
+std::unique_ptr<Expr> Compiler::parse_primary() {
+  const Token &t = peek();
+
+  if (t.kind == TK_NUMBER) {
+    std::unique_ptr<Expr> e(new Expr(E_NUMBER, t.line));
+    e->value = t.value;
+    e->is_unsigned = t.is_unsigned;
+    tok++;
+    return e;
+  }
+  if (t.kind == TK_STRING) {
+    std::unique_ptr<Expr> e(new Expr(E_STRING, t.line));
+    e->text = t.text;
+    tok++;
+    // Adjacent string literals are concatenated
+    while (peek().kind == TK_STRING) {
+      e->text += peek().text;
+      tok++;
+    }
+    return e;
+  }
+  if (t.kind == TK_IDENT && !is_keyword(t.text)) {
+    std::unique_ptr<Expr> e(new Expr(E_VAR, t.line));
+    e->name = t.text;
+    tok++;
+    return e;
+  }
+  if (accept("(")) {
+    std::unique_ptr<Expr> e = parse_expr();
+    if (!e || !expect(")"))
+      return nullptr;
+    return e;
+  }
+
+  report_error(t.line, t.kind == TK_EOF ? "Unexpected end of file"
+                                        : "Unexpected '" + t.text + "'");
+  return nullptr;
+}
+
+/**
+ * Fold a constant expression (array sizes and global initializers)
+ */
+bool Compiler::eval_const(const Expr *e, int &value) {
+  int a, b;
+  switch (e->kind) {
+  case E_NUMBER:
+    value = e->value;
+    return true;
+  case E_UNARY:
+    if (!eval_const(e->lhs.get(), a))
+      return false;
+    if (e->op == "-")
+      value = (-a) & 0xFFFF;
+    else if (e->op == "~")
+      value = (~a) & 0xFFFF;
+    else if (e->op == "!")
+      value = (a == 0);
+    else
+      value = a;
+    return true;
+  case E_BINARY:
+    if (!eval_const(e->lhs.get(), a) || !eval_const(e->rhs.get(), b))
+      return false;
+    if (e->op == "+")
+      value = a + b;
+    else if (e->op == "-")
+      value = a - b;
+    else if (e->op == "*")
+      value = a * b;
+    else if (e->op == "&")
+      value = a & b;
+    else if (e->op == "|")
+      value = a | b;
+    else if (e->op == "^")
+      value = a ^ b;
+    else if (e->op == "<<")
+      value = a << (b & 15);
+    else if (e->op == ">>")
+      value = a >> (b & 15);
+    else if ((e->op == "/" || e->op == "%") && b != 0)
+      value = e->op == "/" ? a / b : a % b;
+    else
+      break;
+    value &= 0xFFFF;
+    return true;
+  default:
+    break;
+  }
+  report_error(e->line, "Expected a constant expression");
+  return false;
+}
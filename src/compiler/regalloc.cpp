@@ -0,0 +1,362 @@
+/**
+ * CFG Cleanup and Linear-Scan Register Allocation
+ *
+ * Before allocation the control-flow graph is tidied: jumps to jumps are
+ * threaded, unreachable blocks are dropped and dead instructions are
+ * removed. The remaining blocks are numbered in layout order and each
+ * vreg gets one live interval [start, end] covering every position where
+ * it is live. Intervals are then assigned to R0-R7 with the classic
+ * linear-scan algorithm; when registers run out, the interval ending
+ * furthest away is spilled to a slot in the software stack frame.
+ */
+
+#include "compiler.h"
+#include <algorithm>
+
+static bool is_terminator(IrOp op) {
+  return op == IR_BR || op == IR_BRI || op == IR_JMP || op == IR_RET;
+}
+
+static bool has_side_effects(const IrInstr &in) {
+  if (in.op == IR_STORE || in.op == IR_STOREG || in.op == IR_CALL ||
+      is_terminator(in.op))
+    return true;
+  // Reads of memory-mapped I/O are kept
+  return in.op == IR_LOADG && in.imm >= IO_START && in.imm <= IO_END;
+}
+
+/**
+ * Collect the vregs read by an instruction
+ */
+static void instr_uses(const IrInstr &in, std::vector<int> &uses) {
+  uses.clear();
+  if (in.a >= 0)
+    uses.push_back(in.a);
+  if (in.b >= 0)
+    uses.push_back(in.b);
+  for (size_t i = 0; i < in.args.size(); i++)
+    uses.push_back(in.args[i]);
+}
+
+static void successors(const IrInstr &term, std::vector<int> &succ) {
+  succ.clear();
+  if (term.op == IR_BR || term.op == IR_BRI) {
+    succ.push_back(term.target);
+    if (term.target2 != term.target)
+      succ.push_back(term.target2);
+  } else if (term.op == IR_JMP) {
+    succ.push_back(term.target);
+  }
+}
+
+/**
+ * Follow a chain of blocks that contain nothing but a jump
+ */
+static int resolve_jump(const IrFunction &f, int block) {
+  for (size_t hops = 0; hops < f.blocks.size(); hops++) {
+    const std::vector<IrInstr> &code = f.blocks[block].code;
+    if (code.size() != 1 || code[0].op != IR_JMP || code[0].target == block)
+      break;
+    block = code[0].target;
+  }
+  return block;
+}
+
+void Compiler::simplify_cfg(IrFunction &f) {
+  // Jump threading
+  for (size_t b = 0; b < f.blocks.size(); b++) {
+    std::vector<IrInstr> &code = f.blocks[b].code;
+    if (code.empty())
+      continue;
+    IrInstr &term = code.back();
+    if (term.op == IR_JMP || term.op == IR_BR || term.op == IR_BRI) {
+      term.target = resolve_jump(f, term.target);
+      if (term.op != IR_JMP) {
+        term.target2 = resolve_jump(f, term.target2);
+        if (term.target == term.target2) {
+          term.op = IR_JMP;
+          term.a = term.b = -1;
+        }
+      }
+    }
+  }
+
+  // Layout: reachable blocks in creation order, which follows the source
+  // and keeps loops rotated. A branch's fall-through block is pulled up
+  // right after it when that branch is its only predecessor.
+  std::vector<int> preds(f.blocks.size(), 0);
+  std::vector<bool> reachable(f.blocks.size(), false);
+  std::vector<int> work(1, 0);
+  std::vector<int> succ;
+  reachable[0] = true;
+  while (!work.empty()) {
+    int b = work.back();
+    work.pop_back();
+    successors(f.blocks[b].code.back(), succ);
+    for (size_t i = 0; i < succ.size(); i++) {
+      preds[succ[i]]++;
+      if (!reachable[succ[i]]) {
+        reachable[succ[i]] = true;
+        work.push_back(succ[i]);
+      }
+    }
+  }
+
+  f.layout.clear();
+  std::vector<bool> placed(f.blocks.size(), false);
+  for (size_t b = 0; b < f.blocks.size(); b++) {
+    int block = (int)b;
+    while (reachable[block] && !placed[block] && block != f.exit_block) {
+      f.layout.push_back(block);
+      placed[block] = true;
+      const IrInstr &term = f.blocks[block].code.back();
+      if ((term.op != IR_BR && term.op != IR_BRI) || preds[term.target2] != 1)
+        break;
+      block = term.target2;
+    }
+  }
+  if (reachable[f.exit_block])
+    f.layout.push_back(f.exit_block);
+
+  // Dead code elimination, repeated until nothing changes
+  bool changed = true;
+  std::vector<int> uses;
+  while (changed) {
+    changed = false;
+    std::vector<int> use_count(f.num_vregs, 0);
+    for (size_t i = 0; i < f.layout.size(); i++) {
+      const std::vector<IrInstr> &code = f.blocks[f.layout[i]].code;
+      for (size_t j = 0; j < code.size(); j++) {
+        instr_uses(code[j], uses);
+        for (size_t k = 0; k < uses.size(); k++)
+          use_count[uses[k]]++;
+      }
+    }
+    for (size_t i = 0; i < f.layout.size(); i++) {
+      std::vector<IrInstr> &code = f.blocks[f.layout[i]].code;
+      std::vector<IrInstr> kept;
+      for (size_t j = 0; j < code.size(); j++) {
+        IrInstr &in = code[j];
+        if (in.op == IR_MOV && in.dst == in.a) {
+          changed = true;
+          continue;
+        }
+        if (in.dst >= 0 && use_count[in.dst] == 0) {
+          if (in.op == IR_CALL) {
+            in.dst = -1;
+          } else if (!has_side_effects(in)) {
+            changed = true;
+            continue;
+          }
+        }
+        kept.push_back(in);
+      }
+      code.swap(kept);
+    }
+  }
+}
+
+/**
+ * Assign every vreg to a register or spill slot
+ * The live intervals are kept in live_start/live_end for the emitter
+ */
+void Compiler::allocate_registers(IrFunction &f) {
+  // Number instructions in layout order
+  int position = 0;
+  std::vector<int> block_start(f.blocks.size(), 0);
+  std::vector<int> block_end(f.blocks.size(), 0);
+  for (size_t i = 0; i < f.layout.size(); i++) {
+    int b = f.layout[i];
+    block_start[b] = position;
+    position += (int)f.blocks[b].code.size();
+    block_end[b] = position - 1;
+  }
+
+  // Backward liveness over the CFG
+  size_t n = f.num_vregs;
+  std::vector<std::vector<bool> > live_in(f.blocks.size(),
+                                          std::vector<bool>(n, false));
+  std::vector<std::vector<bool> > live_out = live_in;
+  std::vector<int> uses, succ;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = f.layout.size(); i-- > 0;) {
+      int b = f.layout[i];
+      const std::vector<IrInstr> &code = f.blocks[b].code;
+      std::vector<bool> live(n, false);
+      successors(code.back(), succ);
+      for (size_t s = 0; s < succ.size(); s++) {
+        for (size_t v = 0; v < n; v++) {
+          if (live_in[succ[s]][v])
+            live[v] = true;
+        }
+      }
+      live_out[b] = live;
+      for (size_t j = code.size(); j-- > 0;) {
+        if (code[j].dst >= 0)
+          live[code[j].dst] = false;
+        instr_uses(code[j], uses);
+        for (size_t k = 0; k < uses.size(); k++)
+          live[uses[k]] = true;
+      }
+      if (live != live_in[b]) {
+        live_in[b] = live;
+        changed = true;
+      }
+    }
+  }
+
+  // Build one interval per vreg
+  live_start.assign(n, -2);
+  live_end.assign(n, -2);
+  std::vector<int> hint(n, -1);
+  struct Extend {
+    static void at(std::vector<int> &s, std::vector<int> &e, int v, int p) {
+      if (s[v] == -2 || p < s[v])
+        s[v] = p;
+      if (e[v] == -2 || p > e[v])
+        e[v] = p;
+    }
+  };
+  for (size_t i = 0; i < f.layout.size(); i++) {
+    int b = f.layout[i];
+    for (size_t v = 0; v < n; v++) {
+      if (live_in[b][v])
+        Extend::at(live_start, live_end, (int)v, block_start[b]);
+      if (live_out[b][v])
+        Extend::at(live_start, live_end, (int)v, block_end[b]);
+    }
+    const std::vector<IrInstr> &code = f.blocks[b].code;
+    for (size_t j = 0; j < code.size(); j++) {
+      int p = block_start[b] + (int)j;
+      const IrInstr &in = code[j];
+      instr_uses(in, uses);
+      for (size_t k = 0; k < uses.size(); k++)
+        Extend::at(live_start, live_end, uses[k], p);
+      if (in.dst >= 0)
+        Extend::at(live_start, live_end, in.dst, p);
+      if (in.op == IR_CALL) {
+        for (size_t k = 0; k < in.args.size(); k++) {
+          if (hint[in.args[k]] < 0)
+            hint[in.args[k]] = 1 + (int)k;
+        }
+        if (in.dst >= 0 && hint[in.dst] < 0)
+          hint[in.dst] = 0;
+      }
+      if (in.op == IR_RET && in.a >= 0)
+        hint[in.a] = 0;
+    }
+  }
+  // Parameters arrive in R1..R4 before the first instruction
+  for (size_t i = 0; i < f.params.size(); i++) {
+    int v = f.params[i];
+    if (live_start[v] != -2) {
+      live_start[v] = -1;
+      hint[v] = 1 + (int)i;
+    }
+  }
+
+  // Functions with local arrays keep R7 as the frame pointer; if values
+  // must be spilled, R5 and R6 are also set aside for reloading them.
+  int spill_slots = 0;
+  uses_frame = f.frame_size > 0;
+  int num_regs = uses_frame ? NUM_REGISTERS - 1 : NUM_REGISTERS;
+  if (!linear_scan(f, num_regs, hint, spill_slots)) {
+    uses_frame = true;
+    spill_slots = 0;
+    linear_scan(f, REG_SCRATCH_A, hint, spill_slots);
+    stat_spills += spill_slots;
+  }
+  // Spill slots sit at the bottom of the frame, where the short ADDI
+  // offsets from the frame pointer reach, with local arrays above them
+  spill_bytes = 2 * spill_slots;
+  frame_total = spill_bytes + f.frame_size;
+  if (!uses_frame)
+    stat_frames_elided++;
+}
+
+/**
+ * Linear scan over registers 0..num_regs-1
+ * Returns false if any interval had to be spilled
+ */
+bool Compiler::linear_scan(IrFunction &f, int num_regs,
+                           const std::vector<int> &hint, int &spill_slots) {
+  // Registers tried for unhinted intervals: scratch-like registers first so
+  // argument and return registers stay free for call sites
+  static const int PREFERENCE[NUM_REGISTERS] = {5, 6, 7, 4, 3, 2, 1, 0};
+
+  size_t n = f.num_vregs;
+  locations.assign(n, Location());
+  std::vector<int> order;
+  for (size_t v = 0; v < n; v++) {
+    locations[v].reg = -1;
+    locations[v].slot = -1;
+    if (live_start[v] != -2)
+      order.push_back((int)v);
+  }
+  struct ByStart {
+    const std::vector<int> *start;
+    bool operator()(int x, int y) const {
+      if ((*start)[x] != (*start)[y])
+        return (*start)[x] < (*start)[y];
+      return x < y;
+    }
+  } by_start;
+  by_start.start = &live_start;
+  std::sort(order.begin(), order.end(), by_start);
+
+  std::vector<int> active; // Vregs currently holding a register
+  bool free_reg[NUM_REGISTERS];
+  for (int r = 0; r < NUM_REGISTERS; r++)
+    free_reg[r] = r < num_regs;
+
+  bool spilled = false;
+  for (size_t i = 0; i < order.size(); i++) {
+    int v = order[i];
+
+    // Expire intervals that ended before this one starts
+    for (size_t j = 0; j < active.size();) {
+      if (live_end[active[j]] <= live_start[v]) {
+        free_reg[locations[active[j]].reg] = true;
+        active.erase(active.begin() + j);
+      } else {
+        j++;
+      }
+    }
+
+    int reg = -1;
+    if (hint[v] >= 0 && hint[v] < num_regs && free_reg[hint[v]])
+      reg = hint[v];
+    for (int k = 0; k < NUM_REGISTERS && reg < 0; k++) {
+      if (PREFERENCE[k] < num_regs && free_reg[PREFERENCE[k]])
+        reg = PREFERENCE[k];
+    }
+
+    if (reg < 0) {
+      // Spill whichever interval ends last
+      spilled = true;
+      int victim = v;
+      size_t victim_index = active.size();
+      for (size_t j = 0; j < active.size(); j++) {
+        if (live_end[active[j]] > live_end[victim]) {
+          victim = active[j];
+          victim_index = j;
+        }
+      }
+      if (victim != v) {
+        reg = locations[victim].reg;
+        active.erase(active.begin() + victim_index);
+      }
+      locations[victim].reg = -1;
+      locations[victim].slot = 2 * spill_slots++;
+      if (victim == v)
+        continue;
+    }
+
+    locations[v].reg = reg;
+    free_reg[reg] = false;
+    active.push_back(v);
+  }
+  return !spilled;
+}
@@ -0,0 +1,154 @@
+/**
+ * Delta-Compressed Checkpoint Chains
+ *
+ * Memory's dirty-page tracking tells each capture which pages changed, so
+ * a checkpoint costs work in proportion to what the program wrote rather
+ * than to the 64KB image.
+ */
+
+#include "checkpoint.h"
+#include "codec.h"
+#include "core_dump.h"
+#include <cstring>
+#include <iostream>
+
+static const char CHAIN_MAGIC[4] = {'C', '1', '6', 'P'};
+static const uint16_t CHAIN_VERSION = 2;
+static const size_t PAGE_BYTES = (size_t)1 << PAGE_SHIFT;
+
+CheckpointChain::CheckpointChain(uint32_t interval)
+    : keyframe_interval(interval ? interval : 1) {}
+
+void CheckpointChain::capture(const CPU &cpu, Memory &memory) {
+  checkpoints.push_back(Checkpoint());
+  Checkpoint &c = checkpoints.back();
+  c.state = cpu.get_state();
+  c.input_position = (uint32_t)memory.get_input_position();
+  const byte_t *image = memory.raw();
+
+  if (is_keyframe(checkpoints.size() - 1)) {
+    std::memset(c.pages, 0xFF, sizeof(c.pages));
+    lz_compress(image, MEMORY_SIZE, c.payload);
+    previous.assign(image, image + MEMORY_SIZE);
+  } else {
+    std::memset(c.pages, 0, sizeof(c.pages));
+    std::vector<byte_t> delta;
+    for (size_t page = 0; page < NUM_PAGES; page++) {
+      if (!memory.is_page_dirty(page))
+        continue;
+      c.pages[page >> 3] |= (byte_t)(1 << (page & 7));
+      size_t base = page << PAGE_SHIFT;
+      for (size_t i = base; i < base + PAGE_BYTES; i++) {
+        delta.push_back(image[i] ^ previous[i]);
+        previous[i] = image[i];
+      }
+    }
+    if (!delta.empty())
+      lz_compress(&delta[0], delta.size(), c.payload);
+  }
+  memory.track_dirty_pages();
+}
+
+size_t CheckpointChain::page_count(size_t index) const {
+  size_t count = 0;
+  for (size_t i = 0; i < sizeof(checkpoints[index].pages); i++) {
+    for (byte_t bits = checkpoints[index].pages[i]; bits; bits &= bits - 1)
+      count++;
+  }
+  return count;
+}
+
+/**
+ * Decode the nearest keyframe at or before index, then XOR the deltas
+ * after it into place
+ */
+bool CheckpointChain::reconstruct(size_t index,
+                                  std::vector<byte_t> &image) const {
+  if (index >= checkpoints.size())
+    return false;
+  size_t keyframe = index - index % keyframe_interval;
+  const Checkpoint &k = checkpoints[keyframe];
+  image.assign(MEMORY_SIZE, 0);
+  if (k.payload.empty() ||
+      !lz_decompress(&k.payload[0], k.payload.size(), &image[0], MEMORY_SIZE))
+    return false;
+
+  std::vector<byte_t> delta;
+  for (size_t i = keyframe + 1; i <= index; i++) {
+    const Checkpoint &c = checkpoints[i];
+    size_t count = page_count(i);
+    if (count == 0)
+      continue;
+    delta.resize(count * PAGE_BYTES);
+    if (c.payload.empty() || !lz_decompress(&c.payload[0], c.payload.size(),
+                                            &delta[0], delta.size()))
+      return false;
+    const byte_t *next = &delta[0];
+    for (size_t page = 0; page < NUM_PAGES; page++) {
+      if (!(c.pages[page >> 3] & (1 << (page & 7))))
+        continue;
+      byte_t *target = &image[page << PAGE_SHIFT];
+      for (size_t b = 0; b < PAGE_BYTES; b++)
+        target[b] ^= next[b];
+      next += PAGE_BYTES;
+    }
+  }
+  return true;
+}
+
+bool CheckpointChain::save(const std::string &path) const {
+  std::vector<byte_t> out(CHAIN_MAGIC, CHAIN_MAGIC + 4);
+  put_u16(out, CHAIN_VERSION);
+  put_u16(out, 0);
+  put_u32(out, keyframe_interval);
+  put_u32(out, (uint32_t)checkpoints.size());
+  for (size_t i = 0; i < checkpoints.size(); i++) {
+    const Checkpoint &c = checkpoints[i];
+    put_cpu_state(out, c.state, c.input_position);
+    out.insert(out.end(), c.pages, c.pages + sizeof(c.pages));
+    put_u32(out, (uint32_t)c.payload.size());
+    out.insert(out.end(), c.payload.begin(), c.payload.end());
+  }
+  return write_whole_file(path, out);
+}
+
+bool CheckpointChain::load(const std::string &path) {
+  std::vector<byte_t> contents;
+  if (!read_whole_file(path, contents))
+    return false;
+
+  ByteReader in(contents);
+  const byte_t *magic = in.take(4);
+  if (!magic || std::memcmp(magic, CHAIN_MAGIC, 4) != 0 ||
+      in.u16() != CHAIN_VERSION) {
+    std::cerr << "Error: '" << path << "' is not a checkpoint file"
+              << std::endl;
+    return false;
+  }
+  in.u16();
+  uint32_t interval = in.u32();
+  uint32_t count = in.u32();
+
+  checkpoints.clear();
+  for (uint32_t i = 0; i < count && !in.failed; i++) {
+    checkpoints.push_back(Checkpoint());
+    Checkpoint &c = checkpoints.back();
+    read_cpu_state(in, c.state, c.input_position);
+    const byte_t *pages = in.take(sizeof(c.pages));
+    if (pages)
+      std::memcpy(c.pages, pages, sizeof(c.pages));
+    uint32_t size = in.u32();
+    const byte_t *payload = in.take(size);
+    if (payload)
+      c.payload.assign(payload, payload + size);
+  }
+  keyframe_interval = interval ? interval : 1;
+  if (in.failed || interval == 0 || count == 0 ||
+      !reconstruct(count - 1, previous)) {
+    checkpoints.clear();
+    std::cerr << "Error: Checkpoint file '" << path << "' is damaged"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "cpu.h"
+#include "memory.h"
+#include <string>
+#include <vector>
+
+const uint32_t DEFAULT_KEYFRAME_INTERVAL = 16;
+
+/**
+ * Checkpoints of a running program, kept small enough to take every
+ * million instructions. Checkpoint 0 and every keyframe_interval-th one
+ * after it hold the whole image; the others hold only the pages written
+ * since the previous checkpoint, XORed with their old contents so that
+ * unchanged bytes become zero runs, and LZ-compressed (codec.h).
+ * Rebuilding any checkpoint decodes at most one keyframe and
+ * keyframe_interval - 1 deltas.
+ *
+ * File layout (little-endian):
+ *   "C16P"  magic
+ *   u16     version (2), u16 reserved
+ *   u32     keyframe interval, u32 checkpoint count
+ *   then per checkpoint: the core state record (core_dump.h), a 32-byte
+ *   bitmap of the pages stored, u32 payload bytes and the payload
+ */
+class CheckpointChain {
+private:
+  struct Checkpoint {
+    CpuState state;
+    uint32_t input_position; // Console input bytes consumed
+    byte_t pages[NUM_PAGES / 8]; // Bit per page present in the payload
+    std::vector<byte_t> payload;
+  };
+
+  std::vector<Checkpoint> checkpoints;
+  std::vector<byte_t> previous; // Image at the last capture
+  uint32_t keyframe_interval;
+
+  bool is_keyframe(size_t index) const {
+    return index % keyframe_interval == 0;
+  }
+
+public:
+  explicit CheckpointChain(uint32_t interval = DEFAULT_KEYFRAME_INTERVAL);
+
+  // Record the CPU and the pages written since the last capture, then
+  // start tracking writes again
+  void capture(const CPU &cpu, Memory &memory);
+
+  size_t size() const { return checkpoints.size(); }
+  const CpuState &state(size_t index) const {
+    return checkpoints[index].state;
+  }
+  uint32_t input_position(size_t index) const {
+    return checkpoints[index].input_position;
+  }
+  size_t page_count(size_t index) const;
+  size_t stored_bytes(size_t index) const {
+    return checkpoints[index].payload.size();
+  }
+
+  // Memory image of a checkpoint; false if the chain is damaged
+  bool reconstruct(size_t index, std::vector<byte_t> &image) const;
+
+  bool save(const std::string &path) const;
+  bool load(const std::string &path);
+};
+
+#endif // CHECKPOINT_H
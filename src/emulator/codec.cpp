@@ -0,0 +1,145 @@
+/**
+ * LZ77 Codec
+ *
+ * Greedy matching through a 4096-entry hash of 3-byte prefixes. It is
+ * tuned for speed on sparse 64KB images rather than for ratio.
+ */
+
+#include "codec.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const size_t HASH_BITS = 12;
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_LITERALS = 128;
+static const size_t MAX_DISTANCE = 0xFFFF;
+
+static inline size_t hash3(const byte_t *p) {
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void emit_literals(const byte_t *start, size_t count,
+                          std::vector<byte_t> &output) {
+  while (count > 0) {
+    size_t run = count < MAX_LITERALS ? count : MAX_LITERALS;
+    output.push_back((byte_t)(run - 1));
+    output.insert(output.end(), start, start + run);
+    start += run;
+    count -= run;
+  }
+}
+
+void lz_compress(const byte_t *input, size_t size,
+                 std::vector<byte_t> &output) {
+  std::vector<int64_t> table((size_t)1 << HASH_BITS, -1);
+  size_t literal_start = 0;
+  size_t i = 0;
+
+  while (i + MIN_MATCH <= size) {
+    size_t h = hash3(input + i);
+    int64_t candidate = table[h];
+    table[h] = (int64_t)i;
+
+    size_t distance = (size_t)((int64_t)i - candidate);
+    if (candidate < 0 || distance > MAX_DISTANCE ||
+        std::memcmp(input + candidate, input + i, MIN_MATCH) != 0) {
+      i++;
+      continue;
+    }
+
+    // Overlapping matches are fine: distance 1 repeats one byte
+    size_t length = MIN_MATCH;
+    while (i + length < size && input[candidate + length] == input[i + length])
+      length++;
+
+    emit_literals(input + literal_start, i - literal_start, output);
+    size_t extra = length - MIN_MATCH;
+    if (extra < 0x7F) {
+      output.push_back((byte_t)(0x80 | extra));
+    } else {
+      output.push_back(0xFF);
+      extra -= 0x7F;
+      while (extra >= 255) {
+        output.push_back(255);
+        extra -= 255;
+      }
+      output.push_back((byte_t)extra);
+    }
+    output.push_back((byte_t)distance);
+    output.push_back((byte_t)(distance >> 8));
+
+    i += length;
+    literal_start = i;
+  }
+  emit_literals(input + literal_start, size - literal_start, output);
+}
+
+bool lz_decompress(const byte_t *input, size_t input_size, byte_t *output,
+                   size_t size) {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < input_size) {
+    byte_t token = input[in++];
+    if (token < 0x80) {
+      size_t run = (size_t)token + 1;
+      if (input_size - in < run || size - out < run)
+        return false;
+      std::memcpy(output + out, input + in, run);
+      in += run;
+      out += run;
+      continue;
+    }
+
+    size_t length = (size_t)(token & 0x7F);
+    if (length == 0x7F) {
+      byte_t more;
+      do {
+        if (in >= input_size)
+          return false;
+        more = input[in++];
+        length += more;
+      } while (more == 255);
+    }
+    length += MIN_MATCH;
+    if (input_size - in < 2)
+      return false;
+    size_t distance = (size_t)input[in] | ((size_t)input[in + 1] << 8);
+    in += 2;
+    if (distance == 0 || distance > out || size - out < length)
+      return false;
+    // Byte by byte, since a match may overlap its own output
+    for (size_t k = 0; k < length; k++, out++)
+      output[out] = output[out - distance];
+  }
+  return out == size;
+}
+
+bool read_whole_file(const std::string &path, std::vector<byte_t> &contents) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
+    return false;
+  }
+  contents.assign(std::istreambuf_iterator<char>(file),
+                  std::istreambuf_iterator<char>());
+  return true;
+}
+
+bool write_whole_file(const std::string &path,
+                      const std::vector<byte_t> &contents) {
+  std::ofstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not create file '" << path << "'" << std::endl;
+    return false;
+  }
+  if (!contents.empty())
+    file.write((const char *)&contents[0], contents.size());
+  if (!file) {
+    std::cerr << "Error: Could not write file '" << path << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,91 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include "../common/types.h"
+#include <string>
+#include <vector>
+
+/**
+ * In-tree LZ77 codec for memory images, cores and checkpoints.
+ *
+ * The stream is a sequence of tokens:
+ *   0x00-0x7F  literal run: (token + 1) bytes follow verbatim
+ *   0x80-0xFF  match: length (token & 0x7F) + 3, then a 2-byte
+ *              little-endian distance back into the output; a length
+ *              field of 0x7F is extended by following bytes, each added
+ *              to it, until one is below 255
+ * Long runs of one value, the common case in a 64KB guest image, become
+ * a single distance-1 match.
+ */
+void lz_compress(const byte_t *input, size_t size, std::vector<byte_t> &output);
+// False if the stream is corrupt or does not decode to exactly size bytes
+bool lz_decompress(const byte_t *input, size_t input_size, byte_t *output,
+                   size_t size);
+
+// Little-endian fields for the binary file formats
+inline void put_u16(std::vector<byte_t> &out, uint16_t value) {
+  out.push_back((byte_t)value);
+  out.push_back((byte_t)(value >> 8));
+}
+
+inline void put_u32(std::vector<byte_t> &out, uint32_t value) {
+  put_u16(out, (uint16_t)value);
+  put_u16(out, (uint16_t)(value >> 16));
+}
+
+inline void put_u64(std::vector<byte_t> &out, uint64_t value) {
+  put_u32(out, (uint32_t)value);
+  put_u32(out, (uint32_t)(value >> 32));
+}
+
+/**
+ * Reads fields back in order; any read past the end sets failed and
+ * returns zero, so callers can check once at the end
+ */
+class ByteReader {
+private:
+  const std::vector<byte_t> &data;
+  size_t position;
+
+public:
+  bool failed;
+
+  explicit ByteReader(const std::vector<byte_t> &bytes)
+      : data(bytes), position(0), failed(false) {}
+
+  uint8_t u8() {
+    if (position >= data.size()) {
+      failed = true;
+      return 0;
+    }
+    return data[position++];
+  }
+  uint16_t u16() {
+    uint16_t low = u8();
+    return (uint16_t)(low | (u8() << 8));
+  }
+  uint32_t u32() {
+    uint32_t low = u16();
+    return low | ((uint32_t)u16() << 16);
+  }
+  uint64_t u64() {
+    uint64_t low = u32();
+    return low | ((uint64_t)u32() << 32);
+  }
+  // Pointer to the next size bytes, or NULL if there are fewer left
+  const byte_t *take(size_t size) {
+    if (data.size() - position < size) {
+      failed = true;
+      return NULL;
+    }
+    position += size;
+    return &data[0] + position - size;
+  }
+  size_t remaining() const { return data.size() - position; }
+};
+
+bool read_whole_file(const std::string &path, std::vector<byte_t> &contents);
+bool write_whole_file(const std::string &path,
+                      const std::vector<byte_t> &contents);
+
+#endif // CODEC_H
@@ -0,0 +1,88 @@
+/**
+ * Core Dumps
+ *
+ * Written in one buffer and one write, so capturing a core costs a
+ * memcpy-sized amount of work (plus the LZ pass when compressed) rather
+ * than formatting 64K bytes of text.
+ */
+
+#include "core_dump.h"
+#include <cstring>
+#include <iostream>
+
+static const char CORE_MAGIC[4] = {'C', '1', '6', 'K'};
+
+void put_cpu_state(std::vector<byte_t> &out, const CpuState &state,
+                   uint32_t input_position) {
+  for (int i = 0; i < NUM_REGISTERS; i++)
+    put_u16(out, state.registers[i]);
+  put_u16(out, state.pc);
+  put_u16(out, state.sp);
+  put_u16(out, state.flags);
+  out.push_back(state.halted ? 1 : 0);
+  out.push_back(0);
+  put_u64(out, state.instruction_count);
+  put_u32(out, input_position);
+}
+
+void read_cpu_state(ByteReader &in, CpuState &state,
+                    uint32_t &input_position) {
+  for (int i = 0; i < NUM_REGISTERS; i++)
+    state.registers[i] = in.u16();
+  state.pc = in.u16();
+  state.sp = in.u16();
+  state.flags = in.u16();
+  state.halted = in.u8() != 0;
+  in.u8();
+  state.instruction_count = in.u64();
+  input_position = in.u32();
+}
+
+bool write_core(const std::string &path, const CpuState &state,
+                const Memory &memory, bool compress) {
+  std::vector<byte_t> out(CORE_MAGIC, CORE_MAGIC + 4);
+  put_u16(out, CORE_VERSION);
+  put_u16(out, compress ? CORE_COMPRESSED : 0);
+  put_cpu_state(out, state, (uint32_t)memory.get_input_position());
+
+  if (compress) {
+    std::vector<byte_t> packed;
+    lz_compress(memory.raw(), MEMORY_SIZE, packed);
+    put_u32(out, (uint32_t)packed.size());
+    out.insert(out.end(), packed.begin(), packed.end());
+  } else {
+    put_u32(out, (uint32_t)MEMORY_SIZE);
+    out.insert(out.end(), memory.raw(), memory.raw() + MEMORY_SIZE);
+  }
+  return write_whole_file(path, out);
+}
+
+bool read_core(const std::string &path, CpuState &state,
+               uint32_t &input_position, std::vector<byte_t> &image,
+               bool &compressed) {
+  std::vector<byte_t> contents;
+  if (!read_whole_file(path, contents))
+    return false;
+
+  ByteReader in(contents);
+  const byte_t *magic = in.take(4);
+  if (!magic || std::memcmp(magic, CORE_MAGIC, 4) != 0 ||
+      in.u16() != CORE_VERSION) {
+    std::cerr << "Error: '" << path << "' is not a core file" << std::endl;
+    return false;
+  }
+  compressed = (in.u16() & CORE_COMPRESSED) != 0;
+  read_cpu_state(in, state, input_position);
+  uint32_t size = in.u32();
+  const byte_t *payload = in.take(size);
+
+  image.assign(MEMORY_SIZE, 0);
+  bool ok = !in.failed &&
+            (compressed ? lz_decompress(payload, size, &image[0], MEMORY_SIZE)
+                        : size == MEMORY_SIZE);
+  if (ok && !compressed)
+    std::memcpy(&image[0], payload, MEMORY_SIZE);
+  if (!ok)
+    std::cerr << "Error: Core file '" << path << "' is damaged" << std::endl;
+  return ok;
+}
@@ -0,0 +1,39 @@
+#ifndef CORE_DUMP_H
+#define CORE_DUMP_H
+
+#include "codec.h"
+#include "cpu.h"
+#include "memory.h"
+#include <string>
+#include <vector>
+
+/**
+ * Binary core file: the CPU state and the whole 64KB memory image.
+ *
+ * Layout (little-endian):
+ *   "C16K"  magic
+ *   u16     version (2)
+ *   u16     CORE_COMPRESSED if the image is LZ-coded (codec.h)
+ *   u16 x8  R0-R7, then u16 PC, SP, FLAGS
+ *   u8      halted, u8 reserved
+ *   u64     instructions executed
+ *   u32     console input bytes consumed
+ *   u32     image bytes that follow, then the image
+ */
+const uint16_t CORE_VERSION = 2;
+const uint16_t CORE_COMPRESSED = 0x0001;
+
+// The 28-byte state record shared by cores and checkpoints
+void put_cpu_state(std::vector<byte_t> &out, const CpuState &state,
+                   uint32_t input_position);
+void read_cpu_state(ByteReader &in, CpuState &state,
+                    uint32_t &input_position);
+
+bool write_core(const std::string &path, const CpuState &state,
+                const Memory &memory, bool compress);
+// image receives all MEMORY_SIZE bytes
+bool read_core(const std::string &path, CpuState &state,
+               uint32_t &input_position, std::vector<byte_t> &image,
+               bool &compressed);
+
+#endif // CORE_DUMP_H
@@ -10,10 +10,13 @@
  */
 
 #include "cpu.h"
+#include "verifier.h"
 #include <iomanip>
 #include <iostream>
 
-CPU::CPU(Memory &mem) : memory(mem) { reset(); }
+CPU::CPU(Memory &mem) : memory(mem), debugger(NULL), coverage(NULL) {
+  reset();
+}
 
 
 void CPU::reset() {
@@ -26,6 +29,7 @@ void CPU::reset() {
   sp = STACK_END;        // Stack grows downward from top of memory
   flags = 0;             // Clear all condition flags
   halted = false;        // CPU is ready to run
+  faulted = false;
   debug_mode = false;
   instruction_count = 0;
 }
@@ -37,13 +41,43 @@ word_t CPU::get_register(int reg) const {
   return 0;
 }
 
+void CPU::set_register(int reg, word_t value) {
+  if (reg >= 0 && reg < NUM_REGISTERS) {
+    registers[reg] = value;
+  }
+}
+
+CpuState CPU::get_state() const {
+  CpuState state;
+  for (int i = 0; i < NUM_REGISTERS; i++)
+    state.registers[i] = registers[i];
+  state.pc = pc;
+  state.sp = sp;
+  state.flags = flags;
+  state.halted = halted;
+  state.instruction_count = instruction_count;
+  return state;
+}
+
+void CPU::set_state(const CpuState &state) {
+  for (int i = 0; i < NUM_REGISTERS; i++)
+    registers[i] = state.registers[i];
+  pc = state.pc;
+  sp = state.sp;
+  flags = state.flags;
+  halted = state.halted;
+  faulted = false;
+  instruction_count = state.instruction_count;
+}
+
 /**
  * Push a value onto the stack
  * Stack grows downward, so we decrement SP before writing
  */
 void CPU::push(word_t value) {
   sp -= 2; // Each word is 2 bytes
-  memory.write_word(sp, value);
+  if (!memory.write_word(sp, value))
+    memory_event();
 }
 
 /**
@@ -51,13 +85,63 @@ void CPU::push(word_t value) {
  * Read the value then increment SP
  */
 word_t CPU::pop() {
-  word_t value = memory.read_word(sp);
+  word_t value = memory.load_word(sp);
   sp += 2;
   return value;
 }
 
 void CPU::halt() { halted = true; }
 
+void CPU::code_fault(const char *access, addr_t address) {
+  std::cerr << "Fault: " << access << " 0x" << std::hex << std::setw(4)
+            << std::setfill('0') << address << std::dec << std::setfill(' ')
+            << " (Harvard mode, " << instruction_count
+            << " instructions executed)" << std::endl;
+  faulted = true;
+  halt();
+}
+
+void CPU::memory_event() {
+  addr_t address;
+  switch (memory.take_event(address)) {
+  case MEMORY_FAULT:
+    code_fault("write into the code segment at", address);
+    break;
+  case MEMORY_WATCH:
+    if (debugger)
+      debugger->watch_hit(*this, memory, address);
+    halt();
+    break;
+  default:
+    break;
+  }
+}
+
+bool CPU::break_here(addr_t address, word_t &original) {
+  if (!debugger) {
+    std::cerr << "BRK at 0x" << std::hex << address << std::dec
+              << " with no debugger attached" << std::endl;
+    faulted = true;
+    halt();
+    return false;
+  }
+  if (debugger->should_stop(*this, memory, address, original)) {
+    halt();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Start executing the subroutine at entry as if it had been CALLed from
+ * just before return_address; its RET resumes there
+ */
+void CPU::call(addr_t entry, addr_t return_address) {
+  push(return_address);
+  pc = entry;
+  halted = false;
+}
+
 /**
  * Execute program until CPU halts
  */
@@ -67,6 +151,203 @@ void CPU::run() {
   }
 }
 
+/**
+ * Execute until the CPU halts or has executed max_instructions in total
+ */
+void CPU::run_limited(uint64_t max_instructions) {
+  while (!halted && instruction_count < max_instructions) {
+    step();
+  }
+}
+
+/**
+ * Execute until HALT, counting each instruction at its address. Kept apart
+ * from run() so unprofiled execution pays nothing for it.
+ */
+void CPU::run_profiled(uint64_t *pc_counts) {
+  while (!halted) {
+    pc_counts[pc]++;
+    step();
+  }
+}
+
+/**
+ * Trusted fast mode. The verifier has already proven opcodes, static
+ * targets and direct stores, so this loop dispatches on pre-decoded
+ * instructions with no fetch, no unknown-opcode case and no debug checks.
+ * Only the facts the verifier cannot see are guarded: an indirect or
+ * stack store landing in the code, and a RET to an address that is not a
+ * verified instruction. Either one stops here with the CPU state exact,
+ * and the caller continues in run(), which rereads memory.
+ *
+ * Breakpoints are BRK opcodes patched into the decoded table, keeping the
+ * covered instruction's operands, so a declined breakpoint re-dispatches
+ * on the original opcode without leaving this loop.
+ */
+bool CPU::run_trusted(const Verifier &program) {
+  const DecodedInstruction *code = program.get_decoded();
+  const addr_t code_end = program.get_code_end();
+  DecodedInstruction resumed;
+
+  while (!halted) {
+    const DecodedInstruction *next = &code[pc >> 1];
+    pc += next->size;
+    instruction_count++;
+
+  dispatch:
+    const DecodedInstruction &in = *next;
+    switch (in.opcode) {
+    case OP_NOP:
+      registers[in.rd] = registers[in.rs];
+      break;
+    case OP_MOVI:
+      registers[in.rd] = in.value;
+      break;
+    case OP_LOAD_IND:
+      registers[in.rd] = memory.load_word(registers[in.rs]);
+      break;
+    case OP_LOAD_DIR:
+      registers[in.rd] = memory.load_word(in.value);
+      break;
+    case OP_STORE_IND: {
+      // In Harvard mode the write is refused instead and the CPU faults
+      addr_t address = registers[in.rd];
+      if (!memory.write_word(address, registers[in.rs]))
+        memory_event();
+      else if (address < code_end || (addr_t)(address + 1) < code_end)
+        return false;
+      break;
+    }
+    case OP_STORE_DIR:
+      if (!memory.write_word(in.value, registers[in.rs]))
+        memory_event();
+      break;
+    case OP_ADD:
+      registers[in.rd] = ALU::add(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_ADDI:
+      registers[in.rd] = ALU::add(registers[in.rs], in.value, flags);
+      break;
+    case OP_SUB:
+      registers[in.rd] = ALU::sub(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_SUBI:
+      registers[in.rd] = ALU::sub(registers[in.rs], in.value, flags);
+      break;
+    case OP_MUL:
+      registers[in.rd] = ALU::mul(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_DIV:
+      registers[in.rd] = ALU::div(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_INC:
+      registers[in.rd] = ALU::add(registers[in.rd], 1, flags);
+      break;
+    case OP_DEC:
+      registers[in.rd] = ALU::sub(registers[in.rd], 1, flags);
+      break;
+    case OP_AND:
+      registers[in.rd] =
+          ALU::and_op(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_ANDI:
+      registers[in.rd] = ALU::and_op(registers[in.rs], in.value, flags);
+      break;
+    case OP_OR:
+      registers[in.rd] = ALU::or_op(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_ORI:
+      registers[in.rd] = ALU::or_op(registers[in.rs], in.value, flags);
+      break;
+    case OP_XOR:
+      registers[in.rd] =
+          ALU::xor_op(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_NOT:
+      registers[in.rd] = ALU::not_op(registers[in.rs], flags);
+      break;
+    case OP_SHL:
+      registers[in.rd] = ALU::shl(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_SHLI:
+      registers[in.rd] = ALU::shl(registers[in.rs], in.value, flags);
+      break;
+    case OP_SHR:
+      registers[in.rd] = ALU::shr(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_SHRI:
+      registers[in.rd] = ALU::shr(registers[in.rs], in.value, flags);
+      break;
+    case OP_CMP:
+      ALU::compare(registers[in.rs], registers[in.rt], flags);
+      break;
+    case OP_CMPI:
+      ALU::compare(registers[in.rs], in.value, flags);
+      break;
+    case OP_JMP:
+      pc = in.value;
+      break;
+    case OP_JZ:
+      if (flags & FLAG_ZERO)
+        pc = in.value;
+      break;
+    case OP_JNZ:
+      if (!(flags & FLAG_ZERO))
+        pc = in.value;
+      break;
+    case OP_JC:
+      if (flags & FLAG_CARRY)
+        pc = in.value;
+      break;
+    case OP_JNC:
+      if (!(flags & FLAG_CARRY))
+        pc = in.value;
+      break;
+    case OP_JN:
+      if (flags & FLAG_NEGATIVE)
+        pc = in.value;
+      break;
+    case OP_CALL:
+      push(pc);
+      pc = in.value;
+      if (sp < code_end)
+        return false;
+      break;
+    case OP_RET:
+      pc = pop();
+      if ((pc & 1) || code[pc >> 1].size == 0)
+        return false;
+      break;
+    case OP_PUSH:
+      push(registers[in.rs]);
+      if (sp < code_end)
+        return false;
+      break;
+    case OP_POP:
+      registers[in.rd] = pop();
+      break;
+    case OP_HALT:
+      halt();
+      break;
+    case OP_BRK: {
+      addr_t address = (addr_t)(pc - in.size);
+      word_t original;
+      instruction_count--; // Not executed yet
+      if (!break_here(address, original)) {
+        pc = address;
+        break;
+      }
+      instruction_count++;
+      resumed = in;
+      resumed.opcode = GET_OPCODE(original);
+      next = &resumed;
+      goto dispatch;
+    }
+    }
+  }
+  return true;
+}
+
 /**
  * Execute a single instruction
  */
@@ -74,8 +355,9 @@ void CPU::step() {
   if (halted)
     return;
 
-  fetch_decode_execute();
+  // Counted first, so a watchpoint stop includes the writing instruction
   instruction_count++;
+  fetch_decode_execute();
 }
 
 /**
@@ -86,14 +368,18 @@ void CPU::step() {
  * 3. EXECUTE: Perform the operation
  */
 void CPU::fetch_decode_execute() {
-  // FETCH: Read the next instruction from memory
-  word_t instruction = memory.read_word(pc);
+  // FETCH: Read the next instruction (from the code copy in Harvard mode)
+  word_t instruction;
+  if (!memory.fetch_word(pc, instruction)) {
+    code_fault("instruction fetch outside the code segment at", pc);
+    return;
+  }
   addr_t current_pc = pc;
   pc += 2; // Move to next instruction (each instruction is 2 bytes)
 
   // Display instruction in debug mode
   if (debug_mode) {
-    std::cout << "\n[" << instruction_count << "] ";
+    std::cout << "\n[" << instruction_count - 1 << "] ";
     disassemble_instruction(instruction, current_pc);
     std::cout << std::endl;
   }
@@ -117,6 +403,7 @@ void CPU::execute_instruction(word_t instruction) {
   byte_t rt = GET_RT(instruction);
   byte_t imm4 = GET_IMM4(instruction);
   byte_t imm7 = GET_IMM7(instruction);
+  addr_t instruction_address = (addr_t)(pc - 2);
 
   // EXECUTE: Perform operation based on opcode
   switch (opcode) {
@@ -135,27 +422,29 @@ void CPU::execute_instruction(word_t instruction) {
 
   case OP_LOAD_IND:
     // Load word from memory address in Rs into Rd
-    registers[rd] = memory.read_word(registers[rs]);
+    registers[rd] = memory.load_word(registers[rs]);
     break;
 
   case OP_LOAD_DIR: {
     // Load from direct address (next word)
     word_t address = memory.read_word(pc);
     pc += 2;
-    registers[rd] = memory.read_word(address);
+    registers[rd] = memory.load_word(address);
     break;
   }
 
   case OP_STORE_IND:
     // Store to memory[Rd]
-    memory.write_word(registers[rd], registers[rs]);
+    if (!memory.write_word(registers[rd], registers[rs]))
+      memory_event();
     break;
 
   case OP_STORE_DIR: {
     // Store to direct address (next word)
     word_t address = memory.read_word(pc);
     pc += 2;
-    memory.write_word(address, registers[rs]);
+    if (!memory.write_word(address, registers[rs]))
+      memory_event();
     break;
   }
 
@@ -324,12 +613,32 @@ void CPU::execute_instruction(word_t instruction) {
     }
     break;
 
+  case OP_BRK: {
+    // Run the covered instruction, or stop on the breakpoint itself
+    addr_t address = (addr_t)(pc - 2);
+    word_t original;
+    instruction_count--; // Not executed yet
+    if (break_here(address, original)) {
+      instruction_count++;
+      execute_instruction(original);
+    } else {
+      pc = address;
+    }
+    break;
+  }
+
   default:
     std::cerr << "Unknown opcode: 0x" << std::hex << (int)opcode << std::dec
               << std::endl;
+    faulted = true;
     halt();
     break;
   }
+
+  // Edges are the (instruction, next pc) pairs of control transfers,
+  // so a conditional branch has one for each outcome
+  if (coverage && opcode >= OP_JMP && opcode <= OP_RET)
+    record_edge(instruction_address, pc);
 }
 
 void CPU::print_registers() const {
@@ -414,6 +723,7 @@ void CPU::disassemble_instruction(word_t instruction, addr_t address) const {
     break;
   case OP_RET:
   case OP_HALT:
+  case OP_BRK:
     // No operands
     break;
   default:
@@ -7,6 +7,38 @@
 #include "memory.h"
 #include <string>
 
+// Bytes in an edge coverage map (a power of two)
+const size_t COVERAGE_MAP_SIZE = 1 << 14;
+
+class CPU;
+class Verifier;
+class TierCache;
+class HostProfiler;
+struct Block;
+
+// Architectural state, as saved in cores and checkpoints
+struct CpuState {
+  word_t registers[NUM_REGISTERS];
+  word_t pc;
+  word_t sp;
+  word_t flags;
+  bool halted;
+  uint64_t instruction_count;
+};
+
+/**
+ * Receives breakpoint and watchpoint events; implemented by Debugger
+ */
+class DebugHandler {
+public:
+  virtual ~DebugHandler() {}
+  // Called on BRK: true to stop, else original is the instruction to run
+  virtual bool should_stop(const CPU &cpu, const Memory &memory,
+                           addr_t address, word_t &original) = 0;
+  virtual void watch_hit(const CPU &cpu, const Memory &memory,
+                         addr_t address) = 0;
+};
+
 class CPU {
 private:
   // Registers
@@ -20,8 +52,12 @@ private:
 
   // CPU state
   bool halted;
+  bool faulted; // Stopped by a protection fault, an unknown opcode, or a
+                // BRK with no debugger attached
   bool debug_mode;
+  DebugHandler *debugger; // Breakpoint and watchpoint handler, or NULL
   uint64_t instruction_count;
+  byte_t *coverage; // Edge hit counts for the fuzzer, or NULL
 
   // Instruction execution helpers
   void execute_instruction(word_t instruction);
@@ -31,25 +67,60 @@ private:
   void push(word_t value);
   word_t pop();
 
+  // Count a control transfer in the coverage map
+  void record_edge(addr_t from, addr_t to) {
+    coverage[((from >> 1) ^ (to << 3) ^ (to >> 3)) &
+             (COVERAGE_MAP_SIZE - 1)]++;
+  }
+
+  // Report an access the Harvard code segment refused, and stop
+  void code_fault(const char *access, addr_t address);
+  // A write was refused or watched: fault or stop at the watchpoint
+  void memory_event();
+  // BRK at address: false to stop there, else the instruction it covers
+  bool break_here(addr_t address, word_t &original);
+
+  // Tiered execution (tiers.cpp)
+  void interpret_block(TierCache &cache);
+  void run_block(TierCache &cache, const Block &block);
+
 public:
   CPU(Memory &mem);
 
   // CPU control
   void reset();
   void run();
+  void run_limited(uint64_t max_instructions); // Stop at HALT or the limit
+  void run_profiled(uint64_t *pc_counts); // Count executions per address
+  // Measure host cost of sampled handlers (host_profiler.cpp)
+  void run_host_profiled(HostProfiler &profiler);
+  // Run a verified program from its pre-decoded form; false if it had to
+  // hand over to run() (a store hit the code or RET left verified code)
+  bool run_trusted(const Verifier &program);
+  // Interpret cold code and compile blocks as they get hot
+  void run_tiered(TierCache &cache);
   void step(); // Execute single instruction
   void halt();
+  void call(addr_t entry, addr_t return_address); // Enter a subroutine
 
   // State inspection
   bool is_halted() const { return halted; }
+  bool is_faulted() const { return faulted; }
   word_t get_pc() const { return pc; }
   word_t get_sp() const { return sp; }
   word_t get_flags() const { return flags; }
   word_t get_register(int reg) const;
+  void set_register(int reg, word_t value);
   uint64_t get_instruction_count() const { return instruction_count; }
+  CpuState get_state() const;
+  void set_state(const CpuState &state);
 
   // Debug features
   void set_debug_mode(bool enable) { debug_mode = enable; }
+  void set_debugger(DebugHandler *handler) { debugger = handler; }
+  // Count every branch, call and return outcome in the interpreter into
+  // a COVERAGE_MAP_SIZE map (NULL to stop)
+  void set_coverage(byte_t *map) { coverage = map; }
   void print_registers() const;
   void print_flags() const;
   void disassemble_instruction(word_t instruction, addr_t address) const;
@@ -0,0 +1,243 @@
+/**
+ * Debugger: Breakpoints and Watchpoints
+ *
+ * Nothing here runs per instruction. Breakpoint conditions are parsed
+ * once into Predicate lists and only evaluated when their BRK is
+ * reached; a breakpoint whose condition fails hands back the covered
+ * instruction and execution carries on.
+ */
+
+#include "debugger.h"
+#include "cpu.h"
+#include "profiler.h"
+#include "verifier.h"
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+Debugger::Debugger() : stopped(false) {}
+
+static std::string hex_word(word_t value) {
+  std::ostringstream out;
+  out << "0x" << std::hex << std::setw(4) << std::setfill('0') << value;
+  return out.str();
+}
+
+static bool parse_number(const std::string &text, word_t &value) {
+  if (text.empty())
+    return false;
+  char *end = NULL;
+  long parsed = std::strtol(text.c_str(), &end, 0);
+  if (*end != '\0' || parsed < -32768 || parsed > 0xFFFF)
+    return false;
+  value = (word_t)parsed;
+  return true;
+}
+
+// A number, or a label from the symbol map
+static bool parse_location(const std::string &text, const Profiler *symbols,
+                           addr_t &address) {
+  word_t value;
+  if (parse_number(text, value)) {
+    address = value;
+    return true;
+  }
+  return symbols && symbols->lookup(text, address);
+}
+
+bool Debugger::parse_operand(const std::string &text, const Profiler *symbols,
+                             Predicate::Operand &kind, word_t &value) {
+  if (text.size() == 2 && (text[0] == 'R' || text[0] == 'r') &&
+      text[1] >= '0' && text[1] < '0' + NUM_REGISTERS) {
+    kind = Predicate::REGISTER;
+    value = (word_t)(text[1] - '0');
+    return true;
+  }
+  if (text.size() > 2 && text[0] == '[' && text[text.size() - 1] == ']') {
+    addr_t address;
+    if (!parse_location(text.substr(1, text.size() - 2), symbols, address))
+      return false;
+    kind = Predicate::MEMORY;
+    value = address;
+    return true;
+  }
+  kind = Predicate::CONSTANT;
+  return parse_number(text, value);
+}
+
+bool Debugger::parse_condition(const std::string &text,
+                               const Profiler *symbols,
+                               std::vector<Predicate> &conditions) {
+  static const struct {
+    const char *text;
+    Predicate::Compare compare;
+  } COMPARES[] = {{"==", Predicate::EQ}, {"!=", Predicate::NE},
+                  {"<=", Predicate::LE}, {">=", Predicate::GE},
+                  {"<", Predicate::LT},  {">", Predicate::GT}};
+
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t end = text.find("&&", start);
+    if (end == std::string::npos)
+      end = text.size();
+    std::string term;
+    for (size_t i = start; i < end; i++) {
+      if (!std::isspace((unsigned char)text[i]))
+        term += text[i];
+    }
+
+    Predicate p;
+    bool parsed = false;
+    for (size_t c = 0; c < sizeof(COMPARES) / sizeof(COMPARES[0]); c++) {
+      size_t at = term.find(COMPARES[c].text);
+      if (at == std::string::npos || at == 0)
+        continue;
+      p.compare = COMPARES[c].compare;
+      std::string rhs = term.substr(at + std::string(COMPARES[c].text).size());
+      parsed = parse_operand(term.substr(0, at), symbols, p.lhs_kind, p.lhs) &&
+               parse_operand(rhs, symbols, p.rhs_kind, p.rhs);
+      break;
+    }
+    if (!parsed) {
+      std::cerr << "Error: Invalid breakpoint condition '" << term << "'"
+                << std::endl;
+      return false;
+    }
+    conditions.push_back(p);
+    start = end + 2;
+  }
+  return true;
+}
+
+bool Debugger::add_breakpoint(const std::string &spec,
+                              const Profiler *symbols) {
+  size_t colon = spec.find(':');
+  Breakpoint b;
+  b.original = 0;
+  b.hits = 0;
+  if (!parse_location(spec.substr(0, colon), symbols, b.address)) {
+    std::cerr << "Error: Unknown breakpoint location '"
+              << spec.substr(0, colon) << "'" << std::endl;
+    return false;
+  }
+  if (colon != std::string::npos &&
+      !parse_condition(spec.substr(colon + 1), symbols, b.conditions))
+    return false;
+  breakpoints[b.address] = b;
+  return true;
+}
+
+bool Debugger::add_watchpoint(const std::string &spec,
+                              const Profiler *symbols) {
+  size_t colon = spec.find(':');
+  addr_t address;
+  word_t length = 2;
+  if (!parse_location(spec.substr(0, colon), symbols, address) ||
+      (colon != std::string::npos &&
+       (!parse_number(spec.substr(colon + 1), length) || length == 0))) {
+    std::cerr << "Error: Invalid watchpoint '" << spec << "'" << std::endl;
+    return false;
+  }
+  watchpoints.push_back(std::make_pair(address, (size_t)length));
+  return true;
+}
+
+bool Debugger::arm(Memory &memory, Verifier *verified) {
+  for (std::map<addr_t, Breakpoint>::iterator it = breakpoints.begin();
+       it != breakpoints.end(); ++it) {
+    Breakpoint &b = it->second;
+    if ((b.address & 1) || b.address >= PROGRAM_END) {
+      std::cerr << "Error: Breakpoint " << hex_word(b.address)
+                << " is not in the code segment" << std::endl;
+      return false;
+    }
+    if (verified && !verified->plant_breakpoint(b.address)) {
+      std::cerr << "Error: Breakpoint " << hex_word(b.address)
+                << " is not on a verified instruction" << std::endl;
+      return false;
+    }
+    memory.fetch_word(b.address, b.original);
+    memory.patch_code(b.address, MAKE_INSTR(OP_BRK, 0, 0, 0));
+  }
+  for (size_t i = 0; i < watchpoints.size(); i++)
+    memory.watch(watchpoints[i].first, watchpoints[i].second);
+  return true;
+}
+
+void Debugger::disarm(Memory &memory) const {
+  for (std::map<addr_t, Breakpoint>::const_iterator it = breakpoints.begin();
+       it != breakpoints.end(); ++it)
+    memory.patch_code(it->first, it->second.original);
+}
+
+word_t Debugger::evaluate(const CPU &cpu, const Memory &memory,
+                          Predicate::Operand kind, word_t value) const {
+  switch (kind) {
+  case Predicate::REGISTER:
+    return cpu.get_register(value);
+  case Predicate::MEMORY:
+    return memory.read_word(value);
+  default:
+    return value;
+  }
+}
+
+bool Debugger::should_stop(const CPU &cpu, const Memory &memory,
+                           addr_t address, word_t &original) {
+  std::map<addr_t, Breakpoint>::iterator it = breakpoints.find(address);
+  if (it == breakpoints.end()) {
+    std::cerr << "BRK at " << hex_word(address) << " is not a breakpoint"
+              << std::endl;
+    stopped = true;
+    return true;
+  }
+  Breakpoint &b = it->second;
+  b.hits++;
+  original = b.original;
+
+  for (size_t i = 0; i < b.conditions.size(); i++) {
+    const Predicate &p = b.conditions[i];
+    word_t lhs = evaluate(cpu, memory, p.lhs_kind, p.lhs);
+    word_t rhs = evaluate(cpu, memory, p.rhs_kind, p.rhs);
+    bool holds;
+    switch (p.compare) {
+    case Predicate::EQ:
+      holds = lhs == rhs;
+      break;
+    case Predicate::NE:
+      holds = lhs != rhs;
+      break;
+    case Predicate::LT:
+      holds = lhs < rhs;
+      break;
+    case Predicate::LE:
+      holds = lhs <= rhs;
+      break;
+    case Predicate::GT:
+      holds = lhs > rhs;
+      break;
+    default:
+      holds = lhs >= rhs;
+      break;
+    }
+    if (!holds)
+      return false;
+  }
+
+  std::cerr << "Breakpoint " << hex_word(address) << " hit (pass " << b.hits
+            << ") after " << cpu.get_instruction_count() << " instructions"
+            << std::endl;
+  stopped = true;
+  return true;
+}
+
+void Debugger::watch_hit(const CPU &cpu, const Memory &memory,
+                         addr_t address) {
+  std::cerr << "Watchpoint " << hex_word(address) << " written: now "
+            << hex_word(memory.read_word(address)) << ", next PC "
+            << hex_word(cpu.get_pc()) << ", after "
+            << cpu.get_instruction_count() << " instructions" << std::endl;
+  stopped = true;
+}
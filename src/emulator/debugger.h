@@ -0,0 +1,78 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include "../common/types.h"
+#include "cpu.h"
+#include "memory.h"
+#include <map>
+#include <string>
+#include <vector>
+
+class Profiler;
+class Verifier;
+
+/**
+ * One comparison of a breakpoint condition, e.g. "R1==3" or
+ * "[0x8000]>=10". Operands are a register, a memory word or a constant;
+ * comparisons are unsigned.
+ */
+struct Predicate {
+  enum Operand { REGISTER, MEMORY, CONSTANT };
+  enum Compare { EQ, NE, LT, LE, GT, GE };
+
+  Operand lhs_kind;
+  word_t lhs;
+  Compare compare;
+  Operand rhs_kind;
+  word_t rhs;
+};
+
+struct Breakpoint {
+  addr_t address;
+  word_t original;                   // Instruction word under the BRK
+  std::vector<Predicate> conditions; // All must hold; empty = always
+  uint64_t hits;                     // Times reached, taken or not
+};
+
+/**
+ * Breakpoints and watchpoints that cost nothing until they are reached.
+ * A breakpoint replaces its instruction with BRK in the instruction
+ * stream (and in a verified program's decoded table); a watchpoint marks
+ * its page in the Memory page attribute table, so only writes to watched
+ * pages take the slow path.
+ */
+class Debugger : public DebugHandler {
+private:
+  std::map<addr_t, Breakpoint> breakpoints;
+  std::vector<std::pair<addr_t, size_t> > watchpoints;
+  bool stopped;
+
+  bool parse_operand(const std::string &text, const Profiler *symbols,
+                     Predicate::Operand &kind, word_t &value);
+  bool parse_condition(const std::string &text, const Profiler *symbols,
+                       std::vector<Predicate> &conditions);
+  word_t evaluate(const CPU &cpu, const Memory &memory,
+                  Predicate::Operand kind, word_t value) const;
+
+public:
+  Debugger();
+
+  // "<address|label>[:<cond>[&&<cond>...]]", e.g. "loop:R1==3&&R2>0"
+  bool add_breakpoint(const std::string &spec, const Profiler *symbols);
+  // "<address|label>[:<bytes>]", 2 bytes (one word) by default
+  bool add_watchpoint(const std::string &spec, const Profiler *symbols);
+
+  // Plant everything into a loaded program; verified may be NULL
+  bool arm(Memory &memory, Verifier *verified);
+  // Put the original instructions back, e.g. before saving memory
+  void disarm(Memory &memory) const;
+
+  // Called on BRK: true to stop, else original is the instruction to run
+  bool should_stop(const CPU &cpu, const Memory &memory, addr_t address,
+                   word_t &original);
+  void watch_hit(const CPU &cpu, const Memory &memory, addr_t address);
+
+  bool has_stopped() const { return stopped; }
+};
+
+#endif // DEBUGGER_H
@@ -0,0 +1,245 @@
+/**
+ * Host Self-Profiling
+ *
+ * A sampled instruction is fetched and decoded as in step(), then its
+ * handler, CPU::execute_instruction, runs between two counter reads. All
+ * other instructions go through the plain step(), so between samples the
+ * emulator pays only for a countdown.
+ */
+
+#include "host_profiler.h"
+#include "../common/instructions.h"
+#include "cpu.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const int CALIBRATION_ROUNDS = 1000;
+
+// Cycles when perf_event_open is unavailable
+static uint64_t host_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// Opcodes that share a mnemonic are told apart by addressing mode
+static const char *handler_name(byte_t opcode) {
+  switch (opcode) {
+  case OP_MOV:
+    return "MOV/NOP";
+  case OP_LOAD_IND:
+    return "LOAD ind";
+  case OP_LOAD_DIR:
+    return "LOAD dir";
+  case OP_STORE_IND:
+    return "STORE ind";
+  case OP_STORE_DIR:
+    return "STORE dir";
+  default:
+    return get_opcode_name(opcode);
+  }
+}
+
+HostProfiler::HostProfiler()
+    : group(-1), opened(0), interval(1), countdown(1), seed(0x2545F491) {
+  for (int c = 0; c < NUM_HOST_COUNTERS; c++) {
+    fds[c] = -1;
+    slot[c] = -1;
+    overhead[c] = 0;
+  }
+  std::memset(samples, 0, sizeof(samples));
+  std::memset(totals, 0, sizeof(totals));
+}
+
+HostProfiler::~HostProfiler() {
+#ifdef __linux__
+  for (int c = 0; c < NUM_HOST_COUNTERS; c++) {
+    if (fds[c] >= 0)
+      close(fds[c]);
+  }
+#endif
+}
+
+/**
+ * Open cycles as the group leader and the miss counters as members, so
+ * one read() returns all of them
+ */
+void HostProfiler::open_counters() {
+#ifdef __linux__
+  static const uint32_t types[NUM_HOST_COUNTERS] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+  static const uint64_t configs[NUM_HOST_COUNTERS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_BRANCH_MISSES,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+
+  for (int c = 0; c < NUM_HOST_COUNTERS; c++) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = types[c];
+    attr.size = sizeof(attr);
+    attr.config = configs[c];
+    attr.disabled = group < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    fds[c] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+    if (fds[c] < 0) {
+      if (c == HOST_CYCLES)
+        return; // No group to join
+      continue;
+    }
+    if (group < 0)
+      group = fds[c];
+    slot[c] = opened++;
+  }
+  ioctl(group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void HostProfiler::read(HostReading &reading) const {
+#ifdef __linux__
+  if (group >= 0) {
+    uint64_t buffer[1 + NUM_HOST_COUNTERS];
+    if (::read(group, buffer, sizeof(buffer)) < (ssize_t)sizeof(uint64_t))
+      buffer[0] = 0;
+    for (int c = 0; c < NUM_HOST_COUNTERS; c++)
+      reading.value[c] = slot[c] >= 0 && (uint64_t)slot[c] < buffer[0]
+                             ? buffer[1 + slot[c]]
+                             : 0;
+    return;
+  }
+#endif
+  reading.value[HOST_CYCLES] = host_clock();
+  reading.value[HOST_BRANCH_MISSES] = 0;
+  reading.value[HOST_L1D_MISSES] = 0;
+}
+
+/**
+ * The smallest difference between two back-to-back reads is what every
+ * sample pays for measuring itself
+ */
+void HostProfiler::calibrate() {
+  for (int c = 0; c < NUM_HOST_COUNTERS; c++)
+    overhead[c] = ~(uint64_t)0;
+  for (int i = 0; i < CALIBRATION_ROUNDS; i++) {
+    HostReading before, after;
+    read(before);
+    read(after);
+    for (int c = 0; c < NUM_HOST_COUNTERS; c++)
+      overhead[c] = std::min(overhead[c], after.value[c] - before.value[c]);
+  }
+}
+
+// Gaps of 1..2*interval-1 instructions, interval on average
+void HostProfiler::schedule() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  countdown = interval > 1 ? 1 + seed % (2 * interval - 1) : 1;
+}
+
+void HostProfiler::start(uint32_t sample_interval) {
+  interval = std::max<uint32_t>(1, sample_interval);
+  if (group < 0)
+    open_counters();
+  calibrate();
+  schedule();
+}
+
+void HostProfiler::record(byte_t opcode, const HostReading &before,
+                          const HostReading &after) {
+  opcode &= NUM_OPCODES - 1;
+  samples[opcode]++;
+  for (int c = 0; c < NUM_HOST_COUNTERS; c++) {
+    uint64_t cost = after.value[c] - before.value[c];
+    totals[opcode][c] += cost > overhead[c] ? cost - overhead[c] : 0;
+  }
+  schedule();
+}
+
+void HostProfiler::report(std::ostream &out) const {
+  uint64_t total_samples = 0;
+  uint64_t total_cycles = 0;
+  std::vector<std::pair<uint64_t, int> > rows;
+  for (int op = 0; op < NUM_OPCODES; op++) {
+    if (samples[op] == 0)
+      continue;
+    total_samples += samples[op];
+    total_cycles += totals[op][HOST_CYCLES];
+    rows.push_back(std::make_pair(totals[op][HOST_CYCLES], op));
+  }
+  std::sort(rows.rbegin(), rows.rend());
+
+  out << "Sampled " << total_samples << " handlers, about 1 in " << interval
+      << " instructions; cycles from "
+      << (has_counter(HOST_CYCLES) ? "perf_event_open" : "the host clock")
+      << ", less " << overhead[HOST_CYCLES] << " per sample for the reads"
+      << std::endl;
+  out << std::setfill(' ') << std::left << std::setw(10) << "Opcode"
+      << std::right << std::setw(10) << "Samples" << std::setw(9) << "Share"
+      << std::setw(12) << "Cycles" << std::setw(14) << "Branch misses"
+      << std::setw(12) << "L1d misses" << std::endl;
+  for (size_t i = 0; i < rows.size(); i++) {
+    int op = rows[i].second;
+    double n = (double)samples[op];
+    out << std::left << std::setw(10) << handler_name((byte_t)op)
+        << std::right << std::setw(10) << samples[op] << std::fixed
+        << std::setprecision(1) << std::setw(8)
+        << (total_cycles ? 100.0 * totals[op][HOST_CYCLES] / total_cycles
+                         : 0.0)
+        << "%" << std::setw(12) << totals[op][HOST_CYCLES] / n
+        << std::setprecision(3);
+    for (int c = HOST_BRANCH_MISSES; c < NUM_HOST_COUNTERS; c++) {
+      out << std::setw(c == HOST_BRANCH_MISSES ? 14 : 12);
+      if (has_counter((HostCounter)c))
+        out << totals[op][c] / n;
+      else
+        out << "n/a";
+    }
+    out << std::endl;
+  }
+}
+
+/**
+ * Execute until HALT, timing the handler of every sampled instruction
+ */
+void CPU::run_host_profiled(HostProfiler &profiler) {
+  while (!halted) {
+    if (!profiler.due()) {
+      step();
+      continue;
+    }
+    instruction_count++;
+    word_t instruction;
+    if (!memory.fetch_word(pc, instruction)) {
+      code_fault("instruction fetch outside the code segment at", pc);
+      return;
+    }
+    pc += 2;
+
+    HostReading before, after;
+    profiler.read(before);
+    execute_instruction(instruction);
+    profiler.read(after);
+    profiler.record(GET_OPCODE(instruction), before, after);
+  }
+}
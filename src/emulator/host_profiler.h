@@ -0,0 +1,68 @@
+#ifndef HOST_PROFILER_H
+#define HOST_PROFILER_H
+
+#include "../common/types.h"
+#include <ostream>
+
+enum HostCounter {
+  HOST_CYCLES = 0,
+  HOST_BRANCH_MISSES,
+  HOST_L1D_MISSES,
+  NUM_HOST_COUNTERS
+};
+
+struct HostReading {
+  uint64_t value[NUM_HOST_COUNTERS];
+};
+
+const int NUM_OPCODES = 64;
+
+/**
+ * Host-side profile of the emulator itself: what each guest opcode's
+ * handler costs in host cycles, branch mispredictions and L1 data cache
+ * misses. Counters are read around one handler every `interval`
+ * instructions on average; the gaps are jittered so a loop whose length
+ * divides the interval is not always sampled at the same instruction.
+ *
+ * Counters come from perf_event_open where the kernel allows it; without
+ * it cycles fall back to the time-stamp counter and misses are not
+ * reported. The cost of the reads themselves is measured at start-up and
+ * subtracted from every sample.
+ */
+class HostProfiler {
+private:
+  int group;                      // perf group leader, -1 if unavailable
+  int fds[NUM_HOST_COUNTERS];     // -1 for a counter the host lacks
+  int slot[NUM_HOST_COUNTERS];    // Position in a group read
+  int opened;                     // Counters in the group
+  uint32_t interval;
+  uint32_t countdown;
+  uint32_t seed;
+
+  uint64_t samples[NUM_OPCODES];
+  uint64_t totals[NUM_OPCODES][NUM_HOST_COUNTERS];
+  uint64_t overhead[NUM_HOST_COUNTERS]; // An empty pair of reads
+
+  void open_counters();
+  void calibrate();
+  void schedule();
+
+public:
+  HostProfiler();
+  ~HostProfiler();
+
+  // Sample about one instruction in every sample_interval
+  void start(uint32_t sample_interval);
+
+  // Count down to the next sample; true if this instruction is one
+  bool due() { return --countdown == 0; }
+  void read(HostReading &reading) const;
+  void record(byte_t opcode, const HostReading &before,
+              const HostReading &after);
+
+  bool has_counter(HostCounter counter) const { return fds[counter] >= 0; }
+  // Per opcode, costliest first
+  void report(std::ostream &out) const;
+};
+
+#endif // HOST_PROFILER_H
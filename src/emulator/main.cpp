@@ -5,10 +5,23 @@
  * machine code produced by our assembler.
  */
 
+#include "checkpoint.h"
+#include "core_dump.h"
 #include "cpu.h"
+#include "debugger.h"
+#include "host_profiler.h"
 #include "memory.h"
+#include "profiler.h"
+#include "tiers.h"
+#include "verifier.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <vector>
 
 void print_usage(const char *program_name) {
   std::cout << "Usage: " << program_name << " <binary_file> [options]\n";
@@ -16,9 +29,240 @@ void print_usage(const char *program_name) {
   std::cout
       << "  -d, --debug    Enable debug mode (show instruction execution)\n";
   std::cout << "  -m, --memdump  Dump memory after execution\n";
+  std::cout << "  -q, --quiet    Print only the program's own output\n";
+  std::cout << "  -f, --fast     Verify the binary, then run it in trusted "
+               "fast mode\n";
+  std::cout << "  -t, --tiered   Interpret cold code and compile blocks as "
+               "they get hot\n";
+  std::cout << "  --tier-up <n>[,<m>]  Entries before a block is decoded, "
+               "and before it is\n";
+  std::cout << "                        fused (default 16,256; m=0 never "
+               "fuses)\n";
+  std::cout << "  -i, --input <file>    Console input read by the program "
+               "(getchar)\n";
+  std::cout << "  --load <address>:<file>  Copy a file into memory before "
+               "running (repeatable)\n";
+  std::cout << "  -H, --harvard  Make the code segment read-only and fetch "
+               "only from it\n";
+  std::cout << "  --verify       Only verify the binary and report the "
+               "result\n";
+  std::cout << "  -p, --profile  Report instructions executed per guest "
+               "symbol\n";
+  std::cout << "  --host-profile        Report host cycles and misses per "
+               "guest opcode handler\n";
+  std::cout << "  --sample-every <n>    Instructions between host samples, "
+               "on average (default 100)\n";
+  std::cout << "  -s, --symbols <file>  Symbol map from the assembler's -s, "
+               "for labels\n";
+  std::cout << "  -b, --break <where>[:<cond>]  Stop at an address or "
+               "label, e.g. loop:R1==3\n";
+  std::cout << "  -w, --watch <where>[:<bytes>] Stop after a write to "
+               "memory\n";
+  std::cout << "  --dump <start>-<end>  Hex dump a memory range after "
+               "execution\n";
+  std::cout << "  --dump-core <file>    Save CPU state and all memory after "
+               "execution\n";
+  std::cout << "  -z, --compress        Compress the core\n";
+  std::cout << "  --core <file>         Show a saved core instead of running "
+               "a program\n";
+  std::cout << "  --checkpoints <file>  Save a checkpoint chain taken "
+               "during execution\n";
+  std::cout << "  --checkpoint-every <n>  Instructions between checkpoints "
+               "(default 1000000)\n";
+  std::cout << "  --restore <file>[@<n>]  Resume from checkpoint n (default "
+               "the last) instead\n";
+  std::cout << "                        of loading a program\n";
+  std::cout << "  --list-checkpoints <file>  Show a checkpoint chain\n";
   std::cout << "  -h, --help     Show this help message\n";
 }
 
+const uint64_t DEFAULT_CHECKPOINT_INTERVAL = 1000000;
+const uint32_t DEFAULT_HOST_SAMPLE_INTERVAL = 100;
+
+struct DumpRange {
+  addr_t start;
+  addr_t end;
+};
+
+static bool parse_range(const std::string &text, DumpRange &range) {
+  char *end = NULL;
+  unsigned long start = std::strtoul(text.c_str(), &end, 0);
+  if (*end != '-')
+    return false;
+  unsigned long last = std::strtoul(end + 1, &end, 0);
+  if (*end != '\0' || start > last || last >= MEMORY_SIZE)
+    return false;
+  range.start = (addr_t)start;
+  range.end = (addr_t)last;
+  return true;
+}
+
+/**
+ * Copy a file into memory for a --load <address>:<file> option
+ */
+static bool load_file(Memory &memory, const std::string &spec) {
+  char *end = NULL;
+  unsigned long address = std::strtoul(spec.c_str(), &end, 0);
+  if (*end != ':' || address >= MEMORY_SIZE) {
+    std::cerr << "Error: Invalid load '" << spec << "'\n";
+    return false;
+  }
+  std::string path = end + 1;
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'\n";
+    return false;
+  }
+  std::vector<byte_t> bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  if (!memory.load_image(bytes, (addr_t)address)) {
+    std::cerr << "Error: '" << path << "' does not fit at 0x" << std::hex
+              << address << std::dec << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Post-mortem view of a core file: state, then any requested ranges
+ */
+static int show_core(const std::string &path,
+                     const std::vector<DumpRange> &ranges) {
+  CpuState state;
+  uint32_t input_position;
+  std::vector<byte_t> image;
+  bool compressed;
+  if (!read_core(path, state, input_position, image, compressed))
+    return 1;
+
+  Memory memory;
+  memory.load_image(image, 0);
+  CPU cpu(memory);
+  cpu.set_state(state);
+  std::cout << "Core '" << path << "' (" << (compressed ? "compressed" : "raw")
+            << "): " << state.instruction_count << " instructions, "
+            << input_position << " input bytes read, "
+            << (state.halted ? "halted" : "stopped") << std::endl;
+  cpu.print_registers();
+  cpu.print_flags();
+  for (size_t i = 0; i < ranges.size(); i++)
+    memory.dump(ranges[i].start, ranges[i].end);
+  return 0;
+}
+
+/**
+ * One line per checkpoint: what it stores and what it costs
+ */
+static int list_checkpoints(const std::string &path) {
+  CheckpointChain chain;
+  if (!chain.load(path))
+    return 1;
+  size_t total = 0;
+  std::cout << "Checkpoint  Instructions  Pages  Bytes\n";
+  for (size_t i = 0; i < chain.size(); i++) {
+    std::cout << std::setw(10) << i << std::setw(14)
+              << chain.state(i).instruction_count << std::setw(7)
+              << chain.page_count(i) << std::setw(7) << chain.stored_bytes(i)
+              << (chain.state(i).halted ? "  halted" : "") << "\n";
+    total += chain.stored_bytes(i);
+  }
+  std::cout << chain.size() << " checkpoints in " << total
+            << " bytes of image data (" << chain.size() * MEMORY_SIZE
+            << " uncompressed)" << std::endl;
+  return 0;
+}
+
+/**
+ * Rebuild checkpoint n of a chain, or the last one for "file" alone.
+ * input_position receives how much console input it had consumed.
+ */
+static bool restore_checkpoint(const std::string &spec, CPU &cpu,
+                               Memory &memory, size_t &input_position) {
+  std::string path = spec;
+  long index = -1;
+  size_t at = spec.rfind('@');
+  if (at != std::string::npos) {
+    path = spec.substr(0, at);
+    index = std::atol(spec.c_str() + at + 1);
+  }
+  CheckpointChain chain;
+  if (!chain.load(path))
+    return false;
+  if (index < 0)
+    index = (long)chain.size() - 1;
+  std::vector<byte_t> image;
+  if ((size_t)index >= chain.size() || !chain.reconstruct(index, image)) {
+    std::cerr << "Error: No checkpoint " << index << " in '" << path << "'"
+              << std::endl;
+    return false;
+  }
+  memory.load_image(image, 0);
+  cpu.set_state(chain.state(index));
+  input_position = chain.input_position(index);
+  return true;
+}
+
+/**
+ * Run in the interpreter, capturing a checkpoint at the start, every
+ * interval instructions and at the end
+ */
+static void run_checkpointed(CPU &cpu, Memory &memory, CheckpointChain &chain,
+                             uint64_t interval) {
+  chain.capture(cpu, memory);
+  while (!cpu.is_halted()) {
+    cpu.run_limited(cpu.get_instruction_count() + interval);
+    chain.capture(cpu, memory);
+  }
+}
+
+/**
+ * Run in trusted mode if the binary verified, finishing (or starting) in
+ * the tiered engine if one is given, else in the interpreter
+ */
+static void run_program(CPU &cpu, const Verifier &verifier, bool trusted,
+                        TierCache *tiers) {
+  if (trusted && cpu.run_trusted(verifier))
+    return;
+  if (tiers)
+    cpu.run_tiered(*tiers);
+  else
+    cpu.run();
+}
+
+/**
+ * Execution statistics and final CPU state after a normal (not -q) run
+ */
+static void print_summary(const CPU &cpu, const Memory &memory,
+                          const Profiler *profiler, const TierCache *tiers,
+                          const HostProfiler *host, bool memdump) {
+  std::cout << "\n=== Execution Complete ===\n";
+  std::cout << "Instructions executed: " << cpu.get_instruction_count()
+            << std::endl;
+  cpu.print_registers();
+  cpu.print_flags();
+
+  if (profiler) {
+    std::cout << "\n=== Guest Profile ===\n";
+    profiler->report(std::cout, 20);
+  }
+
+  if (tiers) {
+    std::cout << "\n=== Execution Tiers ===\n";
+    tiers->report(std::cout);
+  }
+
+  if (host) {
+    std::cout << "\n=== Host Profile ===\n";
+    host->report(std::cout);
+  }
+
+  // Optionally dump memory contents for debugging
+  if (memdump) {
+    std::cout << "\n=== Memory Dump ===\n";
+    memory.dump(0x0000, 0x00FF); // Show first 256 bytes of memory
+  }
+}
+
 int main(int argc, char *argv[]) {
   if (argc < 2) {
     print_usage(argv[0]);
@@ -28,6 +272,27 @@ int main(int argc, char *argv[]) {
   std::string filename;
   bool debug_mode = false;
   bool memdump = false;
+  bool quiet = false;
+  bool profile = false;
+  bool host_profile = false;
+  uint32_t sample_interval = DEFAULT_HOST_SAMPLE_INTERVAL;
+  bool fast = false;
+  bool verify_only = false;
+  bool harvard = false;
+  bool tiered = false;
+  TierCache tiers;
+  std::string symbol_file;
+  std::string input_file;
+  std::vector<std::string> load_specs;
+  std::vector<std::string> break_specs;
+  std::vector<std::string> watch_specs;
+  std::vector<DumpRange> ranges;
+  std::string core_out;
+  std::string core_in;
+  bool compress = false;
+  std::string checkpoint_out;
+  std::string restore_spec;
+  uint64_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
 
   // Parse command-line arguments to extract options and filename
   for (int i = 1; i < argc; i++) {
@@ -36,6 +301,70 @@ int main(int argc, char *argv[]) {
       debug_mode = true;
     } else if (arg == "-m" || arg == "--memdump") {
       memdump = true;
+    } else if (arg == "-q" || arg == "--quiet") {
+      quiet = true;
+    } else if (arg == "-f" || arg == "--fast") {
+      fast = true;
+    } else if (arg == "-t" || arg == "--tiered") {
+      tiered = true;
+    } else if (arg == "--tier-up" && i + 1 < argc) {
+      tiered = true;
+      char *end = NULL;
+      unsigned long decode = std::strtoul(argv[++i], &end, 0);
+      unsigned long fuse = decode * 16;
+      if (*end == ',')
+        fuse = std::strtoul(end + 1, &end, 0);
+      if (*end != '\0' || (fuse != 0 && fuse < decode)) {
+        std::cerr << "Error: Invalid thresholds '" << argv[i] << "'\n";
+        return 1;
+      }
+      tiers.set_thresholds((uint32_t)decode, (uint32_t)fuse);
+    } else if (arg == "-H" || arg == "--harvard") {
+      harvard = true;
+    } else if (arg == "--verify") {
+      verify_only = true;
+    } else if (arg == "-p" || arg == "--profile") {
+      profile = true;
+    } else if (arg == "--host-profile") {
+      host_profile = true;
+    } else if (arg == "--sample-every" && i + 1 < argc) {
+      host_profile = true;
+      sample_interval = (uint32_t)std::strtoul(argv[++i], NULL, 0);
+      if (sample_interval == 0)
+        sample_interval = DEFAULT_HOST_SAMPLE_INTERVAL;
+    } else if ((arg == "-i" || arg == "--input") && i + 1 < argc) {
+      input_file = argv[++i];
+    } else if (arg == "--load" && i + 1 < argc) {
+      load_specs.push_back(argv[++i]);
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      symbol_file = argv[++i];
+    } else if ((arg == "-b" || arg == "--break") && i + 1 < argc) {
+      break_specs.push_back(argv[++i]);
+    } else if ((arg == "-w" || arg == "--watch") && i + 1 < argc) {
+      watch_specs.push_back(argv[++i]);
+    } else if (arg == "--dump" && i + 1 < argc) {
+      DumpRange range;
+      if (!parse_range(argv[++i], range)) {
+        std::cerr << "Error: Invalid range '" << argv[i] << "'\n";
+        return 1;
+      }
+      ranges.push_back(range);
+    } else if (arg == "--dump-core" && i + 1 < argc) {
+      core_out = argv[++i];
+    } else if (arg == "-z" || arg == "--compress") {
+      compress = true;
+    } else if (arg == "--core" && i + 1 < argc) {
+      core_in = argv[++i];
+    } else if (arg == "--checkpoints" && i + 1 < argc) {
+      checkpoint_out = argv[++i];
+    } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+      checkpoint_interval = std::strtoull(argv[++i], NULL, 0);
+      if (checkpoint_interval == 0)
+        checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    } else if (arg == "--restore" && i + 1 < argc) {
+      restore_spec = argv[++i];
+    } else if (arg == "--list-checkpoints" && i + 1 < argc) {
+      return list_checkpoints(argv[++i]);
     } else if (arg == "-h" || arg == "--help") {
       print_usage(argv[0]);
       return 0;
@@ -44,7 +373,11 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  if (filename.empty()) {
+  if (!core_in.empty()) {
+    return show_core(core_in, ranges);
+  }
+
+  if (filename.empty() && restore_spec.empty()) {
     std::cerr << "Error: No input file specified\n";
     print_usage(argv[0]);
     return 1;
@@ -53,10 +386,108 @@ int main(int argc, char *argv[]) {
   // Initialize the virtual hardware: memory and CPU
   Memory memory;
   CPU cpu(memory);
+  Profiler profiler;
+  HostProfiler host;
+  if (!symbol_file.empty() && !profiler.load_symbols(symbol_file)) {
+    return 1;
+  }
+
+  // A checkpoint chain stays consistent only if all writes are tracked;
+  // breakpoint patches and the profiler's loop bypass that
+  bool checkpointing = !checkpoint_out.empty();
+  if (checkpointing && (!break_specs.empty() || profile || host_profile)) {
+    std::cerr << "Error: --checkpoints cannot be combined with -b, -p or "
+                 "--host-profile\n";
+    return 1;
+  }
+  if (profile && host_profile) {
+    std::cerr << "Error: -p and --host-profile need separate runs\n";
+    return 1;
+  }
+
+  // Load the binary program into memory, or resume a checkpoint
+  size_t restored_input = 0;
+  if (!restore_spec.empty()) {
+    if (!restore_checkpoint(restore_spec, cpu, memory, restored_input))
+      return 1;
+    if (!quiet)
+      std::cout << "Restored '" << restore_spec << "' at instruction "
+                << cpu.get_instruction_count() << std::endl;
+    // The code size and any self-modification are unknown here
+    fast = false;
+    verify_only = false;
+  } else {
+    std::streambuf *console = std::cout.rdbuf();
+    std::ostringstream load_message;
+    if (quiet)
+      std::cout.rdbuf(load_message.rdbuf());
+    bool loaded = memory.load_program(filename);
+    std::cout.rdbuf(console);
+    if (!loaded) {
+      return 1;  // Load failed - error already printed
+    }
+  }
+
+  for (size_t i = 0; i < load_specs.size(); i++) {
+    if (!load_file(memory, load_specs[i]))
+      return 1;
+  }
+
+  if (harvard) {
+    memory.protect_code();
+  }
+
+  std::vector<byte_t> input;
+  if (!input_file.empty()) {
+    std::ifstream file(input_file.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Error: Could not open file '" << input_file << "'\n";
+      return 1;
+    }
+    input.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+    // A restored run carries on where the checkpoint left the input
+    memory.set_input(input.empty() ? NULL : &input[0], input.size(),
+                     restored_input);
+  }
 
-  // Load the binary program into memory
-  if (!memory.load_program(filename)) {
-    return 1;  // Load failed - error already printed
+  // Prove the binary safe for the fast path before trusting it
+  Verifier verifier;
+  bool trusted = false;
+  if (fast || verify_only) {
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    trusted = verifier.verify(memory, (size_t)file.tellg());
+    const std::vector<std::string> &errors = verifier.get_errors();
+    for (size_t i = 0; i < errors.size(); i++)
+      std::cerr << "Verifier: " << errors[i] << std::endl;
+    if (verify_only) {
+      std::cout << filename << (trusted ? ": verified" : ": not verified")
+                << std::endl;
+      return trusted ? 0 : 1;
+    }
+    if (!trusted)
+      std::cerr << "Verifier: running in checked mode" << std::endl;
+  }
+  // The fast path has no per-instruction hooks for tracing or profiling,
+  // and no instruction limit to stop at checkpoints
+  bool instrumented = debug_mode || profile || host_profile || checkpointing;
+  trusted = trusted && !instrumented;
+  tiered = tiered && !instrumented;
+
+  // Breakpoints go in after verification, so it sees the real program
+  Debugger debugger;
+  if (!break_specs.empty() || !watch_specs.empty()) {
+    for (size_t i = 0; i < break_specs.size(); i++) {
+      if (!debugger.add_breakpoint(break_specs[i], &profiler))
+        return 1;
+    }
+    for (size_t i = 0; i < watch_specs.size(); i++) {
+      if (!debugger.add_watchpoint(watch_specs[i], &profiler))
+        return 1;
+    }
+    if (!debugger.arm(memory, trusted ? &verifier : NULL))
+      return 1;
+    cpu.set_debugger(&debugger);
   }
 
   // Enable debug mode if user requested detailed execution trace
@@ -66,21 +497,50 @@ int main(int argc, char *argv[]) {
   }
 
   // Execute the program until it halts
-  std::cout << "\n=== Starting Execution ===\n";
-  cpu.run();
-
-  // Display execution statistics and final CPU state
-  std::cout << "\n=== Execution Complete ===\n";
-  std::cout << "Instructions executed: " << cpu.get_instruction_count()
-            << std::endl;
-  cpu.print_registers();
-  cpu.print_flags();
-
-  // Optionally dump memory contents for debugging
-  if (memdump) {
-    std::cout << "\n=== Memory Dump ===\n";
-    memory.dump(0x0000, 0x00FF); // Show first 256 bytes of memory
+  CheckpointChain chain;
+  if (quiet) {
+    if (checkpointing) {
+      run_checkpointed(cpu, memory, chain, checkpoint_interval);
+    } else if (profile) {
+      // Keep stdout to the program's output; the profile goes to stderr
+      cpu.run_profiled(profiler.get_counts());
+      profiler.report(std::cerr, 20);
+    } else if (host_profile) {
+      host.start(sample_interval);
+      cpu.run_host_profiled(host);
+      host.report(std::cerr);
+    } else {
+      run_program(cpu, verifier, trusted, tiered ? &tiers : NULL);
+      if (tiered)
+        tiers.report(std::cerr);
+    }
+  } else {
+    std::cout << "\n=== Starting Execution ===\n";
+    if (checkpointing) {
+      run_checkpointed(cpu, memory, chain, checkpoint_interval);
+    } else if (profile) {
+      cpu.run_profiled(profiler.get_counts());
+    } else if (host_profile) {
+      host.start(sample_interval);
+      cpu.run_host_profiled(host);
+    } else {
+      run_program(cpu, verifier, trusted, tiered ? &tiers : NULL);
+    }
+    print_summary(cpu, memory, profile ? &profiler : NULL,
+                  tiered ? &tiers : NULL, host_profile ? &host : NULL,
+                  memdump);
   }
 
-  return 0;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    memory.dump(ranges[i].start, ranges[i].end);
+  }
+  if (checkpointing && !chain.save(checkpoint_out)) {
+    return 1;
+  }
+  if (!core_out.empty()) {
+    debugger.disarm(memory);
+    if (!write_core(core_out, cpu.get_state(), memory, compress))
+      return 1;
+  }
+  return cpu.is_faulted() ? 1 : 0;
 }
@@ -9,13 +9,26 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 
-Memory::Memory() { clear(); }
+Memory::Memory()
+    : console(&std::cout), input(NULL), input_size(0), input_position(0) {
+  clear();
+}
 
 /**
- * Clear all memory to zero
+ * Clear all memory to zero, leaving Harvard mode and dropping watchpoints
  */
-void Memory::clear() { memset(data, 0, MEMORY_SIZE); }
+void Memory::clear() {
+  memset(data, 0, MEMORY_SIZE);
+  memset(page_attributes, 0, sizeof(page_attributes));
+  memset(dirty_pages, 0, sizeof(dirty_pages));
+  page_attributes[IO_START >> PAGE_SHIFT] = PAGE_IO;
+  watched.clear();
+  event = MEMORY_OK;
+  event_address = 0;
+  code.clear();
+}
 
 /**
  * Read a single byte from memory
@@ -23,19 +36,39 @@ void Memory::clear() { memset(data, 0, MEMORY_SIZE); }
 byte_t Memory::read_byte(addr_t address) const { return data[address]; }
 
 /**
- * Write a single byte to memory
- * Handles memory-mapped I/O for console output at address 0xF000
+ * Write to a page with attributes: protected code, watchpoints, dirty
+ * tracking and memory-mapped I/O for console output at address 0xF000
  */
-void Memory::write_byte(addr_t address, byte_t value) {
+bool Memory::write_slow(addr_t address, byte_t value) {
+  size_t page = address >> PAGE_SHIFT;
+  byte_t attributes = page_attributes[page];
+  if (attributes & PAGE_READONLY) {
+    event = MEMORY_FAULT;
+    event_address = address;
+    return false;
+  }
+  if (attributes & PAGE_TRACKED) {
+    dirty_pages[page] = true;
+    page_attributes[page] &= ~PAGE_TRACKED;
+  }
+
+  // A watched write still happens; the CPU stops after the instruction
+  bool quiet = true;
+  if ((attributes & PAGE_WATCHED) && watched[address]) {
+    event = MEMORY_WATCH;
+    event_address = address;
+    quiet = false;
+  }
+
   // Check for memory-mapped I/O write
   if (address == IO_CONSOLE_OUT) {
     // Write character to console immediately
-    std::cout << (char)value << std::flush;
-    return;
+    *console << (char)value << std::flush;
+    return quiet;
   }
 
-  // Normal memory write
   data[address] = value;
+  return quiet;
 }
 
 /**
@@ -49,12 +82,100 @@ word_t Memory::read_word(addr_t address) const {
 }
 
 /**
- * Write a 16-bit word to memory
- * Uses little-endian format: low byte at lower address
+ * Guest load from the I/O page: console input at address 0xF001
+ */
+word_t Memory::load_io(addr_t address) {
+  if (address == IO_CONSOLE_IN)
+    return input_position < input_size ? input[input_position++] : 0xFFFF;
+  return read_word(address);
+}
+
+/**
+ * Write a 16-bit word touching a page with attributes, low byte first.
+ * A refused store writes neither byte, and is reported at its own address
+ * even when only the high byte is protected.
+ */
+bool Memory::write_word_slow(addr_t address, word_t value) {
+  addr_t high_address = (addr_t)(address + 1);
+  if ((page_attributes[address >> PAGE_SHIFT] |
+       page_attributes[high_address >> PAGE_SHIFT]) & PAGE_READONLY) {
+    event = MEMORY_FAULT;
+    event_address = address;
+    return false;
+  }
+  bool low = write_byte(address, (byte_t)(value & 0xFF));            // Low byte
+  addr_t low_event = event_address;
+  bool high = write_byte(high_address, (byte_t)((value >> 8) & 0xFF)); // High byte
+  if (!low)
+    event_address = low_event; // Report the first watched byte
+  return low && high;
+}
+
+/**
+ * Enter Harvard mode: instructions are fetched from a private copy of the
+ * code segment, and every later write into the segment is refused. Data
+ * loads from the segment still see the same bytes, as nothing can change
+ * them.
+ */
+void Memory::protect_code() {
+  code.assign(data + PROGRAM_START, data + PROGRAM_END + 1);
+  for (size_t page = PROGRAM_START >> PAGE_SHIFT;
+       page <= (PROGRAM_END >> PAGE_SHIFT); page++)
+    page_attributes[page] |= PAGE_READONLY;
+}
+
+bool Memory::fetch_word(addr_t address, word_t &instruction) const {
+  if (code.empty()) {
+    instruction = read_word(address);
+    return true;
+  }
+  if (address >= PROGRAM_END)
+    return false;
+  size_t offset = address - PROGRAM_START;
+  instruction = (word_t)((code[offset + 1] << 8) | code[offset]);
+  return true;
+}
+
+/**
+ * Used for breakpoints. In Harvard mode only the fetch copy changes, so
+ * data loads from the code segment still see the original program.
  */
-void Memory::write_word(addr_t address, word_t value) {
-  write_byte(address, (byte_t)(value & 0xFF));          // Low byte
-  write_byte(address + 1, (byte_t)((value >> 8) & 0xFF)); // High byte
+void Memory::patch_code(addr_t address, word_t instruction) {
+  byte_t *target = code.empty() ? data : &code[0] - PROGRAM_START;
+  target[address] = (byte_t)(instruction & 0xFF);
+  target[(addr_t)(address + 1)] = (byte_t)(instruction >> 8);
+}
+
+void Memory::watch(addr_t address, size_t length) {
+  if (watched.empty())
+    watched.assign(MEMORY_SIZE, false);
+  for (size_t i = 0; i < length; i++) {
+    addr_t byte = (addr_t)(address + i);
+    watched[byte] = true;
+    page_attributes[byte >> PAGE_SHIFT] |= PAGE_WATCHED;
+  }
+}
+
+void Memory::track_dirty_pages() {
+  memset(dirty_pages, 0, sizeof(dirty_pages));
+  for (size_t page = 0; page < NUM_PAGES; page++)
+    page_attributes[page] |= PAGE_TRACKED;
+}
+
+void Memory::restore_pages(const byte_t *image) {
+  for (size_t page = 0; page < NUM_PAGES; page++) {
+    if (dirty_pages[page])
+      memcpy(data + (page << PAGE_SHIFT), image + (page << PAGE_SHIFT),
+             (size_t)1 << PAGE_SHIFT);
+  }
+  track_dirty_pages();
+}
+
+MemoryEvent Memory::take_event(addr_t &address) {
+  MemoryEvent taken = event;
+  address = event_address;
+  event = MEMORY_OK;
+  return taken;
 }
 
 /**
@@ -89,6 +210,47 @@ bool Memory::load_program(const std::string &filename, addr_t start_address) {
             << "' at address 0x" << std::hex << std::setw(4)
             << std::setfill('0') << start_address << std::dec << std::endl;
 
+  if (start_address != PROGRAM_START)
+    return true;
+  std::vector<byte_t> data_segment;
+  if (!read_data_file(filename, data_segment))
+    return false;
+  if (!data_segment.empty()) {
+    load_image(data_segment, DATA_START);
+    std::cout << "Loaded " << data_segment.size() << " data bytes from '"
+              << filename << ".data' at address 0x" << std::hex
+              << std::setw(4) << std::setfill('0') << DATA_START << std::dec
+              << std::endl;
+  }
+  return true;
+}
+
+bool Memory::read_data_file(const std::string &program_file,
+                            std::vector<byte_t> &bytes) {
+  bytes.clear();
+  std::string path = program_file + ".data";
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return true;
+  bytes.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  if (bytes.size() > (size_t)(DATA_END - DATA_START) + 1) {
+    std::cerr << "Error: '" << path << "' is larger than the data segment"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Copy an image that is already in host memory, without console output
+ */
+bool Memory::load_image(const std::vector<byte_t> &image,
+                        addr_t start_address) {
+  if (start_address + image.size() > MEMORY_SIZE)
+    return false;
+  if (!image.empty())
+    memcpy(data + start_address, &image[0], image.size());
   return true;
 }
 
@@ -99,32 +261,50 @@ bool Memory::load_program(const std::string &filename, addr_t start_address) {
 void Memory::dump(addr_t start, addr_t end) const {
   std::cout << "\nMemory Dump [0x" << std::hex << std::setw(4)
             << std::setfill('0') << start << " - 0x" << std::setw(4)
-            << std::setfill('0') << end << "]:\n";
+            << std::setfill('0') << end << "]:\n"
+            << std::dec;
+  write_hex(std::cout, start, end);
+  std::cout << std::endl;
+}
 
-  for (addr_t addr = start; addr <= end; addr += 16) {
-    std::cout << "0x" << std::hex << std::setw(4) << std::setfill('0') << addr
-              << ": ";
+/**
+ * Table-driven formatter: each line is built in a fixed buffer from a
+ * hex digit table and written once, instead of per-byte stream
+ * formatting. Line layout matches the original dump:
+ *   0xADDR: xx xx ... xx  | ascii
+ */
+void Memory::write_hex(std::ostream &out, addr_t start, addr_t end) const {
+  static const char DIGITS[] = "0123456789abcdef";
+  char line[96];
 
-    // Display 16 bytes in hexadecimal
-    for (int i = 0; i < 16 && (addr + i) <= end; i++) {
-      std::cout << std::hex << std::setw(2) << std::setfill('0')
-                << (int)data[addr + i] << " ";
-    }
+  for (size_t address = start; address <= end; address += 16) {
+    char *p = line;
+    *p++ = '0';
+    *p++ = 'x';
+    *p++ = DIGITS[(address >> 12) & 0xF];
+    *p++ = DIGITS[(address >> 8) & 0xF];
+    *p++ = DIGITS[(address >> 4) & 0xF];
+    *p++ = DIGITS[address & 0xF];
+    *p++ = ':';
+    *p++ = ' ';
 
-    // Display ASCII representation for printable characters
-    std::cout << " | ";
-    for (int i = 0; i < 16 && (addr + i) <= end; i++) {
-      byte_t b = data[addr + i];
-      if (b >= 32 && b < 127) {
-        std::cout << (char)b;
-      } else {
-        std::cout << ".";
-      }
+    size_t count = end - address + 1 < 16 ? end - address + 1 : 16;
+    for (size_t i = 0; i < count; i++) {
+      byte_t b = data[address + i];
+      *p++ = DIGITS[b >> 4];
+      *p++ = DIGITS[b & 0xF];
+      *p++ = ' ';
     }
-
-    std::cout << std::endl;
+    *p++ = ' ';
+    *p++ = '|';
+    *p++ = ' ';
+    for (size_t i = 0; i < count; i++) {
+      byte_t b = data[address + i];
+      *p++ = (b >= 32 && b < 127) ? (char)b : '.';
+    }
+    *p++ = '\n';
+    out.write(line, p - line);
   }
-  std::cout << std::dec << std::endl;
 }
 
 void Memory::dump_range(addr_t start, size_t length) const {
@@ -2,31 +2,136 @@
 #define MEMORY_H
 
 #include "../common/types.h"
+#include <ostream>
 #include <string>
 #include <vector>
 
+// Page attribute table: writes to a page with any attribute set take the
+// slow path, all other writes are a plain store. Guest loads take the slow
+// path only on PAGE_IO pages.
+const int PAGE_SHIFT = 8; // 256-byte pages
+const size_t NUM_PAGES = MEMORY_SIZE >> PAGE_SHIFT;
+
+enum PageAttribute {
+  PAGE_IO = 0x01,       // Memory-mapped devices
+  PAGE_READONLY = 0x02, // Harvard-mode code segment
+  PAGE_WATCHED = 0x04,  // Holds at least one watchpoint
+  PAGE_TRACKED = 0x08   // Not yet written since track_dirty_pages()
+};
+
+// What stopped the last refused or watched write
+enum MemoryEvent { MEMORY_OK = 0, MEMORY_FAULT, MEMORY_WATCH };
+
 class Memory {
 private:
   byte_t data[MEMORY_SIZE]; // 64KB memory
+  std::ostream *console;    // Receives writes to IO_CONSOLE_OUT
+
+  byte_t page_attributes[NUM_PAGES];
+  bool dirty_pages[NUM_PAGES];
+  std::vector<bool> watched; // Per byte; sized on the first watchpoint
+  MemoryEvent event;
+  addr_t event_address;
+
+  // Harvard mode: the code segment is copied here and made read-only
+  std::vector<byte_t> code;
+
+  // Console input; each guest load of IO_CONSOLE_IN takes the next byte
+  const byte_t *input;
+  size_t input_size;
+  size_t input_position;
+
+  bool write_slow(addr_t address, byte_t value);
+  bool write_word_slow(addr_t address, word_t value);
+  word_t load_io(addr_t address);
 
 public:
   Memory();
 
-  // Read/write byte
+  // Read/write byte; a write returns false if it was refused or hit a
+  // watchpoint, and take_event() tells which
   byte_t read_byte(addr_t address) const;
-  void write_byte(addr_t address, byte_t value);
+  bool write_byte(addr_t address, byte_t value) {
+    if (page_attributes[address >> PAGE_SHIFT])
+      return write_slow(address, value);
+    data[address] = value;
+    return true;
+  }
 
-  // Read/write word (16-bit, little-endian)
+  // Read/write word (16-bit, little-endian). read_word has no side
+  // effects, for debuggers, dumps and analysis.
   word_t read_word(addr_t address) const;
-  void write_word(addr_t address, word_t value);
+  bool write_word(addr_t address, word_t value) {
+    addr_t high = (addr_t)(address + 1);
+    if (page_attributes[address >> PAGE_SHIFT] |
+        page_attributes[high >> PAGE_SHIFT])
+      return write_word_slow(address, value);
+    data[address] = (byte_t)(value & 0xFF);
+    data[high] = (byte_t)(value >> 8);
+    return true;
+  }
+
+  // A load executed by the guest. Loading IO_CONSOLE_IN consumes the next
+  // input byte, or returns 0xFFFF (-1) at the end of input.
+  word_t load_word(addr_t address) {
+    if (page_attributes[address >> PAGE_SHIFT] & PAGE_IO)
+      return load_io(address);
+    return read_word(address);
+  }
+
+  // Harvard mode: freeze PROGRAM_START..PROGRAM_END until the next clear()
+  void protect_code();
+  bool is_code_protected() const { return !code.empty(); }
+  // Instruction fetch; false in Harvard mode if outside the code segment
+  bool fetch_word(addr_t address, word_t &instruction) const;
+  // Replace a word in the instruction stream, bypassing protection
+  void patch_code(addr_t address, word_t instruction);
+
+  // Stop after any write to the given bytes
+  void watch(addr_t address, size_t length);
+  MemoryEvent take_event(addr_t &address);
 
-  // Load binary program into memory
+  // Start a new dirty-page epoch. Only the first write to each page pays
+  // for the bookkeeping; after it the page is back on the fast path.
+  void track_dirty_pages();
+  bool is_page_dirty(size_t page) const { return dirty_pages[page]; }
+  // Copy the pages written this epoch back from a full image taken at its
+  // start, and begin a new epoch
+  void restore_pages(const byte_t *image);
+
+  // Load binary program into memory, and at PROGRAM_START also the data
+  // segment the assembler wrote beside it
   bool load_program(const std::string &filename,
                     addr_t start_address = PROGRAM_START);
+  // Read <program>.data, loaded at DATA_START; left empty if the program
+  // has no data segment
+  static bool read_data_file(const std::string &program_file,
+                             std::vector<byte_t> &bytes);
+  // Copy an image already in host memory, without printing anything
+  bool load_image(const std::vector<byte_t> &image,
+                  addr_t start_address = PROGRAM_START);
+
+  // Redirect console output (std::cout by default)
+  void set_console(std::ostream *out) { console = out; }
+  // Feed console input from a buffer the caller keeps alive (none by
+  // default), starting at byte position, e.g. where a restored
+  // checkpoint had got to
+  void set_input(const byte_t *bytes, size_t size, size_t position = 0) {
+    input = bytes;
+    input_size = size;
+    input_position = position < size ? position : size;
+  }
+  // Input bytes consumed so far, saved in cores and checkpoints
+  size_t get_input_position() const { return input_position; }
 
   // Memory dump for debugging
   void dump(addr_t start, addr_t end) const;
   void dump_range(addr_t start, size_t length) const;
+  // Hex and ASCII lines for start..end inclusive, without a heading
+  void write_hex(std::ostream &out, addr_t start, addr_t end) const;
+
+  // The whole 64KB image, for cores and checkpoints
+  const byte_t *raw() const { return data; }
 
   // Clear memory
   void clear();
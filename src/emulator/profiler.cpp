@@ -0,0 +1,130 @@
+/**
+ * Guest Profiler
+ *
+ * CPU::run_profiled bumps one counter per executed instruction, indexed by
+ * its address. The report folds those counters into the symbol map's
+ * labels so hot guest functions can be read off directly.
+ */
+
+#include "profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+Profiler::Profiler() : counts(MEMORY_SIZE, 0) {}
+
+static bool by_address(const GuestSymbol &a, const GuestSymbol &b) {
+  return a.address < b.address;
+}
+
+/**
+ * Read "<address> <size> <name>" lines, all numbers in hex
+ */
+bool Profiler::load_symbols(const std::string &path) {
+  std::ifstream file(path.c_str());
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
+    return false;
+  }
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    std::istringstream fields(line);
+    std::string address, size;
+    GuestSymbol symbol;
+    if (!(fields >> address))
+      continue;
+    if (!(fields >> size >> symbol.name)) {
+      std::cerr << "Error on line " << line_number << " of '" << path
+                << "': Expected <address> <size> <name>" << std::endl;
+      return false;
+    }
+    symbol.address = (addr_t)std::strtoul(address.c_str(), NULL, 16);
+    symbol.size = (addr_t)std::strtoul(size.c_str(), NULL, 16);
+    symbols.push_back(symbol);
+    labels[symbol.name] = symbol.address;
+  }
+  std::stable_sort(symbols.begin(), symbols.end(), by_address);
+
+  // Fold the compiler's local labels (__<function>_<n>) into the function
+  std::vector<GuestSymbol> folded;
+  for (size_t i = 0; i < symbols.size(); i++) {
+    if (!folded.empty()) {
+      GuestSymbol &function = folded.back();
+      std::string prefix = "__" + function.name + "_";
+      if (symbols[i].name.compare(0, prefix.size(), prefix) == 0) {
+        function.size = (addr_t)(symbols[i].address + symbols[i].size -
+                                 function.address);
+        continue;
+      }
+    }
+    folded.push_back(symbols[i]);
+  }
+  symbols.swap(folded);
+  return true;
+}
+
+const GuestSymbol *Profiler::find_symbol(addr_t address) const {
+  // Last symbol starting at or before the address that still covers it
+  const GuestSymbol *found = NULL;
+  for (size_t i = 0; i < symbols.size() && symbols[i].address <= address;
+       i++) {
+    if (address < symbols[i].address + symbols[i].size)
+      found = &symbols[i];
+  }
+  return found;
+}
+
+bool Profiler::lookup(const std::string &name, addr_t &address) const {
+  std::map<std::string, addr_t>::const_iterator it = labels.find(name);
+  if (it == labels.end())
+    return false;
+  address = it->second;
+  return true;
+}
+
+void Profiler::report(std::ostream &out, size_t max_rows) const {
+  std::map<std::string, uint64_t> totals;
+  std::map<std::string, addr_t> starts;
+  uint64_t total = 0;
+  for (size_t pc = 0; pc < counts.size(); pc++) {
+    if (counts[pc] == 0)
+      continue;
+    total += counts[pc];
+    const GuestSymbol *symbol = find_symbol((addr_t)pc);
+    std::ostringstream name;
+    if (symbol)
+      name << symbol->name;
+    else
+      name << "[0x" << std::hex << std::setw(4) << std::setfill('0') << pc
+           << "]";
+    if (totals.find(name.str()) == totals.end())
+      starts[name.str()] = symbol ? symbol->address : (addr_t)pc;
+    totals[name.str()] += counts[pc];
+  }
+
+  std::vector<std::pair<uint64_t, std::string> > rows;
+  for (std::map<std::string, uint64_t>::const_iterator it = totals.begin();
+       it != totals.end(); ++it)
+    rows.push_back(std::make_pair(it->second, it->first));
+  std::sort(rows.rbegin(), rows.rend());
+
+  out << std::setfill(' ') << std::left << std::setw(24) << "Symbol"
+      << std::setw(9) << "Address" << std::right << std::setw(14)
+      << "Instructions" << std::setw(9) << "Share" << std::endl;
+  for (size_t i = 0; i < rows.size() && i < max_rows; i++) {
+    out << std::left << std::setw(24) << rows[i].second << "0x" << std::hex
+        << std::setfill('0') << std::right << std::setw(4)
+        << starts[rows[i].second] << std::dec << std::setfill(' ')
+        << "   " << std::setw(14) << rows[i].first << std::fixed
+        << std::setprecision(1) << std::setw(8)
+        << 100.0 * rows[i].first / total << "%" << std::endl;
+  }
+  if (rows.size() > max_rows)
+    out << "(" << rows.size() - max_rows << " more)" << std::endl;
+}
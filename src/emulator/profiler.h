@@ -0,0 +1,41 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "../common/types.h"
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+struct GuestSymbol {
+  addr_t address;
+  addr_t size;
+  std::string name;
+};
+
+/**
+ * Guest-level profile: instructions executed at every address, attributed
+ * to the labels of an assembler symbol map (assembler -s) when one is
+ * given, otherwise to the raw addresses
+ */
+class Profiler {
+private:
+  std::vector<GuestSymbol> symbols; // Sorted by address
+  std::map<std::string, addr_t> labels; // Every label, before folding
+  std::vector<uint64_t> counts;     // Indexed by guest PC
+
+public:
+  Profiler();
+
+  bool load_symbols(const std::string &path);
+  uint64_t *get_counts() { return &counts[0]; }
+  // Symbol covering an address, or NULL if none
+  const GuestSymbol *find_symbol(addr_t address) const;
+  // Address of any label in the map, local ones included
+  bool lookup(const std::string &name, addr_t &address) const;
+
+  // Per-symbol table, hottest first, limited to max_rows lines
+  void report(std::ostream &out, size_t max_rows) const;
+};
+
+#endif // PROFILER_H
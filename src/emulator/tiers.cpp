@@ -0,0 +1,472 @@
+/**
+ * Tiered Execution
+ *
+ * Code that runs once, such as a program's start-up and printing, is
+ * cheapest to interpret; a hot loop repays the cost of decoding it once.
+ * run_tiered() interprets each block (straight-line code up to a control
+ * transfer) while counting entries to it. A block that gets hot is
+ * pre-decoded, and one that stays hot is rewritten with superinstructions
+ * that fold constant-building chains and compare-and-branch pairs into a
+ * single dispatch.
+ *
+ * Unlike run_trusted() nothing is proven ahead of time, so every store
+ * made in any tier is checked against the compiled code. In Harvard mode
+ * the check is skipped: the memory refuses any store into the code.
+ */
+
+#include "tiers.h"
+#include "../common/instructions.h"
+#include "cpu.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+// Hotness value for an entry that starts with an uncompilable instruction
+static const uint32_t NOT_COMPILABLE = 0xFFFFFFFF;
+static const size_t MAX_BLOCK_INSTRUCTIONS = 64;
+
+static const uint32_t DEFAULT_DECODE_AFTER = 16;
+static const uint32_t DEFAULT_FUSE_AFTER = 256;
+
+static bool ends_block(byte_t opcode) {
+  return (opcode >= OP_JMP && opcode <= OP_RET) || opcode == OP_HALT ||
+         opcode == OP_BRK;
+}
+
+static bool is_conditional_branch(byte_t opcode) {
+  return opcode >= OP_JZ && opcode <= OP_JN;
+}
+
+static bool branch_taken(byte_t opcode, word_t flags) {
+  switch (opcode) {
+  case OP_JZ:
+    return (flags & FLAG_ZERO) != 0;
+  case OP_JNZ:
+    return (flags & FLAG_ZERO) == 0;
+  case OP_JC:
+    return (flags & FLAG_CARRY) != 0;
+  case OP_JNC:
+    return (flags & FLAG_CARRY) == 0;
+  default:
+    return (flags & FLAG_NEGATIVE) != 0;
+  }
+}
+
+// Apply an immediate ALU instruction; false if it is not one
+static bool apply_immediate(const DecodedInstruction &in, word_t &value,
+                            word_t &flags) {
+  switch (in.opcode) {
+  case OP_ADDI:
+    value = ALU::add(value, in.value, flags);
+    return true;
+  case OP_SUBI:
+    value = ALU::sub(value, in.value, flags);
+    return true;
+  case OP_ANDI:
+    value = ALU::and_op(value, in.value, flags);
+    return true;
+  case OP_ORI:
+    value = ALU::or_op(value, in.value, flags);
+    return true;
+  case OP_SHLI:
+    value = ALU::shl(value, in.value, flags);
+    return true;
+  case OP_SHRI:
+    value = ALU::shr(value, in.value, flags);
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * Rewrite a decoded block with superinstructions
+ */
+static void fuse(std::vector<DecodedInstruction> &code) {
+  std::vector<DecodedInstruction> fused;
+  for (size_t i = 0; i < code.size(); i++) {
+    const DecodedInstruction &in = code[i];
+
+    // MOVI Rd, k followed by "OP Rd, Rd, imm": the result and the flags
+    // of the last operation are constants
+    if (in.opcode == OP_MOVI) {
+      DecodedInstruction constant = in;
+      word_t value = in.value;
+      word_t flags = 0;
+      size_t j = i + 1;
+      while (j < code.size() && code[j].rd == in.rd &&
+             code[j].rs == in.rd && apply_immediate(code[j], value, flags)) {
+        constant.size = (byte_t)(constant.size + code[j].size);
+        j++;
+      }
+      if (j - i >= 2) {
+        constant.opcode = FUSED_CONSTANT;
+        constant.value = value;
+        constant.rt = (byte_t)flags;
+        constant.rs = (byte_t)(j - i);
+        fused.push_back(constant);
+        i = j - 1;
+        continue;
+      }
+    }
+
+    if ((in.opcode == OP_CMP || in.opcode == OP_CMPI) &&
+        i + 1 < code.size() && is_conditional_branch(code[i + 1].opcode)) {
+      const DecodedInstruction &branch = code[i + 1];
+      DecodedInstruction pair = in;
+      pair.opcode = in.opcode == OP_CMP ? FUSED_CMP_BRANCH : FUSED_CMPI_BRANCH;
+      pair.rd = branch.opcode;
+      if (in.opcode == OP_CMPI)
+        pair.rt = (byte_t)in.value;
+      pair.value = branch.value;
+      pair.size = (byte_t)(in.size + branch.size);
+      fused.push_back(pair);
+      i++;
+      continue;
+    }
+    fused.push_back(in);
+  }
+  code.swap(fused);
+}
+
+TierCache::TierCache()
+    : blocks(MEMORY_SIZE / 2, (Block *)NULL), hotness(MEMORY_SIZE / 2, 0),
+      covered(MEMORY_SIZE / 2, false), decode_after(DEFAULT_DECODE_AFTER),
+      fuse_after(DEFAULT_FUSE_AFTER), invalidations(0) {
+  for (int t = 0; t < NUM_TIERS; t++) {
+    instructions[t] = 0;
+    promotions[t] = 0;
+  }
+}
+
+void TierCache::set_thresholds(uint32_t decode, uint32_t fuse) {
+  decode_after = decode;
+  fuse_after = fuse;
+}
+
+bool TierCache::enter(addr_t address) {
+  uint32_t &count = hotness[address >> 1];
+  if (count == NOT_COMPILABLE)
+    return false;
+  return ++count >= decode_after;
+}
+
+Block *TierCache::compile(const Memory &memory, addr_t address) {
+  Block block;
+  block.start = address;
+  block.tier = TIER_DECODED;
+  block.executions = hotness[address >> 1];
+
+  addr_t pc = address;
+  while (block.code.size() < MAX_BLOCK_INSTRUCTIONS) {
+    word_t instruction;
+    if (!memory.fetch_word(pc, instruction))
+      break;
+    byte_t opcode = GET_OPCODE(instruction);
+    if (opcode == OP_BRK || std::strcmp(get_opcode_name(opcode), "???") == 0)
+      break; // Left to the interpreter
+    DecodedInstruction d;
+    decode_instruction(instruction, memory.read_word((addr_t)(pc + 2)), d);
+    if ((addr_t)(pc + d.size) < pc)
+      break; // Would wrap around the address space
+    block.code.push_back(d);
+    pc = (addr_t)(pc + d.size);
+    if (ends_block(opcode))
+      break;
+  }
+  if (block.code.empty()) {
+    hotness[address >> 1] = NOT_COMPILABLE;
+    return NULL;
+  }
+
+  for (addr_t word = address; word != pc; word = (addr_t)(word + 2))
+    covered[word >> 1] = true;
+  storage.push_back(block);
+  blocks[address >> 1] = &storage.back();
+  promotions[TIER_DECODED]++;
+  return &storage.back();
+}
+
+void TierCache::executed(Block &block) {
+  if (block.tier != TIER_DECODED || fuse_after == 0 ||
+      ++block.executions < fuse_after)
+    return;
+  fuse(block.code);
+  block.tier = TIER_FUSED;
+  promotions[TIER_FUSED]++;
+}
+
+void TierCache::invalidate() {
+  storage.clear();
+  std::fill(blocks.begin(), blocks.end(), (Block *)NULL);
+  std::fill(hotness.begin(), hotness.end(), 0);
+  std::fill(covered.begin(), covered.end(), false);
+  invalidations++;
+}
+
+void TierCache::report(std::ostream &out) const {
+  static const char *const names[NUM_TIERS] = {"interpreted", "decoded",
+                                               "fused"};
+  uint64_t total = 0;
+  for (int t = 0; t < NUM_TIERS; t++)
+    total += instructions[t];
+
+  out << std::setfill(' ') << std::left << std::setw(14) << "Tier"
+      << std::right << std::setw(14) << "Instructions" << std::setw(9)
+      << "Share" << std::setw(10) << "Blocks" << std::endl;
+  for (int t = 0; t < NUM_TIERS; t++) {
+    out << std::left << std::setw(14) << names[t] << std::right
+        << std::setw(14) << instructions[t] << std::fixed
+        << std::setprecision(1) << std::setw(8)
+        << (total ? 100.0 * instructions[t] / total : 0.0) << "%"
+        << std::setw(10);
+    if (t == TIER_INTERPRETED)
+      out << "-";
+    else
+      out << promotions[t];
+    out << std::endl;
+  }
+  out << "Decoded after " << decode_after << " entries, fused after ";
+  if (fuse_after)
+    out << fuse_after;
+  else
+    out << "never";
+  out << "; " << invalidations << " invalidations by stores" << std::endl;
+}
+
+/**
+ * Run until HALT, moving each block up the tiers as it gets hot
+ */
+void CPU::run_tiered(TierCache &cache) {
+  while (!halted) {
+    uint64_t before = instruction_count;
+    Block *block = (pc & 1) ? NULL : cache.find(pc);
+    if (!block && !(pc & 1) && cache.enter(pc))
+      block = cache.compile(memory, pc);
+    if (!block) {
+      interpret_block(cache);
+      cache.count(TIER_INTERPRETED, instruction_count - before);
+      continue;
+    }
+    cache.executed(*block);
+    Tier tier = block->tier; // The block is gone if a store invalidates it
+    run_block(cache, *block);
+    cache.count(tier, instruction_count - before);
+  }
+}
+
+/**
+ * Interpret up to the next control transfer, watching for stores into
+ * compiled code
+ */
+void CPU::interpret_block(TierCache &cache) {
+  const bool code_writable = !memory.is_code_protected();
+  for (;;) {
+    word_t instruction;
+    if (!memory.fetch_word(pc, instruction)) {
+      step(); // Faults
+      return;
+    }
+    byte_t opcode = GET_OPCODE(instruction);
+    bool stores = code_writable;
+    addr_t written = 0;
+    if (stores) {
+      switch (opcode) {
+      case OP_STORE_IND:
+        written = registers[GET_RD(instruction)];
+        break;
+      case OP_STORE_DIR:
+        written = memory.read_word((addr_t)(pc + 2));
+        break;
+      case OP_PUSH:
+      case OP_CALL:
+        written = (addr_t)(sp - 2);
+        break;
+      default:
+        stores = false;
+        break;
+      }
+    }
+
+    step();
+    if (stores && cache.covers(written))
+      cache.invalidate();
+    if (halted || ends_block(opcode))
+      return;
+  }
+}
+
+/**
+ * Run one compiled block. Control transfers only end a block, so the
+ * loop runs off its end after them; a store that lands on compiled code
+ * drops the cache, and with it this block, so it returns at once.
+ */
+void CPU::run_block(TierCache &cache, const Block &block) {
+  const bool code_writable = !memory.is_code_protected();
+  const DecodedInstruction *in = &block.code[0];
+  const DecodedInstruction *end = in + block.code.size();
+
+  for (; in != end; ++in) {
+    pc += in->size;
+    instruction_count++;
+
+    switch (in->opcode) {
+    case OP_NOP:
+      registers[in->rd] = registers[in->rs];
+      break;
+    case OP_MOVI:
+      registers[in->rd] = in->value;
+      break;
+    case OP_LOAD_IND:
+      registers[in->rd] = memory.load_word(registers[in->rs]);
+      break;
+    case OP_LOAD_DIR:
+      registers[in->rd] = memory.load_word(in->value);
+      break;
+    case OP_STORE_IND: {
+      addr_t address = registers[in->rd];
+      if (!memory.write_word(address, registers[in->rs])) {
+        memory_event();
+        return;
+      }
+      if (code_writable && cache.covers(address)) {
+        cache.invalidate();
+        return;
+      }
+      break;
+    }
+    case OP_STORE_DIR:
+      if (!memory.write_word(in->value, registers[in->rs])) {
+        memory_event();
+        return;
+      }
+      if (code_writable && cache.covers(in->value)) {
+        cache.invalidate();
+        return;
+      }
+      break;
+    case OP_ADD:
+      registers[in->rd] =
+          ALU::add(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_ADDI:
+      registers[in->rd] = ALU::add(registers[in->rs], in->value, flags);
+      break;
+    case OP_SUB:
+      registers[in->rd] =
+          ALU::sub(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_SUBI:
+      registers[in->rd] = ALU::sub(registers[in->rs], in->value, flags);
+      break;
+    case OP_MUL:
+      registers[in->rd] =
+          ALU::mul(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_DIV:
+      registers[in->rd] =
+          ALU::div(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_INC:
+      registers[in->rd] = ALU::add(registers[in->rd], 1, flags);
+      break;
+    case OP_DEC:
+      registers[in->rd] = ALU::sub(registers[in->rd], 1, flags);
+      break;
+    case OP_AND:
+      registers[in->rd] =
+          ALU::and_op(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_ANDI:
+      registers[in->rd] = ALU::and_op(registers[in->rs], in->value, flags);
+      break;
+    case OP_OR:
+      registers[in->rd] =
+          ALU::or_op(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_ORI:
+      registers[in->rd] = ALU::or_op(registers[in->rs], in->value, flags);
+      break;
+    case OP_XOR:
+      registers[in->rd] =
+          ALU::xor_op(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_NOT:
+      registers[in->rd] = ALU::not_op(registers[in->rs], flags);
+      break;
+    case OP_SHL:
+      registers[in->rd] =
+          ALU::shl(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_SHLI:
+      registers[in->rd] = ALU::shl(registers[in->rs], in->value, flags);
+      break;
+    case OP_SHR:
+      registers[in->rd] =
+          ALU::shr(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_SHRI:
+      registers[in->rd] = ALU::shr(registers[in->rs], in->value, flags);
+      break;
+    case OP_CMP:
+      ALU::compare(registers[in->rs], registers[in->rt], flags);
+      break;
+    case OP_CMPI:
+      ALU::compare(registers[in->rs], in->value, flags);
+      break;
+    case OP_JMP:
+      pc = in->value;
+      break;
+    case OP_JZ:
+    case OP_JNZ:
+    case OP_JC:
+    case OP_JNC:
+    case OP_JN:
+      if (branch_taken(in->opcode, flags))
+        pc = in->value;
+      break;
+    case OP_CALL:
+      push(pc);
+      pc = in->value;
+      if (code_writable && cache.covers(sp))
+        cache.invalidate();
+      return;
+    case OP_RET:
+      pc = pop();
+      return;
+    case OP_PUSH:
+      push(registers[in->rs]);
+      if (halted)
+        return;
+      if (code_writable && cache.covers(sp)) {
+        cache.invalidate();
+        return;
+      }
+      break;
+    case OP_POP:
+      registers[in->rd] = pop();
+      break;
+    case OP_HALT:
+      halt();
+      return;
+
+    case FUSED_CONSTANT:
+      registers[in->rd] = in->value;
+      flags = in->rt;
+      instruction_count += in->rs - 1;
+      break;
+    case FUSED_CMP_BRANCH:
+      instruction_count++;
+      ALU::compare(registers[in->rs], registers[in->rt], flags);
+      if (branch_taken(in->rd, flags))
+        pc = in->value;
+      break;
+    case FUSED_CMPI_BRANCH:
+      instruction_count++;
+      ALU::compare(registers[in->rs], (word_t)(int8_t)in->rt, flags);
+      if (branch_taken(in->rd, flags))
+        pc = in->value;
+      break;
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#ifndef TIERS_H
+#define TIERS_H
+
+#include "../common/types.h"
+#include "memory.h"
+#include "verifier.h"
+#include <deque>
+#include <ostream>
+#include <vector>
+
+enum Tier {
+  TIER_INTERPRETED = 0, // Fetched and decoded on every execution
+  TIER_DECODED = 1,     // Pre-decoded block
+  TIER_FUSED = 2,       // Pre-decoded block with superinstructions
+  NUM_TIERS = 3
+};
+
+// Superinstructions, numbered past the 6-bit opcode space
+enum FusedOpcode {
+  // MOVI followed by immediate ALU operations on the same register:
+  // value is the final result, rt the final flags, rs the instruction count
+  FUSED_CONSTANT = 0x40,
+  // CMP or CMPI followed by a conditional branch: rd is the branch opcode,
+  // value its target, and rt the CMPI immediate
+  FUSED_CMP_BRANCH = 0x41,
+  FUSED_CMPI_BRANCH = 0x42
+};
+
+// Straight-line code from an entry address up to and including the first
+// control transfer
+struct Block {
+  addr_t start;
+  Tier tier;
+  uint32_t executions;
+  std::vector<DecodedInstruction> code;
+};
+
+/**
+ * Hotness counters and compiled blocks for CPU::run_tiered.
+ *
+ * A block is interpreted until it has been entered decode_after times,
+ * then pre-decoded; after fuse_after entries its common instruction pairs
+ * are rewritten as superinstructions. A store into any compiled
+ * instruction drops every block and starts counting again.
+ */
+class TierCache {
+private:
+  std::deque<Block> storage;    // Stable addresses for blocks
+  std::vector<Block *> blocks;  // Indexed by entry address / 2
+  std::vector<uint32_t> hotness; // Entries while interpreted
+  std::vector<bool> covered;    // Words inside a compiled block
+  uint32_t decode_after;
+  uint32_t fuse_after;
+
+  uint64_t instructions[NUM_TIERS];
+  uint64_t promotions[NUM_TIERS];
+  uint64_t invalidations;
+
+public:
+  TierCache();
+
+  // Entries before a block is decoded, and before it is fused
+  // (0 never fuses)
+  void set_thresholds(uint32_t decode, uint32_t fuse);
+
+  Block *find(addr_t address) const { return blocks[address >> 1]; }
+  // Count an interpreted entry; true once the block should be compiled
+  bool enter(addr_t address);
+  // Decode the block at address; NULL if it starts with an instruction
+  // only the interpreter runs
+  Block *compile(const Memory &memory, addr_t address);
+  // Count an execution of a compiled block, fusing it when due
+  void executed(Block &block);
+
+  // True if a word written at address lands on compiled code
+  bool covers(addr_t address) const {
+    return !storage.empty() &&
+           (covered[address >> 1] || covered[(addr_t)(address + 1) >> 1]);
+  }
+  void invalidate();
+
+  void count(Tier tier, uint64_t executed) { instructions[tier] += executed; }
+  // Instructions run and blocks promoted per tier
+  void report(std::ostream &out) const;
+};
+
+#endif // TIERS_H
@@ -0,0 +1,140 @@
+/**
+ * Static Binary Verifier
+ *
+ * Recursive traversal from the entry point, in the style of a
+ * disassembler: fall through, branch targets and call targets are all
+ * followed, and each address is classified as an instruction start or as
+ * the address word of a two-word instruction. Seeing one address in both
+ * roles is a jump into the middle of an instruction.
+ */
+
+#include "verifier.h"
+#include "../common/instructions.h"
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+// What the traversal has found at each byte address
+enum CodeRole { ROLE_UNSEEN = 0, ROLE_START = 1, ROLE_OPERAND = 2 };
+
+static const size_t MAX_VERIFIER_ERRORS = 20;
+
+Verifier::Verifier() : code_end(PROGRAM_START) {}
+
+void Verifier::error(addr_t address, const std::string &message) {
+  if (errors.size() >= MAX_VERIFIER_ERRORS)
+    return;
+  std::ostringstream out;
+  out << "0x" << std::hex << std::setw(4) << std::setfill('0') << address
+      << ": " << message;
+  errors.push_back(out.str());
+}
+
+bool is_two_word(byte_t opcode) {
+  return opcode == OP_LOAD_DIR || opcode == OP_STORE_DIR ||
+         (opcode >= OP_JMP && opcode <= OP_CALL);
+}
+
+static bool is_known(byte_t opcode) {
+  return std::strcmp(get_opcode_name(opcode), "???") != 0;
+}
+
+static word_t immediate(byte_t opcode, word_t instruction) {
+  switch (opcode) {
+  case OP_MOVI:
+    return (word_t)sign_extend_7bit(GET_IMM7(instruction));
+  case OP_ADDI:
+  case OP_SUBI:
+  case OP_CMPI:
+    return (word_t)sign_extend_4bit(GET_IMM4(instruction));
+  default:
+    return GET_IMM4(instruction);
+  }
+}
+
+void decode_instruction(word_t instruction, word_t operand,
+                        DecodedInstruction &d) {
+  d.opcode = GET_OPCODE(instruction);
+  d.rd = GET_RD(instruction);
+  d.rs = GET_RS(instruction);
+  d.rt = GET_RT(instruction);
+  d.size = is_two_word(d.opcode) ? 4 : 2;
+  d.value = d.size == 4 ? operand : immediate(d.opcode, instruction);
+}
+
+bool Verifier::verify(const Memory &memory, size_t code_size) {
+  errors.clear();
+  decoded.assign(MEMORY_SIZE / 2, DecodedInstruction());
+  if (code_size == 0 || PROGRAM_START + code_size > (size_t)PROGRAM_END + 1) {
+    error(PROGRAM_START, "code does not fit the code segment");
+    return false;
+  }
+  code_end = (addr_t)(PROGRAM_START + code_size);
+
+  std::vector<byte_t> role(MEMORY_SIZE, ROLE_UNSEEN);
+  std::vector<addr_t> worklist(1, PROGRAM_START);
+  while (!worklist.empty()) {
+    addr_t address = worklist.back();
+    worklist.pop_back();
+    if (address & 1) {
+      error(address, "odd instruction address");
+      continue;
+    }
+    if (address < PROGRAM_START || address >= code_end) {
+      error(address, "control reaches outside the loaded code");
+      continue;
+    }
+    if (role[address] == ROLE_OPERAND) {
+      error(address, "jump into the middle of a two-word instruction");
+      continue;
+    }
+    if (role[address] == ROLE_START)
+      continue;
+
+    word_t instruction = memory.read_word(address);
+    byte_t opcode = GET_OPCODE(instruction);
+    if (!is_known(opcode)) {
+      error(address, "unknown opcode");
+      continue;
+    }
+    // Only the debugger plants BRK, after verification
+    if (opcode == OP_BRK) {
+      error(address, "BRK is reserved for the debugger");
+      continue;
+    }
+    role[address] = ROLE_START;
+
+    DecodedInstruction &d = decoded[address / 2];
+    addr_t operand = (addr_t)(address + 2);
+    decode_instruction(instruction, memory.read_word(operand), d);
+
+    if (d.size == 4) {
+      if (operand >= code_end) {
+        error(address, "two-word instruction truncated by end of code");
+        d.size = 0;
+        continue;
+      }
+      if (role[operand] == ROLE_START)
+        error(operand, "jump into the middle of a two-word instruction");
+      role[operand] = ROLE_OPERAND;
+    }
+
+    if (opcode == OP_STORE_DIR) {
+      addr_t last = (addr_t)(d.value + 1);
+      if (d.value <= PROGRAM_END || last <= PROGRAM_END)
+        error(address, "stores into the code segment");
+    }
+    if (opcode >= OP_JMP && opcode <= OP_CALL)
+      worklist.push_back(d.value);
+    if (opcode != OP_JMP && opcode != OP_RET && opcode != OP_HALT)
+      worklist.push_back((addr_t)(address + d.size));
+  }
+  return errors.empty();
+}
+
+bool Verifier::plant_breakpoint(addr_t address) {
+  if ((address & 1) || address >= code_end || decoded[address / 2].size == 0)
+    return false;
+  decoded[address / 2].opcode = OP_BRK;
+  return true;
+}
@@ -0,0 +1,59 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include "../common/types.h"
+#include "memory.h"
+#include <string>
+#include <vector>
+
+// One instruction decoded ahead of time for the trusted fast path
+struct DecodedInstruction {
+  byte_t opcode;
+  byte_t rd;
+  byte_t rs;
+  byte_t rt;
+  byte_t size;  // 2 or 4 bytes; 0 if no verified instruction starts here
+  word_t value; // Sign-extended immediate or the instruction's address word
+};
+
+// LOAD/STORE direct, jumps and CALL carry an address word
+bool is_two_word(byte_t opcode);
+// Decode one instruction; operand is the word after it, used only by
+// two-word instructions
+void decode_instruction(word_t instruction, word_t operand,
+                        DecodedInstruction &d);
+
+/**
+ * Load-time verifier. Follows every path from PROGRAM_START and proves:
+ *   - each reachable word is a known opcode, and not BRK
+ *   - branch and call targets start an instruction, never the address
+ *     word of a two-word instruction, and lie inside the loaded code
+ *   - execution never runs off the end of the code
+ *   - no direct STORE writes into PROGRAM_START..PROGRAM_END
+ *
+ * A verified program is pre-decoded for CPU::run_trusted. What cannot be
+ * proven statically (indirect stores, stack writes, RET targets) is left
+ * to one cheap guard each in that loop.
+ */
+class Verifier {
+private:
+  std::vector<DecodedInstruction> decoded; // Indexed by address / 2
+  std::vector<std::string> errors;
+  addr_t code_end;
+
+  void error(addr_t address, const std::string &message);
+
+public:
+  Verifier();
+
+  // Verify code_size bytes of code loaded at PROGRAM_START
+  bool verify(const Memory &memory, size_t code_size);
+
+  const std::vector<std::string> &get_errors() const { return errors; }
+  addr_t get_code_end() const { return code_end; }
+  const DecodedInstruction *get_decoded() const { return &decoded[0]; }
+  // Turn a verified instruction into BRK, keeping its operands
+  bool plant_breakpoint(addr_t address);
+};
+
+#endif // VERIFIER_H
@@ -0,0 +1,360 @@
+/**
+ * Coverage-Guided Fuzzer
+ *
+ * Every execution starts from the entry-point snapshot: the pages dirtied
+ * by the previous run are copied back, the registers are reset, and the
+ * input becomes the console. The interpreter counts branch edges into
+ * trace, which is then bucketed and compared with the bits seen so far.
+ */
+
+#include "fuzzer.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <sys/stat.h>
+
+// Mutated children of a queue entry before moving to the next one
+static const int HAVOC_ROUNDS = 256;
+// Executions between looks at the clock
+static const uint64_t CLOCK_CHECK_MASK = 1023;
+static const size_t MAX_BLOCK = 32;
+
+static const signed char INTERESTING[] = {-128, -1, 0,  1,  16,
+                                          32,   64, 100, 127};
+
+// Swallows guest console output and fault diagnostics while fuzzing
+class DiscardBuffer : public std::streambuf {
+protected:
+  int overflow(int c) { return traits_type::not_eof(c); }
+};
+
+static DiscardBuffer discard_buffer;
+static std::ostream discard(&discard_buffer);
+
+// Hit count -> bucket bit: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+
+static byte_t bucket(byte_t count) {
+  if (count <= 3)
+    return count == 3 ? 4 : count;
+  if (count <= 7)
+    return 8;
+  if (count <= 15)
+    return 16;
+  if (count <= 31)
+    return 32;
+  return count <= 127 ? 64 : 128;
+}
+
+static byte_t bucket_table[256];
+
+Fuzzer::Fuzzer()
+    : cpu(memory), instruction_limit(50000), max_length(256),
+      seed(0x9E3779B9) {
+  for (int count = 0; count < 256; count++)
+    bucket_table[count] = bucket((byte_t)count);
+  std::memset(trace, 0, sizeof(trace));
+  std::memset(virgin, 0xFF, sizeof(virgin));
+  std::memset(virgin_hangs, 0xFF, sizeof(virgin_hangs));
+  std::memset(&stats, 0, sizeof(stats));
+  memory.set_console(&discard);
+  cpu.set_coverage(trace);
+}
+
+uint32_t Fuzzer::random() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+bool Fuzzer::load(const std::string &binary) {
+  std::ifstream file(binary.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << binary << "'" << std::endl;
+    return false;
+  }
+  std::vector<byte_t> image((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  std::vector<byte_t> data_segment;
+  memory.clear();
+  if (image.empty() || !memory.load_image(image)) {
+    std::cerr << "Error: '" << binary << "' is not a loadable program"
+              << std::endl;
+    return false;
+  }
+  if (!Memory::read_data_file(binary, data_segment))
+    return false;
+  memory.load_image(data_segment, DATA_START);
+  memory.protect_code();
+  cpu.reset();
+  snapshot.assign(memory.raw(), memory.raw() + MEMORY_SIZE);
+  entry = cpu.get_state();
+  memory.track_dirty_pages();
+  return true;
+}
+
+bool Fuzzer::set_output(const std::string &dir) {
+  static const char *subdirs[] = {"", "/queue", "/crashes", "/hangs",
+                                  "/corpus"};
+  for (size_t i = 0; i < sizeof(subdirs) / sizeof(subdirs[0]); i++) {
+    std::string path = dir + subdirs[i];
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+      std::cerr << "Error: Could not create directory '" << path << "'"
+                << std::endl;
+      return false;
+    }
+  }
+  output_dir = dir;
+  return true;
+}
+
+void Fuzzer::save(const char *subdir, size_t id,
+                  const std::vector<byte_t> &input, const std::string &suffix) {
+  if (output_dir.empty())
+    return;
+  std::ostringstream path;
+  path << output_dir << "/" << subdir << "/id_" << std::setw(6)
+       << std::setfill('0') << id << suffix;
+  std::ofstream file(path.str().c_str(), std::ios::binary);
+  if (!input.empty())
+    file.write((const char *)&input[0], input.size());
+}
+
+FuzzOutcome Fuzzer::run(const std::vector<byte_t> &input) {
+  memory.restore_pages(&snapshot[0]);
+  cpu.set_state(entry);
+  memory.set_input(input.empty() ? NULL : &input[0], input.size());
+  std::memset(trace, 0, sizeof(trace));
+  cpu.run_limited(instruction_limit);
+  stats.execs++;
+  if (cpu.is_faulted())
+    return FUZZ_CRASH;
+  return cpu.is_halted() ? FUZZ_OK : FUZZ_HANG;
+}
+
+// Whether the eight map bytes from offset w * 8 are all zero
+static bool empty_word(const byte_t *map, size_t w) {
+  uint64_t word;
+  std::memcpy(&word, map + w * 8, sizeof(word));
+  return word == 0;
+}
+
+void Fuzzer::classify() {
+  for (size_t w = 0; w < COVERAGE_MAP_SIZE / 8; w++) {
+    if (empty_word(trace, w))
+      continue; // Most of the map is untouched
+    for (size_t i = w * 8; i < w * 8 + 8; i++)
+      trace[i] = bucket_table[trace[i]];
+  }
+}
+
+int Fuzzer::merge(byte_t *virgin_map) const {
+  int found = 0;
+  for (size_t w = 0; w < COVERAGE_MAP_SIZE / 8; w++) {
+    if (empty_word(trace, w))
+      continue;
+    for (size_t i = w * 8; i < w * 8 + 8; i++) {
+      if (!(trace[i] & virgin_map[i]))
+        continue;
+      found = std::max(found, virgin_map[i] == 0xFF ? 2 : 1);
+      virgin_map[i] &= ~trace[i];
+    }
+  }
+  return found;
+}
+
+void Fuzzer::consider(const std::vector<byte_t> &input, FuzzOutcome outcome) {
+  if (outcome == FUZZ_CRASH) {
+    stats.crashes++;
+    addr_t site = cpu.get_pc();
+    if (crash_sites.count(site))
+      return;
+    size_t id = crash_sites.size() + 1;
+    crash_sites[site] = id;
+    stats.unique_crashes = id;
+    std::ostringstream suffix;
+    suffix << "_pc_" << std::hex << std::setw(4) << std::setfill('0') << site;
+    save("crashes", id, input, suffix.str());
+    return;
+  }
+
+  classify();
+  if (outcome == FUZZ_HANG) {
+    stats.hangs++;
+    if (merge(virgin_hangs))
+      save("hangs", ++stats.unique_hangs, input);
+    return;
+  }
+  if (merge(virgin)) {
+    queue.push_back(input);
+    save("queue", queue.size(), input);
+  }
+}
+
+void Fuzzer::add_seed(const std::vector<byte_t> &input) {
+  std::vector<byte_t> seed_input(input);
+  if (seed_input.size() > max_length)
+    seed_input.resize(max_length);
+  std::streambuf *errors = std::cerr.rdbuf(discard.rdbuf());
+  consider(seed_input, run(seed_input));
+  std::cerr.rdbuf(errors);
+}
+
+/**
+ * Apply a stack of 2 to 16 random edits
+ */
+void Fuzzer::havoc(std::vector<byte_t> &input) {
+  int edits = 1 << (1 + random_below(4));
+  for (int e = 0; e < edits; e++) {
+    size_t size = input.size();
+    int kind = size == 0 ? 5 : (int)random_below(queue.size() > 1 ? 9 : 8);
+    size_t pos = size ? random_below((uint32_t)size) : 0;
+    switch (kind) {
+    case 0: // Flip a bit
+      input[pos] ^= (byte_t)(1 << random_below(8));
+      break;
+    case 1: // Random byte
+      input[pos] = (byte_t)random();
+      break;
+    case 2: // Interesting value
+      input[pos] = (byte_t)INTERESTING[random_below(sizeof(INTERESTING))];
+      break;
+    case 3: // Small addition
+      input[pos] = (byte_t)(input[pos] + 1 + random_below(35));
+      break;
+    case 4: // Small subtraction
+      input[pos] = (byte_t)(input[pos] - 1 - random_below(35));
+      break;
+    case 5: { // Insert a copy of a block, or a run of random bytes
+      if (size >= max_length)
+        break;
+      size_t length = 1 + random_below((uint32_t)std::min(
+                              MAX_BLOCK, std::max<size_t>(size, 1)));
+      length = std::min(length, max_length - size);
+      std::vector<byte_t> block(length);
+      if (size && random_below(4)) {
+        size_t from = random_below((uint32_t)(size - length + 1));
+        std::memcpy(&block[0], &input[from], length);
+      } else {
+        for (size_t i = 0; i < length; i++)
+          block[i] = (byte_t)random();
+      }
+      size_t at = random_below((uint32_t)size + 1);
+      input.insert(input.begin() + at, block.begin(), block.end());
+      break;
+    }
+    case 6: { // Delete a block
+      if (size < 2)
+        break;
+      size_t length =
+          1 + random_below((uint32_t)std::min(MAX_BLOCK, size - 1));
+      size_t at = random_below((uint32_t)(size - length + 1));
+      input.erase(input.begin() + at, input.begin() + at + length);
+      break;
+    }
+    case 7: { // Overwrite a block with another part of the input
+      size_t length = 1 + random_below((uint32_t)std::min(MAX_BLOCK, size));
+      size_t from = random_below((uint32_t)(size - length + 1));
+      size_t to = random_below((uint32_t)(size - length + 1));
+      std::memmove(&input[to], &input[from], length);
+      break;
+    }
+    default: { // Splice: keep a head, take the tail of another entry
+      const std::vector<byte_t> &other = queue[random_below(
+          (uint32_t)queue.size())];
+      if (other.empty())
+        break;
+      size_t from = random_below((uint32_t)other.size());
+      input.resize(pos);
+      input.insert(input.end(), other.begin() + from, other.end());
+      if (input.size() > max_length)
+        input.resize(max_length);
+      break;
+    }
+    }
+  }
+}
+
+static void print_status(const FuzzStats &stats, size_t queue_size,
+                         size_t edges, double seconds) {
+  std::cout << std::fixed << std::setprecision(1) << std::setw(7) << seconds
+            << "s  execs " << stats.execs << " ("
+            << std::setprecision(0)
+            << (seconds > 0 ? stats.execs / seconds : 0.0)
+            << "/s)  queue " << queue_size << "  edges " << edges
+            << "  crashes " << stats.unique_crashes << " (" << stats.crashes
+            << ")  hangs " << stats.unique_hangs << " (" << stats.hangs
+            << ")" << std::endl;
+}
+
+void Fuzzer::fuzz(uint64_t max_execs, double max_seconds) {
+  if (queue.empty())
+    queue.push_back(std::vector<byte_t>()); // A program with no branches
+  std::streambuf *errors = std::cerr.rdbuf(discard.rdbuf());
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  double elapsed = 0;
+  double next_status = 1;
+  bool done = false;
+  std::vector<byte_t> input;
+  for (size_t current = 0; !done; current = (current + 1) % queue.size()) {
+    for (int round = 0; round < HAVOC_ROUNDS && !done; round++) {
+      input = queue[current];
+      havoc(input);
+      consider(input, run(input));
+
+      if (max_execs && stats.execs >= max_execs)
+        done = true;
+      if ((stats.execs & CLOCK_CHECK_MASK) == 0 || done) {
+        elapsed = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        if (max_seconds > 0 && elapsed >= max_seconds)
+          done = true;
+        if (elapsed >= next_status || done) {
+          print_status(stats, queue.size(), edges_covered(), elapsed);
+          next_status = elapsed + 1;
+        }
+      }
+    }
+  }
+  std::cerr.rdbuf(errors);
+}
+
+/**
+ * Greedy set cover: shortest inputs first, keeping each one that hits an
+ * (edge, bucket) pair none of the kept inputs hit
+ */
+size_t Fuzzer::minimize() {
+  std::vector<std::pair<size_t, size_t> > order;
+  for (size_t i = 0; i < queue.size(); i++)
+    order.push_back(std::make_pair(queue[i].size(), i));
+  std::sort(order.begin(), order.end());
+
+  std::vector<byte_t> covered(COVERAGE_MAP_SIZE, 0xFF);
+  std::streambuf *errors = std::cerr.rdbuf(discard.rdbuf());
+  size_t kept = 0;
+  for (size_t i = 0; i < order.size(); i++) {
+    const std::vector<byte_t> &input = queue[order[i].second];
+    if (run(input) != FUZZ_OK)
+      continue;
+    classify();
+    if (merge(&covered[0]))
+      save("corpus", ++kept, input);
+  }
+  std::cerr.rdbuf(errors);
+  return kept;
+}
+
+size_t Fuzzer::edges_covered() const {
+  size_t edges = 0;
+  for (size_t i = 0; i < COVERAGE_MAP_SIZE; i++)
+    edges += virgin[i] != 0xFF;
+  return edges;
+}
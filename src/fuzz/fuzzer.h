@@ -0,0 +1,90 @@
+#ifndef FUZZER_H
+#define FUZZER_H
+
+#include "../emulator/cpu.h"
+#include "../emulator/memory.h"
+#include <map>
+#include <string>
+#include <vector>
+
+enum FuzzOutcome { FUZZ_OK = 0, FUZZ_CRASH, FUZZ_HANG };
+
+struct FuzzStats {
+  uint64_t execs;
+  uint64_t crashes; // Every crashing input, found before or not
+  uint64_t hangs;
+  size_t unique_crashes; // Distinct faulting pcs
+  size_t unique_hangs;   // Hangs with coverage no earlier hang had
+};
+
+/**
+ * In-process coverage-guided fuzzer for one guest program. The program is
+ * loaded once, in Harvard mode so a wild store or jump crashes it, and
+ * its memory and registers at the entry point are kept as a snapshot.
+ * Each input is fed to the console and run from that snapshot; only the
+ * pages the previous run dirtied are copied back, so a reset costs a few
+ * hundred bytes rather than the whole 64KB.
+ *
+ * Coverage is an AFL-style map of branch edges with hit counts bucketed
+ * into powers of two. An input that sets a bit no earlier input set joins
+ * the queue; the queue is cycled through round-robin, each entry getting
+ * a burst of havoc mutations (bit flips, byte edits, arithmetic, block
+ * inserts and deletes, splices with other entries).
+ */
+class Fuzzer {
+private:
+  Memory memory;
+  CPU cpu;
+  std::vector<byte_t> snapshot; // Full image at the entry point
+  CpuState entry;
+  uint64_t instruction_limit;
+  size_t max_length;
+  uint32_t seed;
+
+  byte_t trace[COVERAGE_MAP_SIZE];       // Counts of the current run
+  byte_t virgin[COVERAGE_MAP_SIZE];      // Bucket bits not yet seen
+  byte_t virgin_hangs[COVERAGE_MAP_SIZE]; // The same, over hangs only
+
+  std::vector<std::vector<byte_t> > queue;
+  std::map<addr_t, size_t> crash_sites; // Faulting pc -> saved crash
+  std::string output_dir;
+  FuzzStats stats;
+
+  uint32_t random();
+  uint32_t random_below(uint32_t limit) { return random() % limit; }
+  void havoc(std::vector<byte_t> &input);
+  // Replace trace counts with their bucket bits
+  void classify();
+  // Clear the classified trace's bits from virgin_map; 2 if an edge was
+  // new, 1 if only a bucket was, else 0
+  int merge(byte_t *virgin_map) const;
+  void save(const char *subdir, size_t id, const std::vector<byte_t> &input,
+            const std::string &suffix = "");
+  void consider(const std::vector<byte_t> &input, FuzzOutcome outcome);
+
+public:
+  Fuzzer();
+
+  bool load(const std::string &binary);
+  void set_instruction_limit(uint64_t limit) { instruction_limit = limit; }
+  void set_max_length(size_t length) { max_length = length; }
+  void set_seed(uint32_t value) { seed = value ? value : 1; }
+  // Create <dir>/queue, crashes, hangs and corpus
+  bool set_output(const std::string &dir);
+
+  // Run one input from the snapshot, leaving its edge counts in trace
+  FuzzOutcome run(const std::vector<byte_t> &input);
+  // Seed inputs go through the queue rules like any other
+  void add_seed(const std::vector<byte_t> &input);
+  // Fuzz until max_execs (0 for no limit) or the time runs out
+  void fuzz(uint64_t max_execs, double max_seconds);
+  // Write the smallest subset of the queue with the same coverage to
+  // <output>/corpus, and return its size
+  size_t minimize();
+
+  const FuzzStats &get_stats() const { return stats; }
+  size_t queue_size() const { return queue.size(); }
+  size_t edges_covered() const;
+};
+
+#endif // FUZZER_H
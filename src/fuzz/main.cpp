@@ -0,0 +1,122 @@
+/**
+ * Coverage-Guided Fuzzer
+ *
+ * Fuzzes the console input of a guest program in-process: every input is
+ * run from a snapshot of the loaded program, and inputs that reach new
+ * branch edges are kept and mutated further. Crashes (Harvard faults and
+ * unknown opcodes) and hangs (runs that reach the instruction limit) are
+ * saved for replay with `emulator -H -i <file>`.
+ *
+ * Output directory layout:
+ *   queue/    every input that found new coverage, in discovery order
+ *   crashes/  the first input to crash at each pc (id_<n>_pc_<pc>)
+ *   hangs/    hangs with coverage no earlier hang had
+ *   corpus/   a minimized queue with the same coverage, written at the end
+ */
+
+#include "fuzzer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name
+            << " [options] <target.bin> [seed files...]\n";
+  std::cout << "Options:\n";
+  std::cout << "  -o <dir>            Output directory (default fuzz-out)\n";
+  std::cout << "  -n <execs>          Stop after this many executions\n";
+  std::cout << "  -t <seconds>        Stop after this long (default 10)\n";
+  std::cout << "  -m <bytes>          Longest input to try (default 256)\n";
+  std::cout << "  -l <instructions>   Per-run limit; reaching it is a hang "
+               "(default 50000)\n";
+  std::cout << "  -s <seed>           Random seed\n";
+  std::cout << "  -h, --help          Show this help message\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::string output_dir = "fuzz-out";
+  uint64_t max_execs = 0;
+  double max_seconds = 10;
+  size_t max_length = 256;
+  uint64_t instruction_limit = 50000;
+  uint32_t seed = 0;
+  std::string target;
+  std::vector<std::string> seed_files;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg == "-o" && has_value) {
+      output_dir = argv[++i];
+    } else if (arg == "-n" && has_value) {
+      max_execs = std::strtoull(argv[++i], NULL, 0);
+    } else if (arg == "-t" && has_value) {
+      max_seconds = std::atof(argv[++i]);
+    } else if (arg == "-m" && has_value) {
+      max_length = (size_t)std::max(1L, std::atol(argv[++i]));
+    } else if (arg == "-l" && has_value) {
+      instruction_limit = std::strtoull(argv[++i], NULL, 0);
+    } else if (arg == "-s" && has_value) {
+      seed = (uint32_t)std::strtoul(argv[++i], NULL, 0);
+    } else if (arg[0] != '-') {
+      if (target.empty())
+        target = arg;
+      else
+        seed_files.push_back(arg);
+    } else {
+      std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (target.empty() || instruction_limit == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (max_execs == 0 && max_seconds <= 0) {
+    std::cerr << "Error: Need an execution or time limit" << std::endl;
+    return 1;
+  }
+
+  Fuzzer *fuzzer = new Fuzzer();
+  fuzzer->set_instruction_limit(instruction_limit);
+  fuzzer->set_max_length(max_length);
+  if (seed)
+    fuzzer->set_seed(seed);
+  if (!fuzzer->load(target) || !fuzzer->set_output(output_dir))
+    return 1;
+
+  if (seed_files.empty())
+    fuzzer->add_seed(std::vector<byte_t>());
+  for (size_t i = 0; i < seed_files.size(); i++) {
+    std::ifstream file(seed_files[i].c_str(), std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Error: Could not open file '" << seed_files[i] << "'"
+                << std::endl;
+      return 1;
+    }
+    fuzzer->add_seed(std::vector<byte_t>(std::istreambuf_iterator<char>(file),
+                                         std::istreambuf_iterator<char>()));
+  }
+
+  std::cout << "Fuzzing '" << target << "' with " << fuzzer->queue_size()
+            << " seed input(s), " << fuzzer->edges_covered()
+            << " edges covered" << std::endl;
+  fuzzer->fuzz(max_execs, max_seconds);
+
+  size_t kept = fuzzer->minimize();
+  const FuzzStats &stats = fuzzer->get_stats();
+  std::cout << "Queue of " << fuzzer->queue_size() << " minimized to "
+            << kept << " in '" << output_dir << "/corpus'; "
+            << stats.unique_crashes << " unique crash(es) in '" << output_dir
+            << "/crashes'" << std::endl;
+  delete fuzzer;
+  return 0;
+}
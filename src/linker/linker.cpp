@@ -0,0 +1,247 @@
+/**
+ * Linker Implementation
+ *
+ * Linking runs in four steps:
+ *   1. Collect every object's global symbols, rejecting duplicates
+ *   2. Mark the atoms reachable from the entry atom and the kept symbols,
+ *      following relocations; an undefined symbol is reported here
+ *   3. Place the live text atoms in object order from PROGRAM_START, and
+ *      the live data atoms from DATA_START
+ *   4. Fill in each relocated address word; an undefined __data_end is
+ *      the first byte after the placed data
+ */
+
+#include "linker.h"
+#include <fstream>
+#include <iostream>
+
+Linker::Linker() : strip_enabled(true), stripped_atoms(0), stripped_bytes(0) {}
+
+bool Linker::add_object(const std::string &path) {
+  ObjectFile object;
+  if (!object.read(path))
+    return false;
+  objects.push_back(object);
+  object_names.push_back(path);
+  return true;
+}
+
+bool Linker::resolve_symbols() {
+  bool ok = true;
+  for (size_t i = 0; i < objects.size(); i++) {
+    const std::vector<ObjectSymbol> &symbols = objects[i].symbols;
+    for (size_t j = 0; j < symbols.size(); j++) {
+      if (!symbols[j].global)
+        continue;
+      std::map<std::string, Definition>::const_iterator existing =
+          globals.find(symbols[j].name);
+      if (existing != globals.end()) {
+        std::cerr << "Error: Symbol '" << symbols[j].name
+                  << "' is defined in both '"
+                  << object_names[existing->second.object] << "' and '"
+                  << object_names[i] << "'" << std::endl;
+        ok = false;
+        continue;
+      }
+      Definition definition = {i, symbols[j].atom, symbols[j].offset};
+      globals[symbols[j].name] = definition;
+    }
+  }
+  return ok;
+}
+
+bool Linker::find_external(size_t object, uint32_t external,
+                           Definition &definition) const {
+  std::map<std::string, Definition>::const_iterator it =
+      globals.find(objects[object].externals[external]);
+  if (it == globals.end())
+    return false;
+  definition = it->second;
+  return true;
+}
+
+bool Linker::mark_live() {
+  live.assign(objects.size(), std::vector<bool>());
+  std::vector<std::vector<std::vector<size_t> > > uses(objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    live[i].assign(objects[i].atoms.size(), !strip_enabled);
+    uses[i].resize(objects[i].atoms.size());
+    for (size_t r = 0; r < objects[i].relocations.size(); r++)
+      uses[i][objects[i].relocations[r].atom].push_back(r);
+  }
+
+  // Roots: the entry atom and the kept symbols
+  std::vector<std::pair<size_t, uint32_t> > work;
+  const std::vector<ObjectAtom> &first = objects[0].atoms;
+  for (uint32_t a = 0; a < first.size(); a++) {
+    if (first[a].section == SECTION_TEXT) {
+      work.push_back(std::make_pair((size_t)0, a));
+      break;
+    }
+  }
+  if (work.empty()) {
+    std::cerr << "Error: '" << object_names[0]
+              << "' has no code to start at" << std::endl;
+    return false;
+  }
+  for (size_t k = 0; k < kept_symbols.size(); k++) {
+    std::map<std::string, Definition>::const_iterator it =
+        globals.find(kept_symbols[k]);
+    if (it == globals.end()) {
+      std::cerr << "Error: Kept symbol '" << kept_symbols[k]
+                << "' is not defined" << std::endl;
+      return false;
+    }
+    work.push_back(std::make_pair(it->second.object, it->second.atom));
+  }
+  if (!strip_enabled) {
+    // Every atom is live, but references must still resolve
+    work.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+      for (uint32_t a = 0; a < objects[i].atoms.size(); a++)
+        work.push_back(std::make_pair(i, a));
+    }
+  } else {
+    for (size_t w = 0; w < work.size(); w++)
+      live[work[w].first][work[w].second] = true;
+  }
+
+  bool ok = true;
+  while (!work.empty()) {
+    size_t object = work.back().first;
+    uint32_t atom = work.back().second;
+    work.pop_back();
+    const std::vector<size_t> &relocations = uses[object][atom];
+    for (size_t r = 0; r < relocations.size(); r++) {
+      const ObjectRelocation &relocation =
+          objects[object].relocations[relocations[r]];
+      Definition target = {object, relocation.target, 0};
+      if (relocation.external &&
+          !find_external(object, relocation.target, target)) {
+        if (objects[object].externals[relocation.target] == DATA_END_SYMBOL)
+          continue; // Supplied once the data is placed
+        std::cerr << "Error: Undefined symbol '"
+                  << objects[object].externals[relocation.target]
+                  << "' referenced in '" << object_names[object] << "'"
+                  << std::endl;
+        ok = false;
+        continue;
+      }
+      if (!live[target.object][target.atom]) {
+        live[target.object][target.atom] = true;
+        work.push_back(std::make_pair(target.object, target.atom));
+      }
+    }
+  }
+  return ok;
+}
+
+bool Linker::lay_out() {
+  placed.assign(objects.size(), std::vector<addr_t>());
+  for (int section = 0; section < NUM_SECTIONS; section++) {
+    std::vector<byte_t> &target = section == SECTION_DATA ? data_image : image;
+    size_t address = section == SECTION_DATA ? DATA_START : PROGRAM_START;
+    for (size_t i = 0; i < objects.size(); i++) {
+      placed[i].resize(objects[i].atoms.size(), 0);
+      for (size_t a = 0; a < objects[i].atoms.size(); a++) {
+        const ObjectAtom &atom = objects[i].atoms[a];
+        if (atom.section != section)
+          continue;
+        if (!live[i][a]) {
+          stripped_atoms++;
+          stripped_bytes += atom.bytes.size();
+          continue;
+        }
+        placed[i][a] = (addr_t)address;
+        target.insert(target.end(), atom.bytes.begin(), atom.bytes.end());
+        address += atom.bytes.size();
+      }
+    }
+  }
+  if (image.size() > (size_t)(PROGRAM_END - PROGRAM_START) + 1) {
+    std::cerr << "Error: Linked program is " << image.size()
+              << " bytes, more than the code region holds" << std::endl;
+    return false;
+  }
+  if (data_image.size() > (size_t)(DATA_END - DATA_START) + 1) {
+    std::cerr << "Error: Linked data is " << data_image.size()
+              << " bytes, more than the data region holds" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void Linker::apply_relocations() {
+  for (size_t i = 0; i < objects.size(); i++) {
+    for (size_t r = 0; r < objects[i].relocations.size(); r++) {
+      const ObjectRelocation &relocation = objects[i].relocations[r];
+      if (!live[i][relocation.atom])
+        continue;
+      Definition target = {i, relocation.target, 0};
+      word_t value;
+      if (relocation.external && !find_external(i, relocation.target, target))
+        value = (word_t)(DATA_START + data_image.size() + relocation.addend);
+      else
+        value = (word_t)(placed[target.object][target.atom] + target.offset +
+                         relocation.addend);
+      bool in_data = objects[i].atoms[relocation.atom].section == SECTION_DATA;
+      std::vector<byte_t> &target_image = in_data ? data_image : image;
+      size_t site = placed[i][relocation.atom] -
+                    (in_data ? DATA_START : PROGRAM_START) +
+                    relocation.offset;
+      target_image[site] = (byte_t)(value & 0xFF);
+      target_image[site + 1] = (byte_t)(value >> 8);
+    }
+  }
+}
+
+bool Linker::link(const std::string &output_file) {
+  if (objects.empty()) {
+    std::cerr << "Error: No objects to link" << std::endl;
+    return false;
+  }
+  if (!resolve_symbols() || !mark_live() || !lay_out())
+    return false;
+  apply_relocations();
+
+  std::ofstream out(output_file.c_str(), std::ios::binary);
+  if (!out.is_open()) {
+    std::cerr << "Error: Could not create output file '" << output_file
+              << "'" << std::endl;
+    return false;
+  }
+  out.write((const char *)image.data(), image.size());
+  if (data_image.empty())
+    return true;
+
+  std::string data_file = output_file + ".data";
+  std::ofstream data_out(data_file.c_str(), std::ios::binary);
+  if (!data_out.is_open()) {
+    std::cerr << "Error: Could not create output file '" << data_file << "'"
+              << std::endl;
+    return false;
+  }
+  data_out.write((const char *)data_image.data(), data_image.size());
+  return true;
+}
+
+/**
+ * A local label whose name another object already used is written as
+ * "name@object"
+ */
+bool Linker::write_symbol_map(const std::string &path) const {
+  std::map<std::string, addr_t> symbols;
+  for (size_t i = 0; i < objects.size(); i++) {
+    for (size_t s = 0; s < objects[i].symbols.size(); s++) {
+      const ObjectSymbol &symbol = objects[i].symbols[s];
+      if (!live[i][symbol.atom])
+        continue;
+      std::string name = symbol.name;
+      if (!symbol.global && symbols.count(name))
+        name += "@" + object_names[i];
+      symbols[name] = (addr_t)(placed[i][symbol.atom] + symbol.offset);
+    }
+  }
+  return write_perf_map(path, symbols,
+                        (addr_t)(PROGRAM_START + image.size()));
+}
@@ -0,0 +1,66 @@
+#ifndef LINKER_H
+#define LINKER_H
+
+#include "../assembler/object_file.h"
+#include "../common/types.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Combines relocatable objects into a code image and a data image.
+ * Execution starts at the first object's first text atom, placed at
+ * PROGRAM_START; the data goes at DATA_START, where stores to it are
+ * allowed in Harvard mode. Only atoms the entry can reach through
+ * relocations (and those named by keep()) are linked.
+ */
+class Linker {
+private:
+  struct Definition {
+    size_t object;
+    uint32_t atom;
+    uint16_t offset;
+  };
+
+  std::vector<ObjectFile> objects;
+  std::vector<std::string> object_names;
+  std::map<std::string, Definition> globals;
+  std::vector<std::string> kept_symbols;
+  bool strip_enabled;
+
+  std::vector<std::vector<bool> > live;     // Per object, per atom
+  std::vector<std::vector<addr_t> > placed; // Address of each live atom
+  std::vector<byte_t> image;      // Text, loaded at PROGRAM_START
+  std::vector<byte_t> data_image; // Data, loaded at DATA_START
+  size_t stripped_atoms;
+  size_t stripped_bytes;
+
+  bool resolve_symbols();
+  bool find_external(size_t object, uint32_t external,
+                     Definition &definition) const;
+  bool mark_live();
+  bool lay_out();
+  void apply_relocations();
+
+public:
+  Linker();
+
+  // Keep atoms that nothing references (default: strip them)
+  void set_strip(bool enable) { strip_enabled = enable; }
+  // Keep the atom defining a global symbol and everything it uses
+  void keep(const std::string &symbol) { kept_symbols.push_back(symbol); }
+
+  bool add_object(const std::string &path);
+  // Write the code to output_file and any data to <output_file>.data
+  bool link(const std::string &output_file);
+
+  const std::vector<byte_t> &get_image() const { return image; }
+  const std::vector<byte_t> &get_data_image() const { return data_image; }
+  size_t get_stripped_atoms() const { return stripped_atoms; }
+  size_t get_stripped_bytes() const { return stripped_bytes; }
+
+  // Addresses of the linked labels, in the assembler's perf map format
+  bool write_symbol_map(const std::string &path) const;
+};
+
+#endif // LINKER_H
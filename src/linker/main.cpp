@@ -0,0 +1,80 @@
+/**
+ * Linker Entry Point
+ *
+ * Links relocatable objects written by "assembler -c" into a binary the
+ * emulator loads at PROGRAM_START, and any data into <output>.data, which
+ * is loaded at DATA_START along with it. Code and data that nothing
+ * reachable from the first object's entry uses are left out.
+ */
+
+#include "linker.h"
+#include <iostream>
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name
+            << " [options] <main.o> [more.o ...] -o <output.bin>\n";
+  std::cout << "Links objects; execution starts at the first object's "
+               "first instruction\n";
+  std::cout << "Options:\n";
+  std::cout << "  -o <file>              Output binary\n";
+  std::cout << "  -s, --symbols <file>   Also write a symbol map of the "
+               "linked labels\n";
+  std::cout << "  --keep <symbol>        Keep a symbol even if nothing "
+               "uses it\n";
+  std::cout << "  --no-strip             Keep all code and data\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> inputs;
+  std::string output_file;
+  std::string symbol_file;
+  Linker linker;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) {
+      output_file = argv[++i];
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      symbol_file = argv[++i];
+    } else if (arg == "--keep" && i + 1 < argc) {
+      linker.keep(argv[++i]);
+    } else if (arg == "--no-strip") {
+      linker.set_strip(false);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (!arg.empty() && arg[0] == '-') {
+      print_usage(argv[0]);
+      return 1;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+
+  if (inputs.empty() || output_file.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!linker.add_object(inputs[i]))
+      return 1;
+  }
+  if (!linker.link(output_file)) {
+    std::cerr << "Linking failed" << std::endl;
+    return 1;
+  }
+  std::cout << "Linked " << inputs.size() << " objects into "
+            << linker.get_image().size() << " bytes at '" << output_file
+            << "' (stripped " << linker.get_stripped_atoms()
+            << " unused blocks, " << linker.get_stripped_bytes()
+            << " bytes)" << std::endl;
+  if (!linker.get_data_image().empty())
+    std::cout << "Wrote " << linker.get_data_image().size()
+              << " data bytes to '" << output_file
+              << ".data' (loaded at 0x8000 with the binary)" << std::endl;
+
+  if (!symbol_file.empty() && !linker.write_symbol_map(symbol_file))
+    return 1;
+  return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * Program Specializer
+ *
+ * Rewrites a binary for inputs that are the same on every run: memory
+ * regions given with -c (a configuration header, a lookup table) and start
+ * registers given with -r. The output runs in the normal emulator, with
+ * the constant regions loaded as before (`emulator --load`), and computes
+ * the same results in fewer instructions.
+ */
+
+#include "specializer.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name
+            << " [options] <program.bin> <output.bin>\n";
+  std::cout << "Options:\n";
+  std::cout << "  -c <address>:<file>  Memory the program always finds "
+               "there and never writes\n";
+  std::cout << "                       (repeatable)\n";
+  std::cout << "  -r R<n>=<value>      Start value of a register (default "
+               "0, repeatable)\n";
+  std::cout << "  -h, --help           Show this help message\n";
+}
+
+/**
+ * Read a constant region for a -c <address>:<file> option
+ */
+static bool add_region(Specializer &specializer, const std::string &spec) {
+  char *end = NULL;
+  unsigned long address = std::strtoul(spec.c_str(), &end, 0);
+  if (*end != ':' || address >= MEMORY_SIZE) {
+    std::cerr << "Error: Invalid constant region '" << spec << "'\n";
+    return false;
+  }
+  std::string path = end + 1;
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << path << "'\n";
+    return false;
+  }
+  std::vector<byte_t> bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  return specializer.add_constant_region((addr_t)address, bytes);
+}
+
+static bool set_register(Specializer &specializer, const std::string &spec) {
+  if (spec.size() < 4 || (spec[0] != 'R' && spec[0] != 'r') ||
+      spec[1] < '0' || spec[1] >= '0' + NUM_REGISTERS || spec[2] != '=') {
+    std::cerr << "Error: Invalid register value '" << spec << "'\n";
+    return false;
+  }
+  char *end = NULL;
+  long value = std::strtol(spec.c_str() + 3, &end, 0);
+  if (*end != '\0' || value < -32768 || value > 0xFFFF) {
+    std::cerr << "Error: Invalid register value '" << spec << "'\n";
+    return false;
+  }
+  specializer.set_register(spec[1] - '0', (word_t)value);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  Specializer specializer;
+  std::vector<std::string> files;
+  std::vector<std::string> regions;
+  std::vector<std::string> registers;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg == "-c" && i + 1 < argc) {
+      regions.push_back(argv[++i]);
+    } else if (arg == "-r" && i + 1 < argc) {
+      registers.push_back(argv[++i]);
+    } else if (arg[0] != '-') {
+      files.push_back(arg);
+    } else {
+      std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (files.size() != 2) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  if (!specializer.load_program(files[0]))
+    return 1;
+  for (size_t i = 0; i < regions.size(); i++) {
+    if (!add_region(specializer, regions[i]))
+      return 1;
+  }
+  for (size_t i = 0; i < registers.size(); i++) {
+    if (!set_register(specializer, registers[i]))
+      return 1;
+  }
+
+  if (!specializer.specialize()) {
+    const std::vector<std::string> &errors = specializer.get_errors();
+    for (size_t i = 0; i < errors.size(); i++)
+      std::cerr << "Error: " << errors[i] << std::endl;
+    std::cerr << "Error: '" << files[0] << "' cannot be specialized"
+              << std::endl;
+    return 1;
+  }
+  if (!specializer.write_binary(files[1]))
+    return 1;
+
+  const SpecializeStats &stats = specializer.get_stats();
+  std::cout << "Specialized '" << files[0] << "' into '" << files[1]
+            << "' (" << specializer.get_output().size() * 2 << " bytes)"
+            << std::endl;
+  std::cout << "  Instructions: " << stats.reachable << " reachable -> "
+            << stats.emitted << " emitted (" << stats.unreachable
+            << " unreachable dropped)" << std::endl;
+  std::cout << "  Folded: " << stats.branches_folded << " branches, "
+            << stats.loads_folded << " loads, " << stats.constants_folded
+            << " constants, " << stats.addresses_folded << " addresses; "
+            << stats.dead_removed << " dead instructions removed"
+            << std::endl;
+  return 0;
+}
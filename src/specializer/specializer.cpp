@@ -0,0 +1,950 @@
+/**
+ * Partial Evaluator
+ *
+ * Three passes over the program:
+ *   1. Analysis: a worklist propagates an abstract state (known register,
+ *      SP and flag values, known memory bytes) from the entry point, and
+ *      joins it at every instruction until nothing changes. A branch
+ *      whose flags are known only passes the state down the side it takes.
+ *   2. Decisions: each reached instruction is kept, dropped, folded to a
+ *      constant or turned into a jump, using liveness of the registers
+ *      and flags in the rewritten program; the two are iterated together
+ *      because dropping an instruction can make its inputs dead.
+ *   3. Emission: the surviving instructions are laid out in their
+ *      original order and branch targets are relocated.
+ */
+
+#include "specializer.h"
+#include "../common/instructions.h"
+#include "../emulator/alu.h"
+#include "../emulator/memory.h"
+#include "../emulator/verifier.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+// Liveness bits: one per register, then the flags
+static const uint16_t LIVE_FLAGS = 1 << NUM_REGISTERS;
+static const uint16_t LIVE_REGISTERS = LIVE_FLAGS - 1;
+static const uint16_t LIVE_ALL = LIVE_REGISTERS | LIVE_FLAGS;
+
+static const int MAX_DECISION_ROUNDS = 64;
+
+static AbstractValue known(word_t value) {
+  AbstractValue v;
+  v.known = true;
+  v.value = value;
+  return v;
+}
+
+static AbstractValue unknown() {
+  AbstractValue v;
+  v.known = false;
+  v.value = 0;
+  return v;
+}
+
+static bool is_io(addr_t address) {
+  return address >= IO_START && address <= IO_END;
+}
+
+static bool fits_movi(word_t value) {
+  int16_t s = (int16_t)value;
+  return s >= -64 && s <= 63;
+}
+
+static bool is_conditional_branch(byte_t opcode) {
+  return opcode >= OP_JZ && opcode <= OP_JN;
+}
+
+// Instructions that write Rd through the ALU, and set every flag
+static bool is_alu(byte_t opcode) {
+  return (opcode >= OP_ADD && opcode <= OP_NOT) ||
+         (opcode >= OP_SHL && opcode <= OP_SHRI);
+}
+
+static bool branch_taken(byte_t opcode, word_t flags) {
+  switch (opcode) {
+  case OP_JZ:
+    return (flags & FLAG_ZERO) != 0;
+  case OP_JNZ:
+    return (flags & FLAG_ZERO) == 0;
+  case OP_JC:
+    return (flags & FLAG_CARRY) != 0;
+  case OP_JNC:
+    return (flags & FLAG_CARRY) == 0;
+  default:
+    return (flags & FLAG_NEGATIVE) != 0;
+  }
+}
+
+/**
+ * Evaluate an ALU instruction, or CMP/CMPI, on known operands, exactly as
+ * CPU::execute_instruction would
+ */
+static word_t evaluate(byte_t opcode, word_t rd, word_t rs, word_t rt,
+                       byte_t imm4, word_t &flags) {
+  switch (opcode) {
+  case OP_ADD:
+    return ALU::add(rs, rt, flags);
+  case OP_ADDI:
+    return ALU::add(rs, sign_extend_4bit(imm4), flags);
+  case OP_SUB:
+    return ALU::sub(rs, rt, flags);
+  case OP_SUBI:
+    return ALU::sub(rs, sign_extend_4bit(imm4), flags);
+  case OP_MUL:
+    return ALU::mul(rs, rt, flags);
+  case OP_DIV:
+    return ALU::div(rs, rt, flags);
+  case OP_INC:
+    return ALU::add(rd, 1, flags);
+  case OP_DEC:
+    return ALU::sub(rd, 1, flags);
+  case OP_AND:
+    return ALU::and_op(rs, rt, flags);
+  case OP_ANDI:
+    return ALU::and_op(rs, imm4, flags);
+  case OP_OR:
+    return ALU::or_op(rs, rt, flags);
+  case OP_ORI:
+    return ALU::or_op(rs, imm4, flags);
+  case OP_XOR:
+    return ALU::xor_op(rs, rt, flags);
+  case OP_NOT:
+    return ALU::not_op(rs, flags);
+  case OP_SHL:
+    return ALU::shl(rs, rt, flags);
+  case OP_SHLI:
+    return ALU::shl(rs, imm4, flags);
+  case OP_SHR:
+    return ALU::shr(rs, rt, flags);
+  case OP_SHRI:
+    return ALU::shr(rs, imm4, flags);
+  case OP_CMP:
+    return ALU::compare(rs, rt, flags);
+  default: // OP_CMPI
+    return ALU::compare(rs, sign_extend_4bit(imm4), flags);
+  }
+}
+
+/**
+ * The registers an ALU instruction or CMP reads, as liveness bits
+ */
+static uint16_t alu_sources(byte_t opcode, byte_t rd, byte_t rs, byte_t rt) {
+  switch (opcode) {
+  case OP_INC:
+  case OP_DEC:
+    return (uint16_t)(1 << rd);
+  case OP_ADDI:
+  case OP_SUBI:
+  case OP_ANDI:
+  case OP_ORI:
+  case OP_NOT:
+  case OP_SHLI:
+  case OP_SHRI:
+  case OP_CMPI:
+    return (uint16_t)(1 << rs);
+  default:
+    return (uint16_t)((1 << rs) | (1 << (rt & 0x07)));
+  }
+}
+
+/**
+ * MOVI, then SHLI/ORI for each remaining nonzero nibble, as the compiler
+ * builds constants
+ */
+static void materialize(byte_t reg, word_t value, std::vector<word_t> &out) {
+  int16_t s = (int16_t)value;
+  int nibbles = 0;
+  while ((s >> (4 * nibbles)) < -64 || (s >> (4 * nibbles)) > 63)
+    nibbles++;
+  out.push_back(MAKE_INSTR_IMM7(OP_MOVI, reg, s >> (4 * nibbles)));
+  int shift = 0;
+  for (int i = nibbles - 1; i >= 0; i--) {
+    shift += 4;
+    int nibble = (value >> (4 * i)) & 0x0F;
+    if (nibble == 0 && i > 0)
+      continue;
+    out.push_back(MAKE_INSTR(OP_SHLI, reg, reg, shift));
+    shift = 0;
+    if (nibble != 0)
+      out.push_back(MAKE_INSTR(OP_ORI, reg, reg, nibble));
+  }
+}
+
+static size_t materialize_length(word_t value) {
+  std::vector<word_t> words;
+  materialize(0, value, words);
+  return words.size();
+}
+
+static bool join_value(AbstractValue &into, const AbstractValue &from) {
+  if (into.known && (!from.known || from.value != into.value)) {
+    into = unknown();
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Merge from into into; true if into lost anything
+ */
+static bool join(AbstractState &into, const AbstractState &from) {
+  if (!into.reached) {
+    into = from;
+    return true;
+  }
+  bool changed = false;
+  for (int r = 0; r < NUM_REGISTERS; r++)
+    changed |= join_value(into.registers[r], from.registers[r]);
+  changed |= join_value(into.sp, from.sp);
+  changed |= join_value(into.flags, from.flags);
+  std::map<addr_t, byte_t>::iterator it = into.memory.begin();
+  while (it != into.memory.end()) {
+    std::map<addr_t, byte_t>::const_iterator other = from.memory.find(it->first);
+    if (other == from.memory.end() || other->second != it->second) {
+      into.memory.erase(it++);
+      changed = true;
+    } else {
+      ++it;
+    }
+  }
+  return changed;
+}
+
+static std::string hex(addr_t address) {
+  std::ostringstream text;
+  text << "0x" << std::hex << address;
+  return text.str();
+}
+
+Specializer::Specializer()
+    : code(PROGRAM_END + 1, 0), program_size(0),
+      constant(MEMORY_SIZE, false), constant_bytes(MEMORY_SIZE, 0) {
+  entry.reached = true;
+  for (int r = 0; r < NUM_REGISTERS; r++)
+    entry.registers[r] = known(0);
+  entry.sp = known(STACK_END);
+  entry.flags = known(0);
+}
+
+bool Specializer::load_program(const std::string &filename) {
+  std::ifstream file(filename.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open file '" << filename << "'"
+              << std::endl;
+    return false;
+  }
+  std::vector<byte_t> image((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  if (image.empty() || image.size() > code.size()) {
+    std::cerr << "Error: '" << filename
+              << "' does not fit in the code segment" << std::endl;
+    return false;
+  }
+  std::copy(image.begin(), image.end(), code.begin());
+  program_size = image.size();
+  // Its contents are only known at run time, since the program may have
+  // written them before any load the analysis sees
+  return Memory::read_data_file(filename, data_segment);
+}
+
+bool Specializer::add_constant_region(addr_t address,
+                                      const std::vector<byte_t> &bytes) {
+  if (address <= PROGRAM_END || address + bytes.size() > IO_START) {
+    std::cerr << "Error: Constant region at " << hex(address)
+              << " must lie within the data segment" << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < bytes.size(); i++) {
+    constant[address + i] = true;
+    constant_bytes[address + i] = bytes[i];
+  }
+  return true;
+}
+
+void Specializer::set_register(int reg, word_t value) {
+  entry.registers[reg] = known(value);
+}
+
+void Specializer::error(addr_t pc, const std::string &message) {
+  std::string text = "at " + hex(pc) + ": " + message;
+  if (std::find(errors.begin(), errors.end(), text) == errors.end())
+    errors.push_back(text);
+}
+
+word_t Specializer::fetch(addr_t address) const {
+  if (address >= program_size)
+    return 0;
+  word_t high = (size_t)address + 1 < program_size ? code[address + 1] : 0;
+  return (word_t)(code[address] | (high << 8));
+}
+
+/**
+ * A word load's value, if the address holds known bytes. The code segment
+ * and constant regions are fixed; the rest is known only from stores.
+ */
+bool Specializer::read_known(const AbstractState &state, addr_t address,
+                             word_t &value) const {
+  byte_t bytes[2];
+  for (int i = 0; i < 2; i++) {
+    addr_t a = (addr_t)(address + i);
+    if (is_io(a))
+      return false;
+    if (a <= PROGRAM_END) {
+      bytes[i] = code[a];
+    } else if (constant[a]) {
+      bytes[i] = constant_bytes[a];
+    } else {
+      std::map<addr_t, byte_t>::const_iterator it = state.memory.find(a);
+      if (it == state.memory.end())
+        return false;
+      bytes[i] = it->second;
+    }
+  }
+  value = (word_t)(bytes[0] | (bytes[1] << 8));
+  return true;
+}
+
+void Specializer::write_known(AbstractState &state,
+                              const AbstractValue &address,
+                              const AbstractValue &value, addr_t pc) {
+  if (!address.known) {
+    state.memory.clear(); // Could have been any of them
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    addr_t a = (addr_t)(address.value + i);
+    if (a <= PROGRAM_END || constant[a]) {
+      error(pc, "store to " + hex(a) +
+                    " in the code segment or a constant region");
+      return;
+    }
+    if (is_io(a))
+      continue;
+    if (value.known)
+      state.memory[a] = (byte_t)(i ? value.value >> 8 : value.value);
+    else
+      state.memory.erase(a);
+  }
+}
+
+/**
+ * Follow every path from the entry point and from each CALL target, to
+ * learn which RETs belong to which subroutine
+ */
+void Specializer::find_subroutines() {
+  decoded.assign(code.size(), false);
+  std::vector<addr_t> entries(1, PROGRAM_START);
+  std::set<addr_t> seen_entries(entries.begin(), entries.end());
+  for (size_t e = 0; e < entries.size(); e++) {
+    addr_t entry_point = entries[e];
+    std::set<addr_t> visited;
+    std::vector<addr_t> pending(1, entry_point);
+    while (!pending.empty()) {
+      addr_t pc = pending.back();
+      pending.pop_back();
+      if (pc >= program_size || (pc & 1) || !visited.insert(pc).second)
+        continue;
+      decoded[pc] = true;
+      byte_t opcode = GET_OPCODE(fetch(pc));
+      addr_t next = (addr_t)(pc + (is_two_word(opcode) ? 4 : 2));
+      addr_t target = fetch((addr_t)(pc + 2));
+      if (opcode == OP_RET) {
+        subroutine_rets[entry_point].insert(pc);
+      } else if (opcode == OP_JMP) {
+        pending.push_back(target);
+      } else if (is_conditional_branch(opcode)) {
+        pending.push_back(target);
+        pending.push_back(next);
+      } else if (opcode == OP_CALL) {
+        pending.push_back(next);
+        if (seen_entries.insert(target).second)
+          entries.push_back(target);
+      } else if (opcode != OP_HALT && opcode != OP_BRK &&
+                 std::string(get_opcode_name(opcode)) != "???") {
+        pending.push_back(next);
+      }
+    }
+  }
+}
+
+bool Specializer::propagate(addr_t target, const AbstractState &state,
+                            std::vector<addr_t> &worklist) {
+  if (target >= program_size || (target & 1)) {
+    error(target, "control reaches an address outside the program's "
+                  "instructions");
+    return false;
+  }
+  if (join(states[target], state))
+    worklist.push_back(target);
+  return true;
+}
+
+void Specializer::push(AbstractState &state, const AbstractValue &value,
+                       addr_t pc) {
+  if (state.sp.known)
+    state.sp.value = (word_t)(state.sp.value - 2);
+  write_known(state, state.sp, value, pc);
+}
+
+void Specializer::transfer(addr_t pc, std::vector<addr_t> &worklist) {
+  AbstractState s = states[pc];
+  word_t instruction = fetch(pc);
+  byte_t opcode = GET_OPCODE(instruction);
+  byte_t rd = GET_RD(instruction);
+  byte_t rs = GET_RS(instruction);
+  byte_t rt = GET_RT(instruction);
+  byte_t imm4 = GET_IMM4(instruction);
+  word_t operand = fetch((addr_t)(pc + 2));
+  addr_t next = (addr_t)(pc + (is_two_word(opcode) ? 4 : 2));
+  AbstractValue *r = s.registers;
+
+  switch (opcode) {
+  case OP_MOV:
+    r[rd] = r[rs];
+    break;
+  case OP_MOVI:
+    r[rd] = known((word_t)sign_extend_7bit(GET_IMM7(instruction)));
+    break;
+  case OP_LOAD_IND:
+  case OP_LOAD_DIR: {
+    AbstractValue address = opcode == OP_LOAD_DIR ? known(operand) : r[rs];
+    word_t value;
+    if (address.known && read_known(s, address.value, value))
+      r[rd] = known(value);
+    else
+      r[rd] = unknown();
+    break;
+  }
+  case OP_STORE_IND:
+    write_known(s, r[rd], r[rs], pc);
+    break;
+  case OP_STORE_DIR:
+    write_known(s, known(operand), r[rs], pc);
+    break;
+  case OP_JMP:
+    propagate(operand, s, worklist);
+    return;
+  case OP_JZ:
+  case OP_JNZ:
+  case OP_JC:
+  case OP_JNC:
+  case OP_JN:
+    if (!s.flags.known || branch_taken(opcode, s.flags.value))
+      propagate(operand, s, worklist);
+    if (!s.flags.known || !branch_taken(opcode, s.flags.value))
+      propagate(next, s, worklist);
+    return;
+  case OP_CALL: {
+    push(s, known(next), pc);
+    // A new return site: the subroutine's RETs must flow to it too
+    if (return_sites[operand].insert(next).second) {
+      const std::set<addr_t> &rets = subroutine_rets[operand];
+      for (std::set<addr_t>::const_iterator it = rets.begin();
+           it != rets.end(); ++it) {
+        if (states[*it].reached)
+          worklist.push_back(*it);
+      }
+    }
+    propagate(operand, s, worklist);
+    return;
+  }
+  case OP_RET: {
+    if (s.sp.known)
+      s.sp.value = (word_t)(s.sp.value + 2);
+    bool owned = false;
+    for (std::map<addr_t, std::set<addr_t> >::const_iterator sub =
+             subroutine_rets.begin();
+         sub != subroutine_rets.end(); ++sub) {
+      if (sub->first == PROGRAM_START || !sub->second.count(pc))
+        continue;
+      owned = true;
+      const std::set<addr_t> &sites = return_sites[sub->first];
+      for (std::set<addr_t>::const_iterator it = sites.begin();
+           it != sites.end(); ++it)
+        propagate(*it, s, worklist);
+    }
+    if (!owned)
+      error(pc, "RET outside any subroutine");
+    return;
+  }
+  case OP_PUSH:
+    push(s, r[rs], pc);
+    break;
+  case OP_POP: {
+    word_t value;
+    if (s.sp.known && read_known(s, s.sp.value, value))
+      r[rd] = known(value);
+    else
+      r[rd] = unknown();
+    if (s.sp.known)
+      s.sp.value = (word_t)(s.sp.value + 2);
+    break;
+  }
+  case OP_HALT:
+    return;
+  case OP_BRK:
+    error(pc, "BRK in the program");
+    return;
+  default: {
+    if (!is_alu(opcode) && opcode != OP_CMP && opcode != OP_CMPI)
+      return; // Unknown opcode: the program stops here
+    uint16_t sources = alu_sources(opcode, rd, rs, rt);
+    bool all_known = true;
+    for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+      if ((sources & (1 << reg)) && !r[reg].known)
+        all_known = false;
+    }
+    if (all_known) {
+      word_t flags = 0;
+      word_t result = evaluate(opcode, r[rd].value, r[rs].value,
+                               r[rt & 0x07].value, imm4, flags);
+      s.flags = known(flags);
+      if (is_alu(opcode))
+        r[rd] = known(result);
+    } else {
+      s.flags = unknown();
+      if (is_alu(opcode))
+        r[rd] = unknown();
+    }
+    break;
+  }
+  }
+  propagate(next, s, worklist);
+}
+
+void Specializer::analyze() {
+  AbstractState unreached;
+  unreached.reached = false;
+  states.assign(code.size(), unreached);
+  find_subroutines();
+
+  std::vector<addr_t> worklist;
+  propagate(PROGRAM_START, entry, worklist);
+  while (!worklist.empty()) {
+    addr_t pc = worklist.back();
+    worklist.pop_back();
+    transfer(pc, worklist);
+  }
+}
+
+/**
+ * Successors in the rewritten program. CALL and RET have none here: they
+ * use every register, so nothing after them matters to liveness.
+ */
+std::vector<addr_t> Specializer::successors(addr_t pc) const {
+  std::vector<addr_t> next_pcs;
+  byte_t opcode = GET_OPCODE(fetch(pc));
+  addr_t next = (addr_t)(pc + (is_two_word(opcode) ? 4 : 2));
+  addr_t target = fetch((addr_t)(pc + 2));
+  if (residual[pc] == RESIDUAL_JUMP || opcode == OP_JMP) {
+    next_pcs.push_back(target);
+  } else if (is_conditional_branch(opcode)) {
+    if (residual[pc] == RESIDUAL_KEEP)
+      next_pcs.push_back(target);
+    next_pcs.push_back(next);
+  } else if (opcode <= OP_STORE_DIR || is_alu(opcode) || opcode == OP_CMP ||
+             opcode == OP_CMPI || opcode == OP_PUSH || opcode == OP_POP) {
+    next_pcs.push_back(next);
+  }
+  return next_pcs;
+}
+
+uint16_t Specializer::uses(addr_t pc) const {
+  word_t instruction = fetch(pc);
+  byte_t opcode = GET_OPCODE(instruction);
+  byte_t rd = GET_RD(instruction);
+  byte_t rs = GET_RS(instruction);
+  switch (residual[pc]) {
+  case RESIDUAL_DROP:
+  case RESIDUAL_CONSTANT:
+  case RESIDUAL_JUMP:
+    return 0;
+  case RESIDUAL_DIRECT:
+    return opcode == OP_STORE_IND ? (uint16_t)(1 << rs) : 0;
+  default:
+    break;
+  }
+  switch (opcode) {
+  case OP_MOV:
+    return rd == rs ? 0 : (uint16_t)(1 << rs);
+  case OP_MOVI:
+  case OP_LOAD_DIR:
+  case OP_POP:
+  case OP_JMP:
+    return 0;
+  case OP_LOAD_IND:
+  case OP_STORE_DIR:
+  case OP_PUSH:
+    return (uint16_t)(1 << rs);
+  case OP_STORE_IND:
+    return (uint16_t)((1 << rd) | (1 << rs));
+  case OP_JZ:
+  case OP_JNZ:
+  case OP_JC:
+  case OP_JNC:
+  case OP_JN:
+    return LIVE_FLAGS;
+  case OP_HALT:
+    return LIVE_REGISTERS;
+  default:
+    if (is_alu(opcode) || opcode == OP_CMP || opcode == OP_CMPI)
+      return alu_sources(opcode, rd, rs, GET_RT(instruction));
+    return LIVE_ALL; // CALL, RET, and opcodes that stop the program
+  }
+}
+
+uint16_t Specializer::defines(addr_t pc) const {
+  word_t instruction = fetch(pc);
+  byte_t opcode = GET_OPCODE(instruction);
+  byte_t rd = GET_RD(instruction);
+  switch (residual[pc]) {
+  case RESIDUAL_DROP:
+  case RESIDUAL_JUMP:
+    return 0;
+  case RESIDUAL_CONSTANT:
+    return (uint16_t)((1 << rd) |
+                      (materialize_length(folded[pc]) > 1 ? LIVE_FLAGS : 0));
+  default:
+    break;
+  }
+  if (opcode == OP_MOV)
+    return rd == GET_RS(instruction) ? 0 : (uint16_t)(1 << rd);
+  if (opcode == OP_MOVI || opcode == OP_LOAD_IND || opcode == OP_LOAD_DIR ||
+      opcode == OP_POP)
+    return (uint16_t)(1 << rd);
+  if (is_alu(opcode))
+    return (uint16_t)((1 << rd) | LIVE_FLAGS);
+  if (opcode == OP_CMP || opcode == OP_CMPI)
+    return LIVE_FLAGS;
+  return 0;
+}
+
+void Specializer::compute_liveness() {
+  std::vector<uint16_t> live_in(code.size(), 0);
+  live_out.assign(code.size(), 0);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = program_size & ~(size_t)1; i-- > 0;) {
+      addr_t pc = (addr_t)i;
+      if (!states[pc].reached)
+        continue;
+      std::vector<addr_t> next_pcs = successors(pc);
+      uint16_t out = 0;
+      for (size_t n = 0; n < next_pcs.size(); n++)
+        out |= live_in[next_pcs[n]];
+      uint16_t in = (uint16_t)(uses(pc) | (out & ~defines(pc)));
+      if (out != live_out[pc] || in != live_in[pc]) {
+        live_out[pc] = out;
+        live_in[pc] = in;
+        changed = true;
+      }
+    }
+  }
+}
+
+/**
+ * The value an ALU instruction, MOV or load leaves in Rd, if known
+ */
+bool Specializer::known_result(addr_t pc, word_t &value) const {
+  const AbstractState &s = states[pc];
+  word_t instruction = fetch(pc);
+  byte_t opcode = GET_OPCODE(instruction);
+  byte_t rd = GET_RD(instruction);
+  byte_t rs = GET_RS(instruction);
+  byte_t rt = GET_RT(instruction);
+  if (opcode == OP_MOV) {
+    value = s.registers[rs].value;
+    return s.registers[rs].known;
+  }
+  if (opcode == OP_LOAD_IND || opcode == OP_LOAD_DIR) {
+    AbstractValue address = opcode == OP_LOAD_DIR
+                                ? known(fetch((addr_t)(pc + 2)))
+                                : s.registers[rs];
+    return address.known && read_known(s, address.value, value);
+  }
+  uint16_t sources = alu_sources(opcode, rd, rs, rt);
+  for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+    if ((sources & (1 << reg)) && !s.registers[reg].known)
+      return false;
+  }
+  word_t flags = 0;
+  value = evaluate(opcode, s.registers[rd].value, s.registers[rs].value,
+                   s.registers[rt & 0x07].value, GET_IMM4(instruction),
+                   flags);
+  return true;
+}
+
+void Specializer::decide(addr_t pc) {
+  const AbstractState &s = states[pc];
+  word_t instruction = fetch(pc);
+  byte_t opcode = GET_OPCODE(instruction);
+  byte_t rd = GET_RD(instruction);
+  byte_t rs = GET_RS(instruction);
+  bool rd_live = (live_out[pc] & (1 << rd)) != 0;
+  bool flags_live = (live_out[pc] & LIVE_FLAGS) != 0;
+  Residual decision = RESIDUAL_KEEP;
+  word_t value = 0;
+
+  switch (opcode) {
+  case OP_MOV:
+  case OP_MOVI:
+    if (opcode == OP_MOV && rd == rs)
+      decision = RESIDUAL_DROP; // NOP
+    else if (!rd_live)
+      decision = RESIDUAL_DROP;
+    else if (opcode == OP_MOV && known_result(pc, value) && fits_movi(value))
+      decision = RESIDUAL_CONSTANT;
+    break;
+  case OP_LOAD_IND:
+  case OP_LOAD_DIR: {
+    AbstractValue address = opcode == OP_LOAD_DIR
+                                ? known(fetch((addr_t)(pc + 2)))
+                                : s.registers[rs];
+    // A load that may touch a device has an effect even if unused
+    if (!address.known || is_io(address.value) ||
+        is_io((addr_t)(address.value + 1)))
+      break;
+    bool from_code = address.value <= PROGRAM_END ||
+                     (addr_t)(address.value + 1) <= PROGRAM_END;
+    bool value_known = known_result(pc, value);
+    if (!rd_live)
+      decision = RESIDUAL_DROP;
+    else if (value_known && (fits_movi(value) || (from_code && !flags_live)))
+      decision = RESIDUAL_CONSTANT;
+    else if (from_code)
+      error(pc, "a read of the code segment that cannot be replaced by a "
+                "constant");
+    else if (opcode == OP_LOAD_IND)
+      decision = RESIDUAL_DIRECT;
+    break;
+  }
+  case OP_STORE_IND:
+    if (s.registers[rd].known)
+      decision = RESIDUAL_DIRECT;
+    break;
+  case OP_JZ:
+  case OP_JNZ:
+  case OP_JC:
+  case OP_JNC:
+  case OP_JN:
+    if (s.flags.known)
+      decision = branch_taken(opcode, s.flags.value) ? RESIDUAL_JUMP
+                                                     : RESIDUAL_DROP;
+    break;
+  default:
+    if (opcode == OP_CMP || opcode == OP_CMPI) {
+      if (!flags_live)
+        decision = RESIDUAL_DROP;
+    } else if (is_alu(opcode)) {
+      if (!rd_live && !flags_live)
+        decision = RESIDUAL_DROP;
+      else if (!flags_live && known_result(pc, value) && fits_movi(value))
+        decision = RESIDUAL_CONSTANT;
+    }
+    break;
+  }
+  residual[pc] = decision;
+  folded[pc] = value;
+}
+
+bool Specializer::falls_through(addr_t from, addr_t target,
+                                const std::vector<size_t> &sizes) const {
+  if (target <= from)
+    return false;
+  for (addr_t pc = (addr_t)(from + 2); pc < target; pc += 2) {
+    if (states[pc].reached && sizes[pc] != 0)
+      return false;
+  }
+  return true;
+}
+
+void Specializer::emit() {
+  // Words each reached instruction becomes
+  std::vector<size_t> sizes(code.size(), 0);
+  for (size_t pc = 0; pc < program_size; pc += 2) {
+    if (!states[pc].reached)
+      continue;
+    byte_t opcode = GET_OPCODE(fetch((addr_t)pc));
+    switch (residual[pc]) {
+    case RESIDUAL_DROP:
+      break;
+    case RESIDUAL_CONSTANT:
+      sizes[pc] = materialize_length(folded[pc]);
+      break;
+    case RESIDUAL_JUMP:
+    case RESIDUAL_DIRECT:
+      sizes[pc] = 2;
+      break;
+    default:
+      sizes[pc] = is_two_word(opcode) ? 2 : 1;
+      break;
+    }
+    if (is_two_word(opcode) && pc + 2 < program_size &&
+        states[pc + 2].reached)
+      error((addr_t)pc, "an instruction overlaps the one at " +
+                            hex((addr_t)(pc + 2)));
+  }
+
+  // Jumps to whatever comes next anyway
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t pc = 0; pc < program_size; pc += 2) {
+      bool jump = residual[pc] == RESIDUAL_JUMP ||
+                  (residual[pc] == RESIDUAL_KEEP &&
+                   GET_OPCODE(fetch((addr_t)pc)) == OP_JMP);
+      if (states[pc].reached && jump && sizes[pc] != 0 &&
+          falls_through((addr_t)pc, fetch((addr_t)(pc + 2)), sizes)) {
+        sizes[pc] = 0;
+        changed = true;
+      }
+    }
+  }
+
+  // Start registers the program reads before writing
+  std::vector<word_t> prologue;
+  uint16_t entry_live = (uint16_t)(uses(PROGRAM_START) |
+                                   (live_out[PROGRAM_START] &
+                                    ~defines(PROGRAM_START)));
+  for (int r = 0; r < NUM_REGISTERS; r++) {
+    word_t value = entry.registers[r].value;
+    if (value == 0 || !(entry_live & (1 << r)))
+      continue;
+    if (materialize_length(value) > 1 && (entry_live & LIVE_FLAGS))
+      error(PROGRAM_START, "the flags are read before they are set, and "
+                           "loading the start registers would change them");
+    materialize((byte_t)r, value, prologue);
+  }
+
+  std::vector<addr_t> relocated(code.size(), 0);
+  size_t address = prologue.size() * 2;
+  for (size_t pc = 0; pc < program_size; pc += 2) {
+    relocated[pc] = (addr_t)address;
+    if (states[pc].reached)
+      address += sizes[pc] * 2;
+  }
+  if (address > code.size()) {
+    error(PROGRAM_START, "the specialized program does not fit in the code "
+                         "segment");
+    return;
+  }
+
+  output = prologue;
+  stats.emitted = prologue.size();
+  for (size_t pc = 0; pc < program_size; pc += 2) {
+    if (!states[pc].reached)
+      continue;
+    word_t instruction = fetch((addr_t)pc);
+    byte_t opcode = GET_OPCODE(instruction);
+    word_t operand = fetch((addr_t)(pc + 2));
+    const AbstractState &s = states[pc];
+    if (residual[pc] == RESIDUAL_DROP || sizes[pc] == 0) {
+      if (!is_conditional_branch(opcode))
+        stats.dead_removed++;
+      continue;
+    }
+    stats.emitted++;
+    switch (residual[pc]) {
+    case RESIDUAL_CONSTANT: {
+      size_t before = output.size();
+      materialize(GET_RD(instruction), folded[pc], output);
+      stats.emitted += output.size() - before - 1;
+      if (opcode == OP_LOAD_IND || opcode == OP_LOAD_DIR)
+        stats.loads_folded++;
+      else
+        stats.constants_folded++;
+      break;
+    }
+    case RESIDUAL_JUMP:
+      output.push_back(MAKE_INSTR(OP_JMP, 0, 0, 0));
+      output.push_back(relocated[operand]);
+      break;
+    case RESIDUAL_DIRECT:
+      stats.addresses_folded++;
+      if (opcode == OP_LOAD_IND) {
+        output.push_back(MAKE_INSTR(OP_LOAD_DIR, GET_RD(instruction), 0, 0));
+        output.push_back(s.registers[GET_RS(instruction)].value);
+      } else {
+        output.push_back(MAKE_INSTR(OP_STORE_DIR, 0, GET_RS(instruction), 0));
+        output.push_back(s.registers[GET_RD(instruction)].value);
+      }
+      break;
+    default:
+      output.push_back(instruction);
+      if (opcode >= OP_JMP && opcode <= OP_CALL)
+        output.push_back(relocated[operand]);
+      else if (is_two_word(opcode))
+        output.push_back(operand);
+      break;
+    }
+  }
+}
+
+bool Specializer::specialize() {
+  errors.clear();
+  stats = SpecializeStats();
+  analyze();
+  if (!errors.empty())
+    return false;
+
+  residual.assign(code.size(), RESIDUAL_KEEP);
+  folded.assign(code.size(), 0);
+  bool settled = false;
+  for (int round = 0; round < MAX_DECISION_ROUNDS && !settled; round++) {
+    compute_liveness();
+    std::vector<Residual> previous = residual;
+    for (size_t pc = 0; pc < program_size; pc += 2) {
+      if (states[pc].reached)
+        decide((addr_t)pc);
+    }
+    settled = residual == previous;
+  }
+  if (!settled) {
+    error(PROGRAM_START, "the rewriting decisions did not settle");
+    return false;
+  }
+
+  for (size_t pc = 0; pc < program_size; pc += 2) {
+    if (states[pc].reached) {
+      stats.reachable++;
+      byte_t opcode = GET_OPCODE(fetch((addr_t)pc));
+      if (is_conditional_branch(opcode) && states[pc].flags.known)
+        stats.branches_folded++;
+    } else if (decoded[pc]) {
+      stats.unreachable++;
+    }
+  }
+  emit();
+  return errors.empty();
+}
+
+bool Specializer::write_binary(const std::string &filename) const {
+  std::ofstream file(filename.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not create file '" << filename << "'"
+              << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < output.size(); i++) {
+    file.put((char)(output[i] & 0xFF));
+    file.put((char)(output[i] >> 8));
+  }
+  if (!file.good() || data_segment.empty())
+    return file.good();
+
+  std::string data_path = filename + ".data";
+  std::ofstream data_file(data_path.c_str(), std::ios::binary);
+  if (!data_file.is_open()) {
+    std::cerr << "Error: Could not create file '" << data_path << "'"
+              << std::endl;
+    return false;
+  }
+  data_file.write((const char *)&data_segment[0], data_segment.size());
+  return data_file.good();
+}
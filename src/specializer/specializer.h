@@ -0,0 +1,136 @@
+#ifndef SPECIALIZER_H
+#define SPECIALIZER_H
+
+#include "../common/types.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// A register, SP or flags word: a known constant or unknown
+struct AbstractValue {
+  bool known;
+  word_t value;
+};
+
+// What is known on entry to one instruction
+struct AbstractState {
+  bool reached;
+  AbstractValue registers[NUM_REGISTERS];
+  AbstractValue sp;
+  AbstractValue flags;
+  // Bytes of writable memory known from earlier stores. Constant regions
+  // and the code segment are looked up separately and never change.
+  std::map<addr_t, byte_t> memory;
+};
+
+// How one reachable instruction appears in the specialized program
+enum Residual {
+  RESIDUAL_KEEP = 0, // Unchanged, apart from relocated branch targets
+  RESIDUAL_DROP,     // Dead, a no-op, or a branch never taken
+  RESIDUAL_CONSTANT, // Result known: load it into Rd instead
+  RESIDUAL_JUMP,     // Conditional branch always taken
+  RESIDUAL_DIRECT    // Indirect load or store with a known address
+};
+
+struct SpecializeStats {
+  size_t reachable;         // Instructions the analysis can reach
+  size_t emitted;           // Instructions in the specialized program
+  size_t unreachable;       // Instructions decoded but never reached
+  size_t branches_folded;   // Conditional branches with a known outcome
+  size_t loads_folded;      // Loads replaced by a constant or removed
+  size_t constants_folded;  // Other instructions replaced by a constant
+  size_t addresses_folded;  // Indirect accesses made direct
+  size_t dead_removed;      // Instructions left with no effect
+};
+
+/**
+ * Partial evaluator: specializes a program for memory regions and start
+ * registers whose values are fixed across runs, such as a configuration
+ * header. Constants are propagated through the control flow graph from
+ * the entry point, following only the branch outcomes still possible.
+ * The program is then rewritten: unreachable code is dropped, branches
+ * with a known outcome become jumps or disappear, loads and ALU results
+ * with a known value become MOVIs or are removed when nothing uses them,
+ * and indirect accesses with a known address become direct ones.
+ *
+ * Assumptions, which hold for compiled programs:
+ *   - Constant regions and the code segment are never written; a store
+ *     to a known address in one of them is reported as an error.
+ *   - A store through a computed address never lands in them either.
+ *   - RET returns to the instruction after the CALL that entered the
+ *     subroutine.
+ *   - No data is read from the code segment through a computed address
+ *     (the code moves when it is rewritten).
+ * Console input is always unknown, and every access to the I/O page is
+ * kept. Registers hold the same values at HALT; flags may not.
+ */
+class Specializer {
+private:
+  std::vector<byte_t> code;    // The code segment (PROGRAM_START..END)
+  size_t program_size;
+  std::vector<byte_t> data_segment; // Copied to the output unchanged
+  std::vector<bool> constant;  // Per address: in a constant region
+  std::vector<byte_t> constant_bytes;
+  AbstractState entry;
+  std::vector<std::string> errors;
+
+  // Analysis results, indexed by instruction address
+  std::vector<AbstractState> states;
+  std::vector<bool> decoded; // Instructions found by following all paths
+  std::map<addr_t, std::set<addr_t> > subroutine_rets; // Entry -> its RETs
+  std::map<addr_t, std::set<addr_t> > return_sites;    // Entry -> sites
+
+  // Rewriting decisions
+  std::vector<Residual> residual;
+  std::vector<word_t> folded;            // Value for RESIDUAL_CONSTANT
+  std::vector<uint16_t> live_out;        // Bit r: register r, bit 8: flags
+  std::vector<word_t> output;
+  SpecializeStats stats;
+
+  word_t fetch(addr_t address) const;
+  bool read_known(const AbstractState &state, addr_t address,
+                  word_t &value) const;
+  void write_known(AbstractState &state, const AbstractValue &address,
+                   const AbstractValue &value, addr_t pc);
+  void push(AbstractState &state, const AbstractValue &value, addr_t pc);
+  void find_subroutines();
+  bool propagate(addr_t target, const AbstractState &state,
+                 std::vector<addr_t> &worklist);
+  void analyze();
+  void transfer(addr_t pc, std::vector<addr_t> &worklist);
+
+  std::vector<addr_t> successors(addr_t pc) const;
+  uint16_t uses(addr_t pc) const;
+  uint16_t defines(addr_t pc) const;
+  bool known_result(addr_t pc, word_t &value) const;
+  void decide(addr_t pc);
+  void compute_liveness();
+  // Whether a jump at from would land on the next emitted instruction
+  bool falls_through(addr_t from, addr_t target,
+                     const std::vector<size_t> &sizes) const;
+  void emit();
+
+  void error(addr_t pc, const std::string &message);
+
+public:
+  Specializer();
+
+  // The program to specialize, loaded at PROGRAM_START, and its .data
+  bool load_program(const std::string &filename);
+  // Bytes the program will always find at address, and never write
+  bool add_constant_region(addr_t address, const std::vector<byte_t> &bytes);
+  // A start register other than its reset value of 0
+  void set_register(int reg, word_t value);
+
+  // Analyze and rewrite; false with errors if the program breaks one of
+  // the assumptions above
+  bool specialize();
+
+  const std::vector<word_t> &get_output() const { return output; }
+  const SpecializeStats &get_stats() const { return stats; }
+  const std::vector<std::string> &get_errors() const { return errors; }
+  bool write_binary(const std::string &filename) const;
+};
+
+#endif // SPECIALIZER_H